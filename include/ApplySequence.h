@@ -10,6 +10,8 @@
 
 /*
  * Command for applying a DNA string sequence to a selected strand and its opposites
+ * The same sequence is applied to every target or selected base. With -fasta, every record of a multi-FASTA file is applied
+ * to the targets in order or, without targets, from the base named by the first word of its header.
  */
 
 #include <Definition.h>
@@ -0,0 +1,27 @@
+#ifndef _CONVERTOXDNABINARY_H_
+#define _CONVERTOXDNABINARY_H_
+
+#include <Definition.h>
+
+#include <maya/MPxCommand.h>
+
+#define MEL_CONVERTOXDNABINARY_COMMAND "convertOxDnaBinary"
+
+/*
+ * Converts binary oxDNA topology and configuration files to the text format oxDNA reads. The text files are written next to the
+ * binary ones. If no files are given, the user is asked for a binary topology and its configuration is converted as well.
+ */
+
+namespace Helix {
+	class VHELIXAPI ConvertOxDnaBinary : public MPxCommand {
+	public:
+		virtual MStatus doIt(const MArgList & args);
+		virtual bool isUndoable () const;
+		virtual bool hasSyntax () const;
+
+		static void *creator();
+		static MSyntax newSyntax();
+	};
+}
+
+#endif /* N _CONVERTOXDNABINARY_H_ */
@@ -14,9 +14,11 @@
 
 #include <Definition.h>
 
+#include <model/BaseBatch.h>
 #include <model/Helix.h>
 
 #include <list>
+#include <vector>
 
 #include <maya/MPxCommand.h>
 #include <maya/MObject.h>
@@ -52,6 +54,13 @@ namespace Helix {
 
 		MStatus create(int bases, const MTransformationMatrix & transform, Model::Helix & helix, const MString & name = "helix1", bool showProgressBar = true);
 
+		/*
+		 * Creates many helices at once, e.g. a lattice block. The helix i gets bases[i] bases and the transform transforms[i].
+		 * All bases are created with a single Model::BaseBatch, and the selection and progress are only updated once.
+		 */
+
+		MStatus create(const std::vector<MTransformationMatrix> & transforms, const std::vector<int> & bases, std::vector<Model::Helix> & helices, const MString & name = "helix1", bool showProgressBar = true);
+
 	private:
 		/*
 		 * The createHelix along CV curve puts requirements on the generated bases
@@ -83,6 +92,25 @@ namespace Helix {
 
 		MStatus createHelix(int bases, Model::Helix & helix, const MTransformationMatrix & transform = MTransformationMatrix::identity, const CreateBaseControl & control = CreateBaseControl(), const MString & name = "helix1", bool showProgressBar = true);
 
+		/*
+		 * Creates the helix node and queues its bases and their connections in the batch. table is the base positions by index, see Creator.cpp.
+		 */
+
+		MStatus addHelix(Model::BaseBatch & batch, int bases, const std::vector<MVector> & table, const MTransformationMatrix & transform, const CreateBaseControl & control, const MString & name, const Model::Material *materials, Model::Helix & helix);
+
+		/*
+		 * Creates all helices with a single batch, each with new random materials. The helix i gets bases[i] bases and the transform
+		 * transforms[i]. The materials picked are stored in m_bundleMaterials, and reused instead of picked again when redoing.
+		 */
+
+		MStatus createHelixBundle(const std::vector<MTransformationMatrix> & transforms, const std::vector<int> & bases, std::vector<Model::Helix> & helices, const MString & name = "helix1", bool showProgressBar = true);
+
+		/*
+		 * The transform of a helix centered at center along normal, rotated by rotation degrees around its axis.
+		 */
+
+		static MStatus helixTransform(const MVector & center, const MVector & normal, double rotation, MTransformationMatrix & matrix);
+
 		/*
 		 * Create a helix along the line between the two given points
 		 * either calculate the number of bases to generate and round to the nearest integer
@@ -119,7 +147,8 @@ namespace Helix {
 			CREATE_BETWEEN = 2,
 			CREATE_ORIENTED = 3,
 			CREATE_ALONG_CURVE = 4,
-			CREATE_TRANSFORMED = 5
+			CREATE_TRANSFORMED = 5,
+			CREATE_BUNDLE = 6
 		} m_redoMode;
 
 		struct {
@@ -128,11 +157,21 @@ namespace Helix {
 			double rotation;
 			std::vector<MPointArray> points;
 			MTransformationMatrix transform;
+			std::vector<MTransformationMatrix> transforms;
+			std::vector<int> bundleBases;
+			MString name;
 		} m_redoData;
 
 		std::list<Model::Helix> m_helices;
 		Model::Material m_materials[2];
 
+		/*
+		 * Two materials per helix created by createHelixBundle, in order. m_bundleMaterialsUsed is the number already used by this do or redo.
+		 */
+
+		std::vector<Model::Material> m_bundleMaterials;
+		size_t m_bundleMaterialsUsed;
+
 		MStatus randomizeMaterials();
 	};
 }
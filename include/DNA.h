@@ -23,18 +23,26 @@
 #define STRAND_NAMES	"forw", "backw"
 
 /*
- * There's no string concatenation available, if PITCH or STEP is changed below, it must be changed here as well for cylinder texturing to work..
+ * There's no string concatenation available, if PITCH_TURNS, PITCH_BASES or STEP is changed below, it must be changed here as well for cylinder texturing to work..
  */
 
 #define PITCH_STR "720.0 / 21.0"
 #define STEP_STR "0.334"
 
 namespace DNA {
+	/*
+	 * The helix makes PITCH_TURNS full turns every PITCH_BASES base pairs. Change these and not PITCH, thus the rotation of a base pair
+	 * always repeats after a whole number of base pairs, see PITCH_PERIOD below.
+	 */
+
+	const int PITCH_TURNS = 2,
+			  PITCH_BASES = 21;
+
 	/*
 	 * Some constants defining DNA behaviour and visual representation
 	 */
 
-	const double PITCH = 720.0 / 21.0,														// degrees
+	const double PITCH = 360.0 * PITCH_TURNS / PITCH_BASES,									// degrees
 				 STEP = 0.334,
 				 SINGLE_STRAND_STEP = 0.5,													// NEW, this is for doing linear interpolation, *NOT* when extending a single strand.
 				 RADIUS = 1.0,
@@ -64,6 +72,21 @@ namespace DNA {
 
 	MStatus CalculateBasePairPositions(double index, MVector & forward, MVector & backward, double offset = 0.0, double totalNumBases = 0);
 
+	/*
+	 * The rotation of a base pair repeats after this many base pairs, as PITCH_PERIOD * PITCH is PITCH_TURNS full turns.
+	 * The positions of integer indices are thus looked up in a table built on startup instead of calling sin and cos.
+	 */
+
+	const int PITCH_PERIOD = PITCH_BASES;
+
+	/*
+	 * Fills the positions of count base pairs starting at index first. Positions are interleaved, forward at positions[i * 2]
+	 * and backward at positions[i * 2 + 1], the same as calling the method above for every index but without any trigonometric
+	 * calls per base pair.
+	 */
+
+	void CalculateBasePairPositions(int first, int count, MVector *positions, double offset = 0.0, double totalNumBases = 0);
+
 	/*
 	 * A small API for managing the DNA enumerations
 	 */
@@ -26,16 +26,16 @@ namespace Helix {
 		HelixBase();
 		virtual ~HelixBase();
 
-		//virtual void postConstructor();
+		virtual void postConstructor();
 
 		/*
 		 * Here we listen to connect/disconnect events on the forward and backward connections.
 		 * Because there's a lot of issues with what we can do when these are executed, 
-		 * they only trigger MUserEventMessages so that further on
+		 * they only update the Model::EndIndex bookkeeping.
 		 */
 
-		//MStatus connectionMade(const MPlug &plug, const MPlug &otherPlug, bool asSrc);
-		//MStatus connectionBroken(const MPlug &plug, const MPlug &otherPlug, bool asSrc);
+		virtual MStatus connectionMade(const MPlug &plug, const MPlug &otherPlug, bool asSrc);
+		virtual MStatus connectionBroken(const MPlug &plug, const MPlug &otherPlug, bool asSrc);
 
 		static void *creator();
 		static MStatus initialize();
@@ -0,0 +1,45 @@
+#ifndef _LOADOXDNATRAJECTORY_H_
+#define _LOADOXDNATRAJECTORY_H_
+
+#include <Definition.h>
+
+#include <maya/MDGModifier.h>
+#include <maya/MIntArray.h>
+#include <maya/MObject.h>
+#include <maya/MPxCommand.h>
+#include <maya/MString.h>
+
+#define MEL_LOADOXDNATRAJECTORY_COMMAND "loadOxDnaTrajectory"
+
+/*
+ * Animates a design imported from oxDNA with a trajectory file. The vHelix glue file written by the exporter maps the oxDNA
+ * base indices to the bases in the scene, and an oxDnaTrajectory node is created that drives their translations from the current time.
+ * If no files are given they are asked for.
+ */
+
+namespace Helix {
+	class VHELIXAPI LoadOxDnaTrajectory : public MPxCommand {
+	public:
+		virtual MStatus doIt(const MArgList & args);
+		virtual MStatus undoIt ();
+		virtual MStatus redoIt ();
+		virtual bool isUndoable () const;
+		virtual bool hasSyntax () const;
+
+		static void *creator();
+		static MSyntax newSyntax();
+
+	private:
+		/*
+		 * Sets the attributes of the created node, which are not part of the modifier.
+		 */
+		MStatus apply();
+
+		MDGModifier m_dgModifier;
+		MObject m_node;
+		MString m_trajectory_filename;
+		MIntArray m_baseHelix;
+	};
+}
+
+#endif /* N _LOADOXDNATRAJECTORY_H_ */
@@ -9,18 +9,39 @@
 #define HELIXLOCATOR_H_
 
 #include <Definition.h>
+#include <Utility.h>
 
 #include <iostream>
 
 #include <maya/MPxLocatorNode.h>
 #include <maya/MTypes.h>
 #include <maya/M3dView.h>
+#include <maya/MCallbackIdArray.h>
+#include <maya/MMessage.h>
+#include <maya/MNodeMessage.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MPlug.h>
+#include <maya/MTime.h>
+
+#include <vector>
+
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_map>
+#include <unordered_set>
+#else
+#include <tr1/unordered_map>
+#include <tr1/unordered_set>
+#endif /* N Windows */
 
 /*
  * Because Python wasn't very good at rendering MPxLocatorNodes, i'm doing this extension in C++
  * This extension is as simple as possible, it just figures out what bases are selected, optionally its neighbours and the connected end bases
  * it marks these visually by rendering "halos" around the molecule models with different coloring and radius.
  * Currently, the halos are rendered as point sprites which are very fast and easy to implement.
+ *
+ * The strands of the selected bases are only walked when the selection or a connection changes, and the bases found are bucketed
+ * by their helix. Every locator then only looks up the bucket of its own helix, and keeps its render buffers between draws until
+ * the bucket changes.
  */
 
 #define HELIX_LOCATOR_ID 0x02114121
@@ -81,10 +102,54 @@
 
 #define GLSL_FRAGMENT_SHADER_COUNT	9 // Always change this one when modifying the shader source code!
 
+/*
+ * Sequence labels are drawn as point sprites textured from a glyph atlas, all of them in a single draw call.
+ * Labels outside the view are discarded by the clipper, labels of bases closer than LABEL_MIN_SPACING pixels are moved out of it.
+ */
+
+#define LABEL_GLYPH_SIZE 8
+#define LABEL_GLYPH_COUNT 5
+#define LABEL_ATLAS_GLYPHS 8 // Always change the fragment shader when modifying this one!
+#define LABEL_POINT_SIZE 16.0f
+#define LABEL_MIN_SPACING 8.0
+
+#define LABEL_GLSL_VERTEX_SHADER																							\
+		"#version 120\n",																									\
+		"uniform vec2 screen;\n",																							\
+		"uniform float pointSize, minPixelsPerUnit;\n",																		\
+		"attribute float glyph;\n",																							\
+		"varying float Glyph;\n",																							\
+		"void main() {\n",																									\
+		"    gl_Position = ftransform();\n",																				\
+		"    if (0.5 * screen.y * gl_ProjectionMatrix[1][1] / gl_Position.w < minPixelsPerUnit)\n",						\
+		"        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);\n",																\
+		"    gl_PointSize = pointSize;\n",																					\
+		"    Glyph = glyph;\n",																								\
+		"}\n"
+
+#define LABEL_GLSL_FRAGMENT_SHADER																							\
+		"#version 120\n",																									\
+		"uniform sampler2D atlas;\n",																						\
+		"varying float Glyph;\n",																							\
+		"void main() {\n",																									\
+		"    float alpha = texture2D(atlas, vec2((Glyph + gl_PointCoord.x) / 8.0, gl_PointCoord.y)).a;\n",				\
+		"    if (alpha < 0.5)\n",																							\
+		"        discard;\n",																								\
+		"    gl_FragColor = vec4(1.0, 1.0, 1.0, alpha);\n",																	\
+		"}\n"
+
+#define LABEL_GLSL_UNIFORM_NAMES "screen", "pointSize", "minPixelsPerUnit", "atlas"
+#define LABEL_GLSL_UNIFORM_COUNT 4
+#define LABEL_GLSL_ATTRIB_NAME "glyph"
+
 namespace Helix {
+	namespace Model {
+		class Base;
+	}
+
 	class HelixLocator : public MPxLocatorNode {
 	public:
-		inline HelixLocator() {
+		inline HelixLocator() : m_epoch(0), m_line_count(0) {
 
 		}
 
@@ -92,20 +157,95 @@ namespace Helix {
 
 		virtual void draw(M3dView &view, const MDagPath &path, M3dView::DisplayStyle style, M3dView::DisplayStatus status);
 
+		/*
+		 * The draw is split in two so that the Viewport 2.0 override can share it with the legacy viewport:
+		 * prepareDraw updates the buckets and render buffers and returns false if nothing should be rendered,
+		 * drawGL issues the OpenGL calls and expects a current context with the matrices set up.
+		 */
+
+		bool prepareDraw();
+		void drawGL(bool isOrtho, int portWidth, int portHeight);
+
 		virtual bool isBounded() const;
 		virtual bool isTransparent() const;
 
 		static void * creator();
 		static MStatus initialize();
 
+		/*
+		 * Removes the callbacks tracking the selection. Called when unloading the plugin.
+		 */
+
+		static void release();
+
 		const static MTypeId id;
 		
 	protected:
 		static bool s_gl_initialized, s_gl_failed;
 		static GLuint s_program, s_vertex_shader, s_fragment_shader;
 		static GLint s_screen_dimensions_uniform, s_halo_size_attrib_location;
+		static GLuint s_label_program, s_label_vertex_shader, s_label_fragment_shader, s_label_texture;
+		static GLint s_label_uniforms[LABEL_GLSL_UNIFORM_COUNT], s_label_glyph_attrib_location;
 
 		void initializeGL();
+		static void initializeLabelAtlas();
+
+		/*
+		 * The bases of a helix that are on the strands of the selected bases. epoch changes whenever any of them changed.
+		 */
+
+		struct Bucket {
+			std::vector<MObjectHandle> bases;
+			std::vector<bool> selected;
+			unsigned int epoch;
+		};
+
+#if defined(WIN32) || defined(WIN64)
+		typedef std::unordered_map<MObjectHandle, Bucket, ObjectHandleHash> bucket_map_t;
+		typedef std::unordered_set<MObjectHandle, ObjectHandleHash> handle_set_t;
+#else
+		typedef std::tr1::unordered_map<MObjectHandle, Bucket, ObjectHandleHash> bucket_map_t;
+		typedef std::tr1::unordered_set<MObjectHandle, ObjectHandleHash> handle_set_t;
+#endif /* N Windows */
+
+		/*
+		 * Walks the strands of the selected bases and registers callbacks on the bases found and their opposites.
+		 */
+
+		static MStatus updateBuckets();
+		static MStatus addToBucket(Model::Base & base, const handle_set_t & selected, handle_set_t & visited);
+		static void clearBuckets();
+
+		/*
+		 * Refills the render buffers from the bucket, which might be NULL if no selected strand passes through our helix.
+		 */
+
+		MStatus updateRenderData(const Bucket *bucket);
+
+		static void MModelMessage_activeListModified(void *clientData);
+		static void MNodeMessage_base_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData);
+		static void MDGMessage_timeChange(MTime & time, void *clientData);
+		static void MSceneMessage_beforeNewOpen(void *clientData);
+
+		/*
+		 * The buckets are indexed by the MObjectHandle of the helix, the callbacks on its bases get a pointer to the bucket. s_epoch is increased for every change, buckets and
+		 * s_bucketsEpoch get the new value so that the locators know when to refill their buffers.
+		 */
+
+		static bucket_map_t s_buckets;
+		static MCallbackIdArray s_globalCallbacks, s_baseCallbacks;
+		static unsigned int s_epoch, s_bucketsEpoch, s_selectedCount;
+		static bool s_bucketsDirty;
+
+		/*
+		 * Render buffers, persisted between draws
+		 */
+
+		std::vector<float> m_vertices, m_line_vertices, m_halo_diameters;
+		std::vector<unsigned char> m_colors, m_line_colors;
+		std::vector<char> m_sequence;
+		std::vector<float> m_label_vertices, m_label_glyphs;
+		unsigned int m_epoch, m_line_count;
 	};
 }
 
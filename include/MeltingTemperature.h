@@ -0,0 +1,39 @@
+#ifndef _MELTING_TEMPERATURE_H_
+#define _MELTING_TEMPERATURE_H_
+
+/*
+ * Command for calculating the melting temperatures of strands and their binding domains. See controller/MeltingTemperature.h.
+ * Without any bases given, the selected strands or else all strands in the scene are evaluated.
+ *
+ * The result is the highest domain melting temperature per strand, or the temperatures of all domains with -domains.
+ * A complete report including free energies and GC contents is written with -file.
+ */
+
+#include <Definition.h>
+
+#include <controller/MeltingTemperature.h>
+
+#include <maya/MPxCommand.h>
+
+#define MEL_MELTINGTEMPERATURE_COMMAND "meltingTemperature"
+
+namespace Helix {
+	class VHELIXAPI MeltingTemperature : public MPxCommand {
+	public:
+		virtual ~MeltingTemperature();
+
+		virtual MStatus doIt(const MArgList & args);
+		virtual MStatus undoIt();
+		virtual MStatus redoIt();
+		virtual bool isUndoable() const;
+		virtual bool hasSyntax() const;
+
+		static MSyntax newSyntax();
+		static void *creator();
+
+	private:
+		Controller::MeltingTemperature m_operation;
+	};
+}
+
+#endif /* _MELTING_TEMPERATURE_H_ */
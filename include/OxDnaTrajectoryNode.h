@@ -0,0 +1,44 @@
+#ifndef _OXDNATRAJECTORYNODE_H_
+#define _OXDNATRAJECTORYNODE_H_
+
+#include <Definition.h>
+
+#include <controller/OxDnaTrajectory.h>
+
+#include <maya/MPxNode.h>
+
+#include <string>
+#include <vector>
+
+#define HELIX_OXDNA_TRAJECTORY_NODE_NAME "oxDnaTrajectory"
+#define HELIX_OXDNA_TRAJECTORY_NODE_ID 0x02114124
+
+namespace Helix {
+	/*
+	 * Animation cache driving the translation of bases from an oxDNA trajectory file.
+	 * The translation of base i is connected from translation[i], which is computed from the frame of the current time only.
+	 * As bases are parented to helices, the world space positions are transformed by the inverse matrix of the helix the base belongs to,
+	 * given by helixInverseMatrix[baseHelix[i]].
+	 */
+
+	class OxDnaTrajectoryNode : public MPxNode {
+	public:
+		virtual MStatus compute(const MPlug & plug, MDataBlock & data);
+
+		static void *creator();
+		static MStatus initialize();
+
+		static MTypeId id;
+
+		static MObject aTime, aFile, aStartFrame, aHelixInverseMatrix, aBaseHelix, aTranslation;
+
+	private:
+		Controller::OxDnaTrajectory m_trajectory;
+		std::vector<MVector> m_positions;
+
+		// The last file opened, even if opening it failed, thus a missing file is not reopened every frame.
+		std::string m_filename;
+	};
+}
+
+#endif /* N _OXDNATRAJECTORYNODE_H_ */
@@ -11,6 +11,10 @@
 #define HELIX_OXDNA_FILE_TYPE	"oxDNA " HELIX_OXDNA_TOP_FILE_TYPE ", " HELIX_OXDNA_CONF_FILE_TYPE
 
 namespace Helix {
+	/*
+	 * Exporting with the option "binary=1" writes the topology and configuration in the binary format described in controller/OxDnaExporter.h
+	 * to .topb and .confb files instead. Use the convertOxDnaBinary command to convert them for oxDNA.
+	 */
 	class OxDnaTranslator : public MPxFileTranslator {
 	public:
 		virtual MStatus writer (const MFileObject& file, const MString& optionsString, MPxFileTranslator::FileAccessMode mode);
@@ -3,6 +3,8 @@
 
 /*
 * Command for counting the length of a strand.
+*
+* With -histogram, the lengths of all strands in the scene are counted in a single pass and summarized instead.
 */
 
 #include <Definition.h>
@@ -32,6 +34,8 @@ namespace Helix {
 		static void *creator();
 
 	private:
+		MStatus histogram();
+
 		Controller::StrandLengthCount m_operation;
 	};
 }
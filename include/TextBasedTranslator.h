@@ -7,13 +7,18 @@
 #define HELIX_TEXT_BASED_FILE_DESCRIPTION "Text based vhelix"
 #define HELIX_TEXT_BASED_FILE_TYPE "rpoly"
 
-// TODO: Implement writer. Currently this is only used to import files from the polygon relaxation simulator.
+/*
+ * Reads files from the polygon relaxation simulator. The writer exports the scene in the same format which, as it only contains
+ * helix transforms, bases and their connections, is a lot faster to save and load than a Maya file.
+ */
 
 namespace Helix {
 	class TextBasedTranslator : public MPxFileTranslator {
 	public:
 		virtual MStatus reader(const MFileObject& file, const MString & options, MPxFileTranslator::FileAccessMode mode);
+		virtual MStatus writer(const MFileObject& file, const MString & options, MPxFileTranslator::FileAccessMode mode);
 		virtual bool haveReadMethod() const;
+		virtual bool haveWriteMethod() const;
 		virtual bool canBeOpened() const;
 		virtual MString defaultExtension() const;
 		virtual MPxFileTranslator::MFileKind identifyFile(const MFileObject& file, const char *buffer, short size) const;
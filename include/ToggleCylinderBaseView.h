@@ -13,6 +13,8 @@
  * The result will be passed out as an MString
  * If helices (or children of helices) are selected, no state change is made but these have their view toggled individually
  * also -target will have the same effect
+ * -automatic true shows both the bases and the cylinders and lets View::HelixLOD decide which one to draw per helix,
+ * -automatic false or -toggle true returns to the manual views
  */
 
 #include <Definition.h>
@@ -24,6 +26,13 @@
 
 #define MEL_TOGGLECYLINDERBASEVIEW_COMMAND "toggleCylinderBaseView"
 
+/*
+ * Values of CurrentView
+ */
+#define TOGGLECYLINDERBASEVIEW_BASES 0
+#define TOGGLECYLINDERBASEVIEW_CYLINDERS 1
+#define TOGGLECYLINDERBASEVIEW_AUTOMATIC 2
+
 namespace Helix {
 	class VHELIXAPI ToggleCylinderBaseView : public MPxCommand {
 	public:
@@ -47,7 +56,8 @@ namespace Helix {
 	private:
 		MStatus toggle(bool toggle, bool refresh, std::list<MObject> & targets);
 
-		bool m_toggled; // For undo/redo
+		bool m_viewChanged; // For undo/redo, CurrentView and m_previousView are swapped
+		int m_previousView;
 		std::list<MObject> m_toggleTargets;
 	};
 }
@@ -27,6 +27,7 @@
 
 #include <maya/MStatus.h>
 #include <maya/MObjectArray.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MPlug.h>
 #include <maya/MDagPath.h>
 #include <maya/MVector.h>
@@ -187,6 +188,18 @@ namespace Helix {
 		return end;
 	}
 
+	/*
+	 * Hash for unordered containers keyed by MObjectHandle. Different nodes can share the same hash code, thus containers must be
+	 * keyed by the handle itself, which is compared on lookup, and never by the hash code alone.
+	 */
+
+	class ObjectHandleHash {
+	public:
+		inline size_t operator()(const MObjectHandle & handle) const {
+			return handle.hashCode();
+		}
+	};
+
 	/*
 	 * This method is for solving a bug in opening Maya files containing helices. FIXME: Move function definition and declaration
 	 */
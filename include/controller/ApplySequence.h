@@ -1,30 +1,65 @@
 #ifndef _CONTROLLER_APPLYSEQUENCE_H_
 #define _CONTROLLER_APPLYSEQUENCE_H_
 
-#include <controller/Operation.h>
-#include <model/Base.h>
+#include <model/Strand.h>
 
 #include <DNA.h>
 
+#include <vector>
+
+#include <maya/MDGModifier.h>
+#include <maya/MObject.h>
+#include <maya/MTypes.h>
+
+/*
+ * MDGModifier::newPlugValueInt is not available in older versions of Maya, where the labels are set on the plugs one by one.
+ */
+
+#if MAYA_API_VERSION >= 201200
+#define APPLYSEQUENCE_MODIFIER
+#endif /* MAYA_API_VERSION >= 201200 */
+
+/*
+ * ApplySequence: Applies sequences to strands, the labels of the opposite bases follow through their label connections.
+ *
+ * The label of a paired base is only stored on one of the two bases, the source of the connection. Every base is thus resolved to
+ * the node actually holding its label when queued with add. All labels are queued on a single MDGModifier, written at once with apply
+ * and restored by undo. Without the modifier, the undo record is the node, new and previous label per base.
+ */
+
 namespace Helix {
 	namespace Controller {
-		class VHELIXAPI ApplySequence : public Operation<Model::Base, DNA::Name, DNA::Name> {
+		class VHELIXAPI ApplySequence {
 		public:
-			inline void setSequence(const MString & sequence) {
-				m_sequence = sequence;
-				m_sequence_index = 0;
+			/*
+			 * Queues the sequence to be applied from the defining base of the strand towards its 3' end. Stops at the end of the
+			 * sequence or the strand, whichever comes first.
+			 */
+			MStatus add(Model::Strand & strand, const char *sequence, size_t length);
+
+			MStatus apply();
+			MStatus undo();
+
+			inline MStatus redo() {
+				return apply();
 			}
 
-		protected:
-			MStatus doExecute(Model::Base & element);
-			MStatus doUndo(Model::Base & element, DNA::Name & undoData);
-			MStatus doRedo(Model::Base & element, DNA::Name & redoData);
+			inline size_t size() const {
+				return m_entries.size();
+			}
 
 		private:
-			MString m_sequence;
-			unsigned int m_sequence_index;
+			struct Entry {
+				MObject node;
+				char label, previous; // DNA::Values as stored on the label attribute of node.
+			};
+
+			std::vector<Entry> m_entries;
+#ifdef APPLYSEQUENCE_MODIFIER
+			MDGModifier m_modifier;
+#endif /* APPLYSEQUENCE_MODIFIER */
 		};
 	}
 }
 
-#endif /* N _CONTROLLER_APPLYSEQUENCE_H_ */
\ No newline at end of file
+#endif /* N _CONTROLLER_APPLYSEQUENCE_H_ */
@@ -4,6 +4,22 @@
 #include <controller/Operation.h>
 
 #include <model/Strand.h>
+#include <Utility.h>
+
+#include <vector>
+
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_set>
+#else
+#include <tr1/unordered_set>
+#endif /* N Windows */
+
+/*
+ * ExportStrands: Collects the sequences of strands for exporting them to a text file.
+ *
+ * Strands are defined by any of their bases, and every visited base is remembered. Thus strands can be executed for every base of interest,
+ * each strand is only walked once and strands already exported are skipped. All sequences are stored in a single buffer.
+ */
 
 namespace Helix {
 	namespace Controller {
@@ -11,9 +27,15 @@ namespace Helix {
 		public:
 			enum Mode {
 				COMMA_SEPARATED,
-				COLON_SEPARATED
+				COLON_SEPARATED,
+				TAB_SEPARATED,
+				FASTA
 			};
 
+			/*
+			 * Writes the name, sequence, length and the helices and bases of the 5' and 3' ends of every strand.
+			 * For the separated modes a header line is written first.
+			 */
 			MStatus write(const MString & filename, Mode mode = COMMA_SEPARATED);
 
 			virtual void onProgressStep();
@@ -28,20 +50,33 @@ namespace Helix {
 			 * The data stored for export
 			 */
 
+			struct End {
+				MString helix, base;
+			};
+
 			struct Data {
-				/*inline Data(const MString & _strand_name, const MString & _sequence) : strand_name(_strand_name), sequence(_sequence) {
+				MString strand_name; // Will be the two end bases for a strand not in a loop, if it's a loop, then any base name
+				size_t offset, length; // Sequence in m_sequences.
+				End fivePrime, threePrime;
+			};
 
-				}*/
+			/*
+			 * Appends the label of the base to m_sequences and marks it as visited.
+			 */
+			MStatus visit(Model::Base & base);
 
-				MString strand_name, // Will be the two end bases for a strand not in a loop, if it's a loop, then any base name
-						sequence;
-			};
+			MStatus getEnd(Model::Base & base, End & end);
 
-			std::list<Data> m_export_data;
+			std::vector<Data> m_export_data;
+			std::vector<char> m_sequences;
 
-			friend std::ostream & operator<<(std::ostream & stream, const ExportStrands::Data & data);
+#if defined(WIN32) || defined(WIN64)
+			std::unordered_set<MObjectHandle, ObjectHandleHash> m_visited;
+#else
+			std::tr1::unordered_set<MObjectHandle, ObjectHandleHash> m_visited;
+#endif /* N Windows */
 		};
 	}
 }
 
-#endif /* N  _CONTROLLER_EXPORTSTRANDS_H_ */
\ No newline at end of file
+#endif /* N  _CONTROLLER_EXPORTSTRANDS_H_ */
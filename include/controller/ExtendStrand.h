@@ -1,12 +1,22 @@
 #ifndef _CONTROLLER_EXTENDSTRAND_H_
 #define _CONTROLLER_EXTENDSTRAND_H_
 
-#include <controller/Operation.h>
 #include <model/Helix.h>
 #include <model/Base.h>
+#include <model/BaseBatch.h>
+#include <model/Material.h>
+
+#include <maya/MObjectHandle.h>
+#include <maya/MVector.h>
 
 #include <vector>
 
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif /* N Windows */
+
 namespace Helix {
 	namespace Controller {
 		/*
@@ -14,10 +24,20 @@ namespace Helix {
 		 * - if two bases that are paired are both selected for extension their new extensions must also be paired
 		 * - if a base that is paired is selected for extension, and its opposite base already have an extension
 		 *    the following bases must be paired along with the extension along the opposite base
+		 *
+		 * All ends are added first, which finds their direction and the existing opposite bases to pair with.
+		 * create then computes the positions of all new bases and creates them with a single Model::BaseBatch.
 		 */
 
-		class VHELIXAPI ExtendStrand : public Operation<Model::Base, std::vector<Model::Base> > {
+		class VHELIXAPI ExtendStrand {
 		public:
+			inline ExtendStrand() : m_length(0), m_materialsQueried(false) {
+
+			}
+
+			virtual ~ExtendStrand() {
+
+			}
 
 			/*
 			 * The number of bases to create
@@ -25,35 +45,36 @@ namespace Helix {
 
 			void setLength(unsigned int length) {
 				m_length = length;
-				/*m_positive_count = 0;
-				m_negative_count = 0;*/
 			}
 
 			/*
-			 * After a successful run, call to make sure the cylinders are set up properly
-			 * Notice that redo is the same as doCylinder
+			 * Adds an end base to be extended. Bases that are not ends are ignored with a warning.
 			 */
+			MStatus add(Model::Base & element);
 
-			MStatus doCylinder();
-			MStatus undoCylinder();
+			MStatus create();
+			MStatus undo();
+			MStatus redo();
 
 		protected:
-			MStatus doExecute(Model::Base & element);
-			MStatus doUndo(Model::Base & element, std::vector<Model::Base> & undoData);
-			MStatus doRedo(Model::Base & element, Empty & redoData);
-
 			virtual void onProgressBegin(int range);
 			virtual void onProgressStep();
 			virtual void onProgressDone();
 
 			unsigned int m_length;
 
-			/*
-			 * Whenever the total length of the structure changes we add them here, positive and negative are along the Z axis
-			 */
-
-			//unsigned int m_positive_count, m_negative_count;
-			//double m_previous_origo, m_previous_height;
+		private:
+			struct Extension {
+				Model::Base element;
+				Model::Helix helix;
+				MString name;
+				MVector translation;
+				Model::Material material;
+				double direction; // -1 or 1 along the z axis.
+				bool extendForward, isDestinationForOpposite;
+				int pairWith; // Index of the extension of the opposite base if both were selected, or -1.
+				std::vector<Model::Base> opposites; // Existing bases along the opposite strand to pair the new bases with.
+			};
 
 			struct Range {
 				inline Range(double _origo, double _height) : origo(_origo), height(_height) { }
@@ -61,9 +82,30 @@ namespace Helix {
 				double origo, height;
 			};
 
-			std::list< std::pair<Model::Helix, Range> > m_modified_helices;
+			/*
+			 * Whenever the total length of a helix changes we track how many bases were added along the positive and negative Z axis.
+			 */
+			struct ModifiedHelix {
+				Model::Helix helix;
+				unsigned int positive_count, negative_count;
+				Range previous, next;
+
+				inline ModifiedHelix(const Model::Helix & _helix) : helix(_helix), positive_count(0), negative_count(0), previous(0.0, 0.0), next(0.0, 0.0) { }
+			};
+
+			std::vector<Extension> m_extensions;
+			std::vector<ModifiedHelix> m_modified_helices;
+			Model::BaseBatch m_batch;
+			Model::Material::Assignments m_materials;
+			bool m_materialsQueried;
+
+#if defined(WIN32) || defined(WIN64)
+			std::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash> m_elementIndices, m_helixIndices;
+#else
+			std::tr1::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash> m_elementIndices, m_helixIndices;
+#endif /* N Windows */
 		};
 	}
 }
 
-#endif /* N _CONTROLLER_EXTENDSTRAND_H_ */
\ No newline at end of file
+#endif /* N _CONTROLLER_EXTENDSTRAND_H_ */
@@ -0,0 +1,120 @@
+#ifndef _CONTROLLER_FILEREADER_H_
+#define _CONTROLLER_FILEREADER_H_
+
+#include <Definition.h>
+
+#include <fstream>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#include <maya/MGlobal.h>
+#include <maya/MString.h>
+
+/*
+ * Helpers for parsing the line based files read by the oxDNA importer, the trajectory reader and the FASTA sequence input.
+ * Files are read into memory at once and parsed in place. Every line is null terminated before it is parsed
+ * so that strtod and strtol can't continue on the next line.
+ */
+
+namespace Helix {
+	namespace Controller {
+		/*
+		 * Reads the whole file into buffer, null terminated.
+		 */
+		inline MStatus FileReader_read(const char *filename, std::vector<char> & buffer) {
+			std::ifstream file(filename, std::ios::in | std::ios::binary);
+
+			if (!file) {
+				MGlobal::displayError(MString("Unable to open file \"") + filename + "\" for reading.");
+				return MStatus::kFailure;
+			}
+
+			file.seekg(0, std::ios::end);
+			const std::streamoff size(file.tellg());
+			file.seekg(0, std::ios::beg);
+
+			buffer.resize(size_t(size) + 1);
+			file.read(&buffer[0], size);
+			buffer[size_t(size)] = '\0';
+
+			if (file.fail()) {
+				MGlobal::displayError(MString("Failed to read file \"") + filename + "\".");
+				return MStatus::kFailure;
+			}
+
+			return MStatus::kSuccess;
+		}
+
+		/*
+		 * Returns the next line, null terminated, or NULL at the end of the buffer.
+		 */
+		inline char *FileReader_nextLine(char *& it, char *end) {
+			if (it >= end)
+				return NULL;
+
+			char *line = it;
+			char *newline = static_cast<char *>(memchr(it, '\n', end - it));
+
+			if (newline) {
+				*newline = '\0';
+				it = newline + 1;
+			}
+			else
+				it = end;
+
+			return line;
+		}
+
+		inline bool FileReader_parse(char *& it, double & value) {
+			char *end;
+			value = strtod(it, &end);
+
+			if (end == it)
+				return false;
+
+			it = end;
+			return true;
+		}
+
+		inline bool FileReader_parse(char *& it, long & value) {
+			char *end;
+			value = strtol(it, &end, 10);
+
+			if (end == it)
+				return false;
+
+			it = end;
+			return true;
+		}
+
+		/*
+		 * Null terminates and returns the next whitespace separated token.
+		 */
+		inline char *FileReader_token(char *& it) {
+			while (*it == ' ' || *it == '\t')
+				++it;
+
+			if (*it == '\0' || *it == '\r')
+				return NULL;
+
+			char *token = it;
+			while (*it != '\0' && *it != ' ' && *it != '\t' && *it != '\r')
+				++it;
+
+			if (*it != '\0')
+				*it++ = '\0';
+
+			return token;
+		}
+
+		inline bool FileReader_skipLine(const char *line) {
+			while (*line == ' ' || *line == '\t')
+				++line;
+
+			return *line == '#' || *line == '\0' || *line == '\r';
+		}
+	}
+}
+
+#endif /* N _CONTROLLER_FILEREADER_H_ */
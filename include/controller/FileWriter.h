@@ -0,0 +1,107 @@
+#ifndef _CONTROLLER_FILEWRITER_H_
+#define _CONTROLLER_FILEWRITER_H_
+
+#include <Definition.h>
+
+#include <maya/MStatus.h>
+#include <maya/MVector.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*
+ * FileWriter: Buffered output for the exporters. Writing through std::ofstream with std::endl flushes on every line and formatting
+ * doubles through iostreams dominates the export of large designs. Instead, values are formatted directly into a large buffer
+ * that is only written to the file when full.
+ *
+ * Doubles are written with a fixed number of decimals, which is more than the 6 significant digits iostreams used to write.
+ * The binary methods write little endian values independent of the platform.
+ */
+
+namespace Helix {
+	namespace Controller {
+		class VHELIXAPI FileWriter {
+		public:
+			FileWriter();
+			~FileWriter();
+
+			MStatus open(const char *filename, bool binary = false);
+
+			/*
+			 * Flushes and closes the file. Returns an error if any of the writes failed.
+			 */
+			MStatus close();
+
+			inline FileWriter & operator<<(const char *str) {
+				return write(str, strlen(str));
+			}
+
+			inline FileWriter & operator<<(const std::string & str) {
+				return write(str.data(), str.size());
+			}
+
+			inline FileWriter & operator<<(char ch) {
+				reserve(1);
+				m_buffer[m_size++] = ch;
+				return *this;
+			}
+
+			inline FileWriter & operator<<(int value) {
+				return writeInteger(value < 0, value < 0 ? 0UL - (unsigned long) value : (unsigned long) value);
+			}
+
+			inline FileWriter & operator<<(unsigned int value) {
+				return writeInteger(false, value);
+			}
+
+			inline FileWriter & operator<<(unsigned long value) {
+				return writeInteger(false, value);
+			}
+
+			FileWriter & operator<<(double value);
+
+			/*
+			 * Space separated vector components.
+			 */
+			inline FileWriter & operator<<(const MVector & vector) {
+				return *this << vector.x << ' ' << vector.y << ' ' << vector.z;
+			}
+
+			FileWriter & write(const char *data, size_t size);
+
+			FileWriter & writeUInt32(unsigned int value);
+			FileWriter & writeInt32(int value);
+			FileWriter & writeFloat(float value);
+
+			inline FileWriter & writeFloat(const MVector & vector) {
+				return writeFloat(float(vector.x)).writeFloat(float(vector.y)).writeFloat(float(vector.z));
+			}
+
+		private:
+			FileWriter(const FileWriter &);
+			FileWriter & operator=(const FileWriter &);
+
+			/*
+			 * Makes sure there's room for at least size bytes in the buffer.
+			 */
+			inline void reserve(size_t size) {
+				if (m_size + size > m_buffer.size())
+					flush();
+			}
+
+			void flush();
+
+			FileWriter & writeInteger(bool negative, unsigned long value);
+
+			std::FILE *m_file;
+			std::string m_filename;
+			std::vector<char> m_buffer;
+			size_t m_size;
+			bool m_failed;
+		};
+	}
+}
+
+#endif /* N _CONTROLLER_FILEWRITER_H_ */
@@ -4,22 +4,42 @@
 #include <Definition.h>
 
 #include <model/Base.h>
+#include <model/BaseBatch.h>
 #include <model/Helix.h>
+#include <model/Material.h>
 #include <model/Object.h>
 
+#include <maya/MDGModifier.h>
 #include <maya/MStatus.h>
 #include <maya/MObject.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MString.h>
 #include <maya/MVector.h>
 
-#include <RetargetBase.h>
-
 #include <vector>
 
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_set>
+#else
+#include <tr1/unordered_set>
+#endif /* N Windows */
+
+/*
+ * FillStrandGaps: Fills the gaps between consecutive bases of strands that are further apart than DNA::SINGLE_STRAND_STEP
+ * with linearly interpolated single stranded bases.
+ *
+ * All gaps are found and their interpolated bases computed first, then they are created with a single Model::BaseBatch.
+ * The undo record is thus the batch, the broken connections and the gaps themselves.
+ */
+
 namespace Helix {
 	namespace Controller {
 		class FillStrandGaps {
 		public:
+			inline FillStrandGaps() : m_numAddedBases(0) {
+
+			}
+
 			/*
 			 * ContainerT: Iterable container of MObjects. Must implement begin, end and size.
 			 */
@@ -31,48 +51,50 @@ namespace Helix {
 					HMEVALUATE_RETURN(status = fill_object(*it), status);
 				}
 
-				return redo();
-			}
-
-			
-			inline MStatus undo() {
-				MStatus status;
-
-				for (std::vector<Model::Base>::iterator it(undoable.begin()); it != undoable.end(); ++it) {
-					HMEVALUATE(it->deleteNode(), status);
-				}
-
-				for (std::vector < std::pair<Model::Base, Model::Base> >::iterator it(previously_connected.begin()); it != previously_connected.end(); ++it) {
-					// There seem to be a bug with the reconnectioning of bases.
-					HMEVALUATE(status = it->first.connect_forward(it->second), status);
-					MDagPath first_fullpath, second_fullpath;
-					HMEVALUATE_RETURN(first_fullpath = it->first.getDagPath(status), status);
-					HMEVALUATE_RETURN(second_fullpath = it->second.getDagPath(status), status);
-					HMEVALUATE_RETURN(status = MGlobal::executeCommandOnIdle(MString(MEL_RETARGETBASE_COMMAND " -base ") + first_fullpath.fullPathName() + " -target " + second_fullpath.fullPathName()), status);
-				}
+				HMEVALUATE_RETURN(status = plan(), status);
+				HMEVALUATE_RETURN(status = disconnect(), status);
+				HMEVALUATE_RETURN(status = m_batch.create(), status);
 
+				HPRINT("Added %u bases.", m_numAddedBases);
 
-				undoable.clear();
-				previously_connected.clear();
 				return MStatus::kSuccess;
 			}
 
+			MStatus undo();
 			MStatus redo();
 
 			MStatus fill_object(const MObject & object);
 			MStatus fill_base(Model::Base & base);
 
 		private:
-			struct Redoable {
+			struct Gap {
 				Model::Base start, end;
 				Model::Helix helix;
 
-				inline Redoable(const Model::Base & start, const Model::Base & end, const Model::Helix & helix) : start(start), end(end), helix(helix) {}
+				inline Gap(const Model::Base & start, const Model::Base & end, const Model::Helix & helix) : start(start), end(end), helix(helix) {}
 			};
 
-			std::vector<Model::Base> undoable;
-			std::vector < std::pair<Model::Base, Model::Base> > previously_connected;
-			std::vector<Redoable> redoable;
+			/*
+			 * Computes the interpolated bases of all gaps and queues them in the batch. Gaps that are too short are removed.
+			 */
+			MStatus plan();
+
+			/*
+			 * Breaks the connections and removes the aim constraints between the start and end of all gaps.
+			 */
+			MStatus disconnect();
+			MStatus redo_disconnect();
+
+			std::vector<Gap> m_gaps;
+#if defined(WIN32) || defined(WIN64)
+			std::unordered_set<MObjectHandle, ObjectHandleHash> m_visited;
+#else
+			std::tr1::unordered_set<MObjectHandle, ObjectHandleHash> m_visited;
+#endif /* N Windows */
+
+			Model::BaseBatch m_batch;
+			MDGModifier m_dgModifier;
+			unsigned int m_numAddedBases;
 		};
 	}
 }
@@ -0,0 +1,128 @@
+#ifndef _CONTROLLER_MELTINGTEMPERATURE_H_
+#define _CONTROLLER_MELTINGTEMPERATURE_H_
+
+#include <controller/Operation.h>
+
+#include <model/Strand.h>
+#include <Utility.h>
+
+#include <DNA.h>
+
+#include <vector>
+
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_map>
+#include <unordered_set>
+#else
+#include <tr1/unordered_map>
+#include <tr1/unordered_set>
+#endif /* N Windows */
+
+/*
+ * MeltingTemperature: Nearest-neighbor thermodynamics of strands and their binding domains.
+ *
+ * Execute on strands (any base along them) to collect their sequences. Strands already collected through another base are skipped.
+ * A domain is a run of consecutive bases on the same helix that all have an opposite base. Every domain is treated as a perfectly
+ * matched duplex with its complement. Unpaired bases and bases without a label break domains.
+ *
+ * calculate then evaluates all strands and domains in a single batched pass, using the unified parameters from
+ * SantaLucia, PNAS 95:1460 (1998) and the Mg2+ to Na+ equivalence from von Ahsen et al., Clin. Chem. 47:1956 (2001).
+ */
+
+namespace Helix {
+	namespace Controller {
+		class VHELIXAPI MeltingTemperature : public Operation<Model::Strand> {
+		public:
+			struct Conditions {
+				double strandConcentration; // nM, of each strand.
+				double sodium, magnesium; // mM.
+
+				// Typical origami folding buffer.
+				inline Conditions() : strandConcentration(100.0), sodium(5.0), magnesium(12.5) {
+
+				}
+			};
+
+			struct Result {
+				double enthalpy; // kcal/mol
+				double entropy; // cal/(K mol), salt corrected.
+				double freeEnergy; // kcal/mol at 37 C.
+				double meltingTemperature; // C, NaN for sequences shorter than two bases or with missing labels.
+				double gcContent; // [0, 1]
+			};
+
+			struct Domain {
+				unsigned int strand, helix; // Indices into strands and helices.
+				size_t offset, length; // Relative to the 5' end of the strand.
+				Result result;
+			};
+
+			struct Strand {
+				MString name;
+				size_t offset, length; // Sequence in the sequence buffer.
+				unsigned int firstDomain, numDomains;
+				Result result; // For the whole strand as a single duplex.
+				double maxDomainMeltingTemperature;
+			};
+
+			/*
+			 * Evaluates the collected strands and domains.
+			 */
+			void calculate(const Conditions & conditions = Conditions());
+
+			/*
+			 * Writes a tab separated report of all strands followed by all domains.
+			 */
+			MStatus write(const MString & filename) const;
+
+			inline const std::vector<Strand> & getStrands() const {
+				return m_strands;
+			}
+
+			inline const std::vector<Domain> & getDomains() const {
+				return m_domains;
+			}
+
+			inline const MString & getHelixName(unsigned int helix) const {
+				return m_helixNames[helix];
+			}
+
+			/*
+			 * Batched evaluation of count sequences given as DNA::Values in sequences, each starting at offsets[i] with lengths[i] bases.
+			 */
+			static void Calculate(const unsigned char *sequences, const size_t *offsets, const size_t *lengths, size_t count, const Conditions & conditions, Result *results);
+
+		protected:
+			MStatus doExecute(Model::Strand & element);
+			MStatus doUndo(Model::Strand & element, Empty & undoData);
+			MStatus doRedo(Model::Strand & element, Empty & redoData);
+
+		private:
+			/*
+			 * Collects the label, helix and whether it is paired, and marks the base as visited.
+			 */
+			MStatus visit(Model::Base & base);
+
+			unsigned int getHelix(const MObject & object, MStatus & status);
+
+			std::vector<Strand> m_strands;
+			std::vector<Domain> m_domains;
+
+			std::vector<unsigned char> m_sequences;
+			std::vector<unsigned int> m_baseHelices; // Per base in m_sequences, or -1 if unpaired.
+
+			std::vector<MObject> m_helices;
+			std::vector<MString> m_helixNames;
+
+#if defined(WIN32) || defined(WIN64)
+			std::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash> m_helixIndices;
+			std::unordered_set<MObjectHandle, ObjectHandleHash> m_visited;
+#else
+			std::tr1::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash> m_helixIndices;
+			std::tr1::unordered_set<MObjectHandle, ObjectHandleHash> m_visited;
+#endif /* N Windows */
+		};
+	}
+}
+
+#endif /* N _CONTROLLER_MELTINGTEMPERATURE_H_ */
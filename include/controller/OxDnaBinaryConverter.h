@@ -0,0 +1,23 @@
+#ifndef _CONTROLLER_OXDNABINARYCONVERTER_H_
+#define _CONTROLLER_OXDNABINARYCONVERTER_H_
+
+#include <Definition.h>
+
+#include <maya/MStatus.h>
+
+/*
+ * OxDnaBinaryConverter: Converts the binary topology and configuration written by the OxDnaExporter to the standard oxDNA text format.
+ * See controller/OxDnaExporter.h for a description of the binary format.
+ */
+
+namespace Helix {
+	namespace Controller {
+		class VHELIXAPI OxDnaBinaryConverter {
+		public:
+			MStatus convertTopology(const char *binary_filename, const char *filename);
+			MStatus convertConfiguration(const char *binary_filename, const char *filename);
+		};
+	}
+}
+
+#endif /* N _CONTROLLER_OXDNABINARYCONVERTER_H_ */
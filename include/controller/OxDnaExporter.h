@@ -2,6 +2,7 @@
 #define _CONTROLLER_OXDNAEXPORTER_H_
 
 #include <controller/Operation.h>
+#include <model/Material.h>
 #include <model/Strand.h>
 
 #include <DNA.h>
@@ -9,6 +10,8 @@
 #include <list>
 #include <vector>
 
+#include <maya/MMatrix.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MQuaternion.h>
 
 #if defined(WIN32) || defined(WIN64)
@@ -20,22 +23,46 @@
 #define HELIX_OXDNA_CONF_FILE_TYPE "conf"
 #define HELIX_OXDNA_TOP_FILE_TYPE "top"
 #define HELIX_OXDNA_VHELIX_FILE_TYPE "vhelix"
+#define HELIX_OXDNA_BINARY_CONF_FILE_TYPE "confb"
+#define HELIX_OXDNA_BINARY_TOP_FILE_TYPE "topb"
+
+#define HELIX_OXDNA_BINARY_CONF_MAGIC "VHOXCONF"
+#define HELIX_OXDNA_BINARY_TOP_MAGIC "VHOXTOPO"
+#define HELIX_OXDNA_BINARY_MAGIC_LENGTH 8
+#define HELIX_OXDNA_BINARY_VERSION 1
 
 /*
  * OxDnaExporter: Generates .top and .conf with the strands of the scene that can be used together with oxDNA for simulating
  * DNA models. See https://dna.physics.ox.ac.uk for more information.
  *
  * All strands must have been assigned sequences.
+ *
+ * Optionally the topology and configuration can be written in a binary format, which is a lot faster to write and read
+ * for very large designs. Use the OxDnaBinaryConverter to convert them to the standard text format. All values are little endian:
+ *
+ * Topology:
+ * char[8] "VHOXTOPO", uint32 version, uint32 number of bases, uint32 number of strands
+ * Per base: int32 strand (1 based), int32 label (ASCII), int32 3' neighbour, int32 5' neighbour (-1 if none)
+ *
+ * Configuration:
+ * char[8] "VHOXCONF", uint32 version, uint32 number of bases, float[3] box
+ * Per base: float[3] position, float[3] a1 (backbone-base versor), float[3] a3 (normal versor)
+ *
+ * Velocities are not written as they are always zero.
  */
 namespace Helix {
 	namespace Controller {
 		class VHELIXAPI OxDnaExporter : public Operation<Model::Strand> {
 		public:
+			inline OxDnaExporter() : m_materialsQueried(false) {
+
+			}
 
 			/*
 			 * Writes what is currently stored in m_strands. Use the Operation interface to populate it.
+			 * If binary is set, the topology and configuration are written in the binary format described above.
 			 */
-			MStatus write(const char *topology_filename, const char *configuration_filename, const char *vhelix_filename, const MVector & minTranslation, const MVector & maxTranslation) const;
+			MStatus write(const char *topology_filename, const char *configuration_filename, const char *vhelix_filename, const MVector & minTranslation, const MVector & maxTranslation, bool binary = false) const;
 
 		protected:
 
@@ -51,7 +78,8 @@ namespace Helix {
 			struct Base {
 				DNA::Name label;
 				MVector translation, normal, tangent; // Tangent is the normalized vector between the helix axis and the base.
-				MString name, helixName, material;
+				MString name, material;
+				unsigned int helix; // Index into m_helices.
 			};
 
 			struct Strand {
@@ -62,11 +90,30 @@ namespace Helix {
 
 			std::list<Strand> m_strands;
 
+			/*
+			 * Everything that only depends on the helix is resolved once per helix. Base world positions are obtained with the inclusive matrix.
+			 */
 			struct Helix {
+				MObject object;
+				MMatrix matrix;
 				MVector translation, normal;
+				MString name;
 			};
 
-			std::tr1::unordered_map<std::string, Helix> m_helices;
+			/*
+			 * Returns the index of the helix into m_helices, adding it if needed.
+			 */
+			unsigned int getHelix(const MObject & object, MStatus & status);
+
+			std::vector<Helix> m_helices;
+#if defined(WIN32) || defined(WIN64)
+			std::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash> m_helixIndices;
+#else
+			std::tr1::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash> m_helixIndices;
+#endif /* N Windows */
+
+			Model::Material::Assignments m_materials;
+			bool m_materialsQueried;
 		};
 	}
 }
@@ -14,6 +14,8 @@
 #include <model/Helix.h>
 #include <model/Base.h>
 
+#include <string>
+#include <vector>
 
 #include <maya/MString.h>
 #include <maya/MVector.h>
@@ -25,25 +27,34 @@ namespace Helix {
 			MStatus read(const char *topology_filename, const char *configuration_filename, const char *vhelix_filename);
 
 		protected:
+			/*
+			 * Called once per parsed file and once when the nodes have been created, the count is always 4.
+			 */
 			virtual void onProcessStart(int count) = 0;
 			virtual void onProcessStep() = 0;
 			virtual void onProcessEnd() = 0;
 
 		private:
+			/*
+			 * oxDNA base indices are dense 0..N-1, thus bases are stored in a vector indexed by them.
+			 */
 			struct Base {
-				unsigned int strand;
 				int forward, backward;
 
 				DNA::Name label;
 				MVector translation;
-				MString name, helixName, material;
-				Model::Base base;
+				MString name;
+				std::string helixName, material;
 			};
 
 			struct Helix {
 				MVector translation, normal;
+				MString name;
 				Model::Helix helix;
 			};
+
+			std::vector<Base> m_bases;
+			std::vector<Helix> m_helices;
 		};
 	}
 }
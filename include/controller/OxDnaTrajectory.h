@@ -0,0 +1,60 @@
+#ifndef _CONTROLLER_OXDNATRAJECTORY_H_
+#define _CONTROLLER_OXDNATRAJECTORY_H_
+
+#include <Definition.h>
+
+#include <maya/MStatus.h>
+#include <maya/MVector.h>
+
+#include <string>
+#include <vector>
+
+#define HELIX_OXDNA_TRAJECTORY_FILE_TYPE "dat"
+
+/*
+ * OxDnaTrajectory: Random access to the frames of an oxDNA trajectory file, which is a sequence of configurations.
+ * Trajectories of relaxations can be several gigabytes, thus the file is memory mapped and only the offsets of the frames
+ * are indexed when opened. readFrame then parses a single configuration, letting the OS page in only the part of the file needed.
+ */
+
+namespace Helix {
+	namespace Controller {
+		class VHELIXAPI OxDnaTrajectory {
+		public:
+			OxDnaTrajectory();
+			~OxDnaTrajectory();
+
+			MStatus open(const char *filename);
+			void close();
+
+			inline bool isOpen() const {
+				return m_data != NULL;
+			}
+
+			inline const std::string & getFilename() const {
+				return m_filename;
+			}
+
+			inline size_t numFrames() const {
+				return m_frames.size();
+			}
+
+			/*
+			 * Positions of all bases in the given frame, in oxDNA base index order. positions is cleared but keeps its capacity,
+			 * so reusing it between calls avoids reallocations.
+			 */
+			MStatus readFrame(size_t frame, std::vector<MVector> & positions) const;
+
+		private:
+			OxDnaTrajectory(const OxDnaTrajectory &);
+			OxDnaTrajectory & operator=(const OxDnaTrajectory &);
+
+			const char *m_data;
+			size_t m_size;
+			std::vector<size_t> m_frames;
+			std::string m_filename;
+		};
+	}
+}
+
+#endif /* N _CONTROLLER_OXDNATRAJECTORY_H_ */
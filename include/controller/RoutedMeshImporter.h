@@ -10,12 +10,28 @@
 
 #include <Utility.h>
 
+#include <model/Helix.h>
+
 #include <vector>
 
+#include <maya/MMatrix.h>
+
+/*
+ * RoutedMeshImporter: Imports a routed mesh as a scaffold strand of one helix per edge.
+ *
+ * The helices are first resolved into plain descriptors. Everything that only depends on the edge itself, including the base positions,
+ * is computed in parallel using the Maya thread pool. Only the tangent propagation along the route is sequential, as every helix
+ * is rotated to continue from the end base of the previous one. The helices are then created in bulk with a single BaseBatch.
+ */
+
 namespace Helix {
 	namespace Controller {
 		class VHELIXAPI RoutedMeshImporter {
 		public:
+			inline RoutedMeshImporter() : m_initialRotation(0.0) {
+
+			}
+
 			MStatus read(const char *filename);
 
 		private:
@@ -31,6 +47,24 @@ namespace Helix {
 
 			std::vector<Edge> m_edges;
 			double m_initialRotation;
+
+			struct HelixDescriptor {
+				bool valid; // False if the edge has no cylinder.
+				bool hasAngle; // If not, the tangent is obtained from the end base of the previous helix.
+				int bases;
+				double length;
+				MVector normal, tangent, start_cylinder, end_cylinder;
+				MMatrix transform;
+				std::vector<MVector> positions; // Forward and backward base positions in helix space, interleaved.
+				Model::Helix helix;
+			};
+
+			std::vector<HelixDescriptor> m_descriptors;
+
+			/*
+			 * Computes the descriptor for the edge at index, apart from the tangent propagation and transform. Called in parallel.
+			 */
+			static void ComputeDescriptor(void *importer, size_t index);
 		};
 	}
 }
@@ -4,12 +4,53 @@
 #include <Definition.h>
 
 #include <model/Strand.h>
+#include <Utility.h>
+
+#include <vector>
+
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_set>
+#else
+#include <tr1/unordered_set>
+#endif /* N Windows */
 
 namespace Helix {
 	namespace Controller {
 		class VHELIXAPI StrandLengthCount {
 		public:
+			/*
+			 * Distribution of the lengths of all strands in the scene. Strands shorter than DNA::SHORTEST_STAPLE or longer than
+			 * DNA::SHORTEST_LONGEST_STAPLE are counted as out of range. Note that the scaffold is counted as well.
+			 */
+			struct Histogram {
+				std::vector<unsigned int> counts; // Number of strands indexed by their length.
+				unsigned int strands, minLength, maxLength, tooShort, tooLong;
+				size_t bases;
+				double mean;
+
+				inline Histogram() : strands(0), minLength(0), maxLength(0), tooShort(0), tooLong(0), bases(0), mean(0.0) {
+
+				}
+			};
+
 			unsigned int length(Model::Strand & strand);
+
+			/*
+			 * Every base is visited once: For every base not already visited, its whole strand is walked and marked as visited.
+			 */
+			MStatus histogram(Histogram & histogram);
+
+		private:
+#if defined(WIN32) || defined(WIN64)
+			typedef std::unordered_set<MObjectHandle, ObjectHandleHash> Visited;
+#else
+			typedef std::tr1::unordered_set<MObjectHandle, ObjectHandleHash> Visited;
+#endif /* N Windows */
+
+			/*
+			 * Walks backwards from the defining base and then forward if the strand is not a loop. Bases are added to visited if given.
+			 */
+			unsigned int walk(Model::Strand & strand, Visited *visited, MStatus & status);
 		};
 	}
 }
@@ -0,0 +1,35 @@
+#ifndef _CONTROLLER_TEXTBASEDEXPORTER_H_
+#define _CONTROLLER_TEXTBASEDEXPORTER_H_
+
+#include <Definition.h>
+#include <Utility.h>
+
+#include <model/Helix.h>
+
+#include <maya/MObjectArray.h>
+
+/*
+ * TextBasedExporter: Writes helices and their bases in the same line based format read by the TextBasedImporter.
+ * As only the transforms, labels, materials and connections are written it is a lot smaller and faster to save and load than a Maya file.
+ *
+ * h <helix> <x> <y> <z> <qx> <qy> <qz> <qw>			A helix without any automatically generated bases.
+ * b <base> <helix> <x> <y> <z> <material> <label>		A base, translation is relative to its helix.
+ * c <helix> <base> - <target helix> <target base> -	A forward connection from base to target base.
+ * o <helix> <base> <target helix> <target base>		A base pair, the label of the target base is the opposite of the base.
+ * ps <helix> <base> <material>					A strand starting at base where every base has the given material.
+ *
+ * The '-' after each base of a connection is its endpoint type, telling the importer the base is named and not one of the f5', f3', b5' or b3' ends.
+ * Bases of strands written as 'ps' and bases without a material are written with the material '-', and bases without a label with the label '?'.
+ * Connections and base pairs to bases of helices that are not exported are skipped, as the importer can't make them.
+ */
+
+namespace Helix {
+	namespace Controller {
+		class VHELIXAPI TextBasedExporter {
+		public:
+			MStatus write(const char *filename, const MObjectArray & helices);
+		};
+	}
+}
+
+#endif /* N _CONTROLLER_TEXTBASEDEXPORTER_H_ */
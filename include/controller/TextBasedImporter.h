@@ -29,7 +29,7 @@ namespace Helix {
 				MVector position;
 				DNA::Name label;
 
-				inline Base(const char *name, const MVector & position, const char *materialName, const DNA::Name & label) : name(name), materialName(materialName), position(position), label(label) {}
+				inline Base(const char *name, const char *helixName, const MVector & position, const char *materialName, const DNA::Name & label) : name(name), helixName(helixName), materialName(materialName), position(position), label(label) {}
 				inline Base() {}
 			};
 
@@ -68,7 +68,7 @@ namespace Helix {
 #endif /* Not windows */
 
 			std::vector<Helix> helices;
-			std::vector<Connection> connections;
+			std::vector<Connection> connections, pairs; // Pairs are explicit opposite connections between named bases given by the 'o' command.
 			std::vector<Base> explicitBases; // Bases explicitly created with the 'b' command.
 			explicit_base_labels_t explicitBaseLabels;
 
@@ -0,0 +1,105 @@
+#ifndef _MODEL_BASEBATCH_H_
+#define _MODEL_BASEBATCH_H_
+
+#include <model/Base.h>
+#include <model/Helix.h>
+#include <model/Material.h>
+
+#include <DNA.h>
+
+#include <maya/MDagModifier.h>
+#include <maya/MDGModifier.h>
+#include <maya/MString.h>
+#include <maya/MVector.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * BaseBatch: Creating bases one by one with Base::Create, setMaterial and connect_forward executes several MEL commands per base
+ * and makes importers and bulk operations on large designs very slow.
+ *
+ * Instead, all bases are queued with add and their connections with connect_forward and connect_opposite.
+ * create then generates all nodes with a single MDagModifier, makes all connections with a single MDGModifier undone along with them,
+ * assigns materials with one MEL command per material and sets up the aim constraints in large MEL chunks.
+ *
+ * Existing bases can be added to be connected with the new ones. Connections are made as given, thus any previous
+ * connections on existing bases must be removed before calling create.
+ */
+
+namespace Helix {
+	namespace Model {
+		class VHELIXAPI BaseBatch {
+		public:
+			/*
+			 * Queue a new base for creation. Returns the index of the base within the batch.
+			 */
+			unsigned int add(Helix & helix, const MString & name, const MVector & translation, const Material & material = Material(), DNA::Name label = DNA::Invalid, MSpace::Space space = MSpace::kTransform);
+
+			/*
+			 * Add an existing base to be able to connect it with the new bases. It will not be modified other than its connections.
+			 */
+			unsigned int add(const Base & base);
+
+			inline void connect_forward(unsigned int source, unsigned int target) {
+				m_forward.push_back(std::make_pair(source, target));
+			}
+
+			inline void connect_opposite(unsigned int source, unsigned int target) {
+				m_opposite.push_back(std::make_pair(source, target));
+			}
+
+			inline void reserve(size_t bases) {
+				m_bases.reserve(bases);
+				m_forward.reserve(bases);
+			}
+
+			inline size_t size() const {
+				return m_bases.size();
+			}
+
+			/*
+			 * Only valid after create.
+			 */
+			inline Base & operator[](unsigned int index) {
+				return m_bases[index].base;
+			}
+
+			MStatus create();
+
+			/*
+			 * Deletes the created bases and the aim constraints made on existing bases. Note that the previous connections of existing bases are not restored.
+			 */
+			MStatus undo();
+			MStatus redo();
+
+			/*
+			 * Executes the MEL command buffer and clears it if it is large enough or if force is given.
+			 * Used for building MEL commands for many bases at once without running out of memory.
+			 */
+			static MStatus ExecuteCommand(std::string & command, bool force = false);
+
+		private:
+			struct Entry {
+				Base base;
+				MObject helix;
+				MString name;
+				MVector translation;
+				Material material;
+				DNA::Name label;
+				MSpace::Space space;
+				bool existing;
+			};
+
+			MStatus apply();
+
+			std::vector<Entry> m_bases;
+			std::vector< std::pair<unsigned int, unsigned int> > m_forward, m_opposite;
+			MDagModifier m_dagModifier;
+			MDGModifier m_dgModifier;
+		};
+	}
+}
+
+#endif /* N _MODEL_BASEBATCH_H_ */
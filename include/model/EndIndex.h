@@ -0,0 +1,96 @@
+#ifndef _MODEL_ENDINDEX_H_
+#define _MODEL_ENDINDEX_H_
+
+#include <model/Base.h>
+#include <Utility.h>
+
+#include <vector>
+
+#include <maya/MCallbackIdArray.h>
+#include <maya/MDagPath.h>
+#include <maya/MObject.h>
+#include <maya/MObjectArray.h>
+#include <maya/MObjectHandle.h>
+
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_map>
+#include <unordered_set>
+#else
+#include <tr1/unordered_map>
+#include <tr1/unordered_set>
+#endif /* N Windows */
+
+/*
+ * EndIndex: Scene-wide index of the 5' and 3' end bases, grouped by helix.
+ *
+ * Finding ends by iterating all bases and calling Base::type queries two plugs per base. Instead, HelixBase reports its creation
+ * and every change of its forward and backward connections here, and bases reparented to another helix are reported through
+ * a DAG callback. Reported bases are queued and their type is resolved with Base::type on the next lookup, when their helix and
+ * connections are known. Lookups are thus proportional to the number of ends and changes and not the number of bases.
+ *
+ * Deleted bases are skipped but kept, so that they are found again if the deletion is undone. The index is cleared when a scene
+ * is created or opened. If the callbacks could not be registered, or an indexed base is no longer on the helix it was indexed
+ * for, the helix bases are tested one by one as before.
+ */
+
+namespace Helix {
+	namespace Model {
+		class VHELIXAPI EndIndex {
+		public:
+			/*
+			 * Called by HelixBase when it's created or its forward or backward connection is made or broken.
+			 */
+			static void Changed(const MObject & base);
+
+			/*
+			 * All bases in the scene, or on the given helix, of exactly the given type. Thus an unconnected base is an END but neither
+			 * a FIVE_PRIME_END nor a THREE_PRIME_END, same as Base::type.
+			 */
+			static MStatus Ends(Base::Type type, MObjectArray & bases);
+			static MStatus Ends(const MObject & helix, Base::Type type, std::vector<Base> & bases);
+
+			/*
+			 * Removes all callbacks and bases. Called when unloading the plugin.
+			 */
+			static void release();
+
+		private:
+			struct Entry {
+				MObjectHandle helix;
+				int type;
+			};
+
+#if defined(WIN32) || defined(WIN64)
+			typedef std::unordered_map<MObjectHandle, Entry, ObjectHandleHash> Container;
+			typedef std::unordered_set<MObjectHandle, ObjectHandleHash> BaseSet;
+			typedef std::unordered_map<MObjectHandle, BaseSet, ObjectHandleHash> HelixContainer;
+#else
+			typedef std::tr1::unordered_map<MObjectHandle, Entry, ObjectHandleHash> Container;
+			typedef std::tr1::unordered_set<MObjectHandle, ObjectHandleHash> BaseSet;
+			typedef std::tr1::unordered_map<MObjectHandle, BaseSet, ObjectHandleHash> HelixContainer;
+#endif /* N Windows */
+
+			static void Set(const MObject & base, int type, MStatus & status);
+			static void ResolveChanged();
+			static void RegisterCallbacks();
+			static void Clear();
+
+			/*
+			 * The bases on the helix of the given type tested one by one, when the index can't be trusted.
+			 */
+			static MStatus Walk(const MObject & helix, Base::Type type, std::vector<Base> & bases);
+			static MStatus Walk(Base::Type type, MObjectArray & bases);
+
+			static void MDagMessage_parentAdded(MDagPath & child, MDagPath & parent, void *clientData);
+			static void MSceneMessage_beforeNewOpen(void *clientData);
+
+			static Container s_ends;
+			static HelixContainer s_helices;
+			static BaseSet s_changed; // Bases changed several times before being resolved are only queued once.
+			static MCallbackIdArray s_callbacks;
+			static bool s_registered, s_reliable;
+		};
+	}
+}
+
+#endif /* N _MODEL_ENDINDEX_H_ */
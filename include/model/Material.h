@@ -9,11 +9,21 @@
 #define MODEL_MATERIAL_H_
 
 #include <model/Object.h>
+#include <Utility.h>
 
+#include <maya/MObject.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MString.h>
 
+#include <utility>
 #include <vector>
 
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif /* N Windows */
+
 /*
 * New code for managing materials, using this code, duplication of material nodes should never occur
 * We're also no longer dependent on the DNAshaders.ma file, which makes it so much easier for users to install the plugin
@@ -194,6 +204,30 @@ namespace Helix {
 				return ApplyMaterialToBases(*this);
 			}
 
+			/*
+			 * Base::getMaterial executes several MEL commands for every base. When the materials of many bases are needed, query
+			 * the members of every material set once instead and look the bases up by their node.
+			 */
+
+			class VHELIXAPI Assignments {
+			public:
+				MStatus query();
+
+				/*
+				 * Returns false if the base does not have a material.
+				 */
+				bool find(const MObject & base, Material & material) const;
+
+			private:
+#if defined(WIN32) || defined(WIN64)
+				typedef std::unordered_map<MObjectHandle, Material, ObjectHandleHash> Container;
+#else
+				typedef std::tr1::unordered_map<MObjectHandle, Material, ObjectHandleHash> Container;
+#endif /* N Windows */
+
+				Container m_assignments;
+			};
+
 		protected:
 			MString m_material;
 		};
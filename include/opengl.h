@@ -38,6 +38,13 @@ bool installGLExtensions();
 
 #endif /* N MAC_PLUGIN */
 
+/*
+ * Instanced rendering requires GL_ARB_draw_instanced and GL_ARB_instanced_arrays, which not all drivers expose.
+ * Must be called in an active GL context
+ */
+
+bool hasGLInstancing();
+
 /*
  * INFO: Remember to disable this when running in production mode as it will decrease performance
  */
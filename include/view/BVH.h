@@ -0,0 +1,212 @@
+#ifndef _VIEW_BVH_H_
+#define _VIEW_BVH_H_
+
+#include <Definition.h>
+
+#include <maya/M3dView.h>
+#include <maya/MBoundingBox.h>
+#include <maya/MMatrix.h>
+#include <maya/MPoint.h>
+#include <maya/MStatus.h>
+#include <maya/MVector.h>
+
+#include <vector>
+
+/*
+ * Maximum number of boxes in a leaf, and the maximum depth of a query. The median split keeps the depth at log2(n / BVH_LEAF_SIZE).
+ */
+#define BVH_LEAF_SIZE 4
+#define BVH_MAX_DEPTH 64
+
+/*
+ * BVH: A bounding volume hierarchy over world space bounding boxes, built by splitting at the median along the longest axis.
+ * The hierarchy only stores the indices of the boxes it was built from, it has to be rebuilt when any of them change.
+ * Building is O(n log n) and costs far more than a query (about half a second for a million bases), so it should only be done lazily.
+ *
+ * Frustum: The camera frustum of a view or of a selection region, for querying the BVH.
+ * Ray: A ray through a point of a view, for picking with the BVH.
+ */
+
+namespace Helix {
+	namespace View {
+		class BVH {
+		public:
+			enum Intersection {
+				kOutside = 0,
+				kIntersects = 1,
+				kInside = 2
+			};
+
+			void build(const std::vector<MBoundingBox> & boxes);
+
+			inline void clear() {
+				m_nodes.clear();
+				m_indices.clear();
+				m_boxes.clear();
+			}
+
+			inline bool empty() const {
+				return m_nodes.empty();
+			}
+
+			/*
+			 * Calls visitor(unsigned int index) for every box that test(const MBoundingBox &) does not classify as outside.
+			 * Boxes below a node completely inside are visited without being tested.
+			 */
+
+			template<typename Test, typename Visitor>
+			void query(const Test & test, Visitor & visitor) const {
+				if (m_nodes.empty())
+					return;
+
+				struct {
+					unsigned int node;
+					bool inside;
+				} stack[BVH_MAX_DEPTH * 2];
+
+				int top = 0;
+
+				stack[0].node = 0;
+				stack[0].inside = false;
+
+				while (top >= 0) {
+					const unsigned int index = stack[top].node;
+					bool inside = stack[top].inside;
+					--top;
+
+					const Node & node(m_nodes[index]);
+
+					if (!inside) {
+						const Intersection intersection = test(node.box);
+
+						if (intersection == kOutside)
+							continue;
+
+						inside = intersection == kInside;
+					}
+
+					if (node.count > 0) {
+						for (unsigned int i = node.first; i < node.first + node.count; ++i) {
+							if (inside || test(m_boxes[m_indices[i]]) != kOutside)
+								visitor(m_indices[i]);
+						}
+					}
+					else {
+						++top;
+						stack[top].node = node.first;
+						stack[top].inside = inside;
+
+						++top;
+						stack[top].node = index + 1;
+						stack[top].inside = inside;
+					}
+				}
+			}
+
+		private:
+			/*
+			 * Nodes are stored depth first, the left child of an inner node directly follows it and first is the index of the right child.
+			 * For leaves, first and count is the range of m_indices.
+			 */
+
+			struct Node {
+				MBoundingBox box;
+				unsigned int first, count;
+			};
+
+			unsigned int build(const std::vector<MPoint> & centroids, unsigned int begin, unsigned int end);
+
+			std::vector<Node> m_nodes;
+			std::vector<unsigned int> m_indices;
+			std::vector<MBoundingBox> m_boxes;
+		};
+
+		class Frustum {
+		public:
+			/*
+			 * An empty frustum contains everything.
+			 */
+
+			inline Frustum() : m_numPlanes(0) {
+
+			}
+
+			/*
+			 * The frustum of the camera of the view.
+			 */
+
+			MStatus setFromView(M3dView & view);
+
+			/*
+			 * The frustum below a rectangle in view coordinates, such as a marquee selection.
+			 */
+
+			MStatus setFromRegion(M3dView & view, short x0, short y0, short x1, short y1);
+
+			BVH::Intersection classify(const MBoundingBox & box) const;
+
+			/*
+			 * Whether any part of the capsule from a to b is inside. Conservative, as every plane is tested independently.
+			 */
+
+			bool intersects(const MPoint & a, const MPoint & b, double radius) const;
+
+			inline BVH::Intersection operator()(const MBoundingBox & box) const {
+				return classify(box);
+			}
+
+		protected:
+			/*
+			 * Adds the plane a * x + b * y + c * z + d >= 0 given in the space transformed to world space by matrix.
+			 */
+
+			void addPlane(const MMatrix & inverseMatrix, double a, double b, double c, double d);
+
+			/*
+			 * Adds the plane through the three points, facing the inside point.
+			 */
+
+			void addPlane(const MPoint & p0, const MPoint & p1, const MPoint & p2, const MPoint & inside);
+
+			double m_planes[6][4];
+			int m_numPlanes;
+		};
+
+		class Ray {
+		public:
+			inline Ray() : direction(MVector::zNegAxis) {
+
+			}
+
+			inline Ray(const MPoint & origin_, const MVector & direction_) : origin(origin_), direction(direction_) {
+
+			}
+
+			/*
+			 * The ray through a point in view coordinates, such as a single click selection.
+			 */
+
+			MStatus setFromView(M3dView & view, short x, short y);
+
+			/*
+			 * Distance is in units of direction, and is zero if the origin is inside the box.
+			 */
+
+			bool intersects(const MBoundingBox & box, double & distance) const;
+
+			inline Ray transformed(const MMatrix & matrix) const {
+				return Ray(origin * matrix, direction * matrix);
+			}
+
+			inline BVH::Intersection operator()(const MBoundingBox & box) const {
+				double distance;
+				return intersects(box, distance) ? BVH::kIntersects : BVH::kOutside;
+			}
+
+			MPoint origin;
+			MVector direction;
+		};
+	}
+}
+
+#endif /* N _VIEW_BVH_H_ */
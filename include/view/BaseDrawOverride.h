@@ -0,0 +1,74 @@
+#ifndef _VIEW_BASEDRAWOVERRIDE_H_
+#define _VIEW_BASEDRAWOVERRIDE_H_
+
+#include <Definition.h>
+
+#include <maya/MTypes.h>
+
+/*
+ * Viewport 2.0 was introduced with Maya 2014, older versions only use the legacy BaseShapeUI
+ */
+
+#if MAYA_API_VERSION >= 201400
+#define HELIX_VIEWPORT2
+#endif /* MAYA_API_VERSION >= 201400 */
+
+#ifdef HELIX_VIEWPORT2
+
+#include <maya/M3dView.h>
+#include <maya/MBoundingBox.h>
+#include <maya/MDagPath.h>
+#include <maya/MDrawContext.h>
+#include <maya/MFrameContext.h>
+#include <maya/MPxDrawOverride.h>
+#include <maya/MUserData.h>
+
+#define BASE_SHAPE_DRAW_CLASSIFICATION "drawdb/geometry/helixBaseShape"
+#define BASE_SHAPE_DRAW_REGISTRANT_ID "helixBaseShapeDrawOverride"
+
+/*
+ * BaseDrawOverride: Draws the bases in Viewport 2.0. Just like BaseShapeUI, every base is submitted to the BaseRenderer
+ * in prepareForDraw and the first draw callback of the frame draws all of them with the shared instance buffer.
+ * Selection is still done by BaseShapeUI::select.
+ */
+
+namespace Helix {
+	namespace View {
+		/*
+		 * Shared with the draw overrides of HelixShape and the locators. The view being drawn by cameraPath, see BaseDrawOverride.cpp.
+		 */
+
+		M3dView BaseDrawOverride_view(const MDagPath & cameraPath);
+
+		/*
+		 * Loads the world view and projection matrices of the object being drawn into the fixed function matrices, so that the OpenGL code
+		 * of the legacy viewport can be reused. Returns false if the matrices could not be obtained, and endGL must then not be called.
+		 */
+
+		bool BaseDrawOverride_beginGL(const MHWRender::MDrawContext & context);
+		void BaseDrawOverride_endGL();
+
+		class BaseDrawOverride : public MHWRender::MPxDrawOverride {
+		public:
+			static MHWRender::MPxDrawOverride *creator(const MObject & obj);
+
+			virtual ~BaseDrawOverride();
+
+			virtual MHWRender::DrawAPI supportedDrawAPIs() const;
+
+			virtual bool isBounded(const MDagPath & objPath, const MDagPath & cameraPath) const;
+			virtual MBoundingBox boundingBox(const MDagPath & objPath, const MDagPath & cameraPath) const;
+
+			virtual MUserData *prepareForDraw(const MDagPath & objPath, const MDagPath & cameraPath, const MHWRender::MFrameContext & frameContext, MUserData *oldData);
+
+			static void draw(const MHWRender::MDrawContext & context, const MUserData *data);
+
+		private:
+			BaseDrawOverride(const MObject & obj);
+		};
+	}
+}
+
+#endif /* N HELIX_VIEWPORT2 */
+
+#endif /* N _VIEW_BASEDRAWOVERRIDE_H_ */
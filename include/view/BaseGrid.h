@@ -0,0 +1,120 @@
+#ifndef _VIEW_BASEGRID_H_
+#define _VIEW_BASEGRID_H_
+
+#include <Definition.h>
+#include <DNA.h>
+#include <Utility.h>
+
+#include <maya/MCallbackIdArray.h>
+#include <maya/MDagPath.h>
+#include <maya/MMessage.h>
+#include <maya/MObjectArray.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MPoint.h>
+#include <maya/MTime.h>
+
+#include <vector>
+
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif /* N Windows */
+
+/*
+ * Size of the grid cells. Connection suggestions are searched within the same distance, so that a query only visits the
+ * 27 cells around a base.
+ */
+#define BASEGRID_CELL_SIZE (DNA::STEP * 2.0)
+
+/*
+ * BaseGrid: The world space positions of all bases in the scene, hashed into a uniform grid for finding the bases close to a position.
+ *
+ * The grid is filled with a single MItDag scan, and after that bases are only moved between cells when they're reported as translated
+ * with update. Moving a helix is reported by ConnectSuggestionsLocatorNode::UpdateHelix as an update of each of its bases, so only
+ * that helix is re-bucketed. Bases being created, deleted or reparented causes a new scan before the next query, as does the time
+ * changing or the selection changing, when bases might have been moved without being tracked.
+ */
+
+namespace Helix {
+	namespace View {
+		class BaseGrid {
+		public:
+			/*
+			 * Moves the base to its new world space position, or adds it if it's not in the grid.
+			 */
+
+			static void update(const MObject & base, const MObject & helix, const MPoint & position);
+
+			/*
+			 * Appends the bases closer than distance to the position. Bases of the given helix are skipped.
+			 */
+
+			static MStatus query(const MPoint & position, double distance, const MObject & helix, MObjectArray & bases);
+
+			/*
+			 * Scan the scene again before the next query.
+			 */
+
+			static void invalidate();
+
+			/*
+			 * Removes all callbacks and bases. Called when unloading the plugin.
+			 */
+
+			static void release();
+
+		private:
+			struct Cell {
+				int x, y, z;
+
+				inline bool operator==(const Cell & cell) const {
+					return x == cell.x && y == cell.y && z == cell.z;
+				}
+			};
+
+			class CellHash {
+			public:
+				inline size_t operator()(const Cell & cell) const {
+					return size_t(cell.x) * 73856093u ^ size_t(cell.y) * 19349663u ^ size_t(cell.z) * 83492791u;
+				}
+			};
+
+			struct Entry {
+				MObjectHandle base, helix;
+				MPoint position;
+				Cell cell;
+			};
+
+#if defined(WIN32) || defined(WIN64)
+			typedef std::unordered_map<MObjectHandle, Entry, ObjectHandleHash> entry_map_t;
+			typedef std::unordered_map<Cell, std::vector<MObjectHandle>, CellHash> cell_map_t;
+#else
+			typedef std::tr1::unordered_map<MObjectHandle, Entry, ObjectHandleHash> entry_map_t;
+			typedef std::tr1::unordered_map<Cell, std::vector<MObjectHandle>, CellHash> cell_map_t;
+#endif /* N Windows */
+
+			static Cell cellOf(const MPoint & position);
+			static MStatus rescan();
+			static void insert(const Entry & entry);
+			static void removeFromCell(const MObjectHandle & base, const Cell & cell);
+			static void clear();
+
+			static void MDGMessage_baseAddedRemoved(MObject & node, void *clientData);
+			static void MDagMessage_parentAdded(MDagPath & child, MDagPath & parent, void *clientData);
+			static void MDGMessage_timeChange(MTime & time, void *clientData);
+			static void MSceneMessage_beforeNewOpen(void *clientData);
+
+			/*
+			 * The entries are indexed by the MObjectHandle of the base, the cells hold the handles of the bases inside them.
+			 */
+
+			static entry_map_t s_entries;
+			static cell_map_t s_cells;
+			static MCallbackIdArray s_globalCallbacks;
+			static bool s_rescan;
+		};
+	}
+}
+
+#endif /* N _VIEW_BASEGRID_H_ */
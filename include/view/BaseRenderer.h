@@ -0,0 +1,234 @@
+#ifndef _VIEW_BASERENDERER_H_
+#define _VIEW_BASERENDERER_H_
+
+#include <Definition.h>
+#include <Utility.h>
+
+#include <view/BVH.h>
+
+#include <maya/M3dView.h>
+#include <maya/MCallbackIdArray.h>
+#include <maya/MBoundingBox.h>
+#include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
+#include <maya/MDrawRequest.h>
+#include <maya/MMatrix.h>
+#include <maya/MMessage.h>
+#include <maya/MNodeMessage.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MPlug.h>
+#include <maya/MPoint.h>
+#include <maya/MPxSurfaceShapeUI.h>
+#include <maya/MSelectInfo.h>
+
+#ifdef MAC_PLUGIN
+
+#include <OpenGL/glext.h>
+#include <OpenGL/gl.h>
+
+#else
+
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#endif /* N MAC_PLUGIN */
+
+#include <vector>
+
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif /* N Windows */
+
+/*
+ * BaseRenderer: Renders the backbone arrows of all visible bases with a single instanced draw call.
+ *
+ * Every base has an instance in a buffer shared by the whole scene holding its world matrix, material color and selection border.
+ * The world matrix is compared with the instance on every submit, as it also changes through constraints, animation and transforms
+ * above the helix. The color is only evaluated again when callbacks report that the material assignment or the attributes of the
+ * surface shader changed. Instances are only rewritten when any of them differ, and only the modified range is downloaded to the
+ * graphics card.
+ *
+ * Maya still issues a draw per base. BaseShapeUI::getDrawRequests (or BaseDrawOverride::prepareForDraw in Viewport 2.0) submits its
+ * base and marks it visible in the current frame, the first draw of the frame draws all of them and the remaining ones return immediately.
+ * Without GL_ARB_draw_instanced and GL_ARB_instanced_arrays, the instances are drawn in a loop using constant vertex attributes.
+ *
+ * Selection doesn't use the OpenGL selection buffer either. The instance matrices already hold the world space positions of the bases,
+ * so a BVH over them answers the ray of a click or the frustum of a marquee for all bases at once.
+ */
+
+namespace Helix {
+	namespace View {
+		class BaseRenderer {
+		public:
+			/*
+			 * Called for every base by BaseShapeUI::getDrawRequests or BaseDrawOverride::prepareForDraw.
+			 * view and ui are used for the selection colors and evaluating the material of the base when needed.
+			 */
+
+			static void submit(const MDagPath & path, M3dView::DisplayStatus displayStatus, M3dView & view, MPxSurfaceShapeUI & ui);
+
+			/*
+			 * Called for every base by BaseShapeUI::draw, only the first call after a submit draws.
+			 */
+
+			static void draw(const MDrawRequest & request, M3dView & view);
+
+			/*
+			 * Same as above for Viewport 2.0, where the matrices are not set up by Maya.
+			 */
+
+			static void draw(const MMatrix & viewMatrix, const MMatrix & projectionMatrix, bool wireframe);
+
+			/*
+			 * Called for every base by BaseShapeUI::select. The bases drawn in the last frame are picked once per selection and the
+			 * result is reused for the remaining bases. point is the world space position of a picked base.
+			 */
+
+			static bool isPicked(MSelectInfo & selectInfo, MPoint & point);
+
+			/*
+			 * The bases drawn in the last frame inside or intersecting the frustum.
+			 */
+
+			static void pick(const Frustum & frustum, MDagPathArray & bases);
+
+			/*
+			 * The closest base drawn in the last frame hit by the ray. distance is in units of the ray direction.
+			 */
+
+			static bool pick(const Ray & ray, MDagPath & base, double & distance);
+
+			static inline bool isInitialized() {
+				return s_drawData.initialized;
+			}
+
+			/*
+			 * Removes all callbacks and instances. Called when unloading the plugin and before a new scene is created or opened.
+			 */
+
+			static void release();
+
+		private:
+			/*
+			 * Layout of an instance in the buffer, must match the instance attributes of the vertex shader.
+			 * matrix is column major as expected by OpenGL, border is the border color and whether to draw the border.
+			 */
+
+			struct Instance {
+				GLfloat matrix[16], color[3], border[4], visible;
+			};
+
+			/*
+			 * shader is the surface shader the color was last evaluated from
+			 */
+
+			struct Record {
+				MObjectHandle shape, shader;
+				unsigned int slot;
+				MCallbackId callbacks[2];
+				bool colorDirty;
+			};
+
+#if defined(WIN32) || defined(WIN64)
+			typedef std::unordered_map<MObjectHandle, Record, ObjectHandleHash> record_map_t;
+			typedef std::unordered_map<MObjectHandle, MCallbackId, ObjectHandleHash> shader_callback_map_t;
+#else
+			typedef std::tr1::unordered_map<MObjectHandle, Record, ObjectHandleHash> record_map_t;
+			typedef std::tr1::unordered_map<MObjectHandle, MCallbackId, ObjectHandleHash> shader_callback_map_t;
+#endif /* N Windows */
+
+			static void initializeDraw();
+			static void drawInstances(bool wireframe);
+			static void clear();
+
+			static Record *addRecord(const MDagPath & path);
+			static void removeRecord(const MObjectHandle & shape);
+
+			/*
+			 * Finds the surface shader assigned to the base and registers a callback on it, so that editing its color is noticed
+			 */
+
+			static void watchShader(const MDagPath & path, Record & record);
+
+			/*
+			 * Marks the instance as modified so that it will be downloaded before the next draw.
+			 */
+
+			static void touch(unsigned int slot);
+
+			/*
+			 * Picking is done on the CPU with a BVH over the world space bounding boxes of the visible instances.
+			 * It is rebuilt by the first pick after any instance was modified.
+			 */
+
+			static void updatePickBVH();
+			static void pickSlots(const Frustum & frustum, std::vector<unsigned int> & slots);
+			static int pickSlot(const Ray & ray, double & distance);
+			static MMatrix instanceMatrix(unsigned int slot);
+			static MStatus getBasePath(unsigned int slot, MDagPath & base);
+
+			static void MNodeMessage_shape_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData);
+			static void MNodeMessage_shape_preRemoval(MObject & node, void *clientData);
+			static void MNodeMessage_shader_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData);
+			static void MSceneMessage_beforeNewOpen(void *clientData);
+
+			struct DrawData {
+				GLuint program, vertex_shader, fragment_shader, instance_buffer;
+				GLint instance_attribs[7];
+				GLsizei instance_buffer_capacity;
+				bool initialized, failure, instancing;
+
+				DrawData() : program(0), vertex_shader(0), fragment_shader(0), instance_buffer(0), instance_buffer_capacity(0), initialized(false), failure(false), instancing(false) { }
+			} static s_drawData;
+
+			/*
+			 * The records are indexed by the MObjectHandle of the BaseShape and point out the slot of their instance.
+			 * s_slots maps the instances back to their records so that the last instance can be moved into the slot of a removed one.
+			 * s_frames is the last frame each instance was submitted in, instances not submitted in the current frame are hidden.
+			 * s_shaders holds the callbacks registered on the surface shaders of the bases.
+			 */
+
+			static std::vector<Instance> s_instances;
+			static std::vector<MObjectHandle> s_slots;
+			static std::vector<unsigned int> s_frames;
+			static record_map_t s_records;
+			static shader_callback_map_t s_shaders;
+			static MCallbackIdArray s_globalCallbacks;
+
+			/*
+			 * s_frame is increased by the first submit after a draw. s_dirty_begin and s_dirty_end is the range of instances to download.
+			 */
+
+			static unsigned int s_frame;
+			static bool s_drawn;
+			static size_t s_dirty_begin, s_dirty_end;
+
+			/*
+			 * s_modified is increased by every touch and removal, the BVH is up to date when it equals s_pickModified.
+			 * s_pickSlots maps the boxes of the BVH to the instances. s_picked holds the sorted slots of the shapes picked by the
+			 * selection identified by s_pickKey, the slots don't change as long as s_modified doesn't.
+			 */
+
+			struct PickKey {
+				MDagPath camera;
+				unsigned int x, y, width, height, frame, modified;
+				bool singleSelection;
+
+				PickKey() : x(0), y(0), width(0), height(0), frame(0), modified(0), singleSelection(false) { }
+
+				inline bool operator==(const PickKey & key) const {
+					return x == key.x && y == key.y && width == key.width && height == key.height && frame == key.frame && modified == key.modified && singleSelection == key.singleSelection && camera == key.camera;
+				}
+			} static s_pickKey;
+
+			static BVH s_pickBVH;
+			static MBoundingBox s_arrowBox;
+			static std::vector<unsigned int> s_pickSlots, s_picked;
+			static unsigned int s_modified, s_pickModified;
+		};
+	}
+}
+
+#endif /* N _VIEW_BASERENDERER_H_ */
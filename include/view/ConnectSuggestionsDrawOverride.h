@@ -0,0 +1,41 @@
+#ifndef _VIEW_CONNECTSUGGESTIONSDRAWOVERRIDE_H_
+#define _VIEW_CONNECTSUGGESTIONSDRAWOVERRIDE_H_
+
+#include <view/BaseDrawOverride.h>
+
+#ifdef HELIX_VIEWPORT2
+
+#define CONNECT_SUGGESTIONS_LOCATOR_DRAW_CLASSIFICATION "drawdb/geometry/connectSuggestionsLocator"
+#define CONNECT_SUGGESTIONS_LOCATOR_DRAW_REGISTRANT_ID "connectSuggestionsLocatorDrawOverride"
+
+/*
+ * ConnectSuggestionsDrawOverride: Draws the connect suggestions in Viewport 2.0 with ConnectSuggestionsLocatorNode::drawGL.
+ * The table of close bases is maintained by the callbacks of the locator, so there is nothing to prepare.
+ */
+
+namespace Helix {
+	namespace View {
+		class ConnectSuggestionsDrawOverride : public MHWRender::MPxDrawOverride {
+		public:
+			static MHWRender::MPxDrawOverride *creator(const MObject & obj);
+
+			virtual ~ConnectSuggestionsDrawOverride();
+
+			virtual MHWRender::DrawAPI supportedDrawAPIs() const;
+
+			virtual bool isBounded(const MDagPath & objPath, const MDagPath & cameraPath) const;
+			virtual MBoundingBox boundingBox(const MDagPath & objPath, const MDagPath & cameraPath) const;
+
+			virtual MUserData *prepareForDraw(const MDagPath & objPath, const MDagPath & cameraPath, const MHWRender::MFrameContext & frameContext, MUserData *oldData);
+
+			static void draw(const MHWRender::MDrawContext & context, const MUserData *data);
+
+		private:
+			ConnectSuggestionsDrawOverride(const MObject & obj);
+		};
+	}
+}
+
+#endif /* N HELIX_VIEWPORT2 */
+
+#endif /* N _VIEW_CONNECTSUGGESTIONSDRAWOVERRIDE_H_ */
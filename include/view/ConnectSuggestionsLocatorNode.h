@@ -71,6 +71,12 @@ namespace Helix {
 
 			virtual void draw(M3dView &view, const MDagPath &path, M3dView::DisplayStyle style, M3dView::DisplayStatus status);
 
+			/*
+			 * The OpenGL part of draw, shared with the Viewport 2.0 override. Expects a current context.
+			 */
+
+			static void drawGL(int portWidth, int portHeight);
+
 			virtual bool isBounded() const;
 			virtual bool isTransparent() const;
 
@@ -0,0 +1,118 @@
+#ifndef _VIEW_HELIXBVH_H_
+#define _VIEW_HELIXBVH_H_
+
+#include <Definition.h>
+#include <Utility.h>
+
+#include <view/BVH.h>
+
+#include <maya/MBoundingBox.h>
+#include <maya/MCallbackIdArray.h>
+#include <maya/MDagPath.h>
+#include <maya/MMessage.h>
+#include <maya/MNodeMessage.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MPlug.h>
+#include <maya/MTime.h>
+
+#include <vector>
+
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_map>
+#include <unordered_set>
+#else
+#include <tr1/unordered_map>
+#include <tr1/unordered_set>
+#endif /* N Windows */
+
+/*
+ * Added to the cylinder radius, as the bases stick out a little and might have been moved slightly outside the cylinder range.
+ */
+#define HELIXBVH_MARGIN 0.5
+
+/*
+ * HelixBVH: The world space bounding volumes of all helices in the scene, obtained from their cylinder range and radius.
+ *
+ * The volumes are only recalculated when callbacks report that a helix or a group above it was transformed or its cylinder range
+ * changed, and the hierarchy is rebuilt from them before the next query. Helices are found with a single MItDag scan whenever helices
+ * were created or deleted.
+ *
+ * HelixLOD culls the helices against the camera frustum once per frame, helices outside of it are neither drawn as bases
+ * nor as cylinders.
+ */
+
+namespace Helix {
+	namespace View {
+		class HelixBVH {
+		public:
+			/*
+			 * Marks the helices inside the frustum as visible.
+			 */
+
+			static void cull(const Frustum & frustum);
+
+			/*
+			 * Whether the helix was inside the frustum of the last cull. Helices the BVH doesn't know about are considered visible.
+			 */
+
+			static bool isVisible(const MObject & helix);
+
+			/*
+			 * Removes all callbacks and volumes. Called when unloading the plugin.
+			 */
+
+			static void release();
+
+		private:
+			struct Entry {
+				MObjectHandle helix;
+				MDagPath path;
+				MBoundingBox box;
+				MCallbackId callbacks[2];
+				unsigned int frame;
+				bool dirty;
+			};
+
+#if defined(WIN32) || defined(WIN64)
+			typedef std::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash> index_map_t;
+			typedef std::unordered_set<MObjectHandle, ObjectHandleHash> handle_set_t;
+#else
+			typedef std::tr1::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash> index_map_t;
+			typedef std::tr1::unordered_set<MObjectHandle, ObjectHandleHash> handle_set_t;
+#endif /* N Windows */
+
+			/*
+			 * Scans the scene for helices and registers callbacks on them. Rebuilds the hierarchy if any volume changed.
+			 */
+
+			static void rescan();
+			static void update();
+			static void clear();
+			static MStatus calculateBox(Entry & entry);
+			static void markDirty(void *clientData);
+
+			static void MNodeMessage_helix_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData);
+			static void MNodeMessage_shape_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData);
+			static void MNodeMessage_ancestor_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData);
+			static void MDGMessage_helixAddedRemoved(MObject & node, void *clientData);
+			static void MDagMessage_parentAdded(MDagPath & child, MDagPath & parent, void *clientData);
+			static void MDGMessage_timeChange(MTime & time, void *clientData);
+			static void MSceneMessage_beforeNewOpen(void *clientData);
+
+			/*
+			 * The entries are indexed by the MObjectHandle of the helix. The BVH is built from the entry boxes in the same order.
+			 * The callbacks of an entry get its index, which doesn't change until clear removes them.
+			 * s_frame is increased by every cull, visible entries get the current frame.
+			 */
+
+			static std::vector<Entry> s_entries;
+			static index_map_t s_indices;
+			static BVH s_bvh;
+			static MCallbackIdArray s_globalCallbacks, s_ancestorCallbacks;
+			static unsigned int s_frame;
+			static bool s_rescan, s_dirty, s_culled;
+		};
+	}
+}
+
+#endif /* N _VIEW_HELIXBVH_H_ */
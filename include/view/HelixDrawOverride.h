@@ -0,0 +1,57 @@
+#ifndef _VIEW_HELIXDRAWOVERRIDE_H_
+#define _VIEW_HELIXDRAWOVERRIDE_H_
+
+#include <view/BaseDrawOverride.h>
+
+#ifdef HELIX_VIEWPORT2
+
+#include <view/HelixLOD.h>
+
+#include <maya/MColor.h>
+
+#define HELIX_SHAPE_DRAW_CLASSIFICATION "drawdb/geometry/helixShape"
+#define HELIX_SHAPE_DRAW_REGISTRANT_ID "helixShapeDrawOverride"
+
+/*
+ * HelixDrawOverride: Draws the cylinders of the helices in Viewport 2.0. The level of detail and border color are evaluated in prepareForDraw
+ * just like HelixShapeUI::getDrawRequests does, and the draw callback draws the cylinder with the shaders and texture of the HelixShapeUI.
+ * Selection is still done by HelixShapeUI::select.
+ */
+
+namespace Helix {
+	namespace View {
+		class HelixShapeUI;
+
+		class HelixDrawOverride : public MHWRender::MPxDrawOverride {
+		public:
+			static MHWRender::MPxDrawOverride *creator(const MObject & obj);
+
+			virtual ~HelixDrawOverride();
+
+			virtual MHWRender::DrawAPI supportedDrawAPIs() const;
+
+			virtual bool isBounded(const MDagPath & objPath, const MDagPath & cameraPath) const;
+			virtual MBoundingBox boundingBox(const MDagPath & objPath, const MDagPath & cameraPath) const;
+
+			virtual MUserData *prepareForDraw(const MDagPath & objPath, const MDagPath & cameraPath, const MHWRender::MFrameContext & frameContext, MUserData *oldData);
+
+			static void draw(const MHWRender::MDrawContext & context, const MUserData *data);
+
+		private:
+			HelixDrawOverride(const MObject & obj);
+
+			class Data : public MUserData {
+			public:
+				inline Data() : MUserData(false), ui(NULL), level(HelixLOD::kCulled) {}
+
+				const HelixShapeUI *ui;
+				HelixLOD::Level level;
+				MColor color;
+			};
+		};
+	}
+}
+
+#endif /* N HELIX_VIEWPORT2 */
+
+#endif /* N _VIEW_HELIXDRAWOVERRIDE_H_ */
@@ -0,0 +1,107 @@
+#ifndef _VIEW_HELIXLOD_H_
+#define _VIEW_HELIXLOD_H_
+
+#include <Definition.h>
+#include <Utility.h>
+
+#include <maya/M3dView.h>
+#include <maya/MDagPath.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MPoint.h>
+#include <maya/MTimer.h>
+
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif /* N Windows */
+
+/*
+ * Thresholds in pixels per unit of the projected bounding box of a helix. Above the first, the bases are drawn,
+ * above the second the cylinder and below it only the bounding box.
+ */
+#define HELIXLOD_BASES_PIXELS_PER_UNIT 8.0
+#define HELIXLOD_CYLINDER_PIXELS_PER_UNIT 0.75
+
+/*
+ * Time in seconds a frame may spend on drawing the helices. When exceeded, the thresholds above are scaled up,
+ * lowering the level of detail of the whole scene until the frames are fast enough again.
+ */
+#define HELIXLOD_FRAME_BUDGET (1.0 / 30.0)
+#define HELIXLOD_MAX_SCALE 64.0
+
+/*
+ * HelixLOD: Decides the level of detail of every helix when ToggleCylinderBaseView is in the automatic view.
+ *
+ * Nearby helices show their bases, helices further away the textured cylinder of HelixShapeUI and distant ones only a box.
+ * The level is evaluated once per helix and frame, both BaseRenderer and HelixShapeUI ask for it in their draw requests.
+ * The first request after something was drawn starts a new frame, and the time from there to the last draw is the frame time.
+ * The size of a helix is approximated by the distance from the camera to its bounding box.
+ * Nothing is changed in the DAG, the shapes simply skip drawing when the level of their helix is not theirs.
+ *
+ * The first request of a frame also culls all helices against the camera frustum using the HelixBVH, in all views.
+ * A request from a view with another camera also starts a new frame, so that every pane is culled against its own camera.
+ */
+
+namespace Helix {
+	namespace View {
+		class HelixLOD {
+		public:
+			enum Level {
+				kBases = 0,
+				kCylinder = 1,
+				kBox = 2,
+				kCulled = 3
+			};
+
+			/*
+			 * Whether the automatic view is active, otherwise the shapes are shown or hidden by ToggleCylinderBaseView.
+			 */
+
+			static bool isAutomatic();
+
+			/*
+			 * Level of detail of the helix at helixPath in the current frame. Helices outside the view are kCulled in every view,
+			 * when not in the automatic view the others are kBases or kCylinder as set by ToggleCylinderBaseView.
+			 */
+
+			static Level level(const MDagPath & helixPath, M3dView & view);
+
+			/*
+			 * The level the helix was last drawn at without starting a new frame, used for selection. kBases if never evaluated.
+			 */
+
+			static Level lastLevel(const MDagPath & helixPath);
+
+			/*
+			 * Called by the renderers when they finished drawing.
+			 */
+
+			static void drawn();
+
+		private:
+			/*
+			 * Culls the helices and obtains the camera of the view, the pixels per unit at a distance of one unit or everywhere
+			 * for orthographic cameras.
+			 */
+
+			static void beginFrame(M3dView & view);
+			static Level evaluate(const MDagPath & helixPath);
+
+#if defined(WIN32) || defined(WIN64)
+			typedef std::unordered_map<MObjectHandle, Level, ObjectHandleHash> level_map_t;
+#else
+			typedef std::tr1::unordered_map<MObjectHandle, Level, ObjectHandleHash> level_map_t;
+#endif /* N Windows */
+
+			static level_map_t s_levels;
+			static MTimer s_timer;
+			static MPoint s_eye;
+			static MDagPath s_camera;
+			static double s_scale, s_pixelsPerUnit;
+			static bool s_drawn, s_timing, s_orthographic;
+		};
+	}
+}
+
+#endif /* N _VIEW_HELIXLOD_H_ */
@@ -0,0 +1,52 @@
+#ifndef _VIEW_HELIXLOCATORDRAWOVERRIDE_H_
+#define _VIEW_HELIXLOCATORDRAWOVERRIDE_H_
+
+#include <view/BaseDrawOverride.h>
+
+#ifdef HELIX_VIEWPORT2
+
+#define HELIX_LOCATOR_DRAW_CLASSIFICATION "drawdb/geometry/helixLocator"
+#define HELIX_LOCATOR_DRAW_REGISTRANT_ID "helixLocatorDrawOverride"
+
+/*
+ * HelixLocatorDrawOverride: Draws the halos, sequence labels and direction arrow of a HelixLocator in Viewport 2.0.
+ * prepareForDraw updates the buckets and render buffers through HelixLocator::prepareDraw, and the draw callback
+ * issues the same OpenGL calls as the legacy viewport through HelixLocator::drawGL.
+ */
+
+namespace Helix {
+	class HelixLocator;
+
+	namespace View {
+		class HelixLocatorDrawOverride : public MHWRender::MPxDrawOverride {
+		public:
+			static MHWRender::MPxDrawOverride *creator(const MObject & obj);
+
+			virtual ~HelixLocatorDrawOverride();
+
+			virtual MHWRender::DrawAPI supportedDrawAPIs() const;
+
+			virtual bool isBounded(const MDagPath & objPath, const MDagPath & cameraPath) const;
+			virtual MBoundingBox boundingBox(const MDagPath & objPath, const MDagPath & cameraPath) const;
+
+			virtual MUserData *prepareForDraw(const MDagPath & objPath, const MDagPath & cameraPath, const MHWRender::MFrameContext & frameContext, MUserData *oldData);
+
+			static void draw(const MHWRender::MDrawContext & context, const MUserData *data);
+
+		private:
+			HelixLocatorDrawOverride(const MObject & obj);
+
+			class Data : public MUserData {
+			public:
+				inline Data() : MUserData(false), locator(NULL), isOrtho(false) {}
+
+				HelixLocator *locator;
+				bool isOrtho;
+			};
+		};
+	}
+}
+
+#endif /* N HELIX_VIEWPORT2 */
+
+#endif /* N _VIEW_HELIXLOCATORDRAWOVERRIDE_H_ */
@@ -6,6 +6,17 @@
 #include <iostream>
 
 #include <maya/MPxSurfaceShapeUI.h>
+#include <maya/MCallbackIdArray.h>
+#include <maya/MColor.h>
+#include <maya/MDagPath.h>
+#include <maya/MMessage.h>
+#include <maya/MNodeMessage.h>
+#include <maya/MPlug.h>
+#include <maya/MTime.h>
+
+#include <model/Helix.h>
+#include <view/BVH.h>
+#include <view/HelixLOD.h>
 
 #ifdef MAC_PLUGIN
 
@@ -81,6 +92,18 @@ namespace Helix {
 
 			static void *creator();
 
+			/*
+			 * Draws the cylinder, or its box, with the current OpenGL state and matrices. Used both by draw and by HelixDrawOverride in Viewport 2.0.
+			 */
+
+			void drawCylinder(HelixLOD::Level level, const MColor & color) const;
+
+			/*
+			 * The color of the border of the cylinder, from the display status of the helix.
+			 */
+
+			static MColor borderColor(M3dView & view, M3dView::DisplayStatus displayStatus);
+
 			/*
 			 * Initialize OpenGL, done statically as the program and models are shared between all helices
 			 */
@@ -88,6 +111,30 @@ namespace Helix {
 			static void initializeDraw();
 			void initializeLocalDraw();
 
+		private:
+			/*
+			 * Registers callbacks on the bases of the helix that mark the texture as dirty when they're moved or change material
+			 */
+
+			MStatus registerCallbacks(Model::Helix & helix);
+
+			/*
+			 * Collect color data from our bases and paint our texture
+			 */
+
+			MStatus updateTexture(Model::Helix & helix, double origo, double height);
+
+			/*
+			 * Intersects a ray in the space of the helix with its cylinder, used for selection
+			 */
+
+			static bool intersectCylinder(const Ray & ray, double origo, double height, double & distance);
+
+			static void MNodeMessage_base_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData);
+			static void MNodeMessage_shape_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData);
+			static void MDagMessage_childAddedRemoved(MDagPath & child, MDagPath & parent, void *clientData);
+			static void MDGMessage_timeChange(MTime & time, void *clientData);
+
 		protected:
 
 			/*
@@ -126,17 +173,23 @@ namespace Helix {
 
 			/*
 			 * OpenGL data unique for the helix
+			 * The texture is only rebuilt when it is marked dirty by the callbacks registered on the bases,
+			 * when a child was added to or removed from the helix or when the cylinder range changed.
 			 */
 
 			struct DrawData_Local {
 				GLuint texture;
 				GLsizei texture_height; // If the number of bases change, we have to resize the texture
 
-				bool initialized, failure;
+				bool initialized, failure, dirty;
+				bool childrenChanged; // The callbacks must be registered again
 				GLfloat *last_colors;
 
-				DrawData_Local() : texture(0), texture_height(0), initialized(false), failure(false), last_colors(NULL) { }
-				~DrawData_Local() { if (last_colors) delete[] last_colors; }
+				double origo, height; // The cylinder range the texture was built for
+				MCallbackIdArray callbacks;
+
+				DrawData_Local() : texture(0), texture_height(0), initialized(false), failure(false), dirty(true), childrenChanged(true), last_colors(NULL), origo(0.0), height(0.0) { }
+				~DrawData_Local() { if (last_colors) delete[] last_colors; if (callbacks.length() > 0) MMessage::removeCallbacks(callbacks); }
 			} m_drawData;
 		};
 	}
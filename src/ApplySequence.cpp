@@ -13,6 +13,8 @@
 #include <model/Helix.h>
 #include <model/Strand.h>
 
+#include <controller/FileReader.h>
+
 #include <maya/MSyntax.h>
 #include <maya/MArgDatabase.h>
 #include <maya/MSelectionList.h>
@@ -22,6 +24,10 @@
 #include <maya/MObjectArray.h>
 #include <maya/MGlobal.h>
 
+#include <cctype>
+#include <string>
+#include <vector>
+
 namespace Helix {
 	ApplySequence::ApplySequence() {
 
@@ -31,11 +37,56 @@ namespace Helix {
 
 	}
 
+	/*
+	 * Reads a multi-FASTA file. The first word of every header is kept as the name of the record.
+	 */
+	MStatus ApplySequence_readFasta(const char *filename, std::vector< std::pair<std::string, std::string> > & records) {
+		MStatus status;
+		std::vector<char> buffer;
+		HMEVALUATE_RETURN(status = Controller::FileReader_read(filename, buffer), status);
+
+		char *it = &buffer[0], *end = &buffer[0] + buffer.size() - 1, *line;
+
+		while ((line = Controller::FileReader_nextLine(it, end))) {
+			if (*line == '>') {
+				++line;
+				const char *name = Controller::FileReader_token(line);
+				records.push_back(std::make_pair(std::string(name ? name : ""), std::string()));
+			}
+			else if (*line != ';' && !records.empty()) {
+				std::string & sequence(records.back().second);
+
+				for (; *line != '\0'; ++line) {
+					if (!isspace(*line))
+						sequence += *line;
+				}
+			}
+		}
+
+		return MStatus::kSuccess;
+	}
+
+	MStatus ApplySequence_getBase(const MString & name, Model::Base & base) {
+		MStatus status;
+		MSelectionList selectionList;
+		MDagPath dagPath;
+		MObject object;
+
+		if (!(status = selectionList.add(name)) || !(status = selectionList.getDagPath(0, dagPath, object))) {
+			MGlobal::displayError(MString("Can't find the base \"") + name + "\"");
+			return MStatus::kNotFound;
+		}
+
+		base = dagPath;
+
+		return MStatus::kSuccess;
+	}
+
 	MStatus ApplySequence::doIt(const MArgList & args) {
 		MStatus status;
 		MArgDatabase argDatabase(syntax(), args, &status);
-		Model::Base target;
-		MString sequence;
+		std::vector<Model::Base> targets;
+		MString sequence, filename;
 
 		if (!status) {
 			status.perror("MArgDatabase::#ctor");
@@ -43,33 +94,33 @@ namespace Helix {
 		}
 
 		if (argDatabase.isFlagSet("-t")) {
-			MString targetName;
+			const unsigned int numTargets = argDatabase.numberOfFlagUses("-t");
 
-			if (!(status = argDatabase.getFlagArgument("-t", 0, targetName))) {
-				status.perror("MArgDatabase::getFlagArgument");
-				return status;
-			}
+			for (unsigned int i = 0; i < numTargets; ++i) {
+				MArgList targetArgs;
+				MString targetName;
+				Model::Base target;
 
-			MSelectionList selectionList;
+				HMEVALUATE_RETURN(status = argDatabase.getFlagArgumentList("-t", i, targetArgs), status);
+				HMEVALUATE_RETURN(targetName = targetArgs.asString(0, &status), status);
+				HMEVALUATE_RETURN(status = ApplySequence_getBase(targetName, target), status);
 
-			if (!(status = selectionList.add(targetName))) {
-				status.perror("ApplySequence::doIt: MSelectionList::add");
-				return status;
+				targets.push_back(target);
 			}
+		}
 
-			MObject target_object;
-
-			MDagPath target_dagPath;
-			
-			if (!(status = selectionList.getDagPath(0, target_dagPath, target_object))) {
-				status.perror("MSelectionList::getDagPath");
+		if (argDatabase.isFlagSet("-s", &status)) {
+			if (!(status = argDatabase.getFlagArgument("-s", 0, sequence))) {
+				status.perror("MArgDatabase::getFlagArgument");
 				return status;
 			}
-
-			target = target_dagPath;
 		}
-		else {
-			// Find argument by select
+
+		if (argDatabase.isFlagSet("-f"))
+			HMEVALUATE_RETURN(status = argDatabase.getFlagArgument("-f", 0, filename), status);
+
+		if (targets.empty() && (filename.length() == 0 || sequence.length() > 0)) {
+			// Find targets by select
 			//
 
 			MObjectArray selectedBases;
@@ -83,43 +134,50 @@ namespace Helix {
 				MGlobal::displayError("No bases to apply the sequence to");
 				return MStatus::kFailure;
 			}
-			else if (selectedBases.length() > 1) {
-				MGlobal::displayError("Too many bases to apply sequences to, select one base only");
+
+			for (unsigned int i = 0; i < selectedBases.length(); ++i)
+				targets.push_back(Model::Base(selectedBases[i]));
+		}
+
+		if (filename.length() > 0) {
+			/*
+			 * Records are applied to the given targets in order. Without targets, the first word of every header names the base to start at.
+			 */
+
+			std::vector< std::pair<std::string, std::string> > records;
+			HMEVALUATE_RETURN(status = ApplySequence_readFasta(filename.asChar(), records), status);
+
+			if (!targets.empty() && records.size() != targets.size()) {
+				MGlobal::displayError(MString("The FASTA file contains ") + (int) records.size() + " sequences but " + (int) targets.size() + " targets were given");
 				return MStatus::kFailure;
 			}
-			else {
-				MFnDagNode dagNode(selectedBases[0]);
-				MDagPath target_dagPath;
 
-				if (!(status = dagNode.getPath(target_dagPath))) {
-					status.perror("MFnDagNode::getPath");
-					return status;
+			for (size_t i = 0; i < records.size(); ++i) {
+				Model::Base target;
+
+				if (targets.empty()) {
+					HMEVALUATE_RETURN(status = ApplySequence_getBase(records[i].first.c_str(), target), status);
 				}
+				else
+					target = targets[i];
 
-				target = target_dagPath;
+				Model::Strand strand(target);
+				HMEVALUATE_RETURN(status = m_operation.add(strand, records[i].second.c_str(), records[i].second.size()), status);
 			}
 		}
-
-		// Load the sequence
-
-		if (argDatabase.isFlagSet("-s", &status)) {
-			if (!(status = argDatabase.getFlagArgument("-s", 0, sequence))) {
-				status.perror("MArgDatabase::getFlagArgument");
-				return status;
+		else {
+			if (sequence.length() == 0) {
+				MGlobal::displayError("No valid DNA sequence given");
+				return MStatus::kFailure;
 			}
-		}
 
-		if (sequence.length() == 0) {
-			MGlobal::displayError("No valid DNA sequence given");
-			return MStatus::kFailure;
+			for (std::vector<Model::Base>::iterator it = targets.begin(); it != targets.end(); ++it) {
+				Model::Strand strand(*it);
+				HMEVALUATE_RETURN(status = m_operation.add(strand, sequence.asChar(), sequence.length()), status);
+			}
 		}
 
-		m_operation.setSequence(sequence);
-
-		Model::Strand strand(target);
-		std::for_each(strand.forward_begin(), strand.forward_end(), m_operation.execute());
-
-		return m_operation.status();
+		return m_operation.apply();
 	}
 
 	MStatus ApplySequence::undoIt () {
@@ -142,7 +200,9 @@ namespace Helix {
 		MSyntax syntax;
 
 		syntax.addFlag("-t", "-target", MSyntax::kString);
+		syntax.makeFlagMultiUse("-t");
 		syntax.addFlag("-s", "-sequence", MSyntax::kString);
+		syntax.addFlag("-f", "-fasta", MSyntax::kString);
 
 		return syntax;
 	}
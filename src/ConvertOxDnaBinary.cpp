@@ -0,0 +1,92 @@
+#include <ConvertOxDnaBinary.h>
+
+#include <Utility.h>
+
+#include <controller/OxDnaBinaryConverter.h>
+#include <controller/OxDnaExporter.h>
+
+#include <maya/MArgDatabase.h>
+#include <maya/MCommandResult.h>
+#include <maya/MGlobal.h>
+#include <maya/MStringArray.h>
+#include <maya/MSyntax.h>
+
+#include <cstring>
+#include <fstream>
+
+namespace Helix {
+	/*
+	 * Replaces the extension of the binary file with the given one.
+	 */
+	MString ConvertOxDnaBinary_filename(const MString & filename, const char *extension) {
+		const int index = filename.rindexW('.');
+		return MString(filename.asChar(), index != -1 ? index : filename.length()) + "." + extension;
+	}
+
+	MStatus ConvertOxDnaBinary::doIt(const MArgList & args) {
+		MStatus status;
+		MArgDatabase argDatabase(syntax(), args, &status);
+		HMEVALUATE_RETURN_DESCRIPTION("MArgDatabase::#ctor", status);
+
+		MString topology_filename, configuration_filename;
+
+		if (argDatabase.isFlagSet("-t"))
+			HMEVALUATE_RETURN(status = argDatabase.getFlagArgument("-t", 0, topology_filename), status);
+
+		if (argDatabase.isFlagSet("-c"))
+			HMEVALUATE_RETURN(status = argDatabase.getFlagArgument("-c", 0, configuration_filename), status);
+
+		if (topology_filename.length() == 0 && configuration_filename.length() == 0) {
+			MCommandResult commandResult;
+			MStringArray result;
+
+			HMEVALUATE_RETURN(status = MGlobal::executeCommand("fileDialog2 -caption \"Convert binary oxDNA files\" -fileFilter \"Binary oxDNA topology (*." HELIX_OXDNA_BINARY_TOP_FILE_TYPE ");;All files (*.*)\" -fileMode 1", commandResult), status);
+			HMEVALUATE_RETURN(status = commandResult.getResult(result), status);
+
+			if (result.length() < 1) {
+				/*
+				 * User cancelled the operation
+				 */
+
+				return MStatus::kSuccess;
+			}
+
+			topology_filename = result[0];
+
+			const MString filename(ConvertOxDnaBinary_filename(topology_filename, HELIX_OXDNA_BINARY_CONF_FILE_TYPE));
+			if (std::ifstream(filename.asChar()))
+				configuration_filename = filename;
+		}
+
+		Controller::OxDnaBinaryConverter converter;
+
+		if (topology_filename.length() > 0)
+			HMEVALUATE_RETURN(status = converter.convertTopology(topology_filename.asChar(), ConvertOxDnaBinary_filename(topology_filename, HELIX_OXDNA_TOP_FILE_TYPE).asChar()), status);
+
+		if (configuration_filename.length() > 0)
+			HMEVALUATE_RETURN(status = converter.convertConfiguration(configuration_filename.asChar(), ConvertOxDnaBinary_filename(configuration_filename, HELIX_OXDNA_CONF_FILE_TYPE).asChar()), status);
+
+		return MStatus::kSuccess;
+	}
+
+	bool ConvertOxDnaBinary::isUndoable () const {
+		return false;
+	}
+
+	bool ConvertOxDnaBinary::hasSyntax () const {
+		return true;
+	}
+
+	MSyntax ConvertOxDnaBinary::newSyntax () {
+		MSyntax syntax;
+
+		syntax.addFlag("-t", "-topology", MSyntax::kString);
+		syntax.addFlag("-c", "-configuration", MSyntax::kString);
+
+		return syntax;
+	}
+
+	void *ConvertOxDnaBinary::creator() {
+		return new ConvertOxDnaBinary();
+	}
+}
@@ -14,8 +14,10 @@
 #include <Locator.h>
 #include <Utility.h>
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
+#include <vector>
 
 #include <maya/MSyntax.h>
 #include <maya/MArgDatabase.h>
@@ -32,7 +34,7 @@
 #include <maya/MPlane.h>
 
 namespace Helix {
-	Creator::Creator() : m_redoMode(CREATE_NONE) {
+	Creator::Creator() : m_redoMode(CREATE_NONE), m_bundleMaterialsUsed(0) {
 
 	}
 
@@ -50,194 +52,246 @@ namespace Helix {
 
 	int Creator::default_bases = DNA::CREATE_DEFAULT_NUM_BASES;
 
-	//MStatus Creator::createHelix(int bases, double rotation, const MVector & origo, Model::Helix & helix, const CreateBaseControl & control) {
-	MStatus Creator::createHelix(int bases, Model::Helix & helix, const MTransformationMatrix & transform, const CreateBaseControl & control, const MString & name, bool showProgressBar) {
-		default_bases = bases;
+	/*
+	 * The positions of the bases only depend on their index along the helix except for the z coordinate that is centered around origo.
+	 * Calculated once per index for all helices created, with totalNumBases = 0. Grows the table to at least bases base pairs.
+	 */
 
-		MStatus status;
+	MStatus Creator_basePairTable(int bases, std::vector<MVector> & table) {
+		const int first = int(table.size() / 2);
 
-		// Setup the progress window
-		//
-		if (showProgressBar) {
-			if (!MProgressWindow::reserve())
-				MGlobal::displayWarning("Failed to reserve the progress window");
+		if (bases > first) {
+			table.resize(size_t(bases) * 2);
+			DNA::CalculateBasePairPositions(first, bases - first, &table[first * 2], 0.0, 0.0);
+		}
 
-			MProgressWindow::setTitle("Create new helix");
-			MProgressWindow::setProgressStatus("Generating new helix bases...");
-			MProgressWindow::setProgressRange(0, bases * 2);
-			MProgressWindow::startProgress();
+		return MStatus::kSuccess;
+	}
+
+	/*
+	 * Pick two materials by random, not the same ones twice unless there's only one.
+	 */
+
+	void Creator_pickMaterials(Model::Material::Iterator materials_begin, Model::Material::Container::size_type numMaterials, Model::Material *materials) {
+		for(int i = 0; i < 2; ++i)
+			materials[i] = Model::Material();
+
+		if (numMaterials == 1) {
+			for(int i = 0; i < 2; ++i)
+				materials[i] = *materials_begin;
 		}
+		else if(numMaterials >= 2) {
+			int indices[] = { rand() % (int) numMaterials, 0 };
+			do { indices[1] = rand() % (int) numMaterials; } while (indices[0] == indices[1]);
+
+			for(int i = 0; i < 2; ++i)
+				materials[i] = *(materials_begin + indices[i]);
+		}
+	}
+
+	MStatus Creator::addHelix(Model::BaseBatch & batch, int bases, const std::vector<MVector> & table, const MTransformationMatrix & transform, const CreateBaseControl & control, const MString & name, const Model::Material *materials, Model::Helix & helix) {
+		MStatus status;
 
 		/*
-		 * Create the helix
+		 * Create the helix, rotated and translated
 		 */
 
-		if (!(status = Model::Helix::Create(name, MTransformationMatrix::identity, helix))) {
+		if (!(status = Model::Helix::Create(name, transform, helix))) {
 			status.perror("Helix::Create");
 			return status;
 		}
 
 		/*
-		 * If control requires world coordinates, we require the world matrix for the newly created helix
-		 * Obtained below
+		 * If control requires shared coordinates, we require the matrix for the newly created helix
 		 */
 
-		MMatrix helix_matrix;
+		const bool sharedCoordinates = control.generateSharedCoordinates();
+		const MMatrix helix_matrix(sharedCoordinates ? transform.asMatrix() : MMatrix::identity);
+		const double z_offset = -bases * DNA::STEP / 2;
 
 		/*
-		 * Rotate and translate the helix
+		 * Queue the bases, last holds the batch indices of the previous bases or -1 if they were not created
 		 */
 
-		{
-			MFnTransform helix_transform(helix.getDagPath(status));
+		int last[] = { -1, -1 };
 
-			if (!status) {
-				status.perror("Helix::getDagPath");
-				return status;
-			}
+		for(int i = 0; i < bases; ++i) {
+			int current[2];
 
-			if (!(status = helix_transform.set(transform))) {
-				status.perror("MFnTransform::set");
-				return status;
+			for(int j = 0; j < 2; ++j) {
+				MVector basePosition(table[i * 2 + j]);
+				basePosition.z += z_offset;
+
+				if (control(sharedCoordinates ? (helix_matrix * basePosition) : basePosition, i, j == 0))
+					current[j] = int(batch.add(helix, MString(DNA::GetStrandName(j)) + "_" + (i + 1), basePosition, materials[j]));
+				else
+					current[j] = -1;
 			}
 
-			if (control.generateSharedCoordinates()) {
-				std::cerr << "Setting up matrix for shared coordinates" << std::endl;
+			/*
+			 * Now connect them, and the previous bases to the newly created ones
+			 */
 
-				helix_matrix = helix_transform.transformationMatrix(&status);
+			if (current[0] != -1 && current[1] != -1)
+				batch.connect_opposite(current[0], current[1]);
 
-				if (!status) {
-					status.perror("MFnTransform::transformationMatrix");
-					return status;
-				}
+			if (last[0] != -1 && current[0] != -1)
+				batch.connect_forward(last[0], current[0]);
 
+			if (last[1] != -1 && current[1] != -1)
+				batch.connect_forward(current[1], last[1]);
 
-			}
+			for(int j = 0; j < 2; ++j)
+				last[j] = current[j];
 		}
 
 		/*
-		 * Add the bases
+		 * Setup cylinder
 		 */
 
-		MVector basePositions[2];
-		Model::Base base_objects[2], last_base_objects[2];
+		if (!(status = helix.setCylinderRange(0.0, DNA::STEP * (bases - 1))))
+			status.perror("Helix::setCylinderRange");
 
-		for(int i = 0; i < bases; ++i) {
-			/*
-			 * Get the positions for the bases from DNA.h
-			 */
+		return MStatus::kSuccess;
+	}
 
-			if (!(status = DNA::CalculateBasePairPositions(double(i), basePositions[0], basePositions[1], 0.0, bases))) {
-				status.perror("DNA::CalculateBasePairPositions");
-				return status;
-			}
+	MStatus Creator::createHelix(int bases, Model::Helix & helix, const MTransformationMatrix & transform, const CreateBaseControl & control, const MString & name, bool showProgressBar) {
+		default_bases = bases;
 
-			/*
-			 * Now create the two base pairs
-			 */
+		MStatus status;
 
-			bool created[2];
+		// Setup the progress window
+		//
+		if (showProgressBar) {
+			if (!MProgressWindow::reserve())
+				MGlobal::displayWarning("Failed to reserve the progress window");
 
-			for(int j = 0; j < 2; ++j) {
-				MString strand(DNA::GetStrandName(j));
+			MProgressWindow::setTitle("Create new helix");
+			MProgressWindow::setProgressStatus("Generating new helix bases...");
+			MProgressWindow::setProgressRange(0, 1);
+			MProgressWindow::startProgress();
+		}
 
-				created[j] = control(control.generateSharedCoordinates() ? (helix_matrix * basePositions[j]) : basePositions[j], i, j == 0);
+		std::vector<MVector> table;
+		HMEVALUATE_RETURN(status = Creator_basePairTable(bases, table), status);
 
-				if (created[j]) {
-					if (!(status = Model::Base::Create(helix, strand + "_" + (i + 1), basePositions[j], base_objects[j]))) {
-						status.perror("Base::Create");
-						return status;
-					}
+		Model::BaseBatch batch;
+		batch.reserve(size_t(bases) * 2);
 
-					if (!(status = base_objects[j].setMaterial(m_materials[j]))) {
-						status.perror("Base::setMaterial");
-						return status;
-					}
-				}
-				else
-					base_objects[j] = MObject::kNullObj;
+		HMEVALUATE_RETURN(status = addHelix(batch, bases, table, transform, control, name, m_materials, helix), status);
+		HMEVALUATE_RETURN(status = batch.create(), status);
 
-				if (showProgressBar)
-					MProgressWindow::advanceProgress(1);
-			}
+		if (showProgressBar) {
+			MProgressWindow::advanceProgress(1);
+			MProgressWindow::endProgress();
+		}
 
-			/*
-			 * Now connect them
-			 */
+		/*
+		 * Select the newly created Helix
+		 */
 
-			if (created[0] && created[1]) {
-				if (!(status = base_objects[0].connect_opposite(base_objects[1], true))) {
-					status.perror("Base::connect_opposite");
-					return status;
-				}
-			}
+		if (!(status = Model::Object::Select(&helix, &helix + 1)))
+			status.perror("Object::Select");
 
-			/*
-			 * Now connect the previous bases to the newly created ones
-			 */
+		m_helices.push_back(helix);
 
-			if (last_base_objects[0] && created[0]) {
-				if (!(status = last_base_objects[0].connect_forward (base_objects[0], true))) {
-					status.perror("Base::connect_forward 0");
-					return status;
-				}
-			}
+		return MStatus::kSuccess;
+	}
 
-			if (last_base_objects[1] && created[1]) {
-				if (!(status = base_objects[1].connect_forward (last_base_objects[1], true))) {
-					status.perror("Base::connect_forward 1");
-					return status;
-				}
-			}
+	MStatus Creator::createHelixBundle(const std::vector<MTransformationMatrix> & transforms, const std::vector<int> & bases, std::vector<Model::Helix> & helices, const MString & name, bool showProgressBar) {
+		MStatus status;
 
-			for(int j = 0; j < 2; ++j)
-				last_base_objects[j] = base_objects[j];
+		if (bases.size() != transforms.size()) {
+			MGlobal::displayError(MString("Got ") + int(bases.size()) + " base counts for " + int(transforms.size()) + " helices");
+			return MStatus::kInvalidParameter;
 		}
 
-		/*
-		 * Setup cylinder
-		 */
+		if (showProgressBar) {
+			if (!MProgressWindow::reserve())
+				MGlobal::displayWarning("Failed to reserve the progress window");
 
-		if (!(status = helix.setCylinderRange(0.0, DNA::STEP * (bases - 1))))
-			status.perror("Helix::setCylinderRange");
+			MProgressWindow::setTitle("Create new helices");
+			MProgressWindow::setProgressStatus("Generating new helices...");
+			MProgressWindow::setProgressRange(0, 1);
+			MProgressWindow::startProgress();
+		}
 
 		/*
-		 * Refresh cylinder/base view
+		 * The positions are shared between all helices, and the materials are only queried once.
 		 */
 
-		/*if (!(status = Model::Helix::RefreshCylinderOrBases()))
-			status.perror("Helix::RefreshCylinderOrBases");*/
+		size_t numBases = 0;
+		int maxBases = 0;
 
-		if (showProgressBar)
-			MProgressWindow::endProgress();
+		for (std::vector<int>::const_iterator it = bases.begin(); it != bases.end(); ++it) {
+			if (*it > 0) {
+				numBases += size_t(*it) * 2;
+				maxBases = std::max(maxBases, *it);
+			}
+		}
 
-		/*
-		 * Select the newly created Helix
-		 */
+		std::vector<MVector> table;
+		HMEVALUATE_RETURN(status = Creator_basePairTable(maxBases, table), status);
 
-		if (!(status = Model::Object::Select(&helix, &helix + 1)))
-			status.perror("Object::Select");
+		Model::Material::Container::size_type numMaterials;
+		Model::Material::Iterator materials_begin;
+		HMEVALUATE_RETURN(materials_begin = Model::Material::AllMaterials_begin(status, numMaterials), status);
 
-		m_helices.push_back(helix);
+		Model::BaseBatch batch;
+		batch.reserve(numBases);
+
+		const size_t first = helices.size();
+		helices.reserve(first + transforms.size());
+
+		for (size_t i = 0; i < transforms.size(); ++i) {
+			if (bases[i] <= 0) {
+				MGlobal::displayWarning(MString("Ignoring request to create helix with ") + bases[i] + " bases");
+				continue;
+			}
+
+			/*
+			 * A redo gets the same colors as the original creation
+			 */
+
+			if (m_bundleMaterialsUsed + 2 > m_bundleMaterials.size()) {
+				Model::Material materials[2];
+				Creator_pickMaterials(materials_begin, numMaterials, materials);
+				m_bundleMaterials.insert(m_bundleMaterials.end(), materials, materials + 2);
+			}
+
+			const Model::Material *materials = &m_bundleMaterials[m_bundleMaterialsUsed];
+			m_bundleMaterialsUsed += 2;
+
+			Model::Helix helix;
+			HMEVALUATE_RETURN(status = addHelix(batch, bases[i], table, transforms[i], CreateBaseControl(), name, materials, helix), status);
+
+			helices.push_back(helix);
+			m_helices.push_back(helix);
+		}
+
+		HMEVALUATE_RETURN(status = batch.create(), status);
+
+		if (showProgressBar) {
+			MProgressWindow::advanceProgress(1);
+			MProgressWindow::endProgress();
+		}
+
+		if (!(status = Model::Object::Select(helices.begin() + first, helices.end())))
+			status.perror("Object::Select");
 
 		return MStatus::kSuccess;
 	}
 
-	MStatus Creator::createHelix(const MVector & center, const MVector & normal, int bases, double rotation, Model::Helix & helix, const CreateBaseControl & control, const MString & name) {
+	MStatus Creator::helixTransform(const MVector & center, const MVector & normal, double rotation, MTransformationMatrix & matrix) {
 		MStatus status;
 
-		if (bases <= 0) {
-			MGlobal::displayWarning(MString("Ignoring request to create helix with ") + bases + " bases");
-			return MStatus::kSuccess;
-		}
-
 		/*
 		 * When rotating the helix, in order to keep the initial rotation of the helix relative to the global xz-plane,
 		 * we have to first rotate the cylinder around the Y-axis (azimuthal/yaw) then along the local X-axis (altitude/pitch)
 		 * and finally along the normal itself (roll).
 		 */
 		const MVector normal_xz(MVector(normal.x, 0, normal.z).normal());
-		MTransformationMatrix matrix;
+		matrix = MTransformationMatrix();
 
 		// Translation to the center of the cylinder.
 		HMEVALUATE_RETURN(status = matrix.setTranslation(center, MSpace::kTransform), status);
@@ -250,6 +304,20 @@ namespace Helix {
 		// Roll (rotation around the cylinder axis).
 		HMEVALUATE_RETURN(matrix.rotateBy(MQuaternion(toRadians(rotation), normal), MSpace::kTransform, &status), status);
 
+		return MStatus::kSuccess;
+	}
+
+	MStatus Creator::createHelix(const MVector & center, const MVector & normal, int bases, double rotation, Model::Helix & helix, const CreateBaseControl & control, const MString & name) {
+		MStatus status;
+
+		if (bases <= 0) {
+			MGlobal::displayWarning(MString("Ignoring request to create helix with ") + bases + " bases");
+			return MStatus::kSuccess;
+		}
+
+		MTransformationMatrix matrix;
+		HMEVALUATE_RETURN(status = helixTransform(center, normal, rotation, matrix), status);
+
 		if (!(status = createHelix(bases, helix, matrix, control, name))) {
 			status.perror("createHelix(bases, helix)");
 			return status;
@@ -262,7 +330,11 @@ namespace Helix {
 		MStatus status;
 
 		double current_rotation = rotation;
-		Model::Helix helix;
+		std::vector<MTransformationMatrix> transforms;
+		std::vector<int> bases;
+
+		transforms.reserve(points.length());
+		bases.reserve(points.length());
 
 		/*
 		 * Generating a plane between the helices, we discard bases on the wrong side of it
@@ -350,10 +422,16 @@ namespace Helix {
 
 			std::cerr << "Start: " << origo.x << ", " << origo.y << ", " << origo.z << " End: " << end.x << ", " << end.y << ", " << end.z << std::endl;
 
-			if (!(status = createHelix(origo, end, current_rotation, helix/*, control*/))) {
-				status.perror(MString("createHelix at index: ") + i);
-				return status;
-			}
+			/*
+			 * Same as createHelix between origo and end, but all helices are created at once below
+			 */
+
+			const MVector delta(end - origo);
+			MTransformationMatrix matrix;
+			HMEVALUATE_RETURN(status = helixTransform(origo + delta / 2, delta.normal(), current_rotation, matrix), status);
+
+			transforms.push_back(matrix);
+			bases.push_back(DNA::DistanceToBaseCount(delta.length()));
 
 			/*
 			 * Calculate a new rotation for the next helix
@@ -363,16 +441,14 @@ namespace Helix {
 
 			//current_rotation += floor((end - origo).length() / DNA::STEP + 0.5) * DNA::PITCH;
 			current_rotation += DNA::HelixRotation((end - origo).length());
+		}
 
-			/*
-			 * A new color for the upcoming helix
-			 */
+		/*
+		 * Every helix gets new colors
+		 */
 
-			if (!(status = randomizeMaterials())) {
-				status.perror("randomizeMaterials");
-				return status;
-			}
-		}
+		std::vector<Model::Helix> helices;
+		HMEVALUATE_RETURN(status = createHelixBundle(transforms, bases, helices), status);
 
 		return MStatus::kSuccess;
 	}
@@ -640,26 +716,7 @@ namespace Helix {
 			return status;
 		}
 
-		for(int i = 0; i < 2; ++i)
-			m_materials[0] = Model::Material();
-
-		if (numMaterials == 1) {
-			for(int i = 0; i < 2; ++i)
-				m_materials[i] = *materials_begin;
-		}
-		else if(numMaterials >= 2) {
-
-			/*
-			 * Pick out two by random, not the same ones twice!
-			 */
-
-			int indices[] = { rand() % (int) numMaterials, 0 };
-			do { indices[1] = rand() % (int) numMaterials; } while (indices[0] == indices[1]);
-
-			for(int i = 0; i < 2; ++i) {
-				m_materials[i] = *(materials_begin + indices[i]);
-			}
-		}
+		Creator_pickMaterials(materials_begin, numMaterials, m_materials);
 
 		return MStatus::kSuccess;
 	}
@@ -698,6 +755,8 @@ namespace Helix {
 		}
 		case CREATE_ALONG_CURVE:
 			// TODO: Is this correct?
+			m_bundleMaterialsUsed = 0;
+
 			for(std::vector<MPointArray>::iterator it = m_redoData.points.begin(); it != m_redoData.points.end(); ++it)
 				createHelices(*it, m_redoData.rotation);
 			break;
@@ -710,6 +769,14 @@ namespace Helix {
 			m_helices.push_back(helix);
 		}
 			break;
+		case CREATE_BUNDLE:
+		{
+			MStatus status;
+			std::vector<Model::Helix> helices;
+			m_bundleMaterialsUsed = 0;
+			HMEVALUATE_RETURN(status = createHelixBundle(m_redoData.transforms, m_redoData.bundleBases, helices, m_redoData.name), status);
+		}
+			break;
 		case CREATE_NONE:
 			break;
 		}
@@ -823,4 +890,16 @@ namespace Helix {
 
 		return createHelix(bases, helix, transform, CreateBaseControl(), name, showProgressBar);
 	}
+
+	MStatus Creator::create(const std::vector<MTransformationMatrix> & transforms, const std::vector<int> & bases, std::vector<Model::Helix> & helices, const MString & name, bool showProgressBar) {
+		m_redoMode = CREATE_BUNDLE;
+		m_redoData.transforms = transforms;
+		m_redoData.bundleBases = bases;
+		m_redoData.name = name;
+
+		m_bundleMaterials.clear();
+		m_bundleMaterialsUsed = 0;
+
+		return createHelixBundle(transforms, bases, helices, name, showProgressBar);
+	}
 }
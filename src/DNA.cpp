@@ -19,6 +19,8 @@
 #include <Utility.h>
 
 #include <algorithm>
+#include <climits>
+#include <cmath>
 
 #include <BackboneArrow.h>
 
@@ -29,6 +31,43 @@ namespace DNA {
 		return strands_str[index];
 	}
 
+	/*
+	 * sin and cos of the forward and backward base angles for every index within the period, see CalculateBasePairPositions below.
+	 * Built during static initialization, thus it is safe to use from threads. If the rotation does not repeat after PITCH_PERIOD
+	 * base pairs the table is not used, and every position is calculated with sin and cos.
+	 */
+
+	struct BasePairTable {
+		double sin[2][PITCH_PERIOD], cos[2][PITCH_PERIOD];
+		bool periodic;
+
+		BasePairTable() {
+			const double turns = PITCH_PERIOD * PITCH / 360.0;
+			periodic = std::fabs(turns - std::floor(turns + 0.5)) < 1e-9;
+
+			if (!periodic)
+				std::cerr << "DNA::PITCH_PERIOD * DNA::PITCH is not a multiple of 360 degrees, base pair positions are not tabulated" << std::endl;
+
+			for (int i = 0; i < PITCH_PERIOD; ++i) {
+				const double rad = i * Helix::toRadians(-PITCH);
+
+				sin[0][i] = std::sin(rad);
+				cos[0][i] = std::cos(rad);
+				sin[1][i] = std::sin(rad + Helix::toRadians(OPPOSITE_ROTATION));
+				cos[1][i] = std::cos(rad + Helix::toRadians(OPPOSITE_ROTATION));
+			}
+		}
+	} s_basePairTable;
+
+	/*
+	 * Index modulo the period, also for negative indices.
+	 */
+
+	inline int BasePairTable_index(int index) {
+		const int i = index % PITCH_PERIOD;
+		return i < 0 ? i + PITCH_PERIOD : i;
+	}
+
 	MStatus CalculateBasePairPositions(double index, MVector & forward, MVector & backward, double offset, double totalNumBases) {
 		/*
 
@@ -46,6 +85,24 @@ y=ystart-self.STEP*numBases/2.0+i*self.STEP+0.165
 
 		 */
 
+		if (s_basePairTable.periodic && index == std::floor(index) && std::fabs(index) < double(INT_MAX)) {
+			/*
+			 * The index is an integer, use the table. Any offset is applied as a rotation.
+			 */
+
+			const int i = BasePairTable_index(int(index));
+			const double sin_offset = std::sin(Helix::toRadians(offset)), cos_offset = std::cos(Helix::toRadians(offset));
+			MVector *positions[] = { &forward, &backward };
+
+			for (int j = 0; j < 2; ++j) {
+				positions[j]->x = ONE_MINUS_SPHERE_RADIUS * (s_basePairTable.sin[j][i] * cos_offset + s_basePairTable.cos[j][i] * sin_offset);
+				positions[j]->y = ONE_MINUS_SPHERE_RADIUS * (s_basePairTable.cos[j][i] * cos_offset - s_basePairTable.sin[j][i] * sin_offset);
+				positions[j]->z = index * STEP + Z_SHIFT - totalNumBases * STEP / 2;
+			}
+
+			return MStatus::kSuccess;
+		}
+
 		double rad = Helix::toRadians(offset) + index * Helix::toRadians(-PITCH);
 
 		forward.x = ONE_MINUS_SPHERE_RADIUS * sin(rad);
@@ -61,6 +118,46 @@ y=ystart-self.STEP*numBases/2.0+i*self.STEP+0.165
 		return MStatus::kSuccess;
 	}
 
+	void CalculateBasePairPositions(int first, int count, MVector *positions, double offset, double totalNumBases) {
+		if (!s_basePairTable.periodic) {
+			for (int k = 0; k < count; ++k)
+				CalculateBasePairPositions(double(first + k), positions[k * 2], positions[k * 2 + 1], offset, totalNumBases);
+
+			return;
+		}
+
+		/*
+		 * Rotate the table by the offset once, then every index is a lookup.
+		 */
+
+		double x[2][PITCH_PERIOD], y[2][PITCH_PERIOD];
+		const double sin_offset = std::sin(Helix::toRadians(offset)), cos_offset = std::cos(Helix::toRadians(offset));
+
+		for (int j = 0; j < 2; ++j) {
+			for (int i = 0; i < PITCH_PERIOD; ++i) {
+				x[j][i] = ONE_MINUS_SPHERE_RADIUS * (s_basePairTable.sin[j][i] * cos_offset + s_basePairTable.cos[j][i] * sin_offset);
+				y[j][i] = ONE_MINUS_SPHERE_RADIUS * (s_basePairTable.cos[j][i] * cos_offset - s_basePairTable.sin[j][i] * sin_offset);
+			}
+		}
+
+		const double z_origo = Z_SHIFT - totalNumBases * STEP / 2;
+		int i = BasePairTable_index(first);
+
+		for (int k = 0; k < count; ++k) {
+			const double z = (first + k) * STEP + z_origo;
+
+			positions[k * 2].x = x[0][i];
+			positions[k * 2].y = y[0][i];
+			positions[k * 2].z = z;
+			positions[k * 2 + 1].x = x[1][i];
+			positions[k * 2 + 1].y = y[1][i];
+			positions[k * 2 + 1].z = z;
+
+			if (++i == PITCH_PERIOD)
+				i = 0;
+		}
+	}
+
 	/*
 	 * New model handling API
 	 */
@@ -24,7 +24,7 @@
 #include <maya/MCommandResult.h>
 #include <maya/MProgressWindow.h>
 
-#include <list>
+#include <vector>
 #include <functional>
 #include <algorithm>
 #include <cstdio>
@@ -147,36 +147,9 @@ namespace Helix {
 			return MStatus::kSuccess;
 		}
 
-		if (!MProgressWindow::reserve())
-			MGlobal::displayWarning("Failed to reserve the progress window");
-
-		MProgressWindow::setTitle("Export strands");
-		MProgressWindow::setProgressStatus("Isolating strands");
-		MProgressWindow::setProgressRange(0, targets.length());
-		MProgressWindow::startProgress();		
-
-		std::list<Model::Strand> strands;
-		std::list<Model::Strand>::iterator it;
-
-		for(unsigned int i = 0; i < targets.length(); ++i) {
-			Model::Base base(targets[i]);
-
-			if ((it = std::find_if(strands.begin(), strands.end(), std::bind2nd(std::ptr_fun(&Model::Strand::Contains_base), base))) == strands.end()) {
-				/*
-				 * The strand represented by the Base is not already present, add it.
-				 */
-
-				strands.push_back(Model::Strand(base));
-			}
-
-			MProgressWindow::advanceProgress(1);
-		}
-
-		MProgressWindow::endProgress();
-		
 		MCommandResult commandResult;
 
-		if (!(status = MGlobal::executeCommand("fileDialog2 -caption \"Export to text file\" -fileFilter \"Comma-separated values (*.csv);;Colon-separated values (*.csv);;Plain text (*.txt);;All files (*.*)\" -rf true -fileMode 0", commandResult))) {
+		if (!(status = MGlobal::executeCommand("fileDialog2 -caption \"Export to text file\" -fileFilter \"Comma-separated values (*.csv);;Colon-separated values (*.csv);;Tab-separated values (*.tsv);;FASTA (*.fasta);;Plain text (*.txt);;All files (*.*)\" -rf true -fileMode 0", commandResult))) {
 			status.perror("MGlobal::executeCommand");
 			return status;
 		}
@@ -205,18 +178,42 @@ namespace Helix {
 
 		MProgressWindow::setTitle("Export strands");
 		MProgressWindow::setProgressStatus("Extracting strand sequences");
-		MProgressWindow::setProgressRange(0, (int) strands.size());
+		MProgressWindow::setProgressRange(0, (int) targets.length());
 		MProgressWindow::startProgress();
 
+		/*
+		 * Every target base defines a strand, the operation skips strands that were already exported through another base.
+		 */
+
+		std::vector<Model::Strand> strands;
+		strands.reserve(targets.length());
+
+		for(unsigned int i = 0; i < targets.length(); ++i)
+			strands.push_back(Model::Strand(Model::Base(targets[i])));
+
 		std::for_each(strands.begin(), strands.end(), m_operation.execute());
 
 		MProgressWindow::endProgress();
 
+		if (!(status = m_operation.status())) {
+			status.perror("ExportStrands::execute");
+			return status;
+		}
+
 		/*
 		 * Write to file
 		 */
 
-		if (!(status = m_operation.write(result[0], strstr(result[1].asChar(), "Comma") != NULL ? Controller::ExportStrands::COMMA_SEPARATED : Controller::ExportStrands::COLON_SEPARATED))) {
+		Controller::ExportStrands::Mode mode = Controller::ExportStrands::COLON_SEPARATED;
+
+		if (strstr(result[1].asChar(), "Comma") != NULL)
+			mode = Controller::ExportStrands::COMMA_SEPARATED;
+		else if (strstr(result[1].asChar(), "Tab") != NULL)
+			mode = Controller::ExportStrands::TAB_SEPARATED;
+		else if (strstr(result[1].asChar(), "FASTA") != NULL)
+			mode = Controller::ExportStrands::FASTA;
+
+		if (!(status = m_operation.write(result[0], mode))) {
 			status.perror("ExportStrands::write");
 			return status;
 		}
@@ -18,8 +18,10 @@
 #include <maya/MDGModifier.h>
 #include <maya/MProgressWindow.h>
 
+#include <algorithm>
 #include <vector>
 #include <iterator>
+#include <list>
 #include <cmath>
 
 #include <model/Helix.h>
@@ -102,9 +104,19 @@ namespace Helix {
 
 		m_operation.setLength(bases);
 
-		std::for_each(targets.begin(), targets.end(), m_operation.execute());
+		for (std::list<Model::Base>::iterator it = targets.begin(); it != targets.end(); ++it) {
+			if (!(status = m_operation.add(*it))) {
+				status.perror("ExtendStrand::add");
+				return status;
+			}
+		}
+
+		if (!(status = m_operation.create())) {
+			status.perror("ExtendStrand::create");
+			return status;
+		}
 
-		return m_operation.status();
+		return MStatus::kSuccess;
 	}
 
 	MStatus ExtendStrand::undoIt () {
@@ -10,9 +10,9 @@
 
 #include <model/Helix.h>
 #include <model/Base.h>
+#include <model/EndIndex.h>
 
 #include <maya/MSyntax.h>
-#include <maya/MItDag.h>
 #include <maya/MFnDagNode.h>
 #include <maya/MSelectionList.h>
 #include <maya/MGlobal.h>
@@ -33,90 +33,21 @@ namespace Helix {
 		MStatus status;
 		MSelectionList activeSelectionList;
 
-		// Traverse the scene, find bases and select the ones that does not have a backward connection (i think? :D)
+		// The 5' ends are tracked by the EndIndex as their connections change, thus there's no need to traverse the scene.
 		//
 
-		MItDag itDag(MItDag::kBreadthFirst, MFn::kTransform, &status);
+		MObjectArray fivePrimeEnds;
 
-		if (!status) {
-			status.perror("MItDag::#ctor");
+		if (!(status = Model::EndIndex::Ends(Model::Base::FIVE_PRIME_END, fivePrimeEnds))) {
+			status.perror("EndIndex::Ends");
 			return status;
 		}
 
-		for (; !itDag.isDone(); itDag.next()) {
-			Model::Base base(itDag.currentItem(&status));
-
-			if (!status) {
-				status.perror("MItDag::currentItem");
-				return status;
-			}
-
-			if (base.type(status) == Model::Base::FIVE_PRIME_END)
-				activeSelectionList.add(base.getObject(status));
-
-			if (!status) {
-				status.perror("Base::type or MSelectionList::add");
-				return status;
-			}
-
-			/*MDagPath dagPath;
-
-			if (!(status = itDag.getPath(dagPath))) {
-				status.perror("MItDag::getPath");
-				return status;
-			}
-
-			MObject object = dagPath.node(&status);
-			if (!status) {
-				status.perror("MDagPath::node");
+		for (unsigned int i = 0; i < fivePrimeEnds.length(); ++i) {
+			if (!(status = activeSelectionList.add(fivePrimeEnds[i]))) {
+				status.perror("MSelectionList::add");
 				return status;
 			}
-
-			MFnDagNode dagNode(object);
-
-			if (dagNode.typeId(&status) == HelixBase::id) {
-				// Got a HelixBase, now figure out if it is connected
-				//
-
-				MPlug plug(object, HelixBase::aBackward);
-
-				if (!plug.isConnected()) {
-					activeSelectionList.add(dagPath);
-				}
-				else {
-					// There might still be a case where it is not connected to any HelixBases but other objects
-					//
-
-					bool hasHelixBaseConnected = false;
-
-					MPlugArray plugArray;
-					if (plug.connectedTo(plugArray, true, true, &status)) {
-						unsigned int plugArray_length = plugArray.length();
-
-						for (unsigned int i = 0; i < plugArray_length; ++i) {
-							MFnDagNode connected_dagNode(plugArray[i].node(&status));
-
-							if (!status) {
-								status.perror("MPlugArray[i]::node");
-								return status;
-							}
-
-							if (connected_dagNode.typeId(&status) == HelixBase::id) {
-								hasHelixBaseConnected = true;
-								break;
-							}
-						}
-					}
-
-					if (!status) {
-						status.perror("MPlug::connectedTo");
-						return status;
-					}
-
-					if (!hasHelixBaseConnected)
-						activeSelectionList.add(dagPath);
-				}
-			}*/
 		}
 
 		// Select all the bases in our array
@@ -25,6 +25,7 @@
 #include <algorithm>
 
 #include <model/Base.h>
+#include <model/EndIndex.h>
 #include <view/ConnectSuggestionsLocatorNode.h>
 
 namespace Helix {
@@ -123,6 +124,25 @@ namespace Helix {
 	//	return MPxTransform::connectionBroken(plug, otherPlug, asSrc);
 	//}
 
+	void HelixBase::postConstructor() {
+		// The helix is not known yet, so the base is only queued.
+		Model::EndIndex::Changed(thisMObject());
+	}
+
+	MStatus HelixBase::connectionMade(const MPlug &plug, const MPlug &otherPlug, bool asSrc) {
+		if (plug == aForward || plug == aBackward)
+			Model::EndIndex::Changed(thisMObject());
+
+		return MPxTransform::connectionMade(plug, otherPlug, asSrc);
+	}
+
+	MStatus HelixBase::connectionBroken(const MPlug &plug, const MPlug &otherPlug, bool asSrc) {
+		if (plug == aForward || plug == aBackward)
+			Model::EndIndex::Changed(thisMObject());
+
+		return MPxTransform::connectionBroken(plug, otherPlug, asSrc);
+	}
+
 	void *HelixBase::creator() {
 		return new HelixBase();
 	}
@@ -0,0 +1,250 @@
+#include <LoadOxDnaTrajectory.h>
+#include <OxDnaTrajectoryNode.h>
+
+#include <Helix.h>
+#include <HelixBase.h>
+#include <Utility.h>
+
+#include <controller/OxDnaExporter.h>
+#include <controller/FileReader.h>
+
+#include <maya/MArgDatabase.h>
+#include <maya/MCommandResult.h>
+#include <maya/MFnDagNode.h>
+#include <maya/MFnIntArrayData.h>
+#include <maya/MGlobal.h>
+#include <maya/MPlugArray.h>
+#include <maya/MPxTransform.h>
+#include <maya/MSelectionList.h>
+#include <maya/MStringArray.h>
+#include <maya/MSyntax.h>
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif /* N Windows */
+
+namespace Helix {
+#if defined(WIN32) || defined(WIN64)
+	typedef std::unordered_map<std::string, unsigned int> LoadOxDnaTrajectory_string_index_map_t;
+	typedef std::unordered_map<std::string, MObject> LoadOxDnaTrajectory_string_object_map_t;
+#else
+	typedef std::tr1::unordered_map<std::string, unsigned int> LoadOxDnaTrajectory_string_index_map_t;
+	typedef std::tr1::unordered_map<std::string, MObject> LoadOxDnaTrajectory_string_object_map_t;
+#endif /* N Windows */
+
+	/*
+	 * Asks the user for a file. filename is left empty if the user cancelled.
+	 */
+	MStatus LoadOxDnaTrajectory_fileDialog(const char *caption, const char *filter, MString & filename) {
+		MStatus status;
+		MCommandResult commandResult;
+		MStringArray result;
+
+		HMEVALUATE_RETURN(status = MGlobal::executeCommand(MString("fileDialog2 -caption \"") + caption + "\" -fileFilter \"" + filter + ";;All files (*.*)\" -fileMode 1", commandResult), status);
+		HMEVALUATE_RETURN(status = commandResult.getResult(result), status);
+
+		filename = result.length() > 0 ? result[0] : MString();
+
+		return MStatus::kSuccess;
+	}
+
+	MStatus LoadOxDnaTrajectory::doIt(const MArgList & args) {
+		MStatus status;
+		MArgDatabase argDatabase(syntax(), args, &status);
+		HMEVALUATE_RETURN_DESCRIPTION("MArgDatabase::#ctor", status);
+
+		MString vhelix_filename;
+
+		if (argDatabase.isFlagSet("-t"))
+			HMEVALUATE_RETURN(status = argDatabase.getFlagArgument("-t", 0, m_trajectory_filename), status);
+
+		if (argDatabase.isFlagSet("-v"))
+			HMEVALUATE_RETURN(status = argDatabase.getFlagArgument("-v", 0, vhelix_filename), status);
+
+		if (m_trajectory_filename.length() == 0) {
+			HMEVALUATE_RETURN(status = LoadOxDnaTrajectory_fileDialog("Load oxDNA trajectory", "oxDNA trajectory (*." HELIX_OXDNA_TRAJECTORY_FILE_TYPE ")", m_trajectory_filename), status);
+
+			if (m_trajectory_filename.length() == 0)
+				return MStatus::kSuccess;
+		}
+
+		if (vhelix_filename.length() == 0) {
+			/*
+			 * The glue file usually has the same name as the exported topology and configuration, but trajectories are often renamed.
+			 */
+
+			const int extension = m_trajectory_filename.rindexW('.');
+			vhelix_filename = MString(m_trajectory_filename.asChar(), extension != -1 ? extension : m_trajectory_filename.length()) + "." HELIX_OXDNA_VHELIX_FILE_TYPE;
+
+			if (!std::ifstream(vhelix_filename.asChar())) {
+				HMEVALUATE_RETURN(status = LoadOxDnaTrajectory_fileDialog("Select the vHelix file of the design", "vHelix oxDNA glue file (*." HELIX_OXDNA_VHELIX_FILE_TYPE ")", vhelix_filename), status);
+
+				if (vhelix_filename.length() == 0)
+					return MStatus::kSuccess;
+			}
+		}
+
+		/*
+		 * Map the oxDNA base indices to helices and base names.
+		 */
+
+		std::vector<char> buffer;
+		HMEVALUATE_RETURN(status = Controller::FileReader_read(vhelix_filename.asChar(), buffer), status);
+
+		std::vector<std::string> helixNames, baseNames;
+		LoadOxDnaTrajectory_string_index_map_t helixIndices;
+
+		{
+			char *it = &buffer[0], *end = &buffer[0] + buffer.size() - 1, *line;
+
+			while ((line = Controller::FileReader_nextLine(it, end))) {
+				if (Controller::FileReader_skipLine(line))
+					continue;
+
+				long index;
+				char *name, *helixName;
+
+				if (strcmp(Controller::FileReader_token(line), "base") != 0 || !Controller::FileReader_parse(line, index) || index < 0 ||
+						!(name = Controller::FileReader_token(line)) || !(helixName = Controller::FileReader_token(line)))
+					continue;
+
+				if (size_t(index) >= baseNames.size()) {
+					baseNames.resize(size_t(index) + 1);
+					m_baseHelix.setLength((unsigned int) index + 1);
+				}
+
+				LoadOxDnaTrajectory_string_index_map_t::iterator helix_it(helixIndices.find(helixName));
+
+				if (helix_it == helixIndices.end()) {
+					helix_it = helixIndices.insert(std::make_pair(std::string(helixName), (unsigned int) helixNames.size())).first;
+					helixNames.push_back(helixName);
+				}
+
+				baseNames[size_t(index)] = name;
+				m_baseHelix[(unsigned int) index] = int(helix_it->second);
+			}
+		}
+
+		std::vector<char>().swap(buffer);
+
+		/*
+		 * Create the node and make the connections.
+		 */
+
+		HMEVALUATE_RETURN(m_node = m_dgModifier.createNode(OxDnaTrajectoryNode::id, &status), status);
+
+		{
+			MSelectionList selectionList;
+			MObject time;
+			HMEVALUATE_RETURN(status = selectionList.add("time1"), status);
+			HMEVALUATE_RETURN(status = selectionList.getDependNode(0, time), status);
+			HMEVALUATE_RETURN(status = m_dgModifier.connect(MFnDependencyNode(time).findPlug("outTime"), MPlug(m_node, OxDnaTrajectoryNode::aTime)), status);
+		}
+
+		std::vector<LoadOxDnaTrajectory_string_object_map_t> helixBases(helixNames.size());
+		MPlug helixInverseMatrixPlug(m_node, OxDnaTrajectoryNode::aHelixInverseMatrix);
+
+		for (unsigned int i = 0; i < helixNames.size(); ++i) {
+			MSelectionList selectionList;
+			MObject helix;
+
+			if (!selectionList.add(helixNames[i].c_str()) || !selectionList.getDependNode(0, helix) || MFnDependencyNode(helix).typeId() != ::Helix::Helix::id) {
+				MGlobal::displayWarning(MString("Can't find helix \"") + helixNames[i].c_str() + "\", its bases will not be animated.");
+				continue;
+			}
+
+			MFnDagNode helix_dagNode(helix);
+			HMEVALUATE_RETURN(status = m_dgModifier.connect(helix_dagNode.findPlug("worldInverseMatrix").elementByLogicalIndex(0), helixInverseMatrixPlug.elementByLogicalIndex(i)), status);
+
+			for (unsigned int j = 0; j < helix_dagNode.childCount(); ++j) {
+				MObject child(helix_dagNode.child(j));
+				MFnDependencyNode child_dependencyNode(child);
+
+				if (child_dependencyNode.typeId() == HelixBase::id)
+					helixBases[i].insert(std::make_pair(std::string(child_dependencyNode.name().asChar()), child));
+			}
+		}
+
+		MPlug translationPlug(m_node, OxDnaTrajectoryNode::aTranslation);
+
+		for (unsigned int i = 0; i < baseNames.size(); ++i) {
+			if (baseNames[i].empty())
+				continue;
+
+			const LoadOxDnaTrajectory_string_object_map_t & bases(helixBases[m_baseHelix[i]]);
+			LoadOxDnaTrajectory_string_object_map_t::const_iterator base_it(bases.find(baseNames[i]));
+
+			if (base_it == bases.end())
+				continue;
+
+			MPlug translatePlug(base_it->second, MPxTransform::translate);
+			MPlugArray sources;
+
+			// A previously loaded trajectory might already drive the base.
+			if (translatePlug.connectedTo(sources, true, false) && sources.length() > 0)
+				HMEVALUATE_RETURN(status = m_dgModifier.disconnect(sources[0], translatePlug), status);
+
+			HMEVALUATE_RETURN(status = m_dgModifier.connect(translationPlug.elementByLogicalIndex(i), translatePlug), status);
+		}
+
+		HMEVALUATE_RETURN(status = redoIt(), status);
+
+		setResult(MFnDependencyNode(m_node).name());
+
+		return MStatus::kSuccess;
+	}
+
+	MStatus LoadOxDnaTrajectory::apply() {
+		MStatus status;
+		MFnIntArrayData baseHelixData;
+		MObject baseHelixObject;
+
+		HMEVALUATE_RETURN(baseHelixObject = baseHelixData.create(m_baseHelix, &status), status);
+		HMEVALUATE_RETURN(status = MPlug(m_node, OxDnaTrajectoryNode::aBaseHelix).setValue(baseHelixObject), status);
+		HMEVALUATE_RETURN(status = MPlug(m_node, OxDnaTrajectoryNode::aFile).setValue(m_trajectory_filename), status);
+
+		return MStatus::kSuccess;
+	}
+
+	MStatus LoadOxDnaTrajectory::undoIt () {
+		MStatus status;
+		HMEVALUATE_RETURN(status = m_dgModifier.undoIt(), status);
+
+		return MStatus::kSuccess;
+	}
+
+	MStatus LoadOxDnaTrajectory::redoIt () {
+		MStatus status;
+		HMEVALUATE_RETURN(status = m_dgModifier.doIt(), status);
+
+		return apply();
+	}
+
+	bool LoadOxDnaTrajectory::isUndoable () const {
+		return true;
+	}
+
+	bool LoadOxDnaTrajectory::hasSyntax () const {
+		return true;
+	}
+
+	MSyntax LoadOxDnaTrajectory::newSyntax () {
+		MSyntax syntax;
+
+		syntax.addFlag("-t", "-trajectory", MSyntax::kString);
+		syntax.addFlag("-v", "-vhelix", MSyntax::kString);
+
+		return syntax;
+	}
+
+	void *LoadOxDnaTrajectory::creator() {
+		return new LoadOxDnaTrajectory();
+	}
+}
@@ -24,6 +24,9 @@
 #include <maya/MPlugArray.h>
 #include <maya/MFnCamera.h>
 #include <maya/MGlobal.h>
+#include <maya/MDGMessage.h>
+#include <maya/MModelMessage.h>
+#include <maya/MSceneMessage.h>
 
 #include <model/Helix.h>
 #include <model/Strand.h>
@@ -61,6 +64,12 @@ namespace Helix {
 	bool HelixLocator::s_gl_initialized = false, HelixLocator::s_gl_failed = false;
 	GLuint HelixLocator::s_program = 0, HelixLocator::s_vertex_shader = 0, HelixLocator::s_fragment_shader = 0;
 	GLint HelixLocator::s_screen_dimensions_uniform = -1, HelixLocator::s_halo_size_attrib_location = -1;
+	GLuint HelixLocator::s_label_program = 0, HelixLocator::s_label_vertex_shader = 0, HelixLocator::s_label_fragment_shader = 0, HelixLocator::s_label_texture = 0;
+	GLint HelixLocator::s_label_uniforms[LABEL_GLSL_UNIFORM_COUNT] = { -1, -1, -1, -1 }, HelixLocator::s_label_glyph_attrib_location = -1;
+	HelixLocator::bucket_map_t HelixLocator::s_buckets;
+	MCallbackIdArray HelixLocator::s_globalCallbacks, HelixLocator::s_baseCallbacks;
+	unsigned int HelixLocator::s_epoch = 0, HelixLocator::s_bucketsEpoch = 0, HelixLocator::s_selectedCount = 0;
+	bool HelixLocator::s_bucketsDirty = true;
 	
 	HelixLocator::~HelixLocator() {
 		
@@ -164,6 +173,21 @@ namespace Helix {
 			s_gl_failed = true;
 		}
 
+		/*
+		 * Sequence labels
+		 */
+
+		{
+			static const char *vertex_shader[] = { LABEL_GLSL_VERTEX_SHADER, NULL }, *fragment_shader[] = { LABEL_GLSL_FRAGMENT_SHADER, NULL }, *uniform_names[] = { LABEL_GLSL_UNIFORM_NAMES, NULL }, *attrib_names[] = { LABEL_GLSL_ATTRIB_NAME, NULL };
+
+			if (!(status = SetupOpenGLShaders(vertex_shader, fragment_shader, uniform_names, s_label_uniforms, LABEL_GLSL_UNIFORM_COUNT, attrib_names, &s_label_glyph_attrib_location, 1, s_label_program, s_label_vertex_shader, s_label_fragment_shader))) {
+				status.perror("Setup opengl label shaders failed");
+				s_gl_failed = true;
+			}
+		}
+
+		initializeLabelAtlas();
+
 		s_gl_initialized = true;
 	}
 
@@ -172,6 +196,66 @@ namespace Helix {
 			SELECTED_ADJACENT_HALO_COLOR, SELECTED_ADJACENT_NEIGHBOUR_HALO_COLOR, SELECTED_ADJACENT_FIVEPRIME_HALO_COLOR, SELECTED_ADJACENT_THREEPRIME_HALO_COLOR
 	};
 
+	/*
+	 * 8x8 glyphs of the sequence labels in the order A, C, G, T and ?, the most significant bit is the leftmost pixel
+	 */
+
+	static const unsigned char label_glyphs[LABEL_GLYPH_COUNT][LABEL_GLYPH_SIZE] = {
+			{ 0x30, 0x78, 0xCC, 0xCC, 0xFC, 0xCC, 0xCC, 0x00 },
+			{ 0x3C, 0x66, 0xC0, 0xC0, 0xC0, 0x66, 0x3C, 0x00 },
+			{ 0x3C, 0x66, 0xC0, 0xC0, 0xCE, 0x66, 0x3E, 0x00 },
+			{ 0xFC, 0xB4, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00 },
+			{ 0x78, 0xCC, 0x0C, 0x18, 0x30, 0x00, 0x30, 0x00 }
+	};
+
+	void HelixLocator::initializeLabelAtlas() {
+		GLubyte atlas[LABEL_GLYPH_SIZE][LABEL_ATLAS_GLYPHS * LABEL_GLYPH_SIZE];
+
+		std::fill(&atlas[0][0], &atlas[0][0] + LABEL_GLYPH_SIZE * LABEL_ATLAS_GLYPHS * LABEL_GLYPH_SIZE, GLubyte(0));
+
+		for (int i = 0; i < LABEL_GLYPH_COUNT; ++i) {
+			for (int y = 0; y < LABEL_GLYPH_SIZE; ++y) {
+				for (int x = 0; x < LABEL_GLYPH_SIZE; ++x)
+					atlas[y][i * LABEL_GLYPH_SIZE + x] = (label_glyphs[i][y] & (0x80 >> x)) ? 0xFF : 0x00;
+			}
+		}
+
+		glPushAttrib(GL_TEXTURE_BIT);
+		glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+
+		glGenTextures(1, &s_label_texture);
+		glBindTexture(GL_TEXTURE_2D, s_label_texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA8, LABEL_ATLAS_GLYPHS * LABEL_GLYPH_SIZE, LABEL_GLYPH_SIZE, 0, GL_ALPHA, GL_UNSIGNED_BYTE, atlas);
+
+		glPopClientAttrib();
+		glPopAttrib();
+	}
+
+	/*
+	 * Index of the glyph of a label in the atlas
+	 */
+
+	static inline float label_glyph(char label) {
+		switch(label) {
+		case 'A':
+			return 0.0f;
+		case 'C':
+			return 1.0f;
+		case 'G':
+			return 2.0f;
+		case 'T':
+			return 3.0f;
+		default:
+			return 4.0f;
+		}
+	}
+
 	// Helper method
 	MStatus recursiveSearchForNeighbourBases(MObjectArray children, MDagPath dagPath, MObject forward_attribute, MObject backward_attribute, MDagPathArray & selectedNeighbourBases, MDagPathArray & endBases, bool force = false) {
 		MStatus status;
@@ -382,269 +466,159 @@ namespace Helix {
 			}
 		}
 
+		if (!prepareDraw())
+			return;
+
+		view.beginGL();
+		drawGL(isOrtho, view.portWidth(), view.portHeight());
+		view.endGL();
+	}
+
+	bool HelixLocator::prepareDraw() {
+		MStatus stat;
+
 		/*
 		 * New extraction code using the new API. Fixes duplications where nodes had several halos (Selected, prime ends and neighbour)
 		 * Might also be a bit faster, and definitely easier to read
 		 */
 
-		MObjectArray selectedBases, selectedChildBasesWithNeighbours;
 		Model::Helix helix(MFnDagNode(thisMObject()).parent(0, &stat)); // We can assume our node has a parent and that it is only the helix
 		
 		if (!stat) {
 			stat.perror("MFnDagNode::parent");
-			return;
-		}
-
-		/*MFnTransform helix_transform(helix.getDagPath(stat));
-
-		if (!stat) {
-			stat.perror("Helix::getDagPath");
-			return;
-		}*/
-
-		/*if (!(stat = helix.getSelectedChildBases(selectedChildBases))) {
-			stat.perror("Helix::getSelectedChildBases");
-			return;
-		}*/
-
-		if (!(stat = Model::Base::AllSelected(selectedBases))) {
-			stat.perror("Base::AllSelected");
-			return;
+			return false;
 		}
 
 		/*
-		 * Do not render if the user is selecting a lot of bases.
+		 * The strands are only walked again when the selection or a connection changed
 		 */
-		if (selectedBases.length() > ToggleLocatorRender::MaxBases)
-			return;
 
-		/*
-		 * Setup OpenGL rendering state
-		 */
+		if (s_globalCallbacks.length() == 0) {
+			s_globalCallbacks.append(MModelMessage::addCallback(MModelMessage::kActiveListModified, &HelixLocator::MModelMessage_activeListModified, NULL, &stat));
 
-		view.beginGL();
+			if (!stat)
+				stat.perror("MModelMessage::addCallback");
 
-		if (!s_gl_initialized) {
-			if (s_gl_failed) {
-				view.endGL();
-				return;
-			}
+			s_globalCallbacks.append(MDGMessage::addTimeChangeCallback(&HelixLocator::MDGMessage_timeChange, NULL, &stat));
 
-			initializeGL();
+			if (!stat)
+				stat.perror("MDGMessage::addTimeChangeCallback");
 
-			if (s_gl_failed) {
-				view.endGL();
-				return;
-			}
-		}
+			s_globalCallbacks.append(MSceneMessage::addCallback(MSceneMessage::kBeforeNew, &HelixLocator::MSceneMessage_beforeNewOpen, NULL, &stat));
 
-		glPushAttrib(GL_POINT_BIT | GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT | GL_TRANSFORM_BIT | GL_LIGHTING_BIT | GL_LINE_BIT);
-		glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+			if (!stat)
+				stat.perror("MSceneMessage::addCallback");
 
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glEnable (GL_LINE_SMOOTH);
+			s_globalCallbacks.append(MSceneMessage::addCallback(MSceneMessage::kBeforeOpen, &HelixLocator::MSceneMessage_beforeNewOpen, NULL, &stat));
 
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
+			if (!stat)
+				stat.perror("MSceneMessage::addCallback");
+		}
 
-		//glDisable(GL_DEPTH_TEST); // I think we want this, at least when we have blending
-		glDepthMask(GL_FALSE); // This is better than disabling the depth test, now blending works, but not through solid objects!
+		if (s_bucketsDirty && !(stat = updateBuckets()))
+			stat.perror("HelixLocator::updateBuckets");
 
 		/*
-		 * If the user has anything selected, render halos, lines, sequences etc
+		 * Do not render if the user is selecting a lot of bases.
 		 */
+		if (s_selectedCount > ToggleLocatorRender::MaxBases)
+			return false;
 
-		if (selectedBases.length() > 0) {
-
-			/*
-			 * Iterate over all bases and iterate over their strands to extract neighbour bases
-			 */
+		{
+			MObject helix_object(helix.getObject(stat));
 
-			for(unsigned int i = 0; i < selectedBases.length(); ++i) {
-				Model::Base base(selectedBases[i]);
-				Model::Strand strand(base);
+			if (!stat) {
+				stat.perror("Helix::getObject");
+				return false;
+			}
 
-				Model::Strand::ForwardIterator it = strand.forward_begin();
-				for(; it != strand.forward_end(); ++it) {
+			bucket_map_t::const_iterator it(s_buckets.find(MObjectHandle(helix_object)));
+			const Bucket *bucket = it != s_buckets.end() ? &it->second : NULL;
+			const unsigned int epoch = bucket ? bucket->epoch : s_bucketsEpoch;
 
-					if (it->getParent(stat) == helix)
-						selectedChildBasesWithNeighbours.append(it->getObject(stat));
-					
+			if (m_epoch != epoch) {
+				if (!(stat = updateRenderData(bucket))) {
+					stat.perror("HelixLocator::updateRenderData");
 
-					if (!stat) {
-						stat.perror("Base::getParent/Base::getObject 1");
-						return;
-					}
+					m_sequence.clear();
+					m_line_count = 0;
 				}
 
-				if (!it.loop()) {
-					for(Model::Strand::BackwardIterator bit = ++strand.reverse_begin(); bit != strand.reverse_end(); ++bit) {
-						if (bit->getParent(stat) == helix)
-							selectedChildBasesWithNeighbours.append(bit->getObject(stat));
-
-						if (!stat) {
-							stat.perror("Base::getParent/Base::getObject 2");
-							return;
-						}
-					}
-				}
+				m_epoch = epoch;
 			}
+		}
 
-			/*
-			 * Data declaration, same as old code, might need a cleanup
-			 */
-		
-			size_t vertices_count = selectedChildBasesWithNeighbours.length();
-
-			// NOTE; Multiply length by two if adjacent bases are to be rendered. See code above!!
-			float *vertices = new float[vertices_count * 3], *line_vertices = new float[vertices_count * 3 * 2], *halo_diameters = new float[vertices_count];
-			unsigned char *colors = new unsigned char[vertices_count * 4], *line_colors = new unsigned char[vertices_count * 4 * 2];
-			char *sequence = new char[vertices_count];
-			unsigned int /*vertex_index = 0, */ line_index = 0;
-
-			/*
-			 * Data gathering
-			 */
+		return true;
+	}
 
-			for(unsigned int i = 0; i < selectedChildBasesWithNeighbours.length(); ++i) {
-				Model::Base base(selectedChildBasesWithNeighbours[i]);
-				MVector base_translation;
+	void HelixLocator::drawGL(bool isOrtho, int portWidth, int portHeight) {
+		MStatus stat;
 
-				/*
-				 * Translation
-				 */
+		Model::Helix helix(MFnDagNode(thisMObject()).parent(0, &stat));
 
-				if (!(stat = base.getTranslation(base_translation, MSpace::kTransform))) {
-					stat.perror("Base::getTranslation");
-					return;
-				}
+		if (!stat) {
+			stat.perror("MFnDagNode::parent");
+			return;
+		}
 
-				for(int j = 0; j < 3; ++j) {
-					vertices[i * 3 + j] = (float) base_translation[j];
-					line_vertices[line_index * 3 + j] = (float) base_translation[j];
-				}
+		if (!s_gl_initialized) {
+			if (s_gl_failed)
+				return;
 
-				/*
-				 * Halo radius and coloring
-				 */
+			initializeGL();
 
-				/* FIXME: Check if this is a selected base, in that case color it red */
+			if (s_gl_failed)
+				return;
+		}
 
-				if (std::find(&selectedBases[0], &selectedBases[0] + selectedBases.length(), selectedChildBasesWithNeighbours[i]) != &selectedBases[0] + selectedBases.length()) {
-					/*
-					 * This is a selected base
-					 */
+		glPushAttrib(GL_POINT_BIT | GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT | GL_TRANSFORM_BIT | GL_LIGHTING_BIT | GL_LINE_BIT | GL_TEXTURE_BIT);
+		glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
 
-					for(int j = 0; j < 4; ++j) {
-						colors[i * 4 + j] = static_colors[0][j];
-						line_colors[line_index * 4 + j] = static_colors[0][j];
-					}
-					halo_diameters[i] = HALO_SELECTED_BASE_DIAMETER_MULTIPLIER;
-				}
-				else {
-					switch(base.type(stat)) {
-			
-					case Model::Base::FIVE_PRIME_END:
-						for(int j = 0; j < 4; ++j) {
-							colors[i * 4 + j] = static_colors[2][j];
-							line_colors[line_index * 4 + j] = static_colors[2][j];
-						}
-						halo_diameters[i] = HALO_FIVE_PRIME_BASE_DIAMETER_MULTIPLIER;
-						break;
-					case Model::Base::THREE_PRIME_END:
-						for(int j = 0; j < 4; ++j) {
-							colors[i * 4 + j] = static_colors[3][j];
-							line_colors[line_index * 4 + j] = static_colors[3][j];
-						}
-						halo_diameters[i] = HALO_THREE_PRIME_BASE_DIAMETER_MULTIPLIER;
-						break;
-					default:
-						for(int j = 0; j < 4; ++j) {
-							colors[i * 4 + j] = static_colors[1][j];
-							line_colors[line_index * 4 + j] = static_colors[1][j];
-						}
-						halo_diameters[i] = 1.0f;
-						break;
-					}
-				}
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glEnable (GL_LINE_SMOOTH);
 
-				if (!stat) {
-					stat.perror("Base::type");
-					return;
-				}
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
 
-				/*
-				 * Label
-				 */
+		//glDisable(GL_DEPTH_TEST); // I think we want this, at least when we have blending
+		glDepthMask(GL_FALSE); // This is better than disabling the depth test, now blending works, but not through solid objects!
 
-				DNA::Name label;
+		/*
+		 * If the user has anything selected, render halos, lines, sequences etc
+		 */
 
-				if (!(stat = base.getLabel(label))) {
-					stat.perror("Base::getLabel");
-					return;
-				}
+		if (!m_sequence.empty()) {
+			const size_t vertices_count = m_sequence.size();
 
-				sequence[i] = label.toChar();
+			// Now render labels, all of them with a single draw from the glyph atlas
+			//
 
-				/*
-				 * Opposite base for line connection
-				 */
+			if (ToggleLocatorRender::CurrentRender & ToggleLocatorRender::kRenderSequence) {
+				glEnableVertexAttribArray(s_label_glyph_attrib_location);
+				glVertexAttribPointer(s_label_glyph_attrib_location, 1, GL_FLOAT, GL_FALSE, 0, &m_label_glyphs[0]);
 
-				Model::Base opposite_base = base.opposite(stat);
+				glTexEnvi(GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE);
 
-				if (stat) {
-					++line_index;
+				glEnable(GL_POINT_SPRITE);
+				glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
 
-					MVector opposite_base_translation;
+				glBindTexture(GL_TEXTURE_2D, s_label_texture);
 
-					if (!(stat = opposite_base.getTranslation(opposite_base_translation, MSpace::kTransform))) {
-						stat.perror("Base::getTranslation 2");
-						return;
-					}
+				glUseProgram(s_label_program);
 
-					for(int j = 0; j < 3; ++j)
-						line_vertices[line_index * 3 + j] = (float) opposite_base_translation[j];
-
-					/*
-					 * Opposite base type
-					 */
-
-					switch(opposite_base.type(stat)) {
-					case Model::Base::FIVE_PRIME_END:
-						for(int j = 0; j < 4; ++j)
-							line_colors[line_index * 4 + j] = static_colors[2][j];
-						break;
-					case Model::Base::THREE_PRIME_END:
-						for(int j = 0; j < 4; ++j)
-							line_colors[line_index * 4 + j] = static_colors[3][j];
-						break;
-					default:
-						for(int j = 0; j < 4; ++j)
-							line_colors[line_index * 4 + j] = static_colors[1][j];
-						break;
-					}
+				glUniform2f(s_label_uniforms[0], (GLfloat) portWidth, (GLfloat) portHeight);
+				glUniform1f(s_label_uniforms[1], LABEL_POINT_SIZE);
+				glUniform1f(s_label_uniforms[2], (GLfloat) (LABEL_MIN_SPACING / DNA::STEP));
+				glUniform1i(s_label_uniforms[3], 0);
 
-					++line_index;
-				}
-				else if (stat != MStatus::kNotFound) {
-					stat.perror("Base::opposite");
-					return;
-				}
-			}
+				glVertexPointer(3, GL_FLOAT, 0, &m_label_vertices[0]);
 
-			// Now render labels
-			//
+				glDrawArrays(GL_POINTS, 0, GLsizei(vertices_count));
 
-			glColor3ub(255, 255, 255);
+				glUseProgram(0);
 
-			if (ToggleLocatorRender::CurrentRender & ToggleLocatorRender::kRenderSequence) {
-				for(size_t i = 0; i < vertices_count; ++i) {
-					if (!(stat = view.drawText(MString(&sequence[i], 1), MPoint(vertices[i * 3], vertices[i * 3 + 1] + DNA::RADIUS * DNA::SEQUENCE_RENDERING_Y_OFFSET, vertices[i * 3 + 2]), M3dView::kCenter))) {
-						stat.perror("M3dView::drawText");
-						break;
-					}
-				}
+				glDisableVertexAttribArray(s_label_glyph_attrib_location);
 			}
 
 			// Render halos using point sprites
@@ -652,7 +626,7 @@ namespace Helix {
 
 			if (!isOrtho && (ToggleLocatorRender::CurrentRender & ToggleLocatorRender::kRenderHalo)) {
 				glEnableVertexAttribArray(s_halo_size_attrib_location);
-				glVertexAttribPointer(s_halo_size_attrib_location, 1, GL_FLOAT, GL_FALSE, 0, halo_diameters);
+				glVertexAttribPointer(s_halo_size_attrib_location, 1, GL_FLOAT, GL_FALSE, 0, &m_halo_diameters[0]);
 
 				glTexEnvi(GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE);
 
@@ -661,10 +635,10 @@ namespace Helix {
 
 				glUseProgram(s_program);
 
-				glUniform2f(s_screen_dimensions_uniform, (GLfloat) view.portWidth(), (GLfloat) view.portHeight());
+				glUniform2f(s_screen_dimensions_uniform, (GLfloat) portWidth, (GLfloat) portHeight);
 
-				glVertexPointer(3, GL_FLOAT, 0, vertices);
-				glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
+				glVertexPointer(3, GL_FLOAT, 0, &m_vertices[0]);
+				glColorPointer(4, GL_UNSIGNED_BYTE, 0, &m_colors[0]);
 
 				glDrawArrays(GL_POINTS, 0, GLsizei(vertices_count));
 
@@ -676,24 +650,14 @@ namespace Helix {
 			// Render the lines
 			//
 
-			if (ToggleLocatorRender::CurrentRender & ToggleLocatorRender::kRenderPairLines) {
+			if (m_line_count > 0 && (ToggleLocatorRender::CurrentRender & ToggleLocatorRender::kRenderPairLines)) {
 				glLineWidth(BASE_CONNECTIONS_LINE_WIDTH);
 
-				glColorPointer(4, GL_UNSIGNED_BYTE, 0, line_colors);
-				glVertexPointer(3, GL_FLOAT, 0, line_vertices);
+				glColorPointer(4, GL_UNSIGNED_BYTE, 0, &m_line_colors[0]);
+				glVertexPointer(3, GL_FLOAT, 0, &m_line_vertices[0]);
 			
-				glDrawArrays(GL_LINES, 0, GLsizei(line_index));
+				glDrawArrays(GL_LINES, 0, GLsizei(m_line_count));
 			}
-
-			// Cleanup
-			//
-
-			delete vertices;
-			delete line_vertices;
-			delete line_colors;
-			delete colors;
-			delete sequence;
-			delete halo_diameters;
 		}
 
 		// Render cylinder direction arrow
@@ -806,8 +770,344 @@ namespace Helix {
 
 		glPopClientAttrib();
 		glPopAttrib();
+	}
 
-		view.endGL();
+	MStatus HelixLocator::updateBuckets() {
+		MStatus status;
+		MObjectArray selectedBases;
+
+		clearBuckets();
+
+		s_bucketsDirty = false;
+		s_bucketsEpoch = ++s_epoch;
+
+		if (!(status = Model::Base::AllSelected(selectedBases))) {
+			status.perror("Base::AllSelected");
+			return status;
+		}
+
+		/*
+		 * Nothing is rendered if the user is selecting a lot of bases
+		 */
+
+		if ((s_selectedCount = selectedBases.length()) > ToggleLocatorRender::MaxBases)
+			return MStatus::kSuccess;
+
+		handle_set_t selected, visited;
+
+		for (unsigned int i = 0; i < selectedBases.length(); ++i)
+			selected.insert(MObjectHandle(selectedBases[i]));
+
+		/*
+		 * Iterate over all bases and iterate over their strands to extract neighbour bases.
+		 * Selected bases on a strand that was already walked are skipped
+		 */
+
+		for (unsigned int i = 0; i < selectedBases.length(); ++i) {
+			if (visited.find(MObjectHandle(selectedBases[i])) != visited.end())
+				continue;
+
+			Model::Base base(selectedBases[i]);
+			Model::Strand strand(base);
+
+			Model::Strand::ForwardIterator it = strand.forward_begin();
+			for(; it != strand.forward_end(); ++it) {
+				if (!(status = addToBucket(*it, selected, visited))) {
+					status.perror("HelixLocator::addToBucket 1");
+					return status;
+				}
+			}
+
+			if (!it.loop()) {
+				for(Model::Strand::BackwardIterator bit = ++strand.reverse_begin(); bit != strand.reverse_end(); ++bit) {
+					if (!(status = addToBucket(*bit, selected, visited))) {
+						status.perror("HelixLocator::addToBucket 2");
+						return status;
+					}
+				}
+			}
+		}
+
+		return MStatus::kSuccess;
+	}
+
+	MStatus HelixLocator::addToBucket(Model::Base & base, const handle_set_t & selected, handle_set_t & visited) {
+		MStatus status;
+		MObject object(base.getObject(status));
+
+		if (!status) {
+			status.perror("Base::getObject");
+			return status;
+		}
+
+		const MObjectHandle handle(object);
+
+		if (!visited.insert(handle).second)
+			return MStatus::kSuccess;
+
+		Model::Helix helix(base.getParent(status));
+
+		if (!status) {
+			status.perror("Base::getParent");
+			return status;
+		}
+
+		MObject helix_object(helix.getObject(status));
+
+		if (!status) {
+			status.perror("Helix::getObject");
+			return status;
+		}
+
+		const MObjectHandle helix_handle(helix_object);
+		bucket_map_t::iterator it(s_buckets.find(helix_handle));
+
+		if (it == s_buckets.end()) {
+			it = s_buckets.insert(std::make_pair(helix_handle, Bucket())).first;
+			it->second.epoch = s_bucketsEpoch;
+		}
+
+		it->second.bases.push_back(handle);
+		it->second.selected.push_back(selected.find(handle) != selected.end());
+
+		/*
+		 * Moving the base or its opposite changes the buffers of the helix, connecting or disconnecting them might change the strands.
+		 * The bucket stays at the same address until clearBuckets removes the callbacks
+		 */
+
+		void *clientData = &it->second;
+
+		s_baseCallbacks.append(MNodeMessage::addAttributeChangedCallback(object, &HelixLocator::MNodeMessage_base_attributeChanged, clientData, &status));
+
+		if (!status)
+			status.perror("MNodeMessage::addAttributeChangedCallback base");
+
+		Model::Base opposite_base(base.opposite(status));
+
+		if (status) {
+			MObject opposite_object(opposite_base.getObject(status));
+
+			if (status) {
+				s_baseCallbacks.append(MNodeMessage::addAttributeChangedCallback(opposite_object, &HelixLocator::MNodeMessage_base_attributeChanged, clientData, &status));
+
+				if (!status)
+					status.perror("MNodeMessage::addAttributeChangedCallback opposite");
+			}
+		}
+
+		return MStatus::kSuccess;
+	}
+
+	void HelixLocator::clearBuckets() {
+		if (s_baseCallbacks.length() > 0) {
+			MMessage::removeCallbacks(s_baseCallbacks);
+			s_baseCallbacks.clear();
+		}
+
+		s_buckets.clear();
+		s_selectedCount = 0;
+	}
+
+	MStatus HelixLocator::updateRenderData(const Bucket *bucket) {
+		MStatus stat;
+		const size_t bases_count = bucket ? bucket->bases.size() : 0;
+		unsigned int vertex_index = 0, line_index = 0;
+
+		/*
+		 * Only grows the buffers, they're shrunk to the number of valid bases at the end
+		 */
+
+		m_vertices.resize(bases_count * 3);
+		m_line_vertices.resize(bases_count * 3 * 2);
+		m_halo_diameters.resize(bases_count);
+		m_colors.resize(bases_count * 4);
+		m_line_colors.resize(bases_count * 4 * 2);
+		m_sequence.resize(bases_count);
+		m_label_vertices.resize(bases_count * 3);
+		m_label_glyphs.resize(bases_count);
+		m_line_count = 0;
+
+		for(size_t i = 0; i < bases_count; ++i) {
+			if (!bucket->bases[i].isValid())
+				continue;
+
+			Model::Base base(bucket->bases[i].object());
+			MVector base_translation;
+			const unsigned int v = vertex_index;
+
+			/*
+			 * Translation
+			 */
+
+			if (!(stat = base.getTranslation(base_translation, MSpace::kTransform))) {
+				stat.perror("Base::getTranslation");
+				return stat;
+			}
+
+			for(int j = 0; j < 3; ++j) {
+				m_vertices[v * 3 + j] = (float) base_translation[j];
+				m_line_vertices[line_index * 3 + j] = (float) base_translation[j];
+			}
+
+			/*
+			 * Halo radius and coloring
+			 */
+
+			if (bucket->selected[i]) {
+				/*
+				 * This is a selected base
+				 */
+
+				for(int j = 0; j < 4; ++j) {
+					m_colors[v * 4 + j] = static_colors[0][j];
+					m_line_colors[line_index * 4 + j] = static_colors[0][j];
+				}
+				m_halo_diameters[v] = HALO_SELECTED_BASE_DIAMETER_MULTIPLIER;
+			}
+			else {
+				switch(base.type(stat)) {
+			
+				case Model::Base::FIVE_PRIME_END:
+					for(int j = 0; j < 4; ++j) {
+						m_colors[v * 4 + j] = static_colors[2][j];
+						m_line_colors[line_index * 4 + j] = static_colors[2][j];
+					}
+					m_halo_diameters[v] = HALO_FIVE_PRIME_BASE_DIAMETER_MULTIPLIER;
+					break;
+				case Model::Base::THREE_PRIME_END:
+					for(int j = 0; j < 4; ++j) {
+						m_colors[v * 4 + j] = static_colors[3][j];
+						m_line_colors[line_index * 4 + j] = static_colors[3][j];
+					}
+					m_halo_diameters[v] = HALO_THREE_PRIME_BASE_DIAMETER_MULTIPLIER;
+					break;
+				default:
+					for(int j = 0; j < 4; ++j) {
+						m_colors[v * 4 + j] = static_colors[1][j];
+						m_line_colors[line_index * 4 + j] = static_colors[1][j];
+					}
+					m_halo_diameters[v] = 1.0f;
+					break;
+				}
+			}
+
+			if (!stat) {
+				stat.perror("Base::type");
+				return stat;
+			}
+
+			/*
+			 * Label
+			 */
+
+			DNA::Name label;
+
+			if (!(stat = base.getLabel(label))) {
+				stat.perror("Base::getLabel");
+				return stat;
+			}
+
+			m_sequence[v] = label.toChar();
+			m_label_glyphs[v] = label_glyph(m_sequence[v]);
+
+			for(int j = 0; j < 3; ++j)
+				m_label_vertices[v * 3 + j] = m_vertices[v * 3 + j];
+
+			m_label_vertices[v * 3 + 1] += float(DNA::RADIUS * DNA::SEQUENCE_RENDERING_Y_OFFSET);
+
+			/*
+			 * Opposite base for line connection
+			 */
+
+			Model::Base opposite_base = base.opposite(stat);
+
+			if (stat) {
+				++line_index;
+
+				MVector opposite_base_translation;
+
+				if (!(stat = opposite_base.getTranslation(opposite_base_translation, MSpace::kTransform))) {
+					stat.perror("Base::getTranslation 2");
+					return stat;
+				}
+
+				for(int j = 0; j < 3; ++j)
+					m_line_vertices[line_index * 3 + j] = (float) opposite_base_translation[j];
+
+				/*
+				 * Opposite base type
+				 */
+
+				switch(opposite_base.type(stat)) {
+				case Model::Base::FIVE_PRIME_END:
+					for(int j = 0; j < 4; ++j)
+						m_line_colors[line_index * 4 + j] = static_colors[2][j];
+					break;
+				case Model::Base::THREE_PRIME_END:
+					for(int j = 0; j < 4; ++j)
+						m_line_colors[line_index * 4 + j] = static_colors[3][j];
+					break;
+				default:
+					for(int j = 0; j < 4; ++j)
+						m_line_colors[line_index * 4 + j] = static_colors[1][j];
+					break;
+				}
+
+				++line_index;
+			}
+			else if (stat != MStatus::kNotFound) {
+				stat.perror("Base::opposite");
+				return stat;
+			}
+
+			++vertex_index;
+		}
+
+		m_vertices.resize(vertex_index * 3);
+		m_halo_diameters.resize(vertex_index);
+		m_colors.resize(vertex_index * 4);
+		m_sequence.resize(vertex_index);
+		m_label_vertices.resize(vertex_index * 3);
+		m_label_glyphs.resize(vertex_index);
+		m_line_count = line_index;
+
+		return MStatus::kSuccess;
+	}
+
+	void HelixLocator::release() {
+		clearBuckets();
+
+		if (s_globalCallbacks.length() > 0) {
+			MMessage::removeCallbacks(s_globalCallbacks);
+			s_globalCallbacks.clear();
+		}
+
+		s_bucketsDirty = true;
+	}
+
+	void HelixLocator::MModelMessage_activeListModified(void *clientData) {
+		s_bucketsDirty = true;
+	}
+
+	void HelixLocator::MNodeMessage_base_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData) {
+		if (msg & (MNodeMessage::kConnectionMade | MNodeMessage::kConnectionBroken))
+			s_bucketsDirty = true;
+		else if (msg & MNodeMessage::kAttributeSet)
+			static_cast<Bucket *>(clientData)->epoch = ++s_epoch;
+	}
+
+	void HelixLocator::MDGMessage_timeChange(MTime & time, void *clientData) {
+		/*
+		 * Animated bases don't trigger any attribute changes
+		 */
+
+		for (bucket_map_t::iterator it = s_buckets.begin(); it != s_buckets.end(); ++it)
+			it->second.epoch = ++s_epoch;
+	}
+
+	void HelixLocator::MSceneMessage_beforeNewOpen(void *clientData) {
+		clearBuckets();
+		s_bucketsDirty = true;
 	}
 
 	bool HelixLocator::isBounded() const {
@@ -0,0 +1,141 @@
+#include <MeltingTemperature.h>
+
+#include <model/Base.h>
+#include <model/Helix.h>
+
+#include <maya/MArgDatabase.h>
+#include <maya/MDoubleArray.h>
+#include <maya/MGlobal.h>
+#include <maya/MSyntax.h>
+
+#include <algorithm>
+#include <list>
+#include <vector>
+
+namespace Helix {
+	MeltingTemperature::~MeltingTemperature() {
+
+	}
+
+	MStatus MeltingTemperature::doIt(const MArgList & args) {
+		MStatus status;
+		MArgDatabase argDatabase(syntax(), args, &status);
+		HMEVALUATE_RETURN_DESCRIPTION("MArgDatabase::#ctor", status);
+
+		Controller::MeltingTemperature::Conditions conditions;
+		MString filename;
+		bool domains = false;
+
+		if (argDatabase.isFlagSet("-c"))
+			HMEVALUATE_RETURN(status = argDatabase.getFlagArgument("-c", 0, conditions.strandConcentration), status);
+
+		if (argDatabase.isFlagSet("-na"))
+			HMEVALUATE_RETURN(status = argDatabase.getFlagArgument("-na", 0, conditions.sodium), status);
+
+		if (argDatabase.isFlagSet("-mg"))
+			HMEVALUATE_RETURN(status = argDatabase.getFlagArgument("-mg", 0, conditions.magnesium), status);
+
+		if (argDatabase.isFlagSet("-d"))
+			HMEVALUATE_RETURN(status = argDatabase.getFlagArgument("-d", 0, domains), status);
+
+		if (argDatabase.isFlagSet("-f"))
+			HMEVALUATE_RETURN(status = argDatabase.getFlagArgument("-f", 0, filename), status);
+
+		if (conditions.strandConcentration <= 0.0 || conditions.sodium < 0.0 || conditions.magnesium < 0.0 || conditions.sodium + conditions.magnesium <= 0.0) {
+			MGlobal::displayError("Invalid strand or salt concentrations");
+			return MStatus::kInvalidParameter;
+		}
+
+		std::list<MObject> targets;
+		status = ArgList_GetModelObjects(args, syntax(), "-b", targets);
+		if (status != MStatus::kNotFound && status != MStatus::kSuccess) {
+			HMEVALUATE_RETURN_DESCRIPTION("ArgList_GetModelObjects", status);
+		}
+
+		std::vector<Model::Strand> strands;
+
+		if (!targets.empty()) {
+			for (std::list<MObject>::const_iterator it(targets.begin()); it != targets.end(); ++it)
+				strands.push_back(Model::Strand(Model::Base(*it)));
+		} else {
+			MObjectArray objects;
+			HMEVALUATE_RETURN(status = Model::Base::AllSelected(objects), status);
+
+			strands.reserve(objects.length());
+
+			for (unsigned int i = 0; i < objects.length(); ++i)
+				strands.push_back(Model::Strand(Model::Base(objects[i])));
+
+			if (objects.length() == 0) {
+				MObjectArray helices;
+				HMEVALUATE_RETURN(status = Model::Helix::All(helices), status);
+
+				for (unsigned int i = 0; i < helices.length(); ++i) {
+					Model::Helix helix(helices[i]);
+
+					for (Model::Helix::BaseIterator it = helix.begin(); it != helix.end(); ++it)
+						strands.push_back(Model::Strand(*it));
+				}
+			}
+		}
+
+		// Strands reached through several bases are only collected once.
+		std::for_each(strands.begin(), strands.end(), m_operation.execute());
+		HMEVALUATE_RETURN_DESCRIPTION("MeltingTemperature::execute", m_operation.status());
+
+		m_operation.calculate(conditions);
+
+		if (filename.length() > 0)
+			HMEVALUATE_RETURN(status = m_operation.write(filename), status);
+
+		MDoubleArray result;
+
+		if (domains) {
+			const std::vector<Controller::MeltingTemperature::Domain> & domains(m_operation.getDomains());
+			for (std::vector<Controller::MeltingTemperature::Domain>::const_iterator it = domains.begin(); it != domains.end(); ++it)
+				result.append(it->result.meltingTemperature);
+		} else {
+			const std::vector<Controller::MeltingTemperature::Strand> & strands(m_operation.getStrands());
+			for (std::vector<Controller::MeltingTemperature::Strand>::const_iterator it = strands.begin(); it != strands.end(); ++it)
+				result.append(it->maxDomainMeltingTemperature);
+		}
+
+		setResult(result);
+
+		return MStatus::kSuccess;
+	}
+
+	MStatus MeltingTemperature::undoIt() {
+		return MStatus::kSuccess;
+	}
+
+	MStatus MeltingTemperature::redoIt() {
+		return MStatus::kSuccess;
+	}
+
+	bool MeltingTemperature::isUndoable() const {
+		return false;
+	}
+
+	bool MeltingTemperature::hasSyntax() const {
+		return true;
+	}
+
+	MSyntax MeltingTemperature::newSyntax() {
+		MSyntax syntax;
+		syntax.addFlag("-b", "-base", MSyntax::kString);
+		syntax.makeFlagMultiUse("-b");
+
+		syntax.addFlag("-c", "-concentration", MSyntax::kDouble);
+		syntax.addFlag("-na", "-sodium", MSyntax::kDouble);
+		syntax.addFlag("-mg", "-magnesium", MSyntax::kDouble);
+		syntax.addFlag("-d", "-domains", MSyntax::kBoolean);
+		syntax.addFlag("-f", "-file", MSyntax::kString);
+
+		return syntax;
+	}
+
+	void *MeltingTemperature::creator() {
+		return new MeltingTemperature();
+	}
+}
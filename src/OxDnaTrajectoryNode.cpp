@@ -0,0 +1,137 @@
+#include <OxDnaTrajectoryNode.h>
+
+#include <Utility.h>
+
+#include <maya/MArrayDataBuilder.h>
+#include <maya/MArrayDataHandle.h>
+#include <maya/MDataBlock.h>
+#include <maya/MDataHandle.h>
+#include <maya/MFnIntArrayData.h>
+#include <maya/MFnMatrixAttribute.h>
+#include <maya/MFnNumericAttribute.h>
+#include <maya/MFnTypedAttribute.h>
+#include <maya/MFnUnitAttribute.h>
+#include <maya/MIntArray.h>
+#include <maya/MMatrix.h>
+#include <maya/MPoint.h>
+#include <maya/MTime.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Helix {
+	MTypeId OxDnaTrajectoryNode::id(HELIX_OXDNA_TRAJECTORY_NODE_ID);
+	MObject OxDnaTrajectoryNode::aTime, OxDnaTrajectoryNode::aFile, OxDnaTrajectoryNode::aStartFrame, OxDnaTrajectoryNode::aHelixInverseMatrix, OxDnaTrajectoryNode::aBaseHelix, OxDnaTrajectoryNode::aTranslation;
+
+	MStatus OxDnaTrajectoryNode::compute(const MPlug & plug, MDataBlock & data) {
+		MStatus status;
+		MPlug outputPlug(plug);
+
+		if (outputPlug.isChild())
+			outputPlug = outputPlug.parent();
+
+		if (outputPlug.isElement())
+			outputPlug = outputPlug.array();
+
+		if (outputPlug != aTranslation)
+			return MStatus::kUnknownParameter;
+
+		const MString file(data.inputValue(aFile).asString());
+		const MTime time(data.inputValue(aTime).asTime());
+		const int startFrame = data.inputValue(aStartFrame).asInt();
+
+		/*
+		 * The trajectory is only reopened and indexed when the file changes, scrubbing only reads the requested frame.
+		 * A file that failed to open is not retried until the file attribute changes.
+		 */
+
+		if (m_filename != file.asChar()) {
+			m_filename = file.asChar();
+
+			if (file.length() > 0) {
+				HMEVALUATE(status = m_trajectory.open(file.asChar()), status);
+			}
+			else
+				m_trajectory.close();
+		}
+
+		MArrayDataHandle outputHandle(data.outputArrayValue(aTranslation));
+		MArrayDataBuilder builder(outputHandle.builder());
+
+		if (m_trajectory.isOpen()) {
+			const long frame = std::max(0L, std::min(long(m_trajectory.numFrames()) - 1, long(floor(time.as(MTime::uiUnit()) + 0.5)) - startFrame));
+			HMEVALUATE_RETURN(status = m_trajectory.readFrame(size_t(frame), m_positions), status);
+
+			MFnIntArrayData baseHelixData(data.inputValue(aBaseHelix).data());
+			const MIntArray baseHelix(baseHelixData.array());
+
+			std::vector<MMatrix> helixInverseMatrices;
+			MArrayDataHandle helixInverseMatrixHandle(data.inputArrayValue(aHelixInverseMatrix));
+
+			for (unsigned int i = 0; i < helixInverseMatrixHandle.elementCount(); ++i, helixInverseMatrixHandle.next()) {
+				const unsigned int index = helixInverseMatrixHandle.elementIndex();
+
+				if (index >= helixInverseMatrices.size())
+					helixInverseMatrices.resize(index + 1);
+
+				helixInverseMatrices[index] = helixInverseMatrixHandle.inputValue().asMatrix();
+			}
+
+			for (unsigned int i = 0; i < m_positions.size(); ++i) {
+				MPoint translation(m_positions[i]);
+
+				if (i < baseHelix.length() && baseHelix[i] >= 0 && size_t(baseHelix[i]) < helixInverseMatrices.size())
+					translation *= helixInverseMatrices[baseHelix[i]];
+
+				MDataHandle elementHandle(builder.addElement(i, &status));
+				HMEVALUATE_RETURN_DESCRIPTION("MArrayDataBuilder::addElement", status);
+				elementHandle.set3Double(translation.x, translation.y, translation.z);
+			}
+		}
+
+		HMEVALUATE_RETURN(status = outputHandle.set(builder), status);
+		HMEVALUATE_RETURN(status = outputHandle.setAllClean(), status);
+		data.setClean(plug);
+
+		return MStatus::kSuccess;
+	}
+
+	void *OxDnaTrajectoryNode::creator() {
+		return new OxDnaTrajectoryNode();
+	}
+
+	MStatus OxDnaTrajectoryNode::initialize() {
+		MStatus status;
+		MFnUnitAttribute timeAttr;
+		MFnTypedAttribute fileAttr, baseHelixAttr;
+		MFnNumericAttribute startFrameAttr, translationAttr;
+		MFnMatrixAttribute helixInverseMatrixAttr;
+
+		HMEVALUATE_RETURN(aTime = timeAttr.create("time", "tm", MFnUnitAttribute::kTime, 0.0, &status), status);
+		HMEVALUATE_RETURN(aFile = fileAttr.create("file", "f", MFnData::kString, MObject::kNullObj, &status), status);
+		HMEVALUATE_RETURN(aStartFrame = startFrameAttr.create("startFrame", "sf", MFnNumericData::kLong, 1, &status), status);
+		HMEVALUATE_RETURN(aHelixInverseMatrix = helixInverseMatrixAttr.create("helixInverseMatrix", "him", MFnMatrixAttribute::kDouble, &status), status);
+		HMEVALUATE_RETURN(status = helixInverseMatrixAttr.setArray(true), status);
+		HMEVALUATE_RETURN(aBaseHelix = baseHelixAttr.create("baseHelix", "bh", MFnData::kIntArray, MObject::kNullObj, &status), status);
+
+		HMEVALUATE_RETURN(aTranslation = translationAttr.create("translation", "tr", MFnNumericData::k3Double, 0.0, &status), status);
+		HMEVALUATE_RETURN(status = translationAttr.setArray(true), status);
+		HMEVALUATE_RETURN(status = translationAttr.setUsesArrayDataBuilder(true), status);
+		HMEVALUATE_RETURN(status = translationAttr.setWritable(false), status);
+		HMEVALUATE_RETURN(status = translationAttr.setStorable(false), status);
+
+		MObject *inputs[] = { &aTime, &aFile, &aStartFrame, &aHelixInverseMatrix, &aBaseHelix };
+
+		for (size_t i = 0; i < sizeof(inputs) / sizeof(*inputs); ++i) {
+			HMEVALUATE_RETURN(status = addAttribute(*inputs[i]), status);
+		}
+
+		HMEVALUATE_RETURN(status = addAttribute(aTranslation), status);
+
+		for (size_t i = 0; i < sizeof(inputs) / sizeof(*inputs); ++i) {
+			HMEVALUATE_RETURN(status = attributeAffects(*inputs[i], aTranslation), status);
+		}
+
+		return MStatus::kSuccess;
+	}
+}
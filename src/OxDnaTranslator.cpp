@@ -17,7 +17,15 @@
 #include <functional>
 #include <limits>
 
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_set>
+#else
+#include <tr1/unordered_set>
+#endif /* N Windows */
+
+#include <maya/MObjectHandle.h>
 #include <maya/MProgressWindow.h>
+#include <maya/MStringArray.h>
 
 namespace Helix {
 	/*
@@ -56,8 +64,8 @@ namespace Helix {
 			if (!MProgressWindow::reserve())
 				MGlobal::displayWarning("Failed to reserve the progress window");
 
-			MProgressWindow::setTitle("oxDNA Exporter");
-			MProgressWindow::setProgressStatus("Writing strands...");
+			MProgressWindow::setTitle("oxDNA Importer");
+			MProgressWindow::setProgressStatus("Reading files...");
 			MProgressWindow::setProgressRange(0, count);
 			MProgressWindow::startProgress();
 		}
@@ -97,15 +105,21 @@ namespace Helix {
 				maxTranslation(-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity());
 
 		// Since a strand is defined by any base along it, the same strand will be obtained multiple times if we don't track them.
-		// This is pretty slow but, since it is only run once it should be ok.
+		// Every base of a found strand is marked as visited, thus every strand is only walked once.
 		std::list<Model::Strand> strands;
+#if defined(WIN32) || defined(WIN64)
+		std::unordered_set<MObjectHandle, ObjectHandleHash> visited;
+#else
+		std::tr1::unordered_set<MObjectHandle, ObjectHandleHash> visited;
+#endif /* N Windows */
 
 		for (unsigned int i = 0; i < helices.length(); ++i) {
 			Model::Helix helix(helices[i]);
 
 			for (Model::Helix::BaseIterator it = helix.begin(); it != helix.end(); ++it) {
+				Model::Base base(*it);
 				MVector translation;
-				HMEVALUATE_RETURN(status = it->getTranslation(translation, MSpace::kWorld), status);
+				HMEVALUATE_RETURN(status = base.getTranslation(translation, MSpace::kWorld), status);
 
 				minTranslation.x = std::min(minTranslation.x, translation.x);
 				minTranslation.y = std::min(minTranslation.y, translation.y);
@@ -115,8 +129,18 @@ namespace Helix {
 				maxTranslation.y = std::max(maxTranslation.y, translation.y);
 				maxTranslation.z = std::max(maxTranslation.z, translation.z);
 
-				if (std::find_if(strands.begin(), strands.end(), std::bind2nd(std::ptr_fun(&Model::Strand::Contains_base), *it)) == strands.end())
-					strands.push_back(*it);
+				if (visited.find(MObjectHandle(base.getObject(status))) != visited.end())
+					continue;
+
+				Model::Strand strand(base);
+
+				for (Model::Strand::ForwardIterator sit = strand.forward_begin(); sit != strand.forward_end(); ++sit)
+					visited.insert(MObjectHandle(sit->getObject(status)));
+
+				for (Model::Strand::BackwardIterator sit = strand.reverse_begin(); sit != strand.reverse_end(); ++sit)
+					visited.insert(MObjectHandle(sit->getObject(status)));
+
+				strands.push_back(strand);
 			}
 
 			MProgressWindow::advanceProgress(1);
@@ -129,7 +153,7 @@ namespace Helix {
 
 		MProgressWindow::setTitle("oxDNA Exporter");
 		MProgressWindow::setProgressStatus("Writing strands...");
-		MProgressWindow::setProgressRange(0, helices.length());
+		MProgressWindow::setProgressRange(0, int(strands.size()));
 		MProgressWindow::startProgress();
 
 		OxDnaExporterWithAdvanceProgress exporter;
@@ -140,11 +164,23 @@ namespace Helix {
 		if (!exporter.status())
 			return exporter.status();
 
+		int binary = 0;
+		MStringArray options_array;
+		optionsString.split(';', options_array);
+		for (unsigned int i = 0; i < options_array.length(); ++i)
+			sscanf(options_array[i].asChar(), "binary=%d", &binary);
+
 		MString top_filename, conf_filename, vhelix_filename;
 		get_filenames(file, top_filename, conf_filename, vhelix_filename);
 
+		if (binary) {
+			const MString stripped_filename(vhelix_filename.asChar(), vhelix_filename.length() - int(strlen(HELIX_OXDNA_VHELIX_FILE_TYPE)));
+			conf_filename = stripped_filename + HELIX_OXDNA_BINARY_CONF_FILE_TYPE;
+			top_filename = stripped_filename + HELIX_OXDNA_BINARY_TOP_FILE_TYPE;
+		}
+
 		HMEVALUATE_RETURN(status = exporter.write(
-				top_filename.asChar(), conf_filename.asChar(), vhelix_filename.asChar(), minTranslation, maxTranslation), status);
+				top_filename.asChar(), conf_filename.asChar(), vhelix_filename.asChar(), minTranslation, maxTranslation, binary != 0), status);
 
 		return status;
 	}
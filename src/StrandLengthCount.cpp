@@ -2,6 +2,11 @@
 
 #include <model/Base.h>
 
+#include <DNA.h>
+
+#include <maya/MArgDatabase.h>
+#include <maya/MGlobal.h>
+#include <maya/MIntArray.h>
 #include <maya/MSyntax.h>
 
 namespace Helix {
@@ -10,8 +15,15 @@ namespace Helix {
 	}
 
 	MStatus StrandLengthCount::doIt(const MArgList & args) {
+		MStatus status;
+		MArgDatabase argDatabase(syntax(), args, &status);
+		HMEVALUATE_RETURN_DESCRIPTION("MArgDatabase::#ctor", status);
+
+		if (argDatabase.isFlagSet("-hi"))
+			return histogram();
+
 		std::list<MObject> targets;
-		MStatus status = ArgList_GetModelObjects(args, syntax(), "-b", targets);
+		status = ArgList_GetModelObjects(args, syntax(), "-b", targets);
 		if (status != MStatus::kNotFound && status != MStatus::kSuccess) {
 			HMEVALUATE_RETURN_DESCRIPTION("ArgList_GetModelObjects", status);
 		}
@@ -39,6 +51,27 @@ namespace Helix {
 		return MStatus::kSuccess;
 	}
 
+	MStatus StrandLengthCount::histogram() {
+		MStatus status;
+		Controller::StrandLengthCount::Histogram histogram;
+
+		HMEVALUATE_RETURN(status = m_operation.histogram(histogram), status);
+
+		MGlobal::displayInfo(MString("") + histogram.strands + " strands with " + (unsigned int) histogram.bases + " bases. Length min: " + histogram.minLength + ", max: " + histogram.maxLength + ", mean: " + histogram.mean);
+		MGlobal::displayInfo(MString("") + histogram.tooShort + " strands are shorter than " + DNA::SHORTEST_STAPLE + " bases and " + histogram.tooLong + " strands are longer than " + DNA::SHORTEST_LONGEST_STAPLE + " bases.");
+
+		for (unsigned int length = 0; length < histogram.counts.size(); ++length) {
+			if (histogram.counts[length] > 0)
+				MGlobal::displayInfo(MString("") + length + ": " + histogram.counts[length]);
+		}
+
+		// The result is the number of strands indexed by their length.
+		clearResult();
+		setResult(MIntArray((const int *) (histogram.counts.empty() ? NULL : &histogram.counts[0]), (unsigned int) histogram.counts.size()));
+
+		return MStatus::kSuccess;
+	}
+
 	MStatus StrandLengthCount::undoIt() {
 		return MStatus::kSuccess;
 	}
@@ -59,6 +92,7 @@ namespace Helix {
 		MSyntax syntax;
 		syntax.addFlag("-b", "-base", MSyntax::kString);
 		syntax.makeFlagMultiUse("-b");
+		syntax.addFlag("-hi", "-histogram", MSyntax::kNoArg);
 
 		return syntax;
 	}
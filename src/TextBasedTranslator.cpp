@@ -1,6 +1,8 @@
 #include <TextBasedTranslator.h>
 
+#include <controller/TextBasedExporter.h>
 #include <controller/TextBasedImporter.h>
+#include <model/Helix.h>
 
 namespace Helix {
 	MStatus TextBasedTranslator::reader(const MFileObject& file, const MString & options, MPxFileTranslator::FileAccessMode mode) {
@@ -21,10 +23,34 @@ namespace Helix {
 		return MStatus::kSuccess;
 	}
 
+	MStatus TextBasedTranslator::writer(const MFileObject& file, const MString & options, MPxFileTranslator::FileAccessMode mode) {
+		MStatus status;
+		MObjectArray helices;
+
+		if (mode == MPxFileTranslator::kExportActiveAccessMode)
+			HMEVALUATE_RETURN(status = Model::Helix::AllSelected(helices), status);
+
+		if (helices.length() == 0)
+			HMEVALUATE_RETURN(status = Model::Helix::All(helices), status);
+
+		if (helices.length() == 0) {
+			MGlobal::displayError("Nothing to export. Aborting...");
+			return MStatus::kSuccess;
+		}
+
+		Controller::TextBasedExporter exporter;
+		HMEVALUATE_RETURN(status = exporter.write(file.fullName().asChar(), helices), status);
+		return MStatus::kSuccess;
+	}
+
 	bool TextBasedTranslator::haveReadMethod() const {
 		return true;
 	}
 
+	bool TextBasedTranslator::haveWriteMethod() const {
+		return true;
+	}
+
 	bool TextBasedTranslator::canBeOpened() const {
 		return true;
 	}
@@ -22,14 +22,15 @@
 
 #define VIEW_BASES "base"
 #define VIEW_CYLINDERS "cylinder"
-#define TOGGLE_VIEWS	VIEW_BASES, VIEW_CYLINDERS
+#define VIEW_AUTOMATIC "automatic"
+#define TOGGLE_VIEWS	VIEW_BASES, VIEW_CYLINDERS, VIEW_AUTOMATIC
 //#define TOGGLE_VIEW_FLAGS { { true, false }, { false, true } }
 
 
 namespace Helix {
 	int ToggleCylinderBaseView::CurrentView = 0;
 
-	ToggleCylinderBaseView::ToggleCylinderBaseView() {
+	ToggleCylinderBaseView::ToggleCylinderBaseView() : m_viewChanged(false), m_previousView(TOGGLECYLINDERBASEVIEW_BASES) {
 
 	}
 
@@ -46,12 +47,14 @@ namespace Helix {
 
 		if (targets.empty()) {
 			if (_toggle) {
+				m_previousView = ToggleCylinderBaseView::CurrentView;
 				ToggleCylinderBaseView::CurrentView = (ToggleCylinderBaseView::CurrentView + 1) % 2;
-				m_toggled = true;
+				m_viewChanged = true;
 			}
 
 			/*
 			 * Iterate over all helices and set HelixShape and HelixBaseShape visibility dependent on CurrentView
+			 * In the automatic view both are visible and the level of detail decides what is drawn
 			 */
 
 			if (_toggle || refresh) {
@@ -83,13 +86,13 @@ namespace Helix {
 						return status;
 					}
 
-					if (!(status = helix.setShapesVisibility(CurrentView == 1))) {
+					if (!(status = helix.setShapesVisibility(CurrentView != TOGGLECYLINDERBASEVIEW_BASES))) {
 						status.perror("Helix::setShapesVisibility");
 						return status;
 					}
 
 					for(Model::Helix::BaseIterator it = helix.begin(); it != helix.end(); ++it) {
-						if (!(status = it->setShapesVisibility(CurrentView == 0))) {
+						if (!(status = it->setShapesVisibility(CurrentView != TOGGLECYLINDERBASEVIEW_CYLINDERS))) {
 							status.perror("Base::setShapesVisibility");
 							return status;
 						}
@@ -105,13 +108,13 @@ namespace Helix {
 			for (std::list<MObject>::iterator it = targets.begin(); it != targets.end(); ++it) {
 				Model::Helix helix(*it);
 
-				if (!(status = helix.setShapesVisibility(CurrentView == 1))) {
+				if (!(status = helix.setShapesVisibility(CurrentView != TOGGLECYLINDERBASEVIEW_BASES))) {
 					status.perror("Helix::toggleShapesVisibility");
 					return status;
 				}
 
 				for (Model::Helix::BaseIterator bit = helix.begin(); bit != helix.end(); ++bit) {
-					if (!(status = bit->setShapesVisibility(CurrentView == 0))) {
+					if (!(status = bit->setShapesVisibility(CurrentView != TOGGLECYLINDERBASEVIEW_CYLINDERS))) {
 						status.perror("Base::toggleShapesVisibility");
 						return status;
 					}
@@ -168,12 +171,34 @@ namespace Helix {
 			}
 		}
 
+		m_toggleTargets.clear();
+
+		if (argDatabase.isFlagSet("-a", &status)) {
+			bool automatic;
+
+			if (!(status = argDatabase.getFlagArgument("-a", 0, automatic))) {
+				status.perror("MArgDatabase::getFlagArgument 3");
+				return status;
+			}
+
+			m_viewChanged = true;
+			m_previousView = CurrentView;
+			CurrentView = automatic ? TOGGLECYLINDERBASEVIEW_AUTOMATIC : TOGGLECYLINDERBASEVIEW_BASES;
+
+			if (!(status = toggle(false, true, m_toggleTargets))) {
+				status.perror("Toggle");
+				return status;
+			}
+
+			setResult(toggleViewNames[ToggleCylinderBaseView::CurrentView]);
+
+			return MStatus::kSuccess;
+		}
+
 		/*
 		 * Look for targets either as `-base` or selected nodes
 		 */
 
-		m_toggleTargets.clear();
-
 		std::cerr << "GetModelObjects by -b argument" << std::endl;
 		if (!(status = ArgList_GetModelObjects(args, syntax(), "-b", m_toggleTargets))) {
 			if (status != MStatus::kNotFound) {
@@ -232,12 +257,22 @@ namespace Helix {
 		return MStatus::kSuccess;
 	}
 
+	/*
+	 * The view that was replaced is restored as it was, toggling again would turn the automatic view into the bases
+	 */
+
 	MStatus ToggleCylinderBaseView::undoIt () {
-		return toggle(m_toggled, true, m_toggleTargets);
+		if (m_viewChanged)
+			std::swap(CurrentView, m_previousView);
+
+		return toggle(false, true, m_toggleTargets);
 	}
 
 	MStatus ToggleCylinderBaseView::redoIt () {
-		return toggle(m_toggled, true, m_toggleTargets);
+		if (m_viewChanged)
+			std::swap(CurrentView, m_previousView);
+
+		return toggle(false, true, m_toggleTargets);
 	}
 
 	bool ToggleCylinderBaseView::isUndoable () const {
@@ -253,6 +288,7 @@ namespace Helix {
 
 		syntax.addFlag("-t", "-toggle", MSyntax::kBoolean);
 		syntax.addFlag("-r", "-refresh", MSyntax::kBoolean);
+		syntax.addFlag("-a", "-automatic", MSyntax::kBoolean);
 		
 		syntax.addFlag("-b", "-base", MSyntax::kString);
 		syntax.makeFlagMultiUse("-b");
@@ -1,46 +1,84 @@
 #include <controller/ApplySequence.h>
 
+#include <HelixBase.h>
+
 #include <DNA.h>
 
+#include <maya/MPlug.h>
+#include <maya/MPlugArray.h>
+
 namespace Helix {
 	namespace Controller {
-		MStatus ApplySequence::doExecute(Model::Base & element) {
-			if (m_sequence_index < m_sequence.length()) {
-				MStatus status;
+		MStatus ApplySequence::add(Model::Strand & strand, const char *sequence, size_t length) {
+			MStatus status;
+			size_t index = 0;
 
-				char char_name = m_sequence.asChar()[m_sequence_index++];
+			for (Model::Strand::ForwardIterator it = strand.forward_begin(); it != strand.forward_end() && index < length; ++it, ++index) {
+				Entry entry;
+				HMEVALUATE_RETURN(entry.node = it->getObject(status), status);
 
-				DNA::Name name(char_name), previous_name;
+				DNA::Name label(sequence[index]);
+				MPlug labelPlug(entry.node, ::Helix::HelixBase::aLabel);
 
-				if (!(status = element.getLabel(previous_name))) {
-					status.perror("Base::getLabel");
-					return status;
-				}
+				/*
+				 * Same as Base::setLabel, the destination of a label connection is read only and the opposite label is set on the source.
+				 */
 
-				if (!(status = element.setLabel(name))) {
-					status.perror("Base::setLabel");
-					return status;
+				if (labelPlug.isDestination(&status)) {
+					MPlugArray sources;
+
+					if (!labelPlug.connectedTo(sources, true, false, &status) || sources.length() == 0) {
+						HMEVALUATE_DESCRIPTION("MPlug::connectedTo", status);
+						return MStatus::kFailure;
+					}
+
+					entry.node = sources[0].node();
+					labelPlug = sources[0];
+					label = label.opposite();
 				}
 
-				saveUndoRedo(element, name, previous_name);
+				entry.label = (char) DNA::Value_fromChar(label.toChar());
+
+#ifdef APPLYSEQUENCE_MODIFIER
+				HMEVALUATE_RETURN(status = m_modifier.newPlugValueInt(labelPlug, entry.label), status);
+#else
+				int previous;
+				HMEVALUATE_RETURN(status = labelPlug.getValue(previous), status);
+
+				entry.previous = (char) previous;
+#endif /* N APPLYSEQUENCE_MODIFIER */
+
+				m_entries.push_back(entry);
 			}
 
 			return MStatus::kSuccess;
 		}
 
-		MStatus ApplySequence::doUndo(Model::Base & element, DNA::Name & undoData) {
+		MStatus ApplySequence::apply() {
 			MStatus status;
 
-			if (!(status = element.setLabel(undoData))) {
-				status.perror("Base::setLabel");
-				return status;
-			}
+#ifdef APPLYSEQUENCE_MODIFIER
+			HMEVALUATE_RETURN(status = m_modifier.doIt(), status);
+#else
+			for (std::vector<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+				HMEVALUATE_RETURN(status = MPlug(it->node, ::Helix::HelixBase::aLabel).setInt(it->label), status);
+#endif /* N APPLYSEQUENCE_MODIFIER */
 
 			return MStatus::kSuccess;
 		}
 
-		MStatus ApplySequence::doRedo(Model::Base & element, DNA::Name & redoData) {
-			return doUndo(element, redoData);
+		MStatus ApplySequence::undo() {
+			MStatus status;
+
+#ifdef APPLYSEQUENCE_MODIFIER
+			HMEVALUATE_RETURN(status = m_modifier.undoIt(), status);
+#else
+			// In reverse, a base queued several times gets its original label back.
+			for (std::vector<Entry>::reverse_iterator it = m_entries.rbegin(); it != m_entries.rend(); ++it)
+				HMEVALUATE_RETURN(status = MPlug(it->node, ::Helix::HelixBase::aLabel).setInt(it->previous), status);
+#endif /* N APPLYSEQUENCE_MODIFIER */
+
+			return MStatus::kSuccess;
 		}
 	}
 }
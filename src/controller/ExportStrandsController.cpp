@@ -1,113 +1,139 @@
 #include <controller/ExportStrands.h>
+#include <controller/FileWriter.h>
 
-#include <fstream>
-#include <iterator>
+#include <algorithm>
+
+#include <maya/MFnDagNode.h>
+#include <maya/MObjectHandle.h>
 
 namespace Helix {
 	namespace Controller {
-		char g_separator;
+		MStatus ExportStrands::write(const MString & filename, ExportStrands::Mode mode) {
+			MStatus status;
+			FileWriter file;
+			HMEVALUATE_RETURN(status = file.open(filename.asChar()), status);
 
-		/*
-		 * Makes the export method really clean
-		 */
+			const char separator = mode == COMMA_SEPARATED ? ',' : (mode == COLON_SEPARATED ? ';' : '\t');
 
-		std::ostream & operator<<(std::ostream & stream, const ExportStrands::Data & data) {
-			stream << data.strand_name.asChar() << g_separator << data.sequence.asChar();
+			if (mode != FASTA)
+				file << "Name" << separator << "Sequence" << separator << "Length" << separator << "5' helix" << separator << "5' base" << separator << "3' helix" << separator << "3' base" << '\n';
 
-			return stream;
-		}
+			for (std::vector<Data>::const_iterator it = m_export_data.begin(); it != m_export_data.end(); ++it) {
+				if (mode == FASTA) {
+					file << '>' << it->strand_name.asChar() << " length=" << (unsigned long) it->length
+						 << " 5'=" << it->fivePrime.helix.asChar() << ':' << it->fivePrime.base.asChar()
+						 << " 3'=" << it->threePrime.helix.asChar() << ':' << it->threePrime.base.asChar() << '\n';
 
-		MStatus ExportStrands::write(const MString & filename, ExportStrands::Mode mode) {
-			g_separator = mode == COMMA_SEPARATED ? ',' : ';';
+					if (it->length > 0)
+						file.write(&m_sequences[it->offset], it->length);
 
-			std::ofstream file(filename.asChar(), std::ios_base::out);
+					file << '\n';
+				} else {
+					file << it->strand_name.asChar() << separator;
 
-			if (!file.good())
-				return MStatus::kFailure;
+					if (it->length > 0)
+						file.write(&m_sequences[it->offset], it->length);
 
-			std::copy(m_export_data.begin(), m_export_data.end(), std::ostream_iterator<ExportStrands::Data>(file, "\n"));
+					file << separator << (unsigned long) it->length
+						 << separator << it->fivePrime.helix.asChar() << separator << it->fivePrime.base.asChar()
+						 << separator << it->threePrime.helix.asChar() << separator << it->threePrime.base.asChar() << '\n';
+				}
+			}
 
-			file.close();
+			HMEVALUATE_RETURN(status = file.close(), status);
 
 			return MStatus::kSuccess;
 		}
 
-		MStatus ExportStrands::doExecute(Model::Strand & element) {
-			/*
-			 * Figure out if this strand is a loop or not by iterating backwards to the end.
-			 * If that is a loop just name it the name of the base, if not use the end bases
-			 */
-			
+		MStatus ExportStrands::visit(Model::Base & base) {
 			MStatus status;
-			Data data;
+			DNA::Name label;
+			MObject object;
 
-			std::cerr << "Working on Strand defined by base: " << element.getDefiningBase().getDagPath(status).fullPathName().asChar() << std::endl;
+			HMEVALUATE_RETURN(status = base.getLabel(label), status);
+			HMEVALUATE_RETURN(object = base.getObject(status), status);
 
-			Model::Strand::BackwardIterator it = element.reverse_begin(), last_it = it;
-			for(; it != element.reverse_end(); ++it) {
-				last_it = it;
-			}
+			m_sequences.push_back(label.toChar());
+			m_visited.insert(MObjectHandle(object));
 
-			if (it.loop()) {
-				std::cerr << "This strand has a loop" << std::endl;
+			return MStatus::kSuccess;
+		}
 
-				MDagPath base_dagPath = element.getDefiningBase().getDagPath(status);
+		MStatus ExportStrands::getEnd(Model::Base & base, End & end) {
+			MStatus status;
+			MObject object, parent;
 
-				if (!status) {
-					status.perror("Base::getDagPath");
-					return status;
-				}
+			HMEVALUATE_RETURN(object = base.getObject(status), status);
+			MFnDagNode base_dagNode(object);
 
-				data.strand_name = base_dagPath.fullPathName();
-			}
+			HMEVALUATE_RETURN(end.base = base_dagNode.name(&status), status);
+			HMEVALUATE_RETURN(parent = base_dagNode.parent(0, &status), status);
+			HMEVALUATE_RETURN(end.helix = MFnDagNode(parent).name(&status), status);
 
-			std::cerr << "After reverse iterating, the first base is: " << last_it->getDagPath(status).fullPathName().asChar() << std::endl;
+			return MStatus::kSuccess;
+		}
+
+		MStatus ExportStrands::doExecute(Model::Strand & element) {
+			MStatus status;
+			Model::Base definingBase(element.getDefiningBase());
+			MObject definingObject;
+
+			HMEVALUATE_RETURN(definingObject = definingBase.getObject(status), status);
+
+			if (m_visited.find(MObjectHandle(definingObject)) != m_visited.end()) {
+				// Already exported through another base of the same strand.
+				onProgressStep();
+				return MStatus::kSuccess;
+			}
 
 			/*
-			 * Iterate forward and collect all the base labels
+			 * Walk backwards from the defining base to the 5' end, or a complete lap if this strand is a loop.
+			 * Then, if not a loop, continue forward from the defining base to the 3' end. Every base is thus visited once.
 			 */
 
-			Model::Strand::ForwardIterator f_it = Model::Strand(*last_it).forward_begin(), last_f_it = f_it;
-			for(; f_it != element.forward_end(); ++f_it) {
-				DNA::Name label;
-
-				if (!(status = f_it->getLabel(label))) {
-					status.perror("Base::getLabel 1");
-					return status;
-				}
+			Data data;
+			data.offset = m_sequences.size();
 
-				char char_label = label.toChar();
-				data.sequence += MString(&char_label, 1);
+			Model::Base fivePrime(definingBase), threePrime(definingBase);
 
-				last_f_it = f_it;
+			Model::Strand::BackwardIterator it = element.reverse_begin();
+			for (; it != element.reverse_end(); ++it) {
+				HMEVALUATE_RETURN(status = visit(*it), status);
+				fivePrime = *it;
 			}
 
-			std::cerr << "After forward iteration, f_it references: " << last_f_it->getDagPath(status).fullPathName().asChar() << std::endl;
-
-			if (!f_it.loop()) {
-				/*
-				 * Since it wasn't a loop, it points to the first element in the strand while f_it should point to the last
-				 */
+			// The labels were collected from 3' to 5'.
+			std::reverse(m_sequences.begin() + data.offset, m_sequences.end());
 
-				std::cerr << "Forward isn't a loop either" << std::endl;
+			if (it.loop()) {
+				// Start the sequence at the defining base, which is now the last one.
+				std::rotate(m_sequences.begin() + data.offset, m_sequences.end() - 1, m_sequences.end());
 
-				MDagPath first_base_dagPath = last_it->getDagPath(status);
+				fivePrime = definingBase;
+				HMEVALUATE_RETURN(threePrime = definingBase.backward(status), status);
 
-				if (!status) {
-					status.perror("Base::getDagPath 1");
-					return status;
+				MDagPath base_dagPath;
+				HMEVALUATE_RETURN(base_dagPath = definingBase.getDagPath(status), status);
+				data.strand_name = base_dagPath.fullPathName();
+			} else {
+				Model::Strand::ForwardIterator f_it = element.forward_begin();
+				for (++f_it; f_it != element.forward_end(); ++f_it) {
+					HMEVALUATE_RETURN(status = visit(*f_it), status);
+					threePrime = *f_it;
 				}
 
-				MDagPath last_base_dagPath = last_f_it->getDagPath(status);
-
-				if (!status) {
-					status.perror("Base::getDagPath 2");
-					return status;
-				}
+				MDagPath first_base_dagPath, last_base_dagPath;
+				HMEVALUATE_RETURN(first_base_dagPath = fivePrime.getDagPath(status), status);
+				HMEVALUATE_RETURN(last_base_dagPath = threePrime.getDagPath(status), status);
 
 				data.strand_name = first_base_dagPath.fullPathName() + " -> " + last_base_dagPath.fullPathName();
 			}
 
+			data.length = m_sequences.size() - data.offset;
+
+			HMEVALUATE_RETURN(status = getEnd(fivePrime, data.fivePrime), status);
+			HMEVALUATE_RETURN(status = getEnd(threePrime, data.threePrime), status);
+
 			m_export_data.push_back(data);
 
 			onProgressStep();
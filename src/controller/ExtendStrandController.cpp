@@ -2,69 +2,46 @@
 #include <model/Helix.h>
 
 #include <maya/MFnDagNode.h>
+#include <maya/MObjectHandle.h>
 #include <Utility.h>
 
-#include <functional>
+#include <algorithm>
+#include <cmath>
 
 namespace Helix {
 	namespace Controller {
-		MStatus ExtendStrand::doExecute(Model::Base & element) {
+		MStatus ExtendStrand::add(Model::Base & element) {
 			/*
 			 * There are two cases to consider here:
 			 * - the base has no opposite base, or the opposite base has no connection in the direction (z-axis, not strand direction) we're extracting
 			 *		just extend our strand
 			 * - the base has an opposite base *and* it has a single stranded extension
 			 *		extend our strand but connect each new base to the opposite equivalent base
+			 * The opposite base might also be selected for extension, in which case the new bases are paired with its new bases.
 			 */
 
 			MStatus status;
 
-			onProgressBegin(m_length);
-
-			MDagPath element_dagPath = element.getDagPath(status);
-
-			if (!status) {
-				status.perror("Base::getDagPath");
-				return status;
-			}
-
-			MString element_name = MFnDagNode(element_dagPath).name(&status);
-
-			if (!status) {
-				status.perror("MFnDagNode::name");
-				return status;
+			if (!m_materialsQueried) {
+				HMEVALUATE_RETURN(status = m_materials.query(), status);
+				m_materialsQueried = true;
 			}
 
-			/*
-			 * Figure out the bases translation. We add to this in order to create the rotation for the following bases
-			 */
-
-			MVector translation;
-
-			if (!(status = element.getTranslation(translation, MSpace::kTransform))) {
-				status.perror("Base::getTranslation");
-				return status;
-			}
-
-			double angle = atan2(translation.y, translation.x);
-
-			/*
-			 * This is for the undo process, we track all the newly created bases so we're able to delete them in case of an undo
-			 */
+			MObject element_object;
+			HMEVALUATE_RETURN(element_object = element.getObject(status), status);
 
-			std::vector<Model::Base> created_bases;
-			created_bases.reserve(m_length);
+			const MObjectHandle handle(element_object);
 
-			/*
-			 * This looks a bit messy, but in order to save some space not duplicating the code for the two different directional cases (extending backward or forward)
-			 * we use member pointers
-			 */
+			if (m_elementIndices.find(handle) != m_elementIndices.end())
+				return MStatus::kSuccess;
 
-			Model::Base (Model::Base::* target_backward) (MStatus &);
+			Extension extension;
+			extension.element = element;
+			extension.pairWith = -1;
+			extension.isDestinationForOpposite = false;
 
-			bool hasForward, hasBackward, extendForward, extendPositiveZ;
-			double direction;
-			unsigned int positive_count = 0, negative_count = 0;
+			HMEVALUATE_RETURN(extension.name = MFnDagNode(element_object).name(&status), status);
+			HMEVALUATE_RETURN(status = element.getTranslation(extension.translation, MSpace::kTransform), status);
 
 			Model::Base forward_base = element.forward(status);
 
@@ -73,7 +50,7 @@ namespace Helix {
 				return status;
 			}
 
-			hasForward = status != MStatus::kNotFound;
+			const bool hasForward = status != MStatus::kNotFound;
 
 			Model::Base backward_base = element.backward(status);
 
@@ -82,79 +59,44 @@ namespace Helix {
 				return status;
 			}
 
-			hasBackward = status != MStatus::kNotFound;
-
-			/*
-			 * Now, depending on wether we have hasForward or hasBackward, decide upon the direction of extension
-			 */
-
-			if (!hasForward && hasBackward) {
-				// We have no forward, extend forward
-
-				//target_forward = &Model::Base::forward;
-				target_backward = &Model::Base::backward;
-				extendForward = true;
-
-				/*
-				 * Figure out what direction using the z-axis distance between this base and its backward base
-				 */
-
-				MVector backward_base_translation;
-				
-				if (!(status = backward_base.getTranslation(backward_base_translation, MSpace::kTransform))) {
-					status.perror("Base::getTranslation 1");
-					return status;
-				}
-
-				int sign = sgn(translation.z - backward_base_translation.z);
-				direction = (double) sign;
-				extendPositiveZ = sign > 0;
-			}
-			else if (hasForward && !hasBackward) {
-				// We already have a forward connection but no backward, extend backward
-				//target_forward = &Model::Base::backward;
-				target_backward = &Model::Base::forward;
-				extendForward = false;
-
-				/*
-				 * Figure out what direction using the z-axis distance between this base and its backward base
-				 */
-
-				MVector forward_base_translation;
-				
-				if (!(status = forward_base.getTranslation(forward_base_translation, MSpace::kTransform))) {
-					status.perror("Base::getTranslation 2");
-					return status;
-				}
-
-				int sign = sgn(translation.z - forward_base_translation.z);
-				direction = (double) sign;
+			const bool hasBackward = status != MStatus::kNotFound;
 
-				extendPositiveZ = sign > 0;
-			}
-			else {
+			if (hasForward == hasBackward) {
 				/*
 				 * Doesn't make sense, the user is trying to extend a base that is already occupied
 				 * or he is trying to extend on a single base. We can't do that because we can't figure out what direction to take
 				 *	in theory we could just choose any direction, but if the base does in fact have an opposite base, we might mess up the structure
 				 */
-				
 
 				if (hasForward && hasBackward)
 					MGlobal::displayWarning(MString("Ignoring base ") + element.getDagPath(status).fullPathName() + " since it is not and end base");
 				else
 					MGlobal::displayWarning(MString("Ignoring base ") + element.getDagPath(status).fullPathName() + " since it has no forward or backward connection it is not possible to choose a proper direction and rotation to extend along");
 
-				onProgressDone();
-
 				return MStatus::kSuccess;
 			}
 
 			/*
-			 * Figure out if the current base has an opposite base and if it already has a connection in the direction we're extending
+			 * Extend where there is no connection, in the direction along the z-axis away from the connected base.
 			 */
 
-			bool hasOppositeStrand = false, isDestinationForOpposite;
+			extension.extendForward = !hasForward;
+
+			MVector connected_translation;
+			HMEVALUATE_RETURN(status = (hasForward ? forward_base : backward_base).getTranslation(connected_translation, MSpace::kTransform), status);
+
+			extension.direction = (double) sgn(extension.translation.z - connected_translation.z);
+
+			Model::Base (Model::Base::* target_backward) (MStatus &) = extension.extendForward ? &Model::Base::backward : &Model::Base::forward;
+
+			HMEVALUATE_RETURN(extension.helix = element.getParent(status), status);
+
+			m_materials.find(element_object, extension.material);
+
+			/*
+			 * Figure out if the current base has an opposite base and if it already has a connection in the direction we're extending.
+			 * The opposite strand can be shorter than the number of bases we're going to extend.
+			 */
 
 			Model::Base opposite_base = element.opposite(status);
 
@@ -164,244 +106,178 @@ namespace Helix {
 			}
 
 			if (status != MStatus::kNotFound) {
-				(opposite_base.*target_backward) (status);
+				HMEVALUATE_RETURN(extension.isDestinationForOpposite = element.opposite_isDestination(status), status);
 
-				if (!status && status != MStatus::kNotFound) {
-					status.perror("Base::*target_forward");
-					return status;
-				}
+				MObject opposite_object;
+				HMEVALUATE_RETURN(opposite_object = opposite_base.getObject(status), status);
 
-				if (status) {
-					/*
-					 * The opposite base has connections in the desired direction. They must be taken into account
-					 */
+#if defined(WIN32) || defined(WIN64)
+				std::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash>::const_iterator opposite_it(m_elementIndices.find(MObjectHandle(opposite_object)));
+#else
+				std::tr1::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash>::const_iterator opposite_it(m_elementIndices.find(MObjectHandle(opposite_object)));
+#endif /* N Windows */
 
-					hasOppositeStrand = true;
+				if (opposite_it != m_elementIndices.end() && m_extensions[opposite_it->second].direction == extension.direction) {
+					// The opposite base is extended as well.
+					extension.pairWith = int(opposite_it->second);
+				} else {
+					Model::Base previous_opposite(opposite_base);
+					extension.opposites.reserve(m_length);
 
-					std::cerr << "Has opposite base" << std::endl;
+					for (unsigned int i = 0; i < m_length; ++i) {
+						Model::Base opposite = (previous_opposite.*target_backward) (status);
 
-					isDestinationForOpposite = element.opposite_isDestination(status);
+						if (status == MStatus::kNotFound)
+							break;
+
+						if (!status) {
+							status.perror("Base::*target_backward");
+							return status;
+						}
 
-					if (!status) {
-						status.perror("Base::opposite_isDestination");
-						return status;
+						Model::Helix opposite_base_helix;
+						HMEVALUATE_RETURN(opposite_base_helix = opposite.getParent(status), status);
+
+						if (!(extension.helix == opposite_base_helix))
+							break;
+
+						extension.opposites.push_back(opposite);
+						previous_opposite = opposite;
 					}
 				}
 			}
 
-			/*
-			 * Setup material handling
-			 */
+			m_elementIndices.insert(std::make_pair(handle, (unsigned int) m_extensions.size()));
+			m_extensions.push_back(extension);
 
-			Model::Material material;
-
-			if (!(status = element.getMaterial(material)))
-				status.perror("Base::getMaterial");
+			return MStatus::kSuccess;
+		}
 
-			/*
-			 * Find the helix this base belongs to
-			 */
+		MStatus ExtendStrand::create() {
+			MStatus status;
 
-			Model::Helix helix = element.getParent(status);
+			onProgressBegin(int(m_extensions.size()));
 
-			if (!status) {
-				status.perror("Base::getParent");
-				return status;
-			}
+			m_batch.reserve(m_extensions.size() * (m_length + 1));
 
 			/*
-			 * Now finally extend the strand
-			 * Note: Whenever we extend and there is no opposite base to attach to, even though hasOppositeStrand is set
-			 *	we must add to the *_count variables as we're extending the total length of the helix.
-			 *  note that the opposite strand, if it exist, can be shorter than the number we're going to extend
-			 *  thus getting the opposite can fail even though hasOppositeStrand is true
+			 * The new bases of an extension are added consecutively, thus the new base i of extension k is firstIndices[k] + i.
 			 */
 
-			Model::Base previous_base = element, previous_opposite = opposite_base;
-
-			for(unsigned int i = 0; i < m_length; ++i) {
-				/*
-				 * Create the new base and position it
-				 */
-
-				MVector new_translation(DNA::ONE_MINUS_SPHERE_RADIUS * cos(angle - direction * (i + 1) * toRadians(-DNA::PITCH)),
-						DNA::ONE_MINUS_SPHERE_RADIUS * sin(angle - direction * (i + 1) * toRadians(-DNA::PITCH)),
-						translation.z + direction * (i + 1) * DNA::STEP);
-
-				Model::Base base;
-
-				MString name = element_name + "_extend_" + (i + 1);
-
-				if (!(status = Model::Base::Create(helix, name, new_translation, base))) {
-					status.perror("Base::Create");
-					return status;
-				}
-
-				/*
-				 * Setup material
-				 */
+			std::vector<unsigned int> firstIndices(m_extensions.size(), 0);
 
-				if (!(status = base.setMaterial(material))) {
-					status.perror("Base::setMaterial");
-					return status;
-				}
+			for (size_t k = 0; k < m_extensions.size(); ++k) {
+				Extension & extension(m_extensions[k]);
 
 				/*
-				 * Connect the base to the previous one
+				 * The bases are rotated by DNA::PITCH around the helix axis per step. Instead of evaluating sin and cos for every base,
+				 * the position is rotated incrementally.
 				 */
 
-				if (extendForward) {
-					if (!(status = previous_base.connect_forward(base, true))) {
-						status.perror("Base::connect_forward 1");
-						return status;
-					}
-				}
-				else {
-					if (!(status = base.connect_forward(previous_base, true))) {
-						status.perror("Base::connect_forward 2");
-						return status;
-					}
-				}
+				const double angle = atan2(extension.translation.y, extension.translation.x), step = extension.direction * toRadians(DNA::PITCH);
+				const double cos_step = cos(step), sin_step = sin(step);
+				double x = DNA::ONE_MINUS_SPHERE_RADIUS * cos(angle), y = DNA::ONE_MINUS_SPHERE_RADIUS * sin(angle);
 
-				if (hasOppositeStrand) {
-					/*
-					 * Find the opposite base if exists (using previous_opposite) and connect to it, use the isDestinationForOpposite to decide on the direction
-					 */
+				unsigned int previous = m_batch.add(extension.element);
 
-					std::cerr << "Connecting to opposite" << std::endl;
+				for (unsigned int i = 0; i < m_length; ++i) {
+					const double next_x = x * cos_step - y * sin_step;
+					y = x * sin_step + y * cos_step;
+					x = next_x;
 
-					Model::Base opposite = (previous_opposite.*target_backward) (status);
+					const unsigned int current = m_batch.add(extension.helix, extension.name + "_extend_" + (i + 1), MVector(x, y, extension.translation.z + extension.direction * (i + 1) * DNA::STEP), extension.material);
 
-					if (!status && status != MStatus::kNotFound) {
-						status.perror("Base::*target_backward");
-						return status;
-					}
+					if (i == 0)
+						firstIndices[k] = current;
 
-					if (status) {
-						/*
-						 * The opposite base exists, connect to it
-						 */
+					if (extension.extendForward)
+						m_batch.connect_forward(previous, current);
+					else
+						m_batch.connect_forward(current, previous);
 
-						Model::Helix opposite_base_helix = opposite.getParent(status);
+					int opposite = -1;
 
-						if (!status) {
-							status.perror("Base::getParent");
-							return status;
-						}
+					if (extension.pairWith != -1)
+						opposite = int(firstIndices[extension.pairWith] + i);
+					else if (i < extension.opposites.size())
+						opposite = int(m_batch.add(extension.opposites[i]));
 
-						if (helix == opposite_base_helix) {
-							if (isDestinationForOpposite) {
-								if (!(status = opposite.connect_opposite(base, true))) {
-									status.perror("Base::connect_opposite 1");
-									return status;
-								}
-							}
-							else {
-								if (!(status = base.connect_opposite(opposite, true))) {
-									status.perror("Base::connect_opposite 2");
-									return status;
-								}
-							}
-						}
+					if (opposite != -1) {
+						if (extension.isDestinationForOpposite)
+							m_batch.connect_opposite((unsigned int) opposite, current);
 						else
-							hasOppositeStrand = false;
+							m_batch.connect_opposite(current, (unsigned int) opposite);
 					}
-					else {
-						/*
-						 * There is no opposite base anymore, to make sure further iterations in the loop don't try again, set hasOppositeStrand = false
-						 */
 
-						hasOppositeStrand = false;
-					}
-					
-					previous_opposite = opposite;
+					previous = current;
 				}
-				else {
 
-					/*
-					 * Since we're extending along a direction in which there does not seem to be any bases further away,
-					 *	we are extending the total length of the helix. It is important to track these changes as it requires us to
-					 *	rescale the cylinder
-					 */
+				/*
+				 * Bases that are not paired extend the total length of the helix. It is important to track these changes as it requires us to
+				 * rescale the cylinder. Several strands extended at the same end of a helix only extend it by the longest extension.
+				 */
 
-					if (extendPositiveZ)
-						++positive_count;
-					else
-						++negative_count;
-				}
+				if (extension.pairWith == -1 && extension.opposites.size() < m_length) {
+					const unsigned int count = m_length - (unsigned int) extension.opposites.size();
+					const MObjectHandle helixHandle(extension.helix.getObject(status));
 
-				previous_base = base;
+#if defined(WIN32) || defined(WIN64)
+					std::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash>::iterator helix_it(m_helixIndices.find(helixHandle));
+#else
+					std::tr1::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash>::iterator helix_it(m_helixIndices.find(helixHandle));
+#endif /* N Windows */
+
+					if (helix_it == m_helixIndices.end()) {
+						helix_it = m_helixIndices.insert(std::make_pair(helixHandle, (unsigned int) m_modified_helices.size())).first;
+						m_modified_helices.push_back(ModifiedHelix(extension.helix));
+					}
 
-				created_bases.push_back(base);
+					ModifiedHelix & modified_helix(m_modified_helices[helix_it->second]);
+					unsigned int & modified_count(extension.direction > 0 ? modified_helix.positive_count : modified_helix.negative_count);
+					modified_count = std::max(modified_count, count);
+				}
 
 				onProgressStep();
 			}
 
-			double previous_origo, previous_height;
-
-			if (!(status = helix.getCylinderRange(previous_origo, previous_height))) {
-				status.perror("Helix::getCylinderRange");
-				return status;
-			}
+			HMEVALUATE_RETURN(status = m_batch.create(), status);
 
-			double new_height = previous_height + (positive_count + negative_count) * DNA::STEP;
-			double new_origo = previous_origo + (new_height - previous_height) / 2.0 - negative_count * DNA::STEP;
+			for (std::vector<ModifiedHelix>::iterator it = m_modified_helices.begin(); it != m_modified_helices.end(); ++it) {
+				HMEVALUATE_RETURN(status = it->helix.getCylinderRange(it->previous.origo, it->previous.height), status);
 
-			if (!(status = helix.setCylinderRange(new_origo, new_height)))
-				status.perror("Helix::setCylinderRange");
+				it->next.height = it->previous.height + (it->positive_count + it->negative_count) * DNA::STEP;
+				it->next.origo = it->previous.origo + (it->next.height - it->previous.height) / 2.0 - it->negative_count * DNA::STEP;
 
-			saveUndoRedo(element, created_bases);
-			m_modified_helices.push_front(std::make_pair(helix, Range(previous_origo, previous_height)));
+				HMEVALUATE(status = it->helix.setCylinderRange(it->next.origo, it->next.height), status);
+			}
 
 			onProgressDone();
 
 			return MStatus::kSuccess;
 		}
 
-		MStatus ExtendStrand::doUndo(Model::Base & element, std::vector<Model::Base> & undoData) {
+		MStatus ExtendStrand::undo() {
 			MStatus status;
 
-			/*
-			 * Erase all the bases
-			 */
-
-			std::for_each(undoData.begin(), undoData.end(), std::mem_fun_ref(&Model::Base::deleteNode));
-
-			/*
-			 * Find the helix this base belongs to
-			 */
+			HMEVALUATE_RETURN(status = m_batch.undo(), status);
 
-			Model::Helix helix = element.getParent(status);
+			for (std::vector<ModifiedHelix>::iterator it = m_modified_helices.begin(); it != m_modified_helices.end(); ++it)
+				HMEVALUATE_RETURN(status = it->helix.setCylinderRange(it->previous.origo, it->previous.height), status);
 
-			if (!status) {
-				status.perror("Base::getParent");
-				return status;
-			}
-
-			/*
-			 * Setup cylinders
-			 */
+			return MStatus::kSuccess;
+		}
 
-			for(std::list< std::pair<Model::Helix, Range> >::iterator it = m_modified_helices.begin(); it != m_modified_helices.end(); ++it) {
-				if (!(status = it->first.setCylinderRange(it->second.origo, it->second.height))) {
-					status.perror("Helix::setCylinderRange");
-					return status;
-				}
-			}
+		MStatus ExtendStrand::redo() {
+			MStatus status;
 
-			/*
-			 * Because redo will add to them again
-			 */
+			HMEVALUATE_RETURN(status = m_batch.redo(), status);
 
-			m_modified_helices.clear();
+			for (std::vector<ModifiedHelix>::iterator it = m_modified_helices.begin(); it != m_modified_helices.end(); ++it)
+				HMEVALUATE_RETURN(status = it->helix.setCylinderRange(it->next.origo, it->next.height), status);
 
 			return MStatus::kSuccess;
 		}
 
-		MStatus ExtendStrand::doRedo(Model::Base & element, Empty & redoData) {
-			return doExecute(element);
-		}
-
 		void ExtendStrand::onProgressBegin(int range) {
 
 		}
@@ -0,0 +1,164 @@
+#include <controller/FileWriter.h>
+
+#include <maya/MGlobal.h>
+#include <maya/MString.h>
+
+#include <cmath>
+
+#define WRITE_BUFFER_SIZE (1 << 20)
+
+/*
+ * Number of decimals written, and the largest magnitude written as fixed point. Larger values, infinity and NaN fall back to snprintf.
+ */
+#define DECIMALS 6
+#define DECIMALS_SCALE 1000000.0
+#define MAX_FIXED_VALUE 4.0e9
+
+namespace Helix {
+	namespace Controller {
+		FileWriter::FileWriter() : m_file(NULL), m_buffer(WRITE_BUFFER_SIZE), m_size(0), m_failed(false) {
+
+		}
+
+		FileWriter::~FileWriter() {
+			close();
+		}
+
+		MStatus FileWriter::open(const char *filename, bool binary) {
+			close();
+
+			if (!(m_file = std::fopen(filename, binary ? "wb" : "w"))) {
+				MGlobal::displayError(MString("Can't open file \"") + filename + "\" for writing.");
+				return MStatus::kFailure;
+			}
+
+			m_filename = filename;
+			m_size = 0;
+			m_failed = false;
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus FileWriter::close() {
+			if (!m_file)
+				return MStatus::kSuccess;
+
+			flush();
+
+			if (std::fclose(m_file) != 0)
+				m_failed = true;
+
+			m_file = NULL;
+
+			if (m_failed) {
+				MGlobal::displayError(MString("Failed to write to file \"") + m_filename.c_str() + "\".");
+				return MStatus::kFailure;
+			}
+
+			return MStatus::kSuccess;
+		}
+
+		void FileWriter::flush() {
+			if (m_size > 0 && m_file && std::fwrite(&m_buffer[0], 1, m_size, m_file) != m_size)
+				m_failed = true;
+
+			m_size = 0;
+		}
+
+		FileWriter & FileWriter::write(const char *data, size_t size) {
+			if (size > m_buffer.size()) {
+				flush();
+
+				if (m_file && std::fwrite(data, 1, size, m_file) != size)
+					m_failed = true;
+
+				return *this;
+			}
+
+			reserve(size);
+			memcpy(&m_buffer[m_size], data, size);
+			m_size += size;
+
+			return *this;
+		}
+
+		FileWriter & FileWriter::writeInteger(bool negative, unsigned long value) {
+			char digits[24];
+			char *it = digits + sizeof(digits);
+
+			do {
+				*--it = char('0' + value % 10);
+				value /= 10;
+			} while (value > 0);
+
+			if (negative)
+				*--it = '-';
+
+			return write(it, digits + sizeof(digits) - it);
+		}
+
+		FileWriter & FileWriter::operator<<(double value) {
+			char digits[64];
+
+			if (!(std::fabs(value) < MAX_FIXED_VALUE)) {
+				const int length = sprintf(digits, "%.10g", value);
+				return write(digits, length > 0 ? size_t(length) : 0);
+			}
+
+			const bool negative = value < 0;
+			const double rounded = std::floor(std::fabs(value) * DECIMALS_SCALE + 0.5);
+			unsigned long integer = (unsigned long) std::floor(rounded / DECIMALS_SCALE);
+			unsigned long fraction = (unsigned long) (rounded - double(integer) * DECIMALS_SCALE);
+
+			char *end = digits + sizeof(digits), *it = end;
+
+			/*
+			 * Fraction without trailing zeros.
+			 */
+			int decimals = DECIMALS;
+			while (decimals > 0 && fraction % 10 == 0) {
+				fraction /= 10;
+				--decimals;
+			}
+
+			if (decimals > 0) {
+				for (int i = 0; i < decimals; ++i) {
+					*--it = char('0' + fraction % 10);
+					fraction /= 10;
+				}
+
+				*--it = '.';
+			}
+
+			do {
+				*--it = char('0' + integer % 10);
+				integer /= 10;
+			} while (integer > 0);
+
+			if (negative && (it[0] != '0' || it + 1 != end))
+				*--it = '-';
+
+			return write(it, end - it);
+		}
+
+		FileWriter & FileWriter::writeUInt32(unsigned int value) {
+			reserve(4);
+
+			for (int i = 0; i < 4; ++i)
+				m_buffer[m_size++] = char((value >> (i * 8)) & 0xFF);
+
+			return *this;
+		}
+
+		FileWriter & FileWriter::writeInt32(int value) {
+			return writeUInt32((unsigned int) value);
+		}
+
+		FileWriter & FileWriter::writeFloat(float value) {
+			unsigned int bits;
+			memcpy(&bits, &value, sizeof(bits));
+
+			return writeUInt32(bits);
+		}
+	}
+}
@@ -7,26 +7,35 @@
 #include <Helix.h>
 #include <HelixBase.h>
 
+#include <maya/MFnDagNode.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MPlug.h>
 #include <maya/MProgressWindow.h>
 
+#include <string>
+
 namespace Helix {
 	namespace Controller {
-		MStatus FillStrandGaps::redo() {
-			unsigned int num_added_bases(0);
+		MStatus FillStrandGaps::plan() {
 			MStatus status;
+			Model::Material::Assignments materials;
+			std::vector<Gap> gaps;
+
+			HMEVALUATE_RETURN(status = materials.query(), status);
 
 			if (!MProgressWindow::reserve())
 				MGlobal::displayWarning("Failed to reserve the progress window");
 
 			MProgressWindow::setTitle("Auto fill strand gaps");
 			MProgressWindow::setProgressStatus("Filling strand gaps by linear interpolation...");
-			MProgressWindow::setProgressRange(0, int(redoable.size()));
+			MProgressWindow::setProgressRange(0, int(m_gaps.size()));
 			MProgressWindow::startProgress();
 
-			for (std::vector<Redoable>::iterator it(redoable.begin()); it != redoable.end(); ++it) {
+			m_numAddedBases = 0;
+			gaps.reserve(m_gaps.size());
 
-				MString base_name(it->start.getDagPath(status).partialPathName());
-				HMEVALUATE_RETURN_DESCRIPTION("Model::Base::getDagPath", status);
+			for (std::vector<Gap>::iterator it(m_gaps.begin()); it != m_gaps.end(); ++it) {
+				MProgressWindow::advanceProgress(1);
 
 				MVector forward_translation, base_translation;
 				HMEVALUATE_RETURN(status = it->start.getTranslation(base_translation, MSpace::kWorld), status);
@@ -34,37 +43,102 @@ namespace Helix {
 				MVector direction(forward_translation - base_translation);
 				const double length(direction.length());
 				int num_additional_bases(int(length / DNA::SINGLE_STRAND_STEP));
+
+				if (num_additional_bases <= 1)
+					continue;
+
 				direction.normalize();
 				direction *= length / num_additional_bases;
 				--num_additional_bases;
-				MVector position;
-				Model::Base previous(it->start);
+
+				MObject start_object;
+				HMEVALUATE_RETURN(start_object = it->start.getObject(status), status);
+
+				const MString base_name(MFnDagNode(start_object).name(&status));
+				HMEVALUATE_RETURN_DESCRIPTION("MFnDagNode::name", status);
+
 				Model::Material material;
-				HMEVALUATE_RETURN(status = previous.getMaterial(material), status);
-
-				if (num_additional_bases > 0) {
-					previously_connected.push_back(std::make_pair(it->start, it->end));
-
-					for (int i = 0; i < num_additional_bases;) {
-						position = base_translation + direction * ++i;
-						Model::Base current;
-						HMEVALUATE_RETURN(status = Model::Base::Create(it->helix, base_name, position, current, MSpace::kWorld), status);
-						undoable.push_back(current);
-						HMEVALUATE(status = current.setMaterial(material), status);
-						HMEVALUATE_RETURN(status = previous.connect_forward(current), status);
-						previous = current;
-						++num_added_bases;
-					}
-
-					HMEVALUATE_RETURN(status = previous.connect_forward(it->end), status);
+				materials.find(start_object, material);
+
+				unsigned int previous(m_batch.add(it->start));
+
+				for (int i = 0; i < num_additional_bases;) {
+					const unsigned int current(m_batch.add(it->helix, base_name, base_translation + direction * ++i, material, DNA::Invalid, MSpace::kWorld));
+					m_batch.connect_forward(previous, current);
+					previous = current;
 				}
 
-				MProgressWindow::advanceProgress(1);
+				m_batch.connect_forward(previous, m_batch.add(it->end));
+				m_numAddedBases += (unsigned int) num_additional_bases;
+
+				gaps.push_back(*it);
 			}
 
 			MProgressWindow::endProgress();
 
-			HPRINT("Added %u bases.", num_added_bases);
+			m_gaps.swap(gaps);
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus FillStrandGaps::disconnect() {
+			MStatus status;
+
+			for (std::vector<Gap>::iterator it(m_gaps.begin()); it != m_gaps.end(); ++it) {
+				MPlug forwardPlug(it->start.getObject(status), ::Helix::HelixBase::aForward), backwardPlug(it->end.getObject(status), ::Helix::HelixBase::aBackward);
+				HMEVALUATE_RETURN(status = m_dgModifier.disconnect(backwardPlug, forwardPlug), status);
+			}
+
+			return redo_disconnect();
+		}
+
+		MStatus FillStrandGaps::redo_disconnect() {
+			MStatus status;
+			std::string command;
+
+			// Same as Base::disconnect_forward, the new aim constraints are created by the batch.
+			for (std::vector<Gap>::iterator it(m_gaps.begin()); it != m_gaps.end(); ++it) {
+				MDagPath start_dagPath;
+				HMEVALUATE_RETURN(start_dagPath = it->start.getDagPath(status), status);
+
+				const MString path(start_dagPath.fullPathName());
+				command += std::string("delete -cn ") + path.asChar() + "; setAttr " + path.asChar() + ".rotate 0 0 0;\n";
+				HMEVALUATE_RETURN(status = Model::BaseBatch::ExecuteCommand(command), status);
+			}
+
+			HMEVALUATE_RETURN(status = Model::BaseBatch::ExecuteCommand(command, true), status);
+			HMEVALUATE_RETURN(status = m_dgModifier.doIt(), status);
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus FillStrandGaps::undo() {
+			MStatus status;
+			std::string command;
+
+			HMEVALUATE_RETURN(status = m_batch.undo(), status);
+			HMEVALUATE_RETURN(status = m_dgModifier.undoIt(), status);
+
+			// Restore the aim constraints of the previous connections, see Base::connect_forward.
+			for (std::vector<Gap>::iterator it(m_gaps.begin()); it != m_gaps.end(); ++it) {
+				MDagPath start_dagPath, end_dagPath;
+				HMEVALUATE_RETURN(start_dagPath = it->start.getDagPath(status), status);
+				HMEVALUATE_RETURN(end_dagPath = it->end.getDagPath(status), status);
+
+				command += std::string("aimConstraint -aimVector 0 0 -1.0 ") + end_dagPath.fullPathName().asChar() + " " + start_dagPath.fullPathName().asChar() + ";\n";
+				HMEVALUATE_RETURN(status = Model::BaseBatch::ExecuteCommand(command), status);
+			}
+
+			HMEVALUATE_RETURN(status = Model::BaseBatch::ExecuteCommand(command, true), status);
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus FillStrandGaps::redo() {
+			MStatus status;
+
+			HMEVALUATE_RETURN(status = redo_disconnect(), status);
+			HMEVALUATE_RETURN(status = m_batch.redo(), status);
 
 			return MStatus::kSuccess;
 		}
@@ -78,17 +152,19 @@ namespace Helix {
 				// Iterate over bases of the helix and look for gaps between its child bases.
 				Model::Helix helix(object);
 				for (Model::Helix::BaseIterator it(helix.begin()); it != helix.end(); ++it)
-					fill_base(*it);
+					HMEVALUATE_RETURN(status = fill_base(*it), status);
 			} else if (typeId == ::Helix::HelixBase::id) {
 				// Iterate over bases in the strand and look for gaps between its child bases.
-				Model::Strand start_strand(object);
-				Model::Base first_base;
-				for (Model::Strand::BackwardIterator it(start_strand.reverse_begin()); it != start_strand.reverse_end(); ++it)
-					first_base = *it;
-				Model::Strand strand(first_base);
-
-				for (Model::Strand::ForwardIterator it(strand.forward_begin()); it != strand.forward_end(); ++it)
-					fill_base(*it);
+				Model::Strand strand(object);
+				Model::Strand::BackwardIterator it(strand.reverse_begin());
+				for (; it != strand.reverse_end(); ++it)
+					HMEVALUATE_RETURN(status = fill_base(*it), status);
+
+				if (!it.loop()) {
+					Model::Strand::ForwardIterator f_it(strand.forward_begin());
+					for (++f_it; f_it != strand.forward_end(); ++f_it)
+						HMEVALUATE_RETURN(status = fill_base(*f_it), status);
+				}
 			}
 
 			return MStatus::kSuccess;
@@ -96,16 +172,23 @@ namespace Helix {
 
 		MStatus FillStrandGaps::fill_base(Model::Base & base) {
 			MStatus status;
-			Model::Helix helix(base.getParent(status));
-			HMEVALUATE_RETURN_DESCRIPTION("Model::Base::getParent", status);
-			
+			MObject object;
+			HMEVALUATE_RETURN(object = base.getObject(status), status);
+
+			// Bases can be reached both through their helix and their strand.
+			if (!m_visited.insert(MObjectHandle(object)).second)
+				return MStatus::kSuccess;
+
 			Model::Base forward(base.forward(status));
 
 			if (status == MStatus::kNotFound)
 				return MStatus::kSuccess;
 			HMEVALUATE_RETURN_DESCRIPTION("Model::Base::forward", status);
 
-			redoable.push_back(Redoable(base, forward, helix));
+			Model::Helix helix(base.getParent(status));
+			HMEVALUATE_RETURN_DESCRIPTION("Model::Base::getParent", status);
+
+			m_gaps.push_back(Gap(base, forward, helix));
 
 			return MStatus::kSuccess;
 		}
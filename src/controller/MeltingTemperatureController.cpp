@@ -0,0 +1,312 @@
+#include <controller/MeltingTemperature.h>
+#include <controller/FileWriter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <maya/MFnDagNode.h>
+#include <maya/MObjectHandle.h>
+
+#define GAS_CONSTANT 1.987 // cal/(K mol)
+#define KELVIN 273.15
+#define UNPAIRED ((unsigned int) -1)
+
+namespace Helix {
+	namespace Controller {
+		/*
+		 * Nearest-neighbor enthalpies (kcal/mol) and entropies (cal/(K mol)) indexed by the DNA::Values of the 5'-XY-3' dinucleotide.
+		 */
+		const double MeltingTemperature_enthalpy[DNA::BASES][DNA::BASES] = {
+				/*   A      T      G      C */
+				{ -7.9,  -7.2,  -7.8,  -8.4 }, // A
+				{ -7.2,  -7.9,  -8.5,  -8.2 }, // T
+				{ -8.2,  -8.4,  -8.0,  -9.8 }, // G
+				{ -8.5,  -7.8, -10.6,  -8.0 }  // C
+		};
+
+		const double MeltingTemperature_entropy[DNA::BASES][DNA::BASES] = {
+				/*   A       T       G       C */
+				{ -22.2,  -20.4,  -21.0,  -22.4 }, // A
+				{ -21.3,  -22.2,  -22.7,  -22.2 }, // T
+				{ -22.2,  -22.4,  -19.9,  -24.4 }, // G
+				{ -22.7,  -21.0,  -27.2,  -19.9 }  // C
+		};
+
+		/*
+		 * Initiation with a terminal A/T or G/C pair, and the symmetry correction for self-complementary sequences.
+		 */
+		const double MeltingTemperature_initiationEnthalpy[] = { 2.3, 2.3, 0.1, 0.1 },
+					 MeltingTemperature_initiationEntropy[] = { 4.1, 4.1, -2.8, -2.8 },
+					 MeltingTemperature_symmetryEntropy = -1.4;
+
+		void MeltingTemperature::Calculate(const unsigned char *sequences, const size_t *offsets, const size_t *lengths, size_t count, const Conditions & conditions, Result *results) {
+			const double nan = std::numeric_limits<double>::quiet_NaN();
+			const double sodium = (conditions.sodium + 120.0 * std::sqrt(conditions.magnesium)) / 1000.0; // M
+			const double saltEntropy = 0.368 * std::log(sodium);
+			const double concentration = conditions.strandConcentration * 1.0e-9; // M
+
+			for (size_t i = 0; i < count; ++i) {
+				const unsigned char *sequence = sequences + offsets[i];
+				const size_t length = lengths[i];
+				Result & result(results[i]);
+
+				double enthalpy = 0.0, entropy = 0.0;
+				size_t gc = 0;
+				bool valid = length >= 2, symmetric = length % 2 == 0;
+
+				for (size_t j = 0; j < length; ++j) {
+					const unsigned char value = sequence[j];
+
+					if (value >= DNA::BASES) {
+						valid = false;
+						break;
+					}
+
+					gc += value >= DNA::G;
+
+					if (j + 1 < length && sequence[j + 1] < DNA::BASES) {
+						enthalpy += MeltingTemperature_enthalpy[value][sequence[j + 1]];
+						entropy += MeltingTemperature_entropy[value][sequence[j + 1]];
+					}
+
+					// The complement of a value is obtained by flipping the lowest bit (A <-> T, G <-> C).
+					symmetric = symmetric && value == (sequence[length - 1 - j] ^ 1);
+				}
+
+				result.gcContent = length > 0 && valid ? double(gc) / double(length) : nan;
+
+				if (!valid) {
+					result.enthalpy = result.entropy = result.freeEnergy = result.meltingTemperature = nan;
+					continue;
+				}
+
+				enthalpy += MeltingTemperature_initiationEnthalpy[sequence[0]] + MeltingTemperature_initiationEnthalpy[sequence[length - 1]];
+				entropy += MeltingTemperature_initiationEntropy[sequence[0]] + MeltingTemperature_initiationEntropy[sequence[length - 1]];
+				entropy += saltEntropy * double(length - 1);
+
+				if (symmetric)
+					entropy += MeltingTemperature_symmetryEntropy;
+
+				result.enthalpy = enthalpy;
+				result.entropy = entropy;
+				result.freeEnergy = enthalpy - (37.0 + KELVIN) * entropy / 1000.0;
+				result.meltingTemperature = 1000.0 * enthalpy / (entropy + GAS_CONSTANT * std::log(symmetric ? concentration : concentration / 4.0)) - KELVIN;
+			}
+		}
+
+		void MeltingTemperature::calculate(const Conditions & conditions) {
+			if (m_sequences.empty())
+				return;
+
+			/*
+			 * Gather all ranges, strands first then domains, to evaluate them all at once.
+			 */
+
+			const size_t count = m_strands.size() + m_domains.size();
+			std::vector<size_t> offsets(count), lengths(count);
+			std::vector<Result> results(count);
+
+			for (size_t i = 0; i < m_strands.size(); ++i) {
+				offsets[i] = m_strands[i].offset;
+				lengths[i] = m_strands[i].length;
+			}
+
+			for (size_t i = 0; i < m_domains.size(); ++i) {
+				offsets[m_strands.size() + i] = m_strands[m_domains[i].strand].offset + m_domains[i].offset;
+				lengths[m_strands.size() + i] = m_domains[i].length;
+			}
+
+			Calculate(&m_sequences[0], &offsets[0], &lengths[0], count, conditions, &results[0]);
+
+			for (size_t i = 0; i < m_strands.size(); ++i) {
+				m_strands[i].result = results[i];
+				m_strands[i].maxDomainMeltingTemperature = std::numeric_limits<double>::quiet_NaN();
+			}
+
+			for (size_t i = 0; i < m_domains.size(); ++i) {
+				Domain & domain(m_domains[i]);
+				domain.result = results[m_strands.size() + i];
+
+				const double meltingTemperature = domain.result.meltingTemperature;
+				double & maxDomainMeltingTemperature(m_strands[domain.strand].maxDomainMeltingTemperature);
+
+				// NaN compares false, thus the first valid temperature replaces it while invalid domains are ignored.
+				if (meltingTemperature == meltingTemperature && !(meltingTemperature <= maxDomainMeltingTemperature))
+					maxDomainMeltingTemperature = meltingTemperature;
+			}
+		}
+
+		MStatus MeltingTemperature::write(const MString & filename) const {
+			MStatus status;
+			FileWriter file;
+			HMEVALUATE_RETURN(status = file.open(filename.asChar()), status);
+
+			file << "Strand\tSequence\tLength\tGC content\tdH (kcal/mol)\tdS (cal/(K mol))\tdG37 (kcal/mol)\tTm (C)\tDomains\tMax domain Tm (C)\n";
+
+			for (std::vector<Strand>::const_iterator it = m_strands.begin(); it != m_strands.end(); ++it) {
+				file << it->name.asChar() << '\t';
+
+				for (size_t i = 0; i < it->length; ++i)
+					file << DNA::Name(DNA::Values(m_sequences[it->offset + i])).toChar();
+
+				file << '\t' << (unsigned long) it->length << '\t' << it->result.gcContent << '\t' << it->result.enthalpy << '\t' << it->result.entropy << '\t'
+					 << it->result.freeEnergy << '\t' << it->result.meltingTemperature << '\t' << it->numDomains << '\t' << it->maxDomainMeltingTemperature << '\n';
+			}
+
+			file << "\nStrand\tHelix\tOffset\tSequence\tLength\tGC content\tdH (kcal/mol)\tdS (cal/(K mol))\tdG37 (kcal/mol)\tTm (C)\n";
+
+			for (std::vector<Domain>::const_iterator it = m_domains.begin(); it != m_domains.end(); ++it) {
+				const Strand & strand(m_strands[it->strand]);
+				file << strand.name.asChar() << '\t' << m_helixNames[it->helix].asChar() << '\t' << (unsigned long) it->offset << '\t';
+
+				for (size_t i = 0; i < it->length; ++i)
+					file << DNA::Name(DNA::Values(m_sequences[strand.offset + it->offset + i])).toChar();
+
+				file << '\t' << (unsigned long) it->length << '\t' << it->result.gcContent << '\t' << it->result.enthalpy << '\t' << it->result.entropy << '\t'
+					 << it->result.freeEnergy << '\t' << it->result.meltingTemperature << '\n';
+			}
+
+			HMEVALUATE_RETURN(status = file.close(), status);
+
+			return MStatus::kSuccess;
+		}
+
+		unsigned int MeltingTemperature::getHelix(const MObject & object, MStatus & status) {
+			const MObjectHandle handle(object);
+#if defined(WIN32) || defined(WIN64)
+			std::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash>::const_iterator it(m_helixIndices.find(handle));
+#else
+			std::tr1::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash>::const_iterator it(m_helixIndices.find(handle));
+#endif /* N Windows */
+
+			status = MStatus::kSuccess;
+
+			if (it != m_helixIndices.end())
+				return it->second;
+
+			const MString name(MFnDagNode(object).name(&status));
+			if (!status) {
+				HMEVALUATE_DESCRIPTION("MFnDagNode::name", status);
+				return 0;
+			}
+
+			m_helices.push_back(object);
+			m_helixNames.push_back(name);
+			m_helixIndices.insert(std::make_pair(handle, (unsigned int) m_helices.size() - 1));
+
+			return (unsigned int) m_helices.size() - 1;
+		}
+
+		MStatus MeltingTemperature::visit(Model::Base & base) {
+			MStatus status;
+			DNA::Name label;
+			MObject object, parent;
+
+			HMEVALUATE_RETURN(status = base.getLabel(label), status);
+			HMEVALUATE_RETURN(object = base.getObject(status), status);
+			HMEVALUATE_RETURN(parent = MFnDagNode(object).parent(0, &status), status);
+
+			unsigned int helix;
+			HMEVALUATE_RETURN(helix = getHelix(parent, status), status);
+
+			Model::Base opposite(base.opposite(status));
+
+			m_sequences.push_back((unsigned char) DNA::Value_fromChar(label.toChar()));
+			m_baseHelices.push_back(opposite ? helix : UNPAIRED);
+			m_visited.insert(MObjectHandle(object));
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus MeltingTemperature::doExecute(Model::Strand & element) {
+			MStatus status;
+			Model::Base definingBase(element.getDefiningBase());
+			MObject definingObject;
+
+			HMEVALUATE_RETURN(definingObject = definingBase.getObject(status), status);
+
+			if (m_visited.find(MObjectHandle(definingObject)) != m_visited.end())
+				return MStatus::kSuccess;
+
+			/*
+			 * Same traversal as ExportStrands, backwards to the 5' end and then forward, visiting every base once.
+			 */
+
+			Strand strand;
+			strand.offset = m_sequences.size();
+
+			Model::Base fivePrime(definingBase), threePrime(definingBase);
+
+			Model::Strand::BackwardIterator it = element.reverse_begin();
+			for (; it != element.reverse_end(); ++it) {
+				HMEVALUATE_RETURN(status = visit(*it), status);
+				fivePrime = *it;
+			}
+
+			std::reverse(m_sequences.begin() + strand.offset, m_sequences.end());
+			std::reverse(m_baseHelices.begin() + strand.offset, m_baseHelices.end());
+
+			if (it.loop()) {
+				std::rotate(m_sequences.begin() + strand.offset, m_sequences.end() - 1, m_sequences.end());
+				std::rotate(m_baseHelices.begin() + strand.offset, m_baseHelices.end() - 1, m_baseHelices.end());
+
+				MDagPath base_dagPath;
+				HMEVALUATE_RETURN(base_dagPath = definingBase.getDagPath(status), status);
+				strand.name = base_dagPath.fullPathName();
+			} else {
+				Model::Strand::ForwardIterator f_it = element.forward_begin();
+				for (++f_it; f_it != element.forward_end(); ++f_it) {
+					HMEVALUATE_RETURN(status = visit(*f_it), status);
+					threePrime = *f_it;
+				}
+
+				MDagPath first_base_dagPath, last_base_dagPath;
+				HMEVALUATE_RETURN(first_base_dagPath = fivePrime.getDagPath(status), status);
+				HMEVALUATE_RETURN(last_base_dagPath = threePrime.getDagPath(status), status);
+
+				strand.name = first_base_dagPath.fullPathName() + " -> " + last_base_dagPath.fullPathName();
+			}
+
+			strand.length = m_sequences.size() - strand.offset;
+			strand.firstDomain = (unsigned int) m_domains.size();
+
+			/*
+			 * Split into domains.
+			 */
+
+			for (size_t i = 0; i < strand.length;) {
+				const unsigned int helix = m_baseHelices[strand.offset + i];
+
+				if (helix == UNPAIRED || m_sequences[strand.offset + i] >= DNA::BASES) {
+					++i;
+					continue;
+				}
+
+				Domain domain;
+				domain.strand = (unsigned int) m_strands.size();
+				domain.helix = helix;
+				domain.offset = i;
+
+				while (i < strand.length && m_baseHelices[strand.offset + i] == helix && m_sequences[strand.offset + i] < DNA::BASES)
+					++i;
+
+				domain.length = i - domain.offset;
+				m_domains.push_back(domain);
+			}
+
+			strand.numDomains = (unsigned int) m_domains.size() - strand.firstDomain;
+			m_strands.push_back(strand);
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus MeltingTemperature::doUndo(Model::Strand & element, Empty & undoData) {
+			return MStatus::kSuccess;
+		}
+
+		MStatus MeltingTemperature::doRedo(Model::Strand & element, Empty & redoData) {
+			return MStatus::kSuccess;
+		}
+	}
+}
@@ -0,0 +1,135 @@
+#include <controller/OxDnaBinaryConverter.h>
+#include <controller/OxDnaExporter.h>
+#include <controller/FileReader.h>
+#include <controller/FileWriter.h>
+
+#include <Utility.h>
+
+#include <cstring>
+#include <vector>
+
+namespace Helix {
+	namespace Controller {
+		/*
+		 * Little endian readers, it must have been verified that there's enough data left.
+		 */
+
+		inline unsigned int OxDnaBinaryConverter_readUInt32(const char *& it) {
+			const unsigned char *bytes = reinterpret_cast<const unsigned char *>(it);
+			it += 4;
+
+			return (unsigned int) bytes[0] | ((unsigned int) bytes[1] << 8) | ((unsigned int) bytes[2] << 16) | ((unsigned int) bytes[3] << 24);
+		}
+
+		inline int OxDnaBinaryConverter_readInt32(const char *& it) {
+			return (int) OxDnaBinaryConverter_readUInt32(it);
+		}
+
+		inline double OxDnaBinaryConverter_readFloat(const char *& it) {
+			const unsigned int bits = OxDnaBinaryConverter_readUInt32(it);
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+
+			return value;
+		}
+
+		inline MVector OxDnaBinaryConverter_readVector(const char *& it) {
+			const double x = OxDnaBinaryConverter_readFloat(it), y = OxDnaBinaryConverter_readFloat(it);
+			return MVector(x, y, OxDnaBinaryConverter_readFloat(it));
+		}
+
+		/*
+		 * Reads the file and verifies the header. Returns the number of bases and a pointer to the rest of the header.
+		 */
+		MStatus OxDnaBinaryConverter_read(const char *filename, const char *magic, size_t headerSize, size_t baseSize, std::vector<char> & buffer, const char *& it, unsigned int & numBases) {
+			MStatus status;
+			HMEVALUATE_RETURN(status = FileReader_read(filename, buffer), status);
+
+			const size_t size = buffer.size() - 1; // FileReader_read null terminates.
+
+			if (size < headerSize || memcmp(&buffer[0], magic, HELIX_OXDNA_BINARY_MAGIC_LENGTH) != 0) {
+				MGlobal::displayError(MString("The file \"") + filename + "\" is not a binary oxDNA file of the expected type.");
+				return MStatus::kFailure;
+			}
+
+			it = &buffer[0] + HELIX_OXDNA_BINARY_MAGIC_LENGTH;
+
+			const unsigned int version = OxDnaBinaryConverter_readUInt32(it);
+			if (version != HELIX_OXDNA_BINARY_VERSION) {
+				MGlobal::displayError(MString("Unsupported version ") + (int) version + " of the file \"" + filename + "\".");
+				return MStatus::kFailure;
+			}
+
+			numBases = OxDnaBinaryConverter_readUInt32(it);
+
+			if ((size - headerSize) / baseSize < numBases) {
+				MGlobal::displayError(MString("The file \"") + filename + "\" is truncated.");
+				return MStatus::kFailure;
+			}
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus OxDnaBinaryConverter::convertTopology(const char *binary_filename, const char *filename) {
+			MStatus status;
+			std::vector<char> buffer;
+			const char *it;
+			unsigned int numBases;
+
+			HMEVALUATE_RETURN(status = OxDnaBinaryConverter_read(binary_filename, HELIX_OXDNA_BINARY_TOP_MAGIC, HELIX_OXDNA_BINARY_MAGIC_LENGTH + 3 * 4, 4 * 4, buffer, it, numBases), status);
+			const unsigned int numStrands = OxDnaBinaryConverter_readUInt32(it);
+
+			FileWriter file;
+			HMEVALUATE_RETURN(status = file.open(filename), status);
+
+			file << numBases << ' ' << numStrands << '\n';
+
+			int previousStrand = 0;
+
+			for (unsigned int i = 0; i < numBases; ++i) {
+				const int strand = OxDnaBinaryConverter_readInt32(it);
+				const char label = char(OxDnaBinaryConverter_readInt32(it));
+				const int next = OxDnaBinaryConverter_readInt32(it);
+				const int previous = OxDnaBinaryConverter_readInt32(it);
+
+				// Strands are separated by empty lines, as in the text files written by the exporter.
+				if (strand != previousStrand) {
+					file << '\n';
+					previousStrand = strand;
+				}
+
+				file << strand << ' ' << label << ' ' << next << ' ' << previous << '\n';
+			}
+
+			HMEVALUATE_RETURN(status = file.close(), status);
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus OxDnaBinaryConverter::convertConfiguration(const char *binary_filename, const char *filename) {
+			MStatus status;
+			std::vector<char> buffer;
+			const char *it;
+			unsigned int numBases;
+
+			HMEVALUATE_RETURN(status = OxDnaBinaryConverter_read(binary_filename, HELIX_OXDNA_BINARY_CONF_MAGIC, HELIX_OXDNA_BINARY_MAGIC_LENGTH + 2 * 4 + 3 * 4, 9 * 4, buffer, it, numBases), status);
+
+			FileWriter file;
+			HMEVALUATE_RETURN(status = file.open(filename), status);
+
+			file << "t = 0\nb = " << OxDnaBinaryConverter_readVector(it) << "\nE = 0. 0. 0.\n";
+
+			for (unsigned int i = 0; i < numBases; ++i) {
+				const MVector position(OxDnaBinaryConverter_readVector(it));
+				const MVector a1(OxDnaBinaryConverter_readVector(it));
+				const MVector a3(OxDnaBinaryConverter_readVector(it));
+
+				file << position << ' ' << a1 << ' ' << a3 << " 0.0 0.0 0.0 0.0 0.0 0.0\n";
+			}
+
+			HMEVALUATE_RETURN(status = file.close(), status);
+
+			return MStatus::kSuccess;
+		}
+	}
+}
@@ -6,78 +6,141 @@
  */
 
 #include <controller/OxDnaExporter.h>
+#include <controller/FileWriter.h>
 #include <model/Helix.h>
 #include <Utility.h>
 
-#include <fstream>
+#include <maya/MFnDagNode.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MPoint.h>
 
 namespace Helix {
 	namespace Controller {
+		unsigned int OxDnaExporter::getHelix(const MObject & object, MStatus & status) {
+			const MObjectHandle handle(object);
+#if defined(WIN32) || defined(WIN64)
+			std::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash>::const_iterator it(m_helixIndices.find(handle));
+#else
+			std::tr1::unordered_map<MObjectHandle, unsigned int, ObjectHandleHash>::const_iterator it(m_helixIndices.find(handle));
+#endif /* N Windows */
+
+			status = MStatus::kSuccess;
+
+			if (it != m_helixIndices.end())
+				return it->second;
+
+			Helix helix;
+			helix.object = object;
+
+			MDagPath dagPath;
+			if (!(status = MDagPath::getAPathTo(object, dagPath))) {
+				HMEVALUATE_DESCRIPTION("MDagPath::getAPathTo", status);
+				return 0;
+			}
+
+			helix.matrix = dagPath.inclusiveMatrix();
+			helix.name = dagPath.fullPathName();
+
+			helix.translation = MVector(MPoint::origin * helix.matrix);
+			helix.normal = (MVector::zAxis * helix.matrix).normal();
+
+			m_helices.push_back(helix);
+			m_helixIndices.insert(std::make_pair(handle, (unsigned int) m_helices.size() - 1));
+
+			return (unsigned int) m_helices.size() - 1;
+		}
+
 		MStatus OxDnaExporter::doExecute(Model::Strand & element) {
 			Strand outstrand;
 			MStatus status;
 
+			if (!m_materialsQueried) {
+				HMEVALUATE_RETURN(status = m_materials.query(), status);
+				m_materialsQueried = true;
+			}
+
 			// Iterate backwards along the strand to find the first base of the strand if not circular.
 			element.rewind();
-			Model::Base & base(element.getDefiningBase());
 			MDagPath baseDagPath;
-			HMEVALUATE_RETURN(baseDagPath = base.getDagPath(status), status);
+			HMEVALUATE_RETURN(baseDagPath = element.getDefiningBase().getDagPath(status), status);
 			HMEVALUATE_RETURN(outstrand.name = baseDagPath.fullPathName(&status), status);
 
-			Model::Helix parent(base.getParent(status));
-			MEulerRotation parentRotation;
-			HMEVALUATE_RETURN(status = parent.getRotation(parentRotation), status);
-			MVector parentTranslation;
-			parent.getTranslation(parentTranslation, MSpace::kWorld);
-			const MVector normal((MVector(0, 0, 1) * parentRotation.asMatrix()).normal());
+			/*
+			 * Only the label, name, material and local translation are obtained per base, the rest is derived from its helix.
+			 * The local translations are kept for deciding the direction of the bases along their helix axis.
+			 */
+
+			std::vector<MVector> localTranslations;
+			unsigned int helixIndex = 0;
+			MObject helixObject;
 
 			Model::Strand::ForwardIterator it = element.forward_begin();
 			for(; it != element.forward_end(); ++it) {
-				Model::Helix parent(it->getParent(status));
+				Model::Base & base(*it);
+				MObject base_object;
+				HMEVALUATE_RETURN(base_object = base.getObject(status), status);
+				MFnDagNode base_dagNode(base_object);
 
-				Base base;
-				HMEVALUATE_RETURN(status = it->getLabel(base.label), status);
+				Base outbase;
+				HMEVALUATE_RETURN(status = base.getLabel(outbase.label), status);
 
-				HMEVALUATE_RETURN(status = it->getTranslation(base.translation, MSpace::kWorld), status);
-
-				MQuaternion rotation;
-				HMEVALUATE_RETURN(status = it->getRotation(rotation), status);
-
-				if (base.label == DNA::Invalid) {
-					const MString errorString(MString("The base ") + it->getDagPath(status).fullPathName() + " does not have an assigned label.");
+				if (outbase.label == DNA::Invalid) {
+					const MString errorString(MString("The base ") + base.getDagPath(status).fullPathName() + " does not have an assigned label.");
 					MGlobal::displayError(errorString);
 					HPRINT("%s", errorString.asChar());
 
 					return MStatus::kInvalidParameter;
 				}
 
-				base.tangent = (normal ^ ((base.translation - parentTranslation) ^ normal)).normal();
+				MObject parent;
+				HMEVALUATE_RETURN(parent = base_dagNode.parent(0, &status), status);
 
-				int direction;
-				HMEVALUATE_RETURN(direction = it->sign_along_axis(MVector::zAxis, MSpace::kTransform, status), status);
+				// Consecutive bases are mostly on the same helix.
+				if (parent != helixObject) {
+					HMEVALUATE_RETURN(helixIndex = getHelix(parent, status), status);
+					helixObject = parent;
+				}
+
+				const Helix & helix(m_helices[helixIndex]);
+
+				MVector translation;
+				HMEVALUATE_RETURN(status = base.getTranslation(translation, MSpace::kTransform), status);
+				localTranslations.push_back(translation);
+
+				outbase.helix = helixIndex;
+				outbase.translation = MVector(MPoint(translation) * helix.matrix);
+				outbase.tangent = (MVector(translation.x, translation.y, 0.0) * helix.matrix).normal();
+				HMEVALUATE_RETURN(outbase.name = base_dagNode.name(&status), status);
 
-				base.normal = normal * direction;
-				HMEVALUATE_RETURN(base.helixName = parent.getDagPath(status).fullPathName(), status);
-				HMEVALUATE_RETURN(base.name = it->getDagPath(status).partialPathName(), status);
 				Model::Material material;
-				HMEVALUATE_RETURN(status = it->getMaterial(material), status);
-				base.material = material.getMaterial();
-				outstrand.strand.push_back(base);
+				outbase.material = m_materials.find(base_object, material) ? material.getMaterial() : MString("-");
+
+				outstrand.strand.push_back(outbase);
+			}
 
-				if (m_helices.find(base.helixName.asChar()) == m_helices.end()) {
-					Helix helix;
+			outstrand.circular = it.loop();
+
+			/*
+			 * Same as Base::sign_along_axis along the helix axis, using the next base if there is one or else the previous one.
+			 */
 
-					HMEVALUATE_RETURN(status = parent.getTranslation(helix.translation, MSpace::kWorld), status);
+			const size_t numBases = outstrand.strand.size();
 
-					MEulerRotation rotation;
-					HMEVALUATE_RETURN(status = parent.getRotation(rotation), status);
-					helix.normal = MVector::zAxis * MTransformationMatrix().rotateTo(rotation).asMatrix();
+			for (size_t i = 0; i < numBases; ++i) {
+				int direction;
 
-					m_helices.insert(std::make_pair(base.helixName.asChar(), helix));
+				if (i + 1 < numBases || (outstrand.circular && numBases > 1))
+					direction = sgn(localTranslations[(i + 1) % numBases].z - localTranslations[i].z);
+				else if (i > 0)
+					direction = sgn(localTranslations[i].z - localTranslations[i - 1].z);
+				else {
+					HPRINT("Failure to obtain any basis. Can't decide on a direction along the axis.");
+					return MStatus::kFailure;
 				}
+
+				outstrand.strand[i].normal = m_helices[outstrand.strand[i].helix].normal * direction;
 			}
 
-			outstrand.circular = it.loop();
 			m_strands.push_back(outstrand);
 
 			return MStatus::kSuccess;
@@ -91,33 +154,24 @@ namespace Helix {
 			return MStatus::kSuccess;
 		}
 
-		MStatus OxDnaExporter::write(const char *topology_filename, const char *configuration_filename, const char *vhelix_filename, const MVector & minTranslation, const MVector & maxTranslation) const {
-
-			std::ofstream conf_file(configuration_filename);
-			std::ofstream top_file(topology_filename);
-			std::ofstream vhelix_file(vhelix_filename);
-
-			if (!conf_file) {
-				MGlobal::displayError(MString("Can't open file \"") + configuration_filename + "\" for writing.");
-				return MStatus::kFailure;
-			}
-
-			if (!top_file) {
-				MGlobal::displayError(MString("Can't open file \"") + topology_filename + "\" for writing.");
-				return MStatus::kFailure;
-			}
+		MStatus OxDnaExporter::write(const char *topology_filename, const char *configuration_filename, const char *vhelix_filename, const MVector & minTranslation, const MVector & maxTranslation, bool binary) const {
+			MStatus status;
+			FileWriter conf_file, top_file, vhelix_file;
 
-			if (!vhelix_file) {
-				MGlobal::displayError(MString("Can't open file \"") + vhelix_filename + "\" for writing.");
-				return MStatus::kFailure;
-			}
+			HMEVALUATE_RETURN(status = conf_file.open(configuration_filename, binary), status);
+			HMEVALUATE_RETURN(status = top_file.open(topology_filename, binary), status);
+			HMEVALUATE_RETURN(status = vhelix_file.open(vhelix_filename), status);
 
 			size_t numBases = 0;
 			for (std::list<Strand>::const_iterator it = m_strands.begin(); it != m_strands.end(); ++it) {
 				numBases += it->strand.size();
 			}
 
-			top_file << numBases << " " << m_strands.size() << std::endl << std::endl;
+			if (binary) {
+				top_file.write(HELIX_OXDNA_BINARY_TOP_MAGIC, HELIX_OXDNA_BINARY_MAGIC_LENGTH);
+				top_file.writeUInt32(HELIX_OXDNA_BINARY_VERSION).writeUInt32((unsigned int) numBases).writeUInt32((unsigned int) m_strands.size());
+			} else
+				top_file << (unsigned long) numBases << ' ' << (unsigned long) m_strands.size() << "\n\n";
 
 			unsigned int i = 1;
 			int j = 0;
@@ -126,58 +180,65 @@ namespace Helix {
 				const int firstIndex = it->circular ? int(it->strand.size()) - 1 : -1;
 				const int lastIndex = it->circular ? 0 : -1;
 
-				top_file << "# " << it->name.asChar() << std::endl;
+				if (!binary)
+					top_file << "# " << it->name.asChar() << '\n';
 
 				int k = 0;
-				for (std::vector<Base>::const_iterator lit = it->strand.begin(); lit != it->strand.end(); ++lit, ++j, ++k)
-					top_file << i << " " << lit->label.toChar() << " " <<
-								(k == int(it->strand.size()) - 1 ? lastIndex : j + 1) << " " <<
-								(k == 0 ? firstIndex : j - 1) << std::endl;
+				for (std::vector<Base>::const_iterator lit = it->strand.begin(); lit != it->strand.end(); ++lit, ++j, ++k) {
+					const int next = k == int(it->strand.size()) - 1 ? lastIndex : j + 1;
+					const int previous = k == 0 ? firstIndex : j - 1;
+
+					if (binary)
+						top_file.writeInt32(int(i)).writeInt32(lit->label.toChar()).writeInt32(next).writeInt32(previous);
+					else
+						top_file << i << ' ' << lit->label.toChar() << ' ' << next << ' ' << previous << '\n';
+				}
 
-				top_file << std::endl;
+				if (!binary)
+					top_file << '\n';
 			}
 
-			top_file.close();
+			HMEVALUATE_RETURN(status = top_file.close(), status);
 
 			const MVector dimensions(maxTranslation - minTranslation);
-			conf_file << "t = 0" << std::endl << "b = " << dimensions.x << " " << dimensions.y << " " << dimensions.z << std::endl << "E = 0. 0. 0." << std::endl;
 
-			for (std::list<Strand>::const_iterator it = m_strands.begin(); it != m_strands.end(); ++it, ++i) {
+			if (binary) {
+				conf_file.write(HELIX_OXDNA_BINARY_CONF_MAGIC, HELIX_OXDNA_BINARY_MAGIC_LENGTH);
+				conf_file.writeUInt32(HELIX_OXDNA_BINARY_VERSION).writeUInt32((unsigned int) numBases).writeFloat(dimensions);
+			} else
+				conf_file << "t = 0\nb = " << dimensions << "\nE = 0. 0. 0.\n";
+
+			for (std::list<Strand>::const_iterator it = m_strands.begin(); it != m_strands.end(); ++it) {
 				for (std::vector<Base>::const_iterator sit = it->strand.begin(); sit != it->strand.end(); ++sit) {
 					const MVector translation(sit->translation/* - minTranslation*/);
 
-					conf_file << translation.x << " " << translation.y << " " << translation.z << " " <<
-							sit->tangent.x << " " << sit->tangent.y << " " << sit->tangent.z << " " <<
-							sit->normal.x << " " << sit->normal.y << " " << sit->normal.z <<
-							" 0.0 0.0 0.0 0.0 0.0 0.0" << std::endl;
+					if (binary)
+						conf_file.writeFloat(translation).writeFloat(sit->tangent).writeFloat(sit->normal);
+					else
+						conf_file << translation << ' ' << sit->tangent << ' ' << sit->normal << " 0.0 0.0 0.0 0.0 0.0 0.0\n";
 				}
 			}
 
-			conf_file.close();
+			HMEVALUATE_RETURN(status = conf_file.close(), status);
 
-			const std::string date(Date());
-			vhelix_file << "# vHelix glue file for oxDNA export \"" << topology_filename << "\" and \"" << configuration_filename << "\"." << std::endl <<
-					"# " << date.c_str() << std::endl << std::endl;
+			vhelix_file << "# vHelix glue file for oxDNA export \"" << topology_filename << "\" and \"" << configuration_filename << "\".\n# " << Date() << "\n\n";
 
-			for (std::tr1::unordered_map<std::string, Helix>::const_iterator it = m_helices.begin(); it != m_helices.end(); ++it) {
-				const MVector translation(it->second.translation/* - minTranslation*/);
+			for (std::vector<Helix>::const_iterator it = m_helices.begin(); it != m_helices.end(); ++it) {
+				const MVector translation(it->translation/* - minTranslation*/);
 
-				vhelix_file << "helix " << it->first.c_str() << " " <<
-						translation.x << " " << translation.y << " " << translation.z << " " <<
-						it->second.normal.x << " " << it->second.normal.y << " " << it->second.normal.z << std::endl;
+				vhelix_file << "helix " << it->name.asChar() << ' ' << translation << ' ' << it->normal << '\n';
 			}
 
-			vhelix_file << std::endl;
+			vhelix_file << '\n';
 
 			unsigned int index = 0;
-			for (std::list<Strand>::const_iterator it = m_strands.begin(); it != m_strands.end(); ++it, ++i) {
+			for (std::list<Strand>::const_iterator it = m_strands.begin(); it != m_strands.end(); ++it) {
 				for (std::vector<Base>::const_iterator bit = it->strand.begin(); bit != it->strand.end(); ++bit) {
-					vhelix_file << "base " << index++ << " " << bit->name << " " << bit->helixName << " " << bit->material.asChar() << std::endl;
+					vhelix_file << "base " << index++ << ' ' << bit->name.asChar() << ' ' << m_helices[bit->helix].name.asChar() << ' ' << bit->material.asChar() << '\n';
 				}
 			}
 
-
-			vhelix_file.close();
+			HMEVALUATE_RETURN(status = vhelix_file.close(), status);
 
 			return MStatus::kSuccess;
 		}
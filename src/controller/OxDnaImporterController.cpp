@@ -6,12 +6,12 @@
  */
 
 #include <controller/OxDnaImporter.h>
+#include <controller/FileReader.h>
+#include <model/BaseBatch.h>
 #include <Utility.h>
 
-#include <fstream>
 #include <string>
-#include <cstdio>
-#include <map>
+#include <cstring>
 
 #if defined(WIN32) || defined(WIN64)
 #include <unordered_map>
@@ -24,185 +24,212 @@
 
 namespace Helix {
 	namespace Controller {
-		MStatus OxDnaImporter::read(const char *topology_filename, const char *configuration_filename, const char *vhelix_filename) {
-			std::ifstream topology_file(topology_filename);
-			std::ifstream configuration_file(configuration_filename);
-			std::ifstream vhelix_file(vhelix_filename);
+#if defined(WIN32) || defined(WIN64)
+		typedef std::unordered_map<std::string, unsigned int> string_index_map_t;
+		typedef std::unordered_map<std::string, Model::Material> string_material_map_t;
+#else
+		typedef std::tr1::unordered_map<std::string, unsigned int> string_index_map_t;
+		typedef std::tr1::unordered_map<std::string, Model::Material> string_material_map_t;
+#endif /* N Windows */
 
-			if (!topology_file) {
-				MGlobal::displayError(MString("Unable to open file \"") + topology_filename + "\" for reading.");
-				return MStatus::kFailure;
-			}
+		MStatus OxDnaImporter::read(const char *topology_filename, const char *configuration_filename, const char *vhelix_filename) {
+			MStatus status;
+			std::vector<char> buffer;
 
-			if (!configuration_file) {
-				MGlobal::displayError(MString("Unable to open file \"") + configuration_filename + "\" for reading.");
-				return MStatus::kFailure;
-			}
+			m_bases.clear();
+			m_helices.clear();
 
-			HPRINT("1");
-			std::tr1::unordered_map<int, Base> bases;
+			onProcessStart(4);
 
-			unsigned int numBases, numStrands;
-			topology_file >> numBases >> numStrands;
-			onProcessStart(numBases * 5);
+			/*
+			 * Topology: a header with the number of bases and strands followed by a line per base with its strand, label, 3' and 5' neighbours.
+			 */
 
-			int baseIndex = 0;
-			std::map<unsigned int, int> strandBaseIndexOffset; // Stores the global base index each strand starts at.
-			unsigned int previousStrandIndex = 0;
+			HMEVALUATE_RETURN(status = FileReader_read(topology_filename, buffer), status);
 
-			while (topology_file.good()) {
-				std::string line;
-				std::getline(topology_file, line);
+			{
+				char *it = &buffer[0], *end = &buffer[0] + buffer.size() - 1, *line;
+				bool header = true;
 
-				if (line[0] == '#' || line.length() == 0)
-					continue;
+				while ((line = FileReader_nextLine(it, end))) {
+					if (FileReader_skipLine(line))
+						continue;
 
-				Base base;
-				char name;
+					if (header) {
+						long numBases;
+						if (FileReader_parse(line, numBases) && numBases > 0)
+							m_bases.reserve(size_t(numBases));
 
-				if (sscanf(line.c_str(), "%u %c %d %d", &base.strand, &name, &base.forward, &base.backward) == 4) {
-					if (previousStrandIndex != base.strand) {
-						previousStrandIndex = base.strand;
-						strandBaseIndexOffset.insert(std::make_pair(previousStrandIndex, baseIndex));
+						header = false;
+						continue;
 					}
 
-					base.label = name;
+					long strand, forward, backward;
+					char *label;
+					if (!FileReader_parse(line, strand) || !(label = FileReader_token(line)) || !FileReader_parse(line, forward) || !FileReader_parse(line, backward))
+						continue;
 
-					std::cerr << "Inserting baseIndex: " << baseIndex << std::endl;
-					bases.insert(std::make_pair(baseIndex, base));
-					++baseIndex;
-
-					onProcessStep();
+					Base base;
+					base.label = *label;
+					base.forward = int(forward);
+					base.backward = int(backward);
+					m_bases.push_back(base);
 				}
 			}
 
-			HPRINT("2");
-			topology_file.close();
+			onProcessStep();
 
-			// TODO: Parse bounding box
+			/*
+			 * Configuration: three header lines, t, b and E, followed by a line per base with position, a1, a3, velocity and angular velocity.
+			 * Only the position is used.
+			 */
 
-			baseIndex = 0;
-			while (configuration_file.good()) {
-				std::string line;
-				std::getline(configuration_file, line);
+			HMEVALUATE_RETURN(status = FileReader_read(configuration_filename, buffer), status);
 
-				if (line[0] == '#' || line.length() == 0)
-					continue;
+			{
+				char *it = &buffer[0], *end = &buffer[0] + buffer.size() - 1, *line;
+				size_t baseIndex = 0;
+
+				while ((line = FileReader_nextLine(it, end))) {
+					if (FileReader_skipLine(line) || *line == 't' || *line == 'b' || *line == 'E')
+						continue;
+
+					double values[15];
+					int count = 0;
+					while (count < 15 && FileReader_parse(line, values[count]))
+						++count;
+
+					if (count != 15)
+						continue;
 
-				MVector baseTranslation, baseVector, normalVector, velocity, angularVelocity; // Only translation is used.
-				// TODO: Use vectors for direction? How would that work with constraints?
-
-				if (sscanf(line.c_str(), "%lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf",
-						&baseTranslation.x, &baseTranslation.y, &baseTranslation.z,
-						&baseVector.x, &baseVector.y, &baseVector.z,
-						&normalVector.x, &normalVector.y, &normalVector.z,
-						&velocity.x, &velocity.y, &velocity.z,
-						&angularVelocity.x, &angularVelocity.y, &angularVelocity.z) == 15) {
-					std::tr1::unordered_map<int, Base>::iterator it = bases.find(baseIndex);
-					if (it == bases.end()) {
-						HPRINT("Error when parsing file, base index %d out of bounds.", baseIndex);
+					if (baseIndex >= m_bases.size()) {
+						HPRINT("Error when parsing file, base index %u out of bounds.", (unsigned int) baseIndex);
 						return MStatus::kFailure;
 					}
-					it->second.translation = baseTranslation;
 
-					++baseIndex;
+					m_bases[baseIndex++].translation = MVector(values[0], values[1], values[2]);
 				}
-
-				onProcessStep();
 			}
 
-			std::tr1::unordered_map<std::string, Helix> helices;
+			onProcessStep();
 
-			HPRINT("3");
-			while (vhelix_file.good()) {
-				std::string line;
-				std::getline(vhelix_file, line);
+			/*
+			 * The vHelix glue file with the helices and the names, helices and materials of the bases.
+			 */
 
-				if (line[0] == '#' || line.length() == 0)
-					continue;
+			HMEVALUATE_RETURN(status = FileReader_read(vhelix_filename, buffer), status);
 
-				int base;
-				char name[1024], helixName[1024], material[1024];
-				Helix helix;
+			string_index_map_t helixIndices;
 
-				if (sscanf(line.c_str(), "base %d %s %s %s", &base, name, helixName, material) == 4) {
-					std::tr1::unordered_map<int, Base>::iterator it = bases.find(base);
-					if (it == bases.end()) {
-						HPRINT("Error when parsing file, base index %d out of bounds.", base);
-						return MStatus::kFailure;
-					}
+			{
+				char *it = &buffer[0], *end = &buffer[0] + buffer.size() - 1, *line;
 
-					it->second.name = name;
-					it->second.helixName = helixName;
-					it->second.material = material;
+				while ((line = FileReader_nextLine(it, end))) {
+					if (FileReader_skipLine(line))
+						continue;
 
-					HPRINT("Named base at index: %d %s, helix: %s", base, name, helixName);
-					onProcessStep();
-				} else if (sscanf(line.c_str(), "helix %s %lf %lf %lf %lf %lf %lf", name, &helix.translation.x, &helix.translation.y, &helix.translation.z, &helix.normal.x, &helix.normal.y, &helix.normal.z) == 7) {
-					helices.insert(std::make_pair(name, helix));
-				} else {
-					HPRINT("Unknown line \"%s\"", line.c_str());
+					char *type = FileReader_token(line);
+
+					if (strcmp(type, "base") == 0) {
+						long index;
+						char *name, *helixName, *material;
+
+						if (FileReader_parse(line, index) && (name = FileReader_token(line)) && (helixName = FileReader_token(line)) && (material = FileReader_token(line))) {
+							if (index < 0 || size_t(index) >= m_bases.size()) {
+								HPRINT("Error when parsing file, base index %ld out of bounds.", index);
+								return MStatus::kFailure;
+							}
+
+							Base & base(m_bases[size_t(index)]);
+							base.name = name;
+							base.helixName = helixName;
+							base.material = material;
+							continue;
+						}
+					} else if (strcmp(type, "helix") == 0) {
+						Helix helix;
+						char *name = FileReader_token(line);
+
+						if (name && FileReader_parse(line, helix.translation.x) && FileReader_parse(line, helix.translation.y) && FileReader_parse(line, helix.translation.z) &&
+								FileReader_parse(line, helix.normal.x) && FileReader_parse(line, helix.normal.y) && FileReader_parse(line, helix.normal.z)) {
+							helix.name = name;
+							helixIndices.insert(std::make_pair(std::string(name), (unsigned int) m_helices.size()));
+							m_helices.push_back(helix);
+							continue;
+						}
+					}
+
+					HPRINT("Unknown line \"%s\"", type);
 				}
 			}
 
-			MStatus status;
+			std::vector<char>().swap(buffer);
+			onProcessStep();
 
-			for (std::tr1::unordered_map<std::string, Helix>::iterator it = helices.begin(); it != helices.end(); ++it) {
+			/*
+			 * Create the helices and bases in file order.
+			 */
+
+			for (std::vector<Helix>::iterator it = m_helices.begin(); it != m_helices.end(); ++it) {
 				MTransformationMatrix transform;
-				const MVector & normal(it->second.normal);
+				const MVector & normal(it->normal);
 				transform.rotateTo(MQuaternion(normal.angle(MVector::zAxis), MVector::zAxis ^ normal));
-				HMEVALUATE_RETURN(status = transform.setTranslation(it->second.translation, MSpace::kWorld), status);
+				HMEVALUATE_RETURN(status = transform.setTranslation(it->translation, MSpace::kWorld), status);
 
-				HMEVALUATE_RETURN(status = Model::Helix::Create(it->first.c_str(), transform, it->second.helix), status);
+				HMEVALUATE_RETURN(status = Model::Helix::Create(it->name, transform, it->helix), status);
 			}
 
-			// Create the bases...
-			for (std::tr1::unordered_map<int, Base>::iterator it = bases.begin(); it != bases.end(); ++it) {
-				std::tr1::unordered_map<std::string, Helix>::iterator helix = helices.find(it->second.helixName.asChar());
-				if (helix == helices.end()) {
-					HPRINT("Error when parsing file, unknown helix \"%s\" out of bounds for base \"%s\" at index %d.", it->second.helixName.asChar(), it->second.name.asChar(), it->first);
-					return MStatus::kSuccess;
-				}
+			string_material_map_t materials;
+			Model::BaseBatch batch;
+			batch.reserve(m_bases.size());
 
-				HMEVALUATE_RETURN(status = Model::Base::Create(helix->second.helix, it->second.name, it->second.translation, it->second.base, MSpace::kWorld), status);
+			for (std::vector<Base>::iterator it = m_bases.begin(); it != m_bases.end(); ++it) {
+				string_index_map_t::const_iterator helix_it(helixIndices.find(it->helixName));
 
-				Model::Material material;
-				if (!(status = Model::Material::Find(it->second.material, material))) {
-					if (status != MStatus::kNotFound) {
-						HMEVALUATE_RETURN_DESCRIPTION("Failed to obtain the material", status);
-					} else {
-						HPRINT("Warning: Can't find material \"%s\" for base \"%s\"", it->second.material.asChar(), it->second.base.getDagPath(status).fullPathName().asChar());
-						HMEVALUATE_RETURN(material = *Model::Material::AllMaterials_begin(status), status);
-					}
+				if (helix_it == helixIndices.end()) {
+					HPRINT("Error when parsing file, unknown helix \"%s\" for base \"%s\" at index %d.", it->helixName.c_str(), it->name.asChar(), int(it - m_bases.begin()));
+					return MStatus::kFailure;
 				}
-				it->second.base.setMaterial(material);
 
-				HMEVALUATE_RETURN(status = it->second.base.setLabel(it->second.label), status);
+				string_material_map_t::iterator material_it(materials.find(it->material));
+
+				if (material_it == materials.end()) {
+					// Bases without a material are exported with the material '-'.
+					Model::Material material;
+					if (it->material != "-" && !(status = Model::Material::Find(it->material.c_str(), material))) {
+						if (status != MStatus::kNotFound) {
+							HMEVALUATE_RETURN_DESCRIPTION("Failed to obtain the material", status);
+						} else {
+							HPRINT("Warning: Can't find material \"%s\"", it->material.c_str());
+							HMEVALUATE_RETURN(material = *Model::Material::AllMaterials_begin(status), status);
+						}
+					}
+
+					material_it = materials.insert(std::make_pair(it->material, material)).first;
+				}
 
-				onProcessStep();
+				batch.add(m_helices[helix_it->second].helix, it->name, it->translation, material_it->second, it->label, MSpace::kWorld);
 			}
 
-			// Make forward connections...
-			for (std::tr1::unordered_map<int, Base>::iterator it = bases.begin(); it != bases.end(); ++it) {
-				if (it->second.forward == -1)
+			// Batch indices are the oxDNA indices as no existing bases are added.
+			for (std::vector<Base>::iterator it = m_bases.begin(); it != m_bases.end(); ++it) {
+				if (it->forward == -1)
 					continue;
 
-				std::tr1::unordered_map<int, Base>::iterator forward = bases.find(it->second.forward);
-				if (forward == bases.end()) {
-					HPRINT("Error when parsing file, base index %d out of bounds.", it->second.forward);
+				if (it->forward < 0 || size_t(it->forward) >= m_bases.size()) {
+					HPRINT("Error when parsing file, base index %d out of bounds.", it->forward);
 					return MStatus::kFailure;
 				}
 
-				HPRINT("From base %s forward to %s (indices %d and %d)", it->second.name.asChar(), forward->second.name.asChar(), it->first, forward->first);
+				batch.connect_forward((unsigned int) (it - m_bases.begin()), (unsigned int) it->forward);
+			}
 
-				HMEVALUATE_RETURN(status = it->second.base.connect_forward(forward->second.base, true), status);
+			HMEVALUATE_RETURN(status = batch.create(), status);
 
-				onProcessStep();
-			}
+			onProcessStep();
+			onProcessEnd();
 
 			return MStatus::kSuccess;
 		}
 	}
 }
-
-
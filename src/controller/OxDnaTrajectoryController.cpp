@@ -0,0 +1,173 @@
+#include <controller/OxDnaTrajectory.h>
+#include <controller/FileReader.h>
+
+#include <Utility.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(WIN32) || defined(WIN64)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* N Windows */
+
+#include <maya/MGlobal.h>
+
+/*
+ * Lines are copied to a null terminated buffer before parsing as the mapped file is read only and not null terminated.
+ * Configuration lines are 15 numbers and much shorter than this.
+ */
+#define MAX_LINE_LENGTH 1024
+
+namespace Helix {
+	namespace Controller {
+		OxDnaTrajectory::OxDnaTrajectory() : m_data(NULL), m_size(0) {
+
+		}
+
+		OxDnaTrajectory::~OxDnaTrajectory() {
+			close();
+		}
+
+		MStatus OxDnaTrajectory::open(const char *filename) {
+			close();
+
+#if defined(WIN32) || defined(WIN64)
+			HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+
+			if (file == INVALID_HANDLE_VALUE) {
+				MGlobal::displayError(MString("Unable to open file \"") + filename + "\" for reading.");
+				return MStatus::kFailure;
+			}
+
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+				CloseHandle(file);
+				MGlobal::displayError(MString("The trajectory file \"") + filename + "\" is empty.");
+				return MStatus::kFailure;
+			}
+
+			HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			const void *data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+
+			// The view keeps the mapping and file alive.
+			if (mapping)
+				CloseHandle(mapping);
+			CloseHandle(file);
+
+			if (!data) {
+				MGlobal::displayError(MString("Failed to map file \"") + filename + "\".");
+				return MStatus::kFailure;
+			}
+
+			m_size = size_t(size.QuadPart);
+#else
+			const int fd = ::open(filename, O_RDONLY);
+
+			if (fd == -1) {
+				MGlobal::displayError(MString("Unable to open file \"") + filename + "\" for reading.");
+				return MStatus::kFailure;
+			}
+
+			struct stat st;
+			if (fstat(fd, &st) != 0 || st.st_size == 0) {
+				::close(fd);
+				MGlobal::displayError(MString("The trajectory file \"") + filename + "\" is empty.");
+				return MStatus::kFailure;
+			}
+
+			void *data = mmap(NULL, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+			// The mapping keeps the file alive.
+			::close(fd);
+
+			if (data == MAP_FAILED) {
+				MGlobal::displayError(MString("Failed to map file \"") + filename + "\".");
+				return MStatus::kFailure;
+			}
+
+			m_size = size_t(st.st_size);
+#endif /* N Windows */
+
+			m_data = static_cast<const char *>(data);
+			m_filename = filename;
+
+			/*
+			 * Index the frames. Every configuration starts with a "t = <step>" line.
+			 */
+
+			for (const char *it = m_data, *end = m_data + m_size; it < end;) {
+				const char *line = it;
+				const char *newline = static_cast<const char *>(memchr(it, '\n', end - it));
+				it = newline ? newline + 1 : end;
+
+				while (line < it && (*line == ' ' || *line == '\t'))
+					++line;
+
+				if (line < it && *line == 't')
+					m_frames.push_back(size_t(line - m_data));
+			}
+
+			if (m_frames.empty()) {
+				MGlobal::displayError(MString("No configurations found in trajectory file \"") + filename + "\".");
+				close();
+				return MStatus::kFailure;
+			}
+
+			return MStatus::kSuccess;
+		}
+
+		void OxDnaTrajectory::close() {
+			if (m_data) {
+#if defined(WIN32) || defined(WIN64)
+				UnmapViewOfFile(m_data);
+#else
+				munmap(const_cast<char *>(m_data), m_size);
+#endif /* N Windows */
+			}
+
+			m_data = NULL;
+			m_size = 0;
+			m_frames.clear();
+			m_filename.clear();
+		}
+
+		MStatus OxDnaTrajectory::readFrame(size_t frame, std::vector<MVector> & positions) const {
+			positions.clear();
+
+			if (frame >= m_frames.size())
+				return MStatus::kInvalidParameter;
+
+			const char *it = m_data + m_frames[frame], *end = frame + 1 < m_frames.size() ? m_data + m_frames[frame + 1] : m_data + m_size;
+			char buffer[MAX_LINE_LENGTH];
+
+			while (it < end) {
+				const char *newline = static_cast<const char *>(memchr(it, '\n', end - it));
+				const char *line_end = newline ? newline : end;
+				const size_t length = std::min(size_t(line_end - it), size_t(MAX_LINE_LENGTH - 1));
+
+				memcpy(buffer, it, length);
+				buffer[length] = '\0';
+				it = newline ? newline + 1 : end;
+
+				char *line = buffer;
+
+				while (*line == ' ' || *line == '\t')
+					++line;
+
+				if (FileReader_skipLine(line) || *line == 't' || *line == 'b' || *line == 'E')
+					continue;
+
+				MVector position;
+				if (FileReader_parse(line, position.x) && FileReader_parse(line, position.y) && FileReader_parse(line, position.z))
+					positions.push_back(position);
+			}
+
+			return MStatus::kSuccess;
+		}
+	}
+}
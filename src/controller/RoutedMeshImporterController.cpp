@@ -1,14 +1,128 @@
 #include <controller/RoutedMeshImporter.h>
 #include <controller/PaintStrand.h>
-#include <Creator.h>
+#include <model/BaseBatch.h>
+#include <model/Object.h>
+
+#include <DNA.h>
 
 #include <maya/MQuaternion.h>
+#include <maya/MThreadPool.h>
+#include <maya/MTransformationMatrix.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 #include <string>
 
+/*
+ * Edges are distributed over the thread pool in tasks of this many edges.
+ */
+#define PARALLEL_TASK_SIZE 16
+
 namespace Helix {
 	namespace Controller {
+		struct RoutedMeshImporter_Task {
+			void (*function)(void *, size_t);
+			void *data;
+			size_t begin, end;
+		};
+
+		MThreadRetVal RoutedMeshImporter_executeTask(void *data) {
+			const RoutedMeshImporter_Task & task(*static_cast<RoutedMeshImporter_Task *>(data));
+
+			for (size_t i = task.begin; i < task.end; ++i)
+				task.function(task.data, i);
+
+			return (MThreadRetVal) 0;
+		}
+
+		void RoutedMeshImporter_createTasks(void *data, MThreadRootTask *root) {
+			std::vector<RoutedMeshImporter_Task> & tasks(*static_cast<std::vector<RoutedMeshImporter_Task> *>(data));
+
+			for (std::vector<RoutedMeshImporter_Task>::iterator it = tasks.begin(); it != tasks.end(); ++it)
+				MThreadPool::createTask(RoutedMeshImporter_executeTask, &*it, root);
+
+			MThreadPool::executeAndJoin(root);
+		}
+
+		/*
+		 * Calls function(data, i) for all i in [0, count) using the Maya thread pool. The function must not call the Maya API other than for plain math.
+		 * Falls back to a sequential loop if the thread pool is not available.
+		 */
+		MStatus RoutedMeshImporter_parallelFor(size_t count, void (*function)(void *, size_t), void *data) {
+			std::vector<RoutedMeshImporter_Task> tasks;
+			tasks.reserve(count / PARALLEL_TASK_SIZE + 1);
+
+			for (size_t i = 0; i < count; i += PARALLEL_TASK_SIZE) {
+				RoutedMeshImporter_Task task = { function, data, i, std::min(i + PARALLEL_TASK_SIZE, count) };
+				tasks.push_back(task);
+			}
+
+			if (tasks.size() <= 1 || !MThreadPool::init()) {
+				for (std::vector<RoutedMeshImporter_Task>::iterator it = tasks.begin(); it != tasks.end(); ++it)
+					RoutedMeshImporter_executeTask(&*it);
+
+				return MStatus::kSuccess;
+			}
+
+			MStatus status = MThreadPool::newParallelRegion(RoutedMeshImporter_createTasks, &tasks);
+			MThreadPool::release();
+			HMEVALUATE_RETURN_DESCRIPTION("MThreadPool::newParallelRegion", status);
+
+			return MStatus::kSuccess;
+		}
+
+		void RoutedMeshImporter::ComputeDescriptor(void *importer, size_t index) {
+			const RoutedMeshImporter & self(*static_cast<RoutedMeshImporter *>(importer));
+			const Edge & edge(self.m_edges[index]), & next_edge(self.m_edges[index + 1]);
+			HelixDescriptor & descriptor(static_cast<RoutedMeshImporter *>(importer)->m_descriptors[index]);
+
+			descriptor.valid = edge.hasCylinder;
+
+			if (!descriptor.valid)
+				return;
+
+			const MVector start(self.m_vertices[edge.vertex]);
+			const MVector end(self.m_vertices[next_edge.vertex]);
+			descriptor.normal = (end - start).normal();
+
+			descriptor.start_cylinder = start + descriptor.normal * edge.cylinder[0];
+			descriptor.end_cylinder = start + descriptor.normal * edge.cylinder[1];
+			descriptor.length = (descriptor.end_cylinder - descriptor.start_cylinder).length();
+			descriptor.bases = DNA::DistanceToBaseCount(descriptor.length);
+
+			const MVector error_vector(descriptor.normal * ((descriptor.length - DNA::HelixLength(descriptor.length)) / 2));
+			descriptor.start_cylinder += error_vector;
+			descriptor.end_cylinder -= error_vector;
+
+			if (descriptor.bases <= 0) {
+				descriptor.valid = false;
+				return;
+			}
+
+			/*
+			 * The first helix uses the initial rotation, the following ones the angle given on the edge after it, if any.
+			 */
+
+			double angle = 0.0;
+
+			if (index == 0) {
+				descriptor.hasAngle = true;
+				angle = self.m_initialRotation;
+			} else if (index + 1 < self.m_edges.size() && self.m_edges[index + 1].hasAngle) {
+				descriptor.hasAngle = true;
+				angle = self.m_edges[index + 1].angle;
+			} else
+				descriptor.hasAngle = false;
+
+			descriptor.tangent = (descriptor.normal ^ MVector::yAxis ^ descriptor.normal).normal().rotateBy(MQuaternion(toRadians(angle), descriptor.normal));
+
+			descriptor.positions.resize(size_t(descriptor.bases) * 2);
+
+			if (descriptor.bases > 0)
+				DNA::CalculateBasePairPositions(0, descriptor.bases, &descriptor.positions[0], 0.0, descriptor.bases);
+		}
+
 		MStatus RoutedMeshImporter::read(const char *filename) {
 			std::ifstream file(filename);
 
@@ -78,127 +192,152 @@ namespace Helix {
 				}
 			}
 
-			MStatus status;
-			std::vector<Model::Helix> helices;
-			helices.reserve(m_edges.size() - 1);
-
-			{
-				double rotation(m_initialRotation);
-				std::vector<Edge>::const_iterator it = m_edges.begin();
-				std::vector<Edge>::const_iterator prev_it = it++;
-
-				if (prev_it->vertex >= m_vertices.size()) {
-					HPRINT("Index out of range: %u", prev_it->vertex);
-					return MStatus::kInvalidParameter;
-				}
+			if (m_edges.size() < 2) {
+				HPRINT("At least two edges are required");
+				return MStatus::kInvalidParameter;
+			}
 
+			for (std::vector<Edge>::const_iterator it = m_edges.begin(); it != m_edges.end(); ++it) {
 				if (it->vertex >= m_vertices.size()) {
 					HPRINT("Index out of range: %u", it->vertex);
 					return MStatus::kInvalidParameter;
 				}
+			}
 
-				Creator creator;
-				MVector start(m_vertices[prev_it->vertex]);
-				MVector end(m_vertices[it->vertex]);
-				MVector normal((end - start).normal());
+			MStatus status;
+
+			/*
+			 * Everything but the tangents only depends on the edge itself.
+			 */
+
+			m_descriptors.clear();
+			m_descriptors.resize(m_edges.size() - 1);
 
-				MVector tangent((normal ^ MVector::yAxis ^ normal).normal().rotateBy(MQuaternion(toRadians(rotation), normal)));
-				MVector start_cylinder(start + normal * prev_it->cylinder[0]);
-				MVector end_cylinder(start + normal * prev_it->cylinder[1]);
-				double length((end_cylinder - start_cylinder).length());
+			HMEVALUATE_RETURN(status = RoutedMeshImporter_parallelFor(m_descriptors.size(), &RoutedMeshImporter::ComputeDescriptor, this), status);
 
-				MVector error_vector(normal * ((length - DNA::HelixLength(length)) / 2));
-				start_cylinder += error_vector;
-				end_cylinder -= error_vector;
+			/*
+			 * Unless an angle is given, a helix is rotated so that its first base continues from the end base of the previous helix.
+			 */
+
+			{
+				bool hasEndBase = false;
+				MVector end_base;
 
-				for (; it != m_edges.end(); ++it, ++prev_it) {
-					if (!prev_it->hasCylinder)
+				for (std::vector<HelixDescriptor>::iterator it = m_descriptors.begin(); it != m_descriptors.end(); ++it) {
+					if (!it->valid)
 						continue;
 
-					if (prev_it->vertex >= m_vertices.size()) {
-						HPRINT("Index out of range: %u", prev_it->vertex);
-						return MStatus::kInvalidParameter;
+					if (!it->hasAngle && hasEndBase) {
+						const MVector delta(end_base - it->start_cylinder);
+						it->tangent = (it->normal ^ (delta ^ it->normal)).normal();
 					}
 
-					if (it->vertex >= m_vertices.size()) {
-						HPRINT("Index out of range: %u", it->vertex);
-						return MStatus::kInvalidParameter;
-					}
+					end_base = it->end_cylinder + it->tangent.rotateBy(MQuaternion(toRadians(DNA::HelixRotation(it->length)), it->normal));
+					hasEndBase = true;
+
+					HPRINT("end_base: %f %f %f", end_base.x, end_base.y, end_base.z);
 
-					const MVector center((end_cylinder + start_cylinder) / 2);
-					const MVector binormal((tangent ^ normal).normal());
+					const MVector center((it->end_cylinder + it->start_cylinder) / 2);
+					const MVector binormal((it->tangent ^ it->normal).normal());
 
 					double transformationMatrix[][4] = {
-							{ binormal.x, tangent.x, normal.x, center.x },
-							{ binormal.y, tangent.y, normal.y, center.y },
-							{ binormal.z, tangent.z, normal.z, center.z },
+							{ binormal.x, it->tangent.x, it->normal.x, center.x },
+							{ binormal.y, it->tangent.y, it->normal.y, center.y },
+							{ binormal.z, it->tangent.z, it->normal.z, center.z },
 							{ 0, 0, 0, 1 }
 					};
 
-					Model::Helix helix;
-					HMEVALUATE_RETURN(status = creator.create(DNA::DistanceToBaseCount(length), MMatrix(transformationMatrix).transpose(), helix), status);
-					helices.push_back(helix);
-
-					// Now recalculate start, end, normal, tangent, binormal, start_cylinder, end_cylinder for the upcoming cylinder if any.
-
-					const std::vector<Edge>::const_iterator next_it(it + 1);
-					if (next_it != m_edges.end()) {
-
-						const MVector end_base(end_cylinder + tangent.rotateBy(MQuaternion(toRadians(DNA::HelixRotation(length)), normal)));
-
-						HPRINT("end_base: %f %f %f", end_base.x, end_base.y, end_base.z);
-						start = m_vertices[it->vertex];
-						end = m_vertices[next_it->vertex];
-						normal = (end - start).normal();
-						start_cylinder = start + normal * it->cylinder[0];
-						end_cylinder = start + normal * it->cylinder[1];
-						length = (end_cylinder - start_cylinder).length();
-						MVector error_vector(normal * ((length - DNA::HelixLength(length)) / 2));
-						start_cylinder += error_vector;
-						end_cylinder -= error_vector;
-
-						// TODO: In case we have an angle, cleanup the code above
-						if (next_it->hasAngle)
-							tangent = MVector((normal ^ MVector::yAxis ^ normal).normal().rotateBy(MQuaternion(toRadians(next_it->angle), normal)));
-						else {
-							const MVector delta(end_base - start_cylinder);
-							tangent = (normal ^ (delta ^ normal)).normal();
-						}
+					it->transform = MMatrix(transformationMatrix).transpose();
+				}
+			}
+
+			/*
+			 * Create all helices, then all bases and connections including the scaffold with a single batch.
+			 */
+
+			Model::Material::Container::size_type numMaterials;
+			Model::Material::Iterator materials_begin;
+			HMEVALUATE_RETURN(materials_begin = Model::Material::AllMaterials_begin(status, numMaterials), status);
+
+			size_t numBases = 0;
+			for (std::vector<HelixDescriptor>::const_iterator it = m_descriptors.begin(); it != m_descriptors.end(); ++it)
+				numBases += it->positions.size();
+
+			Model::BaseBatch batch;
+			batch.reserve(numBases);
+
+			std::vector<Model::Helix> helices;
+			std::vector< std::pair<unsigned int, unsigned int> > scaffoldEnds; // Batch indices of the forward 5' and 3' bases per helix.
+			helices.reserve(m_descriptors.size());
+			scaffoldEnds.reserve(m_descriptors.size());
+
+			for (std::vector<HelixDescriptor>::iterator it = m_descriptors.begin(); it != m_descriptors.end(); ++it) {
+				if (!it->valid)
+					continue;
+
+				HMEVALUATE_RETURN(status = Model::Helix::Create("helix1", MTransformationMatrix(it->transform), it->helix), status);
+				HMEVALUATE_RETURN(status = it->helix.setCylinderRange(0.0, DNA::STEP * (it->bases - 1)), status);
+
+				// Same as Creator, pick two different materials by random.
+				Model::Material materials[2];
+
+				if (numMaterials == 1)
+					materials[0] = materials[1] = *materials_begin;
+				else if (numMaterials >= 2) {
+					int indices[] = { rand() % (int) numMaterials, 0 };
+					do { indices[1] = rand() % (int) numMaterials; } while (indices[0] == indices[1]);
+
+					for (int i = 0; i < 2; ++i)
+						materials[i] = *(materials_begin + indices[i]);
+				}
+
+				unsigned int last[2];
+
+				for (int i = 0; i < it->bases; ++i) {
+					unsigned int current[2];
+
+					for (int j = 0; j < 2; ++j)
+						current[j] = batch.add(it->helix, MString(DNA::GetStrandName(j)) + "_" + (i + 1), it->positions[i * 2 + j], materials[j]);
+
+					batch.connect_opposite(current[0], current[1]);
+
+					if (i > 0) {
+						batch.connect_forward(last[0], current[0]);
+						batch.connect_forward(current[1], last[1]);
 					}
+					else
+						scaffoldEnds.push_back(std::make_pair(current[0], current[0]));
+
+					for (int j = 0; j < 2; ++j)
+						last[j] = current[j];
 				}
+
+				scaffoldEnds.back().second = last[0];
+				helices.push_back(it->helix);
 			}
 
 			// Connect scaffold
-			std::vector<Model::Helix>::iterator it = helices.begin();
-			std::vector<Model::Helix>::iterator prev_it = it++;
+			for (size_t i = 1; i < scaffoldEnds.size(); ++i)
+				batch.connect_forward(scaffoldEnds[i - 1].second, scaffoldEnds[i].first);
 
-			for (; it != helices.end(); ++it, ++prev_it) {
-				Model::Base forward_threeprime, forward_fiveprime;
-				HMEVALUATE_RETURN(status = prev_it->getForwardThreePrime(forward_threeprime), status);
-				HMEVALUATE_RETURN(status = it->getForwardFivePrime(forward_fiveprime), status);
+			const bool circular = helices.size() > 1 && m_edges.begin()->vertex == (--m_edges.end())->vertex;
 
-				HMEVALUATE_RETURN(status = forward_threeprime.connect_forward(forward_fiveprime, true), status);
+			if (circular) {
+				// Circular, connect the first and last bases as well.
+				batch.connect_forward(scaffoldEnds.back().second, scaffoldEnds.front().first);
 			}
 
+			HMEVALUATE_RETURN(status = batch.create(), status);
+
+			if (!(status = Model::Object::Select(helices.begin(), helices.end())))
+				status.perror("Object::Select");
+
 			if (helices.size() > 1) {
 				// Paint the scaffold.
 				Controller::PaintMultipleStrandsWithNewColorFunctor functor;
 				HMEVALUATE_RETURN(status = functor.loadMaterials(), status);
-				Model::Base fiveprime;
-				HMEVALUATE_RETURN(status = helices.begin()->getForwardFivePrime(fiveprime), status);
-				functor(fiveprime);
+				functor(batch[scaffoldEnds.front().first]);
 				HMEVALUATE_DESCRIPTION("Controller::PaintMultipleStrandsWithNewColorFunctor", functor.status());
-
-				if (m_edges.begin()->vertex == (--m_edges.end())->vertex) {
-					// Circular, connect the first and last bases as well.
-					std::vector<Model::Helix>::iterator first = helices.begin();
-					std::vector<Model::Helix>::iterator last = --helices.end();
-					Model::Base threeprime, fiveprime;
-					HMEVALUATE_RETURN(status = last->getForwardThreePrime(threeprime), status);
-					HMEVALUATE_RETURN(status = first->getForwardFivePrime(fiveprime), status);
-
-					HMEVALUATE_RETURN(status = threeprime.connect_forward(fiveprime, true), status);
-				}
 			}
 
 			return MStatus::kSuccess;
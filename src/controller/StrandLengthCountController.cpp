@@ -1,20 +1,109 @@
 #include <controller/StrandLengthCount.h>
 
+#include <model/Helix.h>
+
+#include <DNA.h>
+
+#include <maya/MObjectHandle.h>
+
 namespace Helix {
 	namespace Controller {
 		unsigned int StrandLengthCount::length(Model::Strand & strand) {
-			// First rewind if the strand is not a loop.
-			Model::Strand::BackwardIterator it(strand.reverse_begin());
-			Model::Base start_base;
-			for (; it != strand.reverse_end(); ++it)
-				start_base = *it;
+			MStatus status;
+			const unsigned int length = walk(strand, NULL, status);
 
-			Model::Strand new_strand(start_base);
-			unsigned int length(0);
-			for (Model::Strand::ForwardIterator it(new_strand.forward_begin()); it != new_strand.forward_end(); ++it, ++length);
+			if (!status)
+				HMEVALUATE_DESCRIPTION("StrandLengthCount::walk", status);
 
 			HPRINT("Return length: %u", length);
 			return length;
 		}
+
+		unsigned int StrandLengthCount::walk(Model::Strand & strand, Visited *visited, MStatus & status) {
+			unsigned int length(0);
+			status = MStatus::kSuccess;
+
+			Model::Strand::BackwardIterator it(strand.reverse_begin());
+			for (; it != strand.reverse_end(); ++it, ++length) {
+				if (visited) {
+					MObject object(it->getObject(status));
+
+					if (!status) {
+						HMEVALUATE_DESCRIPTION("Base::getObject", status);
+						return length;
+					}
+
+					visited->insert(MObjectHandle(object));
+				}
+			}
+
+			// A loop has been completely walked by the backward iterator.
+			if (it.loop())
+				return length;
+
+			Model::Strand::ForwardIterator f_it(strand.forward_begin());
+			for (++f_it; f_it != strand.forward_end(); ++f_it, ++length) {
+				if (visited) {
+					MObject object(f_it->getObject(status));
+
+					if (!status) {
+						HMEVALUATE_DESCRIPTION("Base::getObject", status);
+						return length;
+					}
+
+					visited->insert(MObjectHandle(object));
+				}
+			}
+
+			return length;
+		}
+
+		MStatus StrandLengthCount::histogram(Histogram & histogram) {
+			MStatus status;
+			MObjectArray helices;
+			Visited visited;
+
+			histogram = Histogram();
+
+			HMEVALUATE_RETURN(status = Model::Helix::All(helices), status);
+
+			for (unsigned int i = 0; i < helices.length(); ++i) {
+				Model::Helix helix(helices[i]);
+
+				for (Model::Helix::BaseIterator it = helix.begin(); it != helix.end(); ++it) {
+					MObject object;
+					HMEVALUATE_RETURN(object = it->getObject(status), status);
+
+					if (visited.find(MObjectHandle(object)) != visited.end())
+						continue;
+
+					Model::Strand strand(*it);
+					unsigned int length;
+					HMEVALUATE_RETURN(length = walk(strand, &visited, status), status);
+
+					if (length >= histogram.counts.size())
+						histogram.counts.resize(length + 1, 0);
+
+					++histogram.counts[length];
+					++histogram.strands;
+					histogram.bases += length;
+
+					if (histogram.strands == 1 || length < histogram.minLength)
+						histogram.minLength = length;
+
+					if (length > histogram.maxLength)
+						histogram.maxLength = length;
+
+					if (length < DNA::SHORTEST_STAPLE)
+						++histogram.tooShort;
+					else if (length > DNA::SHORTEST_LONGEST_STAPLE)
+						++histogram.tooLong;
+				}
+			}
+
+			histogram.mean = histogram.strands > 0 ? double(histogram.bases) / double(histogram.strands) : 0.0;
+
+			return MStatus::kSuccess;
+		}
 	}
 }
@@ -0,0 +1,246 @@
+#include <controller/TextBasedExporter.h>
+#include <model/Material.h>
+#include <model/Strand.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(WIN32) || defined(WIN64)
+#include <unordered_set>
+#else
+#include <tr1/unordered_set>
+#endif /* N Windows */
+
+#include <maya/MFnDagNode.h>
+#include <maya/MProgressWindow.h>
+#include <maya/MQuaternion.h>
+
+#define WRITE_BUFFER_SIZE (1 << 20)
+
+namespace Helix {
+	namespace Controller {
+#if defined(WIN32) || defined(WIN64)
+		typedef std::unordered_set<MObjectHandle, ObjectHandleHash> TextBasedExporter_handle_set_t;
+#else
+		typedef std::tr1::unordered_set<MObjectHandle, ObjectHandleHash> TextBasedExporter_handle_set_t;
+#endif /* N Windows */
+
+		/*
+		 * Name of the base and the helix it belongs to, as used by the importer to identify bases.
+		 */
+		MStatus TextBasedExporter_names(Model::Base & base, MString & name, MObject & helix, MString & helixName) {
+			MStatus status;
+			MObject object;
+			HMEVALUATE_RETURN(object = base.getObject(status), status);
+
+			MFnDagNode base_dagNode(object);
+			HMEVALUATE_RETURN(name = base_dagNode.name(&status), status);
+
+			HMEVALUATE_RETURN(helix = base_dagNode.parent(0, &status), status);
+			HMEVALUATE_RETURN(helixName = MFnDagNode(helix).name(&status), status);
+
+			return MStatus::kSuccess;
+		}
+
+		/*
+		 * Walks the strand of base once and marks all of its bases as visited. If every base of the strand belongs to an exported helix and
+		 * they share the same material, the strand is written as a single paint strand line and its bases are added to painted,
+		 * so that they are written without a material of their own.
+		 */
+		MStatus TextBasedExporter_strand(Model::Base & base, const Model::Material::Assignments & materials, const TextBasedExporter_handle_set_t & exported,
+				TextBasedExporter_handle_set_t & visited, TextBasedExporter_handle_set_t & painted, std::string & paintStrands) {
+			MStatus status;
+			Model::Strand strand(base);
+			strand.rewind();
+
+			std::vector<MObjectHandle> bases;
+			Model::Material material;
+			bool uniform = true;
+
+			for (Model::Strand::ForwardIterator it = strand.forward_begin(); it != strand.forward_end(); ++it) {
+				MObject object;
+				HMEVALUATE_RETURN(object = it->getObject(status), status);
+				visited.insert(MObjectHandle(object));
+
+				if (!uniform)
+					continue;
+
+				MObject helix;
+				HMEVALUATE_RETURN(helix = MFnDagNode(object).parent(0, &status), status);
+
+				Model::Material baseMaterial;
+				if (exported.find(MObjectHandle(helix)) == exported.end() || !materials.find(object, baseMaterial) || (!bases.empty() && baseMaterial != material))
+					uniform = false;
+				else {
+					material = baseMaterial;
+					bases.push_back(MObjectHandle(object));
+				}
+			}
+
+			if (!uniform)
+				return MStatus::kSuccess;
+
+			MObject helix;
+			MString name, helixName;
+			HMEVALUATE_RETURN(status = TextBasedExporter_names(strand.getDefiningBase(), name, helix, helixName), status);
+
+			paintStrands += std::string("ps ") + helixName.asChar() + " " + name.asChar() + " " + material.getMaterial().asChar() + "\n";
+			painted.insert(bases.begin(), bases.end());
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus TextBasedExporter::write(const char *filename, const MObjectArray & helices) {
+			MStatus status;
+			std::FILE *file = std::fopen(filename, "w");
+
+			if (!file) {
+				MGlobal::displayError(MString("Can't open file \"") + filename + "\" for writing.");
+				return MStatus::kFailure;
+			}
+
+			std::vector<char> buffer(WRITE_BUFFER_SIZE);
+			std::setvbuf(file, &buffer[0], _IOFBF, buffer.size());
+
+			Model::Material::Assignments materials;
+			if (!(status = materials.query())) {
+				std::fclose(file);
+				return status;
+			}
+
+			std::fprintf(file, "# vHelix text based export\n# %s\n\n", Date().c_str());
+
+			/*
+			 * All helices must be created before any connections are made, thus the connections are buffered and written last.
+			 */
+
+			std::string connections, pairs, paintStrands;
+
+			/*
+			 * Connections to helices that are not exported can't be made by the importer and are skipped.
+			 */
+
+			TextBasedExporter_handle_set_t exported, visited, painted;
+
+			for (unsigned int i = 0; i < helices.length(); ++i)
+				exported.insert(MObjectHandle(helices[i]));
+
+			unsigned int skipped = 0;
+
+			if (!MProgressWindow::reserve())
+				MGlobal::displayWarning("Failed to reserve the progress window");
+
+			MProgressWindow::setTitle("Text based exporter");
+			MProgressWindow::setProgressStatus("Writing helices...");
+			MProgressWindow::setProgressRange(0, int(helices.length()));
+			MProgressWindow::startProgress();
+
+			for (unsigned int i = 0; i < helices.length(); ++i) {
+				Model::Helix helix(helices[i]);
+
+				MString helixName;
+				HMEVALUATE(helixName = MFnDagNode(helices[i]).name(&status), status);
+
+				MVector translation;
+				MQuaternion rotation;
+				HMEVALUATE(status = helix.getTranslation(translation, MSpace::kTransform), status);
+				HMEVALUATE(status = helix.getRotation(rotation), status);
+
+				if (!status)
+					break;
+
+				std::fprintf(file, "h %s %.10g %.10g %.10g %.10g %.10g %.10g %.10g\n", helixName.asChar(), translation.x, translation.y, translation.z, rotation.x, rotation.y, rotation.z, rotation.w);
+
+				for (Model::Helix::BaseIterator it = helix.begin(); it != helix.end(); ++it) {
+					Model::Base base(*it);
+
+					MString name;
+					HMEVALUATE(name = MFnDagNode(base.getObject(status)).name(), status);
+
+					DNA::Name label;
+					HMEVALUATE(status = base.getTranslation(translation, MSpace::kTransform), status);
+					HMEVALUATE(status = base.getLabel(label), status);
+
+					if (!status)
+						break;
+
+					const MObjectHandle handle(base.getObject(status));
+
+					if (visited.find(handle) == visited.end())
+						HMEVALUATE(status = TextBasedExporter_strand(base, materials, exported, visited, painted, paintStrands), status);
+
+					if (!status)
+						break;
+
+					Model::Material material;
+					const bool hasMaterial = painted.find(handle) == painted.end() && materials.find(handle.object(), material);
+
+					std::fprintf(file, "b %s %s %.10g %.10g %.10g %s %c\n", name.asChar(), helixName.asChar(), translation.x, translation.y, translation.z,
+							hasMaterial ? material.getMaterial().asChar() : "-", label.toChar());
+
+					Model::Base forward(base.forward(status));
+
+					if (status && forward) {
+						MObject targetHelix;
+						MString targetName, targetHelixName;
+						HMEVALUATE(status = TextBasedExporter_names(forward, targetName, targetHelix, targetHelixName), status);
+
+						if (!status)
+							break;
+
+						if (exported.find(MObjectHandle(targetHelix)) != exported.end())
+							connections += std::string("c ") + helixName.asChar() + " " + name.asChar() + " - " + targetHelixName.asChar() + " " + targetName.asChar() + " -\n";
+						else
+							++skipped;
+					}
+
+					Model::Base opposite(base.opposite(status));
+
+					if (status && opposite && !base.opposite_isDestination(status)) {
+						MObject targetHelix;
+						MString targetName, targetHelixName;
+						HMEVALUATE(status = TextBasedExporter_names(opposite, targetName, targetHelix, targetHelixName), status);
+
+						if (!status)
+							break;
+
+						if (exported.find(MObjectHandle(targetHelix)) != exported.end())
+							pairs += std::string("o ") + helixName.asChar() + " " + name.asChar() + " " + targetHelixName.asChar() + " " + targetName.asChar() + "\n";
+						else
+							++skipped;
+					}
+
+					// forward and opposite return kNotFound for end bases and unpaired bases.
+					status = MStatus::kSuccess;
+				}
+
+				if (!status)
+					break;
+
+				MProgressWindow::advanceProgress(1);
+			}
+
+			MProgressWindow::endProgress();
+
+			if (skipped > 0)
+				MGlobal::displayWarning(MString("Skipped ") + int(skipped) + " connections to helices that were not exported.");
+
+			if (status) {
+				std::fputs("\n", file);
+				std::fwrite(pairs.data(), 1, pairs.size(), file);
+				std::fputs("\n", file);
+				std::fwrite(connections.data(), 1, connections.size(), file);
+				std::fputs("\n", file);
+				std::fwrite(paintStrands.data(), 1, paintStrands.size(), file);
+			}
+
+			if (std::fclose(file) != 0 && status) {
+				MGlobal::displayError(MString("Failed to write to file \"") + filename + "\".");
+				return MStatus::kFailure;
+			}
+
+			return status;
+		}
+	}
+}
@@ -8,6 +8,7 @@
 
 #include <cstdio>
 #include <fstream>
+#include <set>
 #include <string>
 
 #include <maya/MQuaternion.h>
@@ -28,6 +29,15 @@ namespace Helix {
 			}
 		};
 
+		/*
+		 * A strand to paint given by the 'ps' command. Without a material the strand is painted with a new random color.
+		 */
+		struct paint_strand_t {
+			std::string helixName, name, materialName;
+
+			inline paint_strand_t(const char *helixName, const char *name, const char *materialName = "") : helixName(helixName), name(name), materialName(materialName) {}
+		};
+
 		struct base_offset_comparator_t : public std::binary_function<std::pair<Model::Base, int>, std::pair<Model::Base, int>, bool> {
 			const int offset;
 
@@ -85,11 +95,12 @@ namespace Helix {
 			MVector position;
 			MQuaternion orientation;
 			unsigned int bases;
-			char nameBuffer[BUFFER_SIZE], helixNameBuffer[BUFFER_SIZE], materialNameBuffer[BUFFER_SIZE], targetNameBuffer[BUFFER_SIZE], targetHelixNameBuffer[BUFFER_SIZE];
+			char nameBuffer[BUFFER_SIZE], helixNameBuffer[BUFFER_SIZE], materialNameBuffer[BUFFER_SIZE], targetNameBuffer[BUFFER_SIZE], targetHelixNameBuffer[BUFFER_SIZE], typeBuffer[BUFFER_SIZE], targetTypeBuffer[BUFFER_SIZE];
 			char label;
 			bool autostaple(false);
-			std::vector< std::pair<std::string, std::string> > paintStrands;
+			std::vector<paint_strand_t> paintStrands;
 			std::vector<Model::Base> paintStrandBases, disconnectBackwardBases;
+			std::vector< std::pair<Model::Base, Model::Material> > materialStrandBases;
 
 			std::vector<Model::Base> nonNickedBases;
 
@@ -101,16 +112,22 @@ namespace Helix {
 					helices.push_back(Helix(position, orientation, nameBuffer));
 				else if (sscanf(line.c_str(), "hb %s %u %lf %lf %lf %lf %lf %lf %lf", nameBuffer, &bases, &position.x, &position.y, &position.z, &orientation.x, &orientation.y, &orientation.z, &orientation.w) == 9)
 					helices.push_back(Helix(position, orientation, nameBuffer, bases));
-				else if (sscanf(line.c_str(), "b %s %s %lf %lf %lf %s %c", nameBuffer, helixNameBuffer, &position.x, &position.y, &position.z, materialNameBuffer, &label) == 7) {
-					std::vector<TextBasedImporter::Helix>::iterator helix_it(std::find(helices.begin(), helices.end(), helixNameBuffer));
-					explicitBases.push_back(TextBasedImporter::Base(nameBuffer, position, materialNameBuffer, label));
-				}
+				else if (sscanf(line.c_str(), "b %s %s %lf %lf %lf %s %c", nameBuffer, helixNameBuffer, &position.x, &position.y, &position.z, materialNameBuffer, &label) == 7)
+					explicitBases.push_back(TextBasedImporter::Base(nameBuffer, helixNameBuffer, position, materialNameBuffer, label));
+				else if (sscanf(line.c_str(), "c %s %s %s %s %s %s", helixNameBuffer, nameBuffer, typeBuffer, targetHelixNameBuffer, targetNameBuffer, targetTypeBuffer) == 6)
+					connections.push_back(Connection(helixNameBuffer, nameBuffer, targetHelixNameBuffer, targetNameBuffer, Connection::TypeFromString(typeBuffer), Connection::TypeFromString(targetTypeBuffer)));
 				else if (sscanf(line.c_str(), "c %s %s %s %s", helixNameBuffer, nameBuffer, targetHelixNameBuffer, targetNameBuffer) == 4)
 					connections.push_back(Connection(helixNameBuffer, nameBuffer, targetHelixNameBuffer, targetNameBuffer, Connection::TypeFromString(nameBuffer), Connection::TypeFromString(targetNameBuffer)));
+				else if (sscanf(line.c_str(), "o %s %s %s %s", helixNameBuffer, nameBuffer, targetHelixNameBuffer, targetNameBuffer) == 4)
+					pairs.push_back(Connection(helixNameBuffer, nameBuffer, targetHelixNameBuffer, targetNameBuffer, Connection::kNamed, Connection::kNamed));
+				else if (sscanf(line.c_str(), "l %s %s %c", helixNameBuffer, nameBuffer, &label) == 3)
+					explicitBaseLabels.insert(std::make_pair(std::string(helixNameBuffer) + "|" + nameBuffer, label));
 				else if (sscanf(line.c_str(), "l %s %c", nameBuffer, &label) == 2)
 					explicitBaseLabels.insert(std::make_pair(nameBuffer, label));
+				else if (sscanf(line.c_str(), "ps %s %s %s", helixNameBuffer, nameBuffer, materialNameBuffer) == 3)
+					paintStrands.push_back(paint_strand_t(helixNameBuffer, nameBuffer, materialNameBuffer));
 				else if (sscanf(line.c_str(), "ps %s %s", helixNameBuffer, nameBuffer) == 2)
-					paintStrands.push_back(std::make_pair(std::string(helixNameBuffer), std::string(nameBuffer)));
+					paintStrands.push_back(paint_strand_t(helixNameBuffer, nameBuffer));
 				else if (line == "autostaple" || line == "autonick")
 					autostaple = true;
 			}
@@ -176,7 +193,9 @@ namespace Helix {
 			typedef std::tr1::unordered_map<std::string, Model::Base> string_base_map_t;
 #endif /* N Windows */
 
-			string_base_map_t baseStructures;
+			// Base names are only unique within their helix, thus bases are identified by both. Explicit labels might only give the base name.
+			string_base_map_t baseStructures, baseStructuresByName;
+			std::set<std::string> ambiguousNames;
 
 			if (!explicitBases.empty()) {
 				if (!MProgressWindow::reserve())
@@ -187,6 +206,16 @@ namespace Helix {
 				MProgressWindow::setProgressRange(0, int(explicitBases.size()));
 				MProgressWindow::startProgress();
 
+				/*
+				 * Setting materials uses MEL, thus all bases of the same material are buffered and given their material using a single command.
+				 */
+#if defined(WIN32) || defined(WIN64)
+				typedef std::unordered_map<std::string, std::pair<Model::Material, std::vector<Model::Base> > > string_material_map_t;
+#else
+				typedef std::tr1::unordered_map<std::string, std::pair<Model::Material, std::vector<Model::Base> > > string_material_map_t;
+#endif /* N Windows */
+				string_material_map_t materials;
+
 				for (std::vector<Base>::iterator it(explicitBases.begin()); it != explicitBases.end(); ++it) {
 					if (helixStructures.find(it->helixName) == helixStructures.end()) {
 						HPRINT("Unable to find Helix structure \"%s\"", it->helixName.c_str());
@@ -197,10 +226,56 @@ namespace Helix {
 					HMEVALUATE_RETURN(status = Model::Base::Create(helix, it->name.c_str(), it->position, base), status);
 					base.setLabel(it->label);
 
-					Model::Material material;
-					HMEVALUATE_RETURN(status = Model::Material::Find(it->materialName.c_str(), material), status);
-					HMEVALUATE(status = base.setMaterial(material), status);
-					baseStructures.insert(std::make_pair(it->name, base));
+					if (it->materialName != "-") {
+						string_material_map_t::iterator material_it(materials.find(it->materialName));
+
+						if (material_it == materials.end()) {
+							Model::Material material;
+							HMEVALUATE_RETURN(status = Model::Material::Find(it->materialName.c_str(), material), status);
+							material_it = materials.insert(std::make_pair(it->materialName, std::make_pair(material, std::vector<Model::Base>()))).first;
+						}
+
+						material_it->second.second.push_back(base);
+					}
+
+					baseStructures.insert(std::make_pair(it->helixName + "|" + it->name, base));
+
+					if (!baseStructuresByName.insert(std::make_pair(it->name, base)).second)
+						ambiguousNames.insert(it->name);
+
+					MProgressWindow::advanceProgress(1);
+				}
+
+				for (string_material_map_t::iterator it(materials.begin()); it != materials.end(); ++it) {
+					Model::Material::ApplyMaterialToBases apply(it->second.first.setMaterialOnMultipleBases());
+
+					for (std::vector<Model::Base>::iterator base_it(it->second.second.begin()); base_it != it->second.second.end(); ++base_it)
+						HMEVALUATE_RETURN(status = apply.add(*base_it), status);
+
+					HMEVALUATE(status = apply.apply(), status);
+				}
+
+				MProgressWindow::endProgress();
+			}
+
+			if (!pairs.empty()) {
+				if (!MProgressWindow::reserve())
+					MGlobal::displayWarning("Failed to reserve the progress window");
+
+				MProgressWindow::setTitle("Import routed polygon");
+				MProgressWindow::setProgressStatus("Pairing explicit bases...");
+				MProgressWindow::setProgressRange(0, int(pairs.size()));
+				MProgressWindow::startProgress();
+
+				for (std::vector<Connection>::iterator it(pairs.begin()); it != pairs.end(); ++it) {
+					string_base_map_t::iterator fromIt(baseStructures.find(it->fromHelixName + "|" + it->fromName)), toIt(baseStructures.find(it->toHelixName + "|" + it->toName));
+
+					if (fromIt == baseStructures.end() || toIt == baseStructures.end()) {
+						HPRINT("Failed to find base pair \"%s|%s\" and \"%s|%s\"", it->fromHelixName.c_str(), it->fromName.c_str(), it->toHelixName.c_str(), it->toName.c_str());
+						return MStatus::kFailure;
+					}
+
+					HMEVALUATE_RETURN(status = fromIt->second.connect_opposite(toIt->second, true), status);
 
 					MProgressWindow::advanceProgress(1);
 				}
@@ -217,15 +292,24 @@ namespace Helix {
 				MProgressWindow::setProgressRange(0, int(explicitBaseLabels.size()));
 				MProgressWindow::startProgress();
 
-				// Set explicit labels
+				// Set explicit labels, given either as <helix>|<base> or only the name of the base.
 				for (explicit_base_labels_t::iterator it(explicitBaseLabels.begin()); it != explicitBaseLabels.end(); ++it) {
-					if (baseStructures.find(it->first) == baseStructures.end()) {
+					const bool byName = it->first.find('|') == std::string::npos;
+
+					if (byName && ambiguousNames.find(it->first) != ambiguousNames.end()) {
+						HPRINT("Base name \"%s\" is used in several helices, give the label as \"l <helix> <base> <label>\"", it->first.c_str());
+						return MStatus::kFailure;
+					}
+
+					string_base_map_t & structures(byName ? baseStructuresByName : baseStructures);
+					string_base_map_t::iterator base_it(structures.find(it->first));
+
+					if (base_it == structures.end()) {
 						HPRINT("Unable to find Base structure \"%s\"", it->first.c_str());
 						return MStatus::kFailure;
 					}
 
-					Model::Base & base(baseStructures[it->first]);
-					HMEVALUATE_RETURN(status = base.setLabel(it->second), status);
+					HMEVALUATE_RETURN(status = base_it->second.setLabel(it->second), status);
 
 					MProgressWindow::advanceProgress(1);
 				}
@@ -242,23 +326,31 @@ namespace Helix {
 				MProgressWindow::setProgressRange(0, int(paintStrands.size()));
 				MProgressWindow::startProgress();
 
-				for (std::vector< std::pair<std::string, std::string> >::const_iterator it(paintStrands.begin()); it != paintStrands.end(); ++it) {
-					string_helix_map_t::iterator helixIt(helixStructures.find(it->first));
+#if defined(WIN32) || defined(WIN64)
+				typedef std::unordered_map<std::string, Model::Material> string_material_map_t;
+#else
+				typedef std::tr1::unordered_map<std::string, Model::Material> string_material_map_t;
+#endif /* N Windows */
+				string_material_map_t materials;
+
+				for (std::vector<paint_strand_t>::const_iterator it(paintStrands.begin()); it != paintStrands.end(); ++it) {
+					string_helix_map_t::iterator helixIt(helixStructures.find(it->helixName));
 
 					if (helixIt == helixStructures.end()) {
-						HPRINT("Failed to find helix named \"%s\"", it->first.c_str());
+						HPRINT("Failed to find helix named \"%s\"", it->helixName.c_str());
 						return MStatus::kFailure;
 					}
 
+					// Strands with a material are always given by a named base.
 					Model::Base base;
-					const Connection::Type type(Connection::TypeFromString(it->second.c_str()));
+					const Connection::Type type(it->materialName.empty() ? Connection::TypeFromString(it->name.c_str()) : Connection::kNamed);
 					switch (type) {
 					case Connection::kNamed:
 					{
-						string_base_map_t::iterator baseIt(baseStructures.find(it->second));
+						string_base_map_t::iterator baseIt(baseStructures.find(it->helixName + "|" + it->name));
 
 						if (baseIt == baseStructures.end()) {
-							HPRINT("failed to find base \"%s\"", it->second.c_str());
+							HPRINT("failed to find base \"%s\"", it->name.c_str());
 							return MStatus::kFailure;
 						}
 
@@ -270,7 +362,20 @@ namespace Helix {
 						break;
 					}
 
-					paintStrandBases.push_back(base);
+					if (it->materialName.empty())
+						paintStrandBases.push_back(base);
+					else {
+						string_material_map_t::iterator material_it(materials.find(it->materialName));
+
+						if (material_it == materials.end()) {
+							Model::Material material;
+							HMEVALUATE_RETURN(status = Model::Material::Find(it->materialName.c_str(), material), status);
+							material_it = materials.insert(std::make_pair(it->materialName, material)).first;
+						}
+
+						materialStrandBases.push_back(std::make_pair(base, material_it->second));
+					}
+
 					MProgressWindow::advanceProgress(1);
 				}
 
@@ -305,7 +410,7 @@ namespace Helix {
 					Model::Base fromBase, toBase;
 
 					if (it->fromType == Connection::kNamed) {
-						string_base_map_t::iterator baseIt(baseStructures.find(it->fromName));
+						string_base_map_t::iterator baseIt(baseStructures.find(it->fromHelixName + "|" + it->fromName));
 
 						if (baseIt == baseStructures.end()) {
 							HPRINT("failed to find base \"%s\"", it->fromName.c_str());
@@ -318,7 +423,7 @@ namespace Helix {
 						HMEVALUATE_RETURN(status = getBaseFromConnectionType(fromHelix, it->fromType, fromBase), status);
 
 					if (it->toType == Connection::kNamed) {
-						string_base_map_t::iterator baseIt(baseStructures.find(it->toName));
+						string_base_map_t::iterator baseIt(baseStructures.find(it->toHelixName + "|" + it->toName));
 
 						if (baseIt == baseStructures.end()) {
 							HPRINT("failed to find base \"%s\"", it->toName.c_str());
@@ -372,6 +477,25 @@ namespace Helix {
 				MProgressWindow::endProgress();
 			}
 
+			if (!materialStrandBases.empty()) {
+				if (!MProgressWindow::reserve())
+					MGlobal::displayWarning("Failed to reserve the progress window");
+
+				MProgressWindow::setTitle("Import routed polygon");
+				MProgressWindow::setProgressStatus("Painting strands with explicit materials...");
+				MProgressWindow::setProgressRange(0, int(materialStrandBases.size()));
+				MProgressWindow::startProgress();
+
+				Controller::PaintMultipleStrandsNoUndoFunctor paint;
+				for (std::vector< std::pair<Model::Base, Model::Material> >::iterator it(materialStrandBases.begin()); it != materialStrandBases.end(); ++it) {
+					paint(Model::Strand(it->first), it->second);
+					HMEVALUATE_RETURN(status = paint.status(), status);
+					MProgressWindow::advanceProgress(1);
+				}
+
+				MProgressWindow::endProgress();
+			}
+
 			/*
 			 * Group bases on the same strands.
 			 */
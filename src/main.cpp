@@ -29,23 +29,36 @@
 #include <ExtendStrand.h>
 #include <ExtendGui.h>
 #include <StrandLengthCount.h>
+#include <MeltingTemperature.h>
 #include <ToggleCylinderBaseView.h>
 #include <ToggleLocatorRender.h>
 #include <ToggleShowSuggestedConnections.h>
 #include <ExportStrands.h>
 #include <JSONTranslator.h>
 #include <OxDnaTranslator.h>
+#include <OxDnaTrajectoryNode.h>
+#include <LoadOxDnaTrajectory.h>
+#include <ConvertOxDnaBinary.h>
 #include <RoutedMeshTranslator.h>
 #include <TextBasedTranslator.h>
 #include <RetargetBase.h>
 #include <TargetHelixBaseBackward.h>
 #include <CreateCurves.h>
 
+#include <model/EndIndex.h>
+
 #include <view/BaseShape.h>
 #include <view/BaseShapeUI.h>
+#include <view/BaseDrawOverride.h>
+#include <view/BaseRenderer.h>
+#include <view/HelixBVH.h>
+#include <view/BaseGrid.h>
 #include <view/HelixShape.h>
 #include <view/HelixShapeUI.h>
+#include <view/HelixDrawOverride.h>
+#include <view/HelixLocatorDrawOverride.h>
 #include <view/ConnectSuggestionsLocatorNode.h>
+#include <view/ConnectSuggestionsDrawOverride.h>
 #include <view/ConnectSuggestionsContextCommand.h>
 #include <view/ConnectSuggestionsToolCommand.h>
 
@@ -61,8 +74,34 @@
 #include <maya/MProgressWindow.h>
 #include <maya/MSceneMessage.h>
 
+#ifdef HELIX_VIEWPORT2
+#include <maya/MDrawRegistry.h>
+#endif /* N HELIX_VIEWPORT2 */
+
 #include <ctime>
 
+/*
+ * Viewport 2.0 finds the draw override of a shape through its classification
+ */
+
+#ifdef HELIX_VIEWPORT2
+#define BASE_SHAPE_CLASSIFICATION BASE_SHAPE_DRAW_CLASSIFICATION
+#define HELIX_SHAPE_CLASSIFICATION HELIX_SHAPE_DRAW_CLASSIFICATION
+#define HELIX_LOCATOR_CLASSIFICATION HELIX_LOCATOR_DRAW_CLASSIFICATION
+#define CONNECT_SUGGESTIONS_LOCATOR_CLASSIFICATION CONNECT_SUGGESTIONS_LOCATOR_DRAW_CLASSIFICATION
+#define REGISTER_DRAW_OVERRIDES																																																														\
+	, new RegisterDrawOverride(BASE_SHAPE_DRAW_CLASSIFICATION, BASE_SHAPE_DRAW_REGISTRANT_ID, Helix::View::BaseDrawOverride::creator),																																				\
+	new RegisterDrawOverride(HELIX_SHAPE_DRAW_CLASSIFICATION, HELIX_SHAPE_DRAW_REGISTRANT_ID, Helix::View::HelixDrawOverride::creator),																																				\
+	new RegisterDrawOverride(HELIX_LOCATOR_DRAW_CLASSIFICATION, HELIX_LOCATOR_DRAW_REGISTRANT_ID, Helix::View::HelixLocatorDrawOverride::creator),																																	\
+	new RegisterDrawOverride(CONNECT_SUGGESTIONS_LOCATOR_DRAW_CLASSIFICATION, CONNECT_SUGGESTIONS_LOCATOR_DRAW_REGISTRANT_ID, Helix::View::ConnectSuggestionsDrawOverride::creator)
+#else
+#define BASE_SHAPE_CLASSIFICATION ""
+#define HELIX_SHAPE_CLASSIFICATION ""
+#define HELIX_LOCATOR_CLASSIFICATION ""
+#define CONNECT_SUGGESTIONS_LOCATOR_CLASSIFICATION ""
+#define REGISTER_DRAW_OVERRIDES
+#endif /* N HELIX_VIEWPORT2 */
+
 #define REGISTER_OPERATIONS																																																															\
 	new RegisterCommand(MEL_CREATEHELIX_COMMAND, Helix::Creator::creator, Helix::Creator::newSyntax),																																												\
 	new RegisterCommand(MEL_CREATEHELIX_GUI_COMMAND, Helix::CreatorGui::creator),																																																	\
@@ -80,21 +119,26 @@
 	new RegisterCommand(MEL_TOGGLELOCATORRENDER_COMMAND, Helix::ToggleLocatorRender::creator, Helix::ToggleLocatorRender::newSyntax),																																				\
 	new RegisterCommand(MEL_TOGGLESHOWSUGGESTEDCONNECTIONS_COMMAND, Helix::ToggleShowSuggestedConnections::creator, Helix::ToggleShowSuggestedConnections::newSyntax),																												\
 	new RegisterCommand(MEL_STRANDLENGTHCOUNT_COMMAND, Helix::StrandLengthCount::creator, Helix::StrandLengthCount::newSyntax),																																						\
+	new RegisterCommand(MEL_MELTINGTEMPERATURE_COMMAND, Helix::MeltingTemperature::creator, Helix::MeltingTemperature::newSyntax),																																						\
 	new RegisterCommand(MEL_EXPORTSTRANDS_COMMAND, Helix::ExportStrands::creator, Helix::ExportStrands::newSyntax),																																									\
 	new RegisterCommand(MEL_RETARGETBASE_COMMAND, Helix::RetargetBase::creator, Helix::RetargetBase::newSyntax),																																									\
 	new RegisterCommand(MEL_TARGET_HELIXBASE_BACKWARD, Helix::TargetHelixBaseBackward::creator, Helix::TargetHelixBaseBackward::newSyntax),																																			\
 	new RegisterCommand(MEL_CREATE_CURVES_COMMAND, Helix::CreateCurves::creator, Helix::CreateCurves::newSyntax),																																									\
+	new RegisterCommand(MEL_LOADOXDNATRAJECTORY_COMMAND, Helix::LoadOxDnaTrajectory::creator, Helix::LoadOxDnaTrajectory::newSyntax),																																				\
+	new RegisterCommand(MEL_CONVERTOXDNABINARY_COMMAND, Helix::ConvertOxDnaBinary::creator, Helix::ConvertOxDnaBinary::newSyntax),																																					\
 	new RegisterContextCommand(MEL_CONNECT_SUGGESTIONS_CONTEXT_COMMAND, Helix::View::ConnectSuggestionsContextCommand::creator, MEL_CONNECT_SUGGESTIONS_TOOL_COMMAND, Helix::View::ConnectSuggestionsToolCommand::creator, Helix::View::ConnectSuggestionsToolCommand::newSyntax),	\
-	new RegisterNode("HelixLocator", Helix::HelixLocator::id, &Helix::HelixLocator::creator, &Helix::HelixLocator::initialize, MPxNode::kLocatorNode),																																\
-	new RegisterNode(CONNECT_SUGGESTIONS_LOCATOR_NAME, Helix::View::ConnectSuggestionsLocatorNode::id, &Helix::View::ConnectSuggestionsLocatorNode::creator, &Helix::View::ConnectSuggestionsLocatorNode::initialize, MPxNode::kLocatorNode),										\
+	new RegisterNode("HelixLocator", Helix::HelixLocator::id, &Helix::HelixLocator::creator, &Helix::HelixLocator::initialize, MPxNode::kLocatorNode, HELIX_LOCATOR_CLASSIFICATION),																																\
+	new RegisterNode(CONNECT_SUGGESTIONS_LOCATOR_NAME, Helix::View::ConnectSuggestionsLocatorNode::id, &Helix::View::ConnectSuggestionsLocatorNode::creator, &Helix::View::ConnectSuggestionsLocatorNode::initialize, MPxNode::kLocatorNode, CONNECT_SUGGESTIONS_LOCATOR_CLASSIFICATION),										\
+	new RegisterNode(HELIX_OXDNA_TRAJECTORY_NODE_NAME, Helix::OxDnaTrajectoryNode::id, &Helix::OxDnaTrajectoryNode::creator, &Helix::OxDnaTrajectoryNode::initialize, MPxNode::kDependNode),																						\
 	new RegisterTransform(HELIX_HELIXBASE_NAME, Helix::HelixBase::id, Helix::HelixBase::creator, Helix::HelixBase::initialize, MPxTransformationMatrix::creator, MPxTransformationMatrix::baseTransformationMatrixId.id()),															\
 	new RegisterTransform(HELIX_HELIX_NAME, Helix::Helix::id, Helix::Helix::creator, Helix::Helix::initialize, MPxTransformationMatrix::creator, MPxTransformationMatrix::baseTransformationMatrixId.id()),																			\
 	new RegisterFileTranslator(HELIX_CADNANO_JSON_FILE_TYPE, Helix::JSONTranslator::creator),																																														\
 	new RegisterFileTranslator(HELIX_OXDNA_FILE_TYPE, Helix::OxDnaTranslator::creator),																																																\
 	new RegisterFileTranslator(HELIX_ROUTED_MESH_FILE_TYPE, Helix::RoutedMeshTranslator::creator),																																													\
 	new RegisterFileTranslator(HELIX_TEXT_BASED_FILE_DESCRIPTION, Helix::TextBasedTranslator::creator),																																												\
-	new RegisterShape(BASE_SHAPE_NAME, Helix::View::BaseShape::id, Helix::View::BaseShape::creator, Helix::View::BaseShape::initialize, Helix::View::BaseShapeUI::creator),																											\
-	new RegisterShape(HELIX_SHAPE_NAME, Helix::View::HelixShape::id, Helix::View::HelixShape::creator, Helix::View::HelixShape::initialize, Helix::View::HelixShapeUI::creator)
+	new RegisterShape(BASE_SHAPE_NAME, Helix::View::BaseShape::id, Helix::View::BaseShape::creator, Helix::View::BaseShape::initialize, Helix::View::BaseShapeUI::creator, BASE_SHAPE_CLASSIFICATION),																											\
+	new RegisterShape(HELIX_SHAPE_NAME, Helix::View::HelixShape::id, Helix::View::HelixShape::creator, Helix::View::HelixShape::initialize, Helix::View::HelixShapeUI::creator, HELIX_SHAPE_CLASSIFICATION) \
+	REGISTER_DRAW_OVERRIDES
 
 #define MEL_REGISTER_MENU_COMMAND															\
     "menu -tearOff true -label \"Helix\" -allowOptionBoxes true -parent $gMainWindow;\n"
@@ -133,8 +177,11 @@
 {	"Apply sequence", "Apply a given sequence string to the currently selected strand and calculate connected staple sequences", MEL_APPLYSEQUENCE_GUI_COMMAND, "", false, false, false, -1, ACCEL_NONE },	\
 {	"Export strands", "Export all or selected bases strands to Excel or a text file", MEL_EXPORTSTRANDS_COMMAND, "", false, false, false, -1, ACCEL_NONE },	\
 {	"Create curves from strands", "Create curves from selected helices and strands, or the whole scene", MEL_CREATE_CURVES_COMMAND, "", false, false, false, -1, ACCEL_NONE },	\
+{	"Load oxDNA trajectory", "Animate a design imported from oxDNA with a trajectory file", MEL_LOADOXDNATRAJECTORY_COMMAND, "", false, false, false, -1, ACCEL_NONE },	\
+{	"Convert binary oxDNA files", "Convert binary oxDNA exports to the text format read by oxDNA", MEL_CONVERTOXDNABINARY_COMMAND, "", false, false, false, -1, ACCEL_NONE },	\
 {	"-", "", ";", "", true, false, false, -1, ACCEL_NONE },	\
 {	"Toggle cylinder or bases view", "Show the cylinder or base representation of the helices", MEL_TOGGLECYLINDERBASEVIEW_COMMAND " -toggle true", "", false, false, false, -1, ACCEL_CTRL | ACCEL_ALT, 't' },	\
+{	"Automatic level of detail", "Show bases, cylinders or boxes depending on the distance to the helices", MEL_TOGGLECYLINDERBASEVIEW_COMMAND " -automatic #1", "", false, false, false, 0, ACCEL_NONE },	\
 {	"Toggle show suggested connections", "Show potential inter-helix base connections", MEL_TOGGLESHOWSUGGESTEDCONNECTIONS_COMMAND, "", false, false, false, -1, ACCEL_CTRL | ACCEL_ALT, 'z' },	\
 {	"Render", "Toggle rendering of some of the HUD elements", "", "", false, true, false, -1, ACCEL_NONE },	\
 {	"Halo", "Display the colored halos around bases", MEL_TOGGLELOCATORRENDER_COMMAND " -toggle \\\"halo\\\"", "", false, false, false, HALOS_CHECKED, ACCEL_NONE },	\
@@ -208,14 +255,14 @@ private:
 
 class RegisterNode : public Register {
 public:
-	inline RegisterNode(const char *node, const MTypeId & typeId, void *(*creator)(), MStatus (*initialize)(), MPxNode::Type type) : m_node(node), m_typeId(typeId), m_creator(creator), m_initialize(initialize), m_type(type) {
+	inline RegisterNode(const char *node, const MTypeId & typeId, void *(*creator)(), MStatus (*initialize)(), MPxNode::Type type, MString classification = "") : m_node(node), m_typeId(typeId), m_creator(creator), m_initialize(initialize), m_type(type), m_classification(classification) {
 
 	}
 
 	MStatus doRegister(MFnPlugin & plugin) {
 		MStatus status;
 
-		if (!(status = plugin.registerNode(m_node, m_typeId, m_creator, m_initialize, m_type))) {
+		if (!(status = plugin.registerNode(m_node, m_typeId, m_creator, m_initialize, m_type, m_classification.length() > 0 ? &m_classification : NULL))) {
 			status.perror(MString("registerNode: ") + m_node);
 			return status;
 		}
@@ -240,6 +287,7 @@ private:
 	void *(*m_creator)();
 	MStatus (*m_initialize)();
 	MPxNode::Type m_type;
+	MString m_classification;
 };
 
 class RegisterTransform : public Register {
@@ -314,14 +362,14 @@ private:
 
 class RegisterShape : public Register {
 public:
-	RegisterShape(MString typeName, MTypeId typeId, MCreatorFunction creatorFunction, MInitializeFunction initFunction, MCreatorFunction uiCreatorFunction) : m_typeName(typeName), m_typeId(typeId), m_creatorFunction(creatorFunction), m_initFunction(initFunction), m_uiCreatorFunction(uiCreatorFunction) {
+	RegisterShape(MString typeName, MTypeId typeId, MCreatorFunction creatorFunction, MInitializeFunction initFunction, MCreatorFunction uiCreatorFunction, MString classification = "") : m_typeName(typeName), m_typeId(typeId), m_creatorFunction(creatorFunction), m_initFunction(initFunction), m_uiCreatorFunction(uiCreatorFunction), m_classification(classification) {
 
 	}
 
 	virtual MStatus doRegister(MFnPlugin & plugin) {
 		MStatus status;
 
-		if (!(status = plugin.registerShape(m_typeName, m_typeId, m_creatorFunction, m_initFunction, m_uiCreatorFunction))) {
+		if (!(status = plugin.registerShape(m_typeName, m_typeId, m_creatorFunction, m_initFunction, m_uiCreatorFunction, m_classification.length() > 0 ? &m_classification : NULL))) {
 			status.perror(MString("MFnPlugin::registerShape: ") + m_typeName);
 			return status;
 		}
@@ -343,8 +391,48 @@ protected:
 	MCreatorFunction m_creatorFunction;
 	MInitializeFunction m_initFunction;
 	MCreatorFunction m_uiCreatorFunction;
+	MString m_classification;
 };
 
+#ifdef HELIX_VIEWPORT2
+class RegisterDrawOverride : public Register {
+public:
+	RegisterDrawOverride(const MString & classification, const MString & registrantId, MHWRender::MDrawRegistry::DrawOverrideCreator creatorFunction) : m_classification(classification), m_registrantId(registrantId), m_creatorFunction(creatorFunction) {
+
+	}
+
+	virtual MStatus doRegister(MFnPlugin & plugin) {
+		MStatus status;
+
+		if (!(status = MHWRender::MDrawRegistry::registerDrawOverrideCreator(m_classification, m_registrantId, m_creatorFunction))) {
+			status.perror(MString("MDrawRegistry::registerDrawOverrideCreator: ") + m_classification);
+			return status;
+		}
+
+		return MStatus::kSuccess;
+	}
+
+	virtual MStatus doDeregister(MFnPlugin & plugin) {
+		MStatus status;
+
+		if (!(status = MHWRender::MDrawRegistry::deregisterDrawOverrideCreator(m_classification, m_registrantId))) {
+			status.perror(MString("MDrawRegistry::deregisterDrawOverrideCreator: ") + m_classification);
+			return status;
+		}
+
+		return MStatus::kSuccess;
+	}
+
+	virtual bool isValid() const {
+		return true;
+	}
+
+protected:
+	MString m_classification, m_registrantId;
+	MHWRender::MDrawRegistry::DrawOverrideCreator m_creatorFunction;
+};
+#endif /* N HELIX_VIEWPORT2 */
+
 class RegisterContextCommand : public Register {
 public:
 	RegisterContextCommand(const MString & commandName, MCreatorFunction creatorFunction, const MString & toolCmdName, MCreatorFunction toolCmdCreator, MCreateSyntaxFunction toolCmdSyntax = NULL) : m_commandName(commandName), m_creatorFunction(creatorFunction), m_toolCmdName(toolCmdName), m_toolCmdCreator(toolCmdCreator), m_toolCmdSyntax(toolCmdSyntax) {
@@ -559,5 +647,11 @@ MLL_EXPORT MStatus uninitializePlugin(MObject obj)
 
 		MGlobal::executeCommand(MString(MEL_DEREGISTER_MENU_COMMAND " \"") + g_menuName + "\"", false);
 
+		Helix::View::BaseRenderer::release();
+		Helix::View::HelixBVH::release();
+		Helix::View::BaseGrid::release();
+		Helix::HelixLocator::release();
+		Helix::Model::EndIndex::release();
+
 		return MStatus::kSuccess;
 }
@@ -0,0 +1,204 @@
+#include <model/BaseBatch.h>
+#include <view/BaseShape.h>
+
+#include <HelixBase.h>
+#include <Utility.h>
+
+#include <maya/MFnTransform.h>
+#include <maya/MMatrix.h>
+#include <maya/MPlug.h>
+#include <maya/MPoint.h>
+
+#include <map>
+
+/*
+ * Executing one very large MEL command is not much faster than a few large ones and risks running out of memory.
+ */
+#define MEL_CHUNK_SIZE (1 << 20)
+
+namespace Helix {
+	namespace Model {
+		unsigned int BaseBatch::add(Helix & helix, const MString & name, const MVector & translation, const Material & material, DNA::Name label, MSpace::Space space) {
+			MStatus status;
+			Entry entry;
+			entry.helix = helix.getObject(status);
+			entry.name = name;
+			entry.translation = translation;
+			entry.material = material;
+			entry.label = label;
+			entry.space = space;
+			entry.existing = false;
+			m_bases.push_back(entry);
+
+			return (unsigned int) m_bases.size() - 1;
+		}
+
+		unsigned int BaseBatch::add(const Base & base) {
+			Entry entry;
+			entry.base = base;
+			entry.space = MSpace::kTransform;
+			entry.existing = true;
+			m_bases.push_back(entry);
+
+			return (unsigned int) m_bases.size() - 1;
+		}
+
+		MStatus BaseBatch::ExecuteCommand(std::string & command, bool force) {
+			MStatus status;
+
+			if (command.empty() || (!force && command.size() < MEL_CHUNK_SIZE))
+				return MStatus::kSuccess;
+
+			HMEVALUATE(status = MGlobal::executeCommand(command.c_str(), false), status);
+			command.clear();
+
+			return status;
+		}
+
+		MStatus BaseBatch::create() {
+			MStatus status;
+
+			for (std::vector<Entry>::iterator it(m_bases.begin()); it != m_bases.end(); ++it) {
+				if (it->existing)
+					continue;
+
+				MObject base_object;
+				HMEVALUATE_RETURN(base_object = m_dagModifier.createNode(::Helix::HelixBase::id, it->helix, &status), status);
+				HMEVALUATE_RETURN(status = m_dagModifier.renameNode(base_object, it->name), status);
+				HMEVALUATE_RETURN(m_dagModifier.createNode(View::BaseShape::id, base_object, &status), status);
+
+				it->base = base_object;
+			}
+
+			HMEVALUATE_RETURN(status = m_dagModifier.doIt(), status);
+
+			/*
+			 * Connections. Same attributes as used by Base::connect_forward and Base::connect_opposite.
+			 * They are only queued once, apply executes them and undo reverts them.
+			 */
+
+			for (std::vector< std::pair<unsigned int, unsigned int> >::iterator it(m_forward.begin()); it != m_forward.end(); ++it) {
+				MPlug forwardPlug(m_bases[it->first].base.getObject(status), ::Helix::HelixBase::aForward), backwardPlug(m_bases[it->second].base.getObject(status), ::Helix::HelixBase::aBackward);
+				HMEVALUATE_RETURN(status = m_dgModifier.connect(backwardPlug, forwardPlug), status);
+			}
+
+			for (std::vector< std::pair<unsigned int, unsigned int> >::iterator it(m_opposite.begin()); it != m_opposite.end(); ++it) {
+				MPlug thisLabelPlug(m_bases[it->first].base.getObject(status), ::Helix::HelixBase::aLabel), targetLabelPlug(m_bases[it->second].base.getObject(status), ::Helix::HelixBase::aLabel);
+				HMEVALUATE_RETURN(status = m_dgModifier.connect(thisLabelPlug, targetLabelPlug), status);
+			}
+
+			return apply();
+		}
+
+		MStatus BaseBatch::redo() {
+			MStatus status;
+			HMEVALUATE_RETURN(status = m_dagModifier.doIt(), status);
+
+			return apply();
+		}
+
+		MStatus BaseBatch::undo() {
+			MStatus status;
+			std::string command;
+
+			HMEVALUATE_RETURN(status = m_dgModifier.undoIt(), status);
+
+			for (std::vector< std::pair<unsigned int, unsigned int> >::iterator it(m_forward.begin()); it != m_forward.end(); ++it) {
+				Entry & source(m_bases[it->first]);
+
+				if (source.existing) {
+					const MString path(source.base.getDagPath(status).fullPathName());
+					command += std::string("delete -cn ") + path.asChar() + "; setAttr " + path.asChar() + ".rotate 0 0 0;\n";
+					HMEVALUATE_RETURN(status = ExecuteCommand(command), status);
+				}
+			}
+
+			HMEVALUATE_RETURN(status = ExecuteCommand(command, true), status);
+			HMEVALUATE_RETURN(status = m_dagModifier.undoIt(), status);
+
+			return MStatus::kSuccess;
+		}
+
+		/*
+		 * Sets up everything that is not part of the MDagModifier. Executed both on create and redo.
+		 */
+		MStatus BaseBatch::apply() {
+			MStatus status;
+
+			/*
+			 * Translations and labels. Translations given in world space are transformed into the space of the helix, the matrix is only obtained once per helix.
+			 */
+
+			MObject helix;
+			MMatrix helix_inverse;
+
+			for (std::vector<Entry>::iterator it(m_bases.begin()); it != m_bases.end(); ++it) {
+				if (it->existing)
+					continue;
+
+				MObject & base_object(it->base.getObject(status));
+				MVector translation(it->translation);
+
+				if (it->space == MSpace::kWorld) {
+					if (helix != it->helix) {
+						helix = it->helix;
+						MDagPath helix_dagPath;
+						HMEVALUATE_RETURN(status = MDagPath::getAPathTo(helix, helix_dagPath), status);
+						HMEVALUATE_RETURN(helix_inverse = helix_dagPath.inclusiveMatrixInverse(&status), status);
+					}
+
+					translation = MVector(MPoint(translation) * helix_inverse);
+				}
+
+				MFnTransform base_transform(base_object);
+				HMEVALUATE_RETURN(status = base_transform.setTranslation(translation, MSpace::kTransform), status);
+
+				if (it->label != DNA::Invalid) {
+					MPlug labelPlug(base_object, ::Helix::HelixBase::aLabel);
+					HMEVALUATE_RETURN(status = labelPlug.setInt((int) it->label), status);
+				}
+			}
+
+			/*
+			 * Connections, queued on the modifier by create.
+			 */
+
+			HMEVALUATE_RETURN(status = m_dgModifier.doIt(), status);
+
+			/*
+			 * Materials, one sets command per material.
+			 */
+
+			std::map<std::string, std::string> materials;
+
+			for (std::vector<Entry>::iterator it(m_bases.begin()); it != m_bases.end(); ++it) {
+				if (it->existing || it->material.getMaterial().length() == 0)
+					continue;
+
+				std::string & command(materials[it->material.getMaterial().asChar()]);
+				command += " ";
+				command += it->base.getDagPath(status).fullPathName().asChar();
+			}
+
+			for (std::map<std::string, std::string>::iterator it(materials.begin()); it != materials.end(); ++it) {
+				std::string command(std::string("sets -noWarnings -forceElement ") + it->first + it->second + ";");
+				HMEVALUATE_RETURN(status = ExecuteCommand(command, true), status);
+			}
+
+			/*
+			 * Aim constraints, see Base::connect_forward.
+			 */
+
+			std::string command;
+
+			for (std::vector< std::pair<unsigned int, unsigned int> >::iterator it(m_forward.begin()); it != m_forward.end(); ++it) {
+				command += std::string("aimConstraint -aimVector 0 0 -1.0 ") + m_bases[it->second].base.getDagPath(status).fullPathName().asChar() + " " + m_bases[it->first].base.getDagPath(status).fullPathName().asChar() + ";\n";
+				HMEVALUATE_RETURN(status = ExecuteCommand(command), status);
+			}
+
+			HMEVALUATE_RETURN(status = ExecuteCommand(command, true), status);
+
+			return MStatus::kSuccess;
+		}
+	}
+}
@@ -0,0 +1,260 @@
+#include <model/EndIndex.h>
+
+#include <HelixBase.h>
+#include <Utility.h>
+
+#include <maya/MDagMessage.h>
+#include <maya/MFnDagNode.h>
+#include <maya/MItDag.h>
+#include <maya/MMessage.h>
+#include <maya/MSceneMessage.h>
+
+namespace Helix {
+	namespace Model {
+		EndIndex::Container EndIndex::s_ends;
+		EndIndex::HelixContainer EndIndex::s_helices;
+		EndIndex::BaseSet EndIndex::s_changed;
+		MCallbackIdArray EndIndex::s_callbacks;
+		bool EndIndex::s_registered = false, EndIndex::s_reliable = true;
+
+		void EndIndex::Changed(const MObject & base) {
+			RegisterCallbacks();
+
+			// The plugs and the parent might not reflect the change yet, thus the base is only queued.
+			s_changed.insert(MObjectHandle(base));
+		}
+
+		void EndIndex::Set(const MObject & base, int type, MStatus & status) {
+			MFnDagNode base_dagNode(base);
+
+			if (base_dagNode.parentCount(&status) == 0) {
+				// Not added to its helix yet.
+				s_changed.insert(MObjectHandle(base));
+				return;
+			}
+
+			const MObject helix(base_dagNode.parent(0, &status));
+			if (!status) {
+				HMEVALUATE_DESCRIPTION("MFnDagNode::parent", status);
+				return;
+			}
+
+			const MObjectHandle baseHandle(base), helixHandle(helix);
+			Container::iterator it(s_ends.find(baseHandle));
+
+			if (it != s_ends.end() && (it->second.helix != helixHandle || type == Base::BASE)) {
+				HelixContainer::iterator helix_it(s_helices.find(it->second.helix));
+
+				if (helix_it != s_helices.end()) {
+					helix_it->second.erase(baseHandle);
+
+					if (helix_it->second.empty())
+						s_helices.erase(helix_it);
+				}
+
+				s_ends.erase(it);
+			}
+
+			if (type == Base::BASE)
+				return;
+
+			Entry entry;
+			entry.helix = helixHandle;
+			entry.type = type;
+
+			s_ends[baseHandle] = entry;
+			s_helices[helixHandle].insert(baseHandle);
+		}
+
+		void EndIndex::ResolveChanged() {
+			if (s_changed.empty())
+				return;
+
+			BaseSet changed;
+			changed.swap(s_changed);
+
+			for (BaseSet::const_iterator it = changed.begin(); it != changed.end(); ++it) {
+				if (!it->isValid())
+					continue;
+
+				MStatus status;
+				Base base(it->object());
+				const Base::Type type = base.type(status);
+
+				if (!status) {
+					HMEVALUATE_DESCRIPTION("Base::type", status);
+					continue;
+				}
+
+				Set(it->object(), type, status);
+			}
+		}
+
+		void EndIndex::RegisterCallbacks() {
+			if (s_registered)
+				return;
+
+			MStatus status;
+			s_registered = true;
+
+			/*
+			 * Bases can be reparented to another helix without their connections changing, and a new or opened scene invalidates
+			 * every entry. Without these callbacks the index can't be trusted.
+			 */
+
+			s_callbacks.append(MDagMessage::addParentAddedCallback(&EndIndex::MDagMessage_parentAdded, NULL, &status));
+
+			if (!status) {
+				status.perror("MDagMessage::addParentAddedCallback");
+				s_reliable = false;
+			}
+
+			s_callbacks.append(MSceneMessage::addCallback(MSceneMessage::kBeforeNew, &EndIndex::MSceneMessage_beforeNewOpen, NULL, &status));
+
+			if (!status) {
+				status.perror("MSceneMessage::addCallback");
+				s_reliable = false;
+			}
+
+			s_callbacks.append(MSceneMessage::addCallback(MSceneMessage::kBeforeOpen, &EndIndex::MSceneMessage_beforeNewOpen, NULL, &status));
+
+			if (!status) {
+				status.perror("MSceneMessage::addCallback");
+				s_reliable = false;
+			}
+		}
+
+		MStatus EndIndex::Ends(Base::Type type, MObjectArray & bases) {
+			MStatus status;
+			ResolveChanged();
+
+			if (!s_reliable)
+				return Walk(type, bases);
+
+			for (Container::iterator it = s_ends.begin(); it != s_ends.end(); ++it) {
+				if (it->second.type == type && it->first.isValid())
+					HMEVALUATE_RETURN(status = bases.append(it->first.object()), status);
+			}
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus EndIndex::Ends(const MObject & helix, Base::Type type, std::vector<Base> & bases) {
+			MStatus status;
+			ResolveChanged();
+
+			if (!s_reliable)
+				return Walk(helix, type, bases);
+
+			HelixContainer::const_iterator helix_it(s_helices.find(MObjectHandle(helix)));
+
+			if (helix_it == s_helices.end())
+				return MStatus::kSuccess;
+
+			const std::vector<Base>::size_type size = bases.size();
+
+			for (BaseSet::const_iterator it = helix_it->second.begin(); it != helix_it->second.end(); ++it) {
+				if (!it->isValid())
+					continue;
+
+				Container::const_iterator end_it(s_ends.find(*it));
+
+				if (end_it == s_ends.end())
+					continue;
+
+				/*
+				 * The base should never have been moved without being reindexed, but if it was, the index is not trusted for this helix.
+				 */
+
+				const MObject parent(MFnDagNode(it->object()).parent(0, &status));
+
+				if (!status || parent != helix) {
+					bases.resize(size);
+					return Walk(helix, type, bases);
+				}
+
+				if (end_it->second.type == type)
+					bases.push_back(Base(it->object()));
+			}
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus EndIndex::Walk(const MObject & helix, Base::Type type, std::vector<Base> & bases) {
+			MStatus status;
+			MFnDagNode helix_dagNode(helix);
+			unsigned int childCount;
+
+			HMEVALUATE_RETURN(childCount = helix_dagNode.childCount(&status), status);
+
+			for (unsigned int i = 0; i < childCount; ++i) {
+				MObject child;
+				HMEVALUATE_RETURN(child = helix_dagNode.child(i, &status), status);
+
+				if (MFnDagNode(child).typeId(&status) != ::Helix::HelixBase::id)
+					continue;
+
+				Base base(child);
+				const Base::Type baseType = base.type(status);
+				HMEVALUATE_RETURN_DESCRIPTION("Base::type", status);
+
+				if (baseType == type)
+					bases.push_back(base);
+			}
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus EndIndex::Walk(Base::Type type, MObjectArray & bases) {
+			MStatus status;
+			MItDag itDag(MItDag::kDepthFirst, MFn::kTransform, &status);
+			HMEVALUATE_RETURN_DESCRIPTION("MItDag::#ctor", status);
+
+			for (; !itDag.isDone(); itDag.next()) {
+				MObject object;
+				HMEVALUATE_RETURN(object = itDag.currentItem(&status), status);
+
+				if (MFnDagNode(object).typeId(&status) != ::Helix::HelixBase::id)
+					continue;
+
+				Base base(object);
+				const Base::Type baseType = base.type(status);
+				HMEVALUATE_RETURN_DESCRIPTION("Base::type", status);
+
+				if (baseType == type)
+					HMEVALUATE_RETURN(status = bases.append(object), status);
+			}
+
+			return MStatus::kSuccess;
+		}
+
+		void EndIndex::Clear() {
+			s_ends.clear();
+			s_helices.clear();
+			s_changed.clear();
+		}
+
+		void EndIndex::release() {
+			Clear();
+
+			if (s_callbacks.length() > 0) {
+				MMessage::removeCallbacks(s_callbacks);
+				s_callbacks.clear();
+			}
+
+			s_registered = false;
+			s_reliable = true;
+		}
+
+		void EndIndex::MDagMessage_parentAdded(MDagPath & child, MDagPath & parent, void *clientData) {
+			MStatus status;
+
+			if (MFnDagNode(child.node()).typeId(&status) == ::Helix::HelixBase::id)
+				s_changed.insert(MObjectHandle(child.node()));
+		}
+
+		void EndIndex::MSceneMessage_beforeNewOpen(void *clientData) {
+			Clear();
+		}
+	}
+}
@@ -7,6 +7,7 @@
 
 #include <model/Helix.h>
 #include <model/Base.h>
+#include <model/EndIndex.h>
 #include <view/HelixShape.h>
 
 #include <maya/MFnDagNode.h>
@@ -1154,28 +1155,29 @@ namespace Helix {
 		};
 
 		/*
-		 * Helper for search
+		 * Helper for search. The ends are looked up in the EndIndex instead of testing the type of every base on the helix.
 		 */
-		template<Base::Type Type, typename ContainerT>
-		MStatus GetBaseAndZCoordinateOfBaseType(Helix::BaseIterator begin, Helix::BaseIterator end, ContainerT & bases) {
+		MStatus GetBaseAndZCoordinateOfBaseType(const MObject & helix, Base::Type type, std::list< std::pair<Base, double> > & bases) {
 			MStatus status;
+			std::vector<Base> ends;
 
-			for(Helix::BaseIterator it = begin; it != end; ++it) {
-				if (it->type(status) == Type) {
-					MVector translation;
+			if (!(status = EndIndex::Ends(helix, type, ends))) {
+				status.perror("EndIndex::Ends");
+				return status;
+			}
 
-					if (!(status = it->getTranslation(translation, MSpace::kTransform))) {
-						status.perror("Base::getTranslation");
-						return status;
-					}
+			if (ends.empty())
+				return MStatus::kNotFound;
 
-					bases.push_back(std::make_pair(*it, translation.z));
-				}
+			for(std::vector<Base>::iterator it = ends.begin(); it != ends.end(); ++it) {
+				MVector translation;
 
-				if (!status) {
-					status.perror("Base::type");
+				if (!(status = it->getTranslation(translation, MSpace::kTransform))) {
+					status.perror("Base::getTranslation");
 					return status;
 				}
+
+				bases.push_back(std::make_pair(*it, translation.z));
 			}
 
 			return MStatus::kSuccess;
@@ -1185,8 +1187,9 @@ namespace Helix {
 			MStatus status;
 			std::list< std::pair<Base, double> > bases;
 
-			if (!(status = GetBaseAndZCoordinateOfBaseType<Base::THREE_PRIME_END>(begin(), end(), bases))) {
-				status.perror("GetBaseAndZCoordinateOfBaseType");
+			if (!(status = GetBaseAndZCoordinateOfBaseType(getObject(status), Base::THREE_PRIME_END, bases))) {
+				if (status != MStatus::kNotFound)
+					status.perror("GetBaseAndZCoordinateOfBaseType");
 				return status;
 			}
 
@@ -1199,8 +1202,9 @@ namespace Helix {
 			MStatus status;
 			std::list< std::pair<Base, double> > bases;
 
-			if (!(status = GetBaseAndZCoordinateOfBaseType<Base::FIVE_PRIME_END>(begin(), end(), bases))) {
-				status.perror("GetBaseAndZCoordinateOfBaseType");
+			if (!(status = GetBaseAndZCoordinateOfBaseType(getObject(status), Base::FIVE_PRIME_END, bases))) {
+				if (status != MStatus::kNotFound)
+					status.perror("GetBaseAndZCoordinateOfBaseType");
 				return status;
 			}
 
@@ -1213,8 +1217,9 @@ namespace Helix {
 			MStatus status;
 			std::list< std::pair<Base, double> > bases;
 
-			if (!(status = GetBaseAndZCoordinateOfBaseType<Base::THREE_PRIME_END>(begin(), end(), bases))) {
-				status.perror("GetBaseAndZCoordinateOfBaseType");
+			if (!(status = GetBaseAndZCoordinateOfBaseType(getObject(status), Base::THREE_PRIME_END, bases))) {
+				if (status != MStatus::kNotFound)
+					status.perror("GetBaseAndZCoordinateOfBaseType");
 				return status;
 			}
 
@@ -1227,8 +1232,9 @@ namespace Helix {
 			MStatus status;
 			std::list< std::pair<Base, double> > bases;
 
-			if (!(status = GetBaseAndZCoordinateOfBaseType<Base::FIVE_PRIME_END>(begin(), end(), bases))) {
-				status.perror("GetBaseAndZCoordinateOfBaseType");
+			if (!(status = GetBaseAndZCoordinateOfBaseType(getObject(status), Base::FIVE_PRIME_END, bases))) {
+				if (status != MStatus::kNotFound)
+					status.perror("GetBaseAndZCoordinateOfBaseType");
 				return status;
 			}
 
@@ -16,6 +16,8 @@
 #include <maya/MCommandResult.h>
 #include <maya/MPlug.h>
 #include <maya/MPlugArray.h>
+#include <maya/MFnSet.h>
+#include <maya/MObjectHandle.h>
 
 #include <DNA.h>
 
@@ -186,5 +188,47 @@ namespace Helix {
 			HMEVALUATE_RETURN(status = MGlobal::executeCommand(MString("sets -noWarnings -forceElement ") + m_material.getMaterial() + m_concat), status);
 			return MStatus::kSuccess;
 		}
+
+		MStatus Material::Assignments::query() {
+			MStatus status;
+			Material::Iterator it;
+			HMEVALUATE_RETURN(it = AllMaterials_begin(status), status);
+
+			m_assignments.clear();
+
+			for (; it != AllMaterials_end(); ++it) {
+				MObject set_object;
+				HMEVALUATE_RETURN(status = StringIdentifierToObject(it->getMaterial(), set_object), status);
+
+				MFnSet set(set_object);
+				MSelectionList members;
+				HMEVALUATE_RETURN(status = set.getMembers(members, true), status);
+
+				for (unsigned int i = 0; i < members.length(); ++i) {
+					MDagPath dagPath;
+
+					if (!members.getDagPath(i, dagPath))
+						continue;
+
+					// Materials are assigned to the shapes of the bases.
+					if (!dagPath.node().hasFn(MFn::kTransform))
+						dagPath.pop();
+
+					m_assignments.insert(std::make_pair(MObjectHandle(dagPath.node()), *it));
+				}
+			}
+
+			return MStatus::kSuccess;
+		}
+
+		bool Material::Assignments::find(const MObject & base, Material & material) const {
+			const Container::const_iterator it(m_assignments.find(MObjectHandle(base)));
+
+			if (it == m_assignments.end())
+				return false;
+
+			material = it->second;
+			return true;
+		}
 	}
 }
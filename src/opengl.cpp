@@ -1,5 +1,7 @@
 #include <opengl.h>
 
+#include <cstring>
+
 #ifndef MAC_PLUGIN
 struct glTag {
 	bool installed;
@@ -32,6 +34,18 @@ struct glTag {
 	PFNGLBINDBUFFERPROC glBindBuffer;
 	PFNGLTEXIMAGE3DPROC glTexImage3D;
 	PFNGLACTIVETEXTUREPROC glActiveTexture;
+
+	PFNGLGENBUFFERSPROC glGenBuffers;
+	PFNGLDELETEBUFFERSPROC glDeleteBuffers;
+	PFNGLBUFFERDATAPROC glBufferData;
+	PFNGLBUFFERSUBDATAPROC glBufferSubData;
+	PFNGLVERTEXATTRIB4FVPROC glVertexAttrib4fv;
+
+	/*
+	 * Optional, see hasGLInstancing
+	 */
+	PFNGLDRAWARRAYSINSTANCEDARBPROC glDrawArraysInstancedARB;
+	PFNGLVERTEXATTRIBDIVISORARBPROC glVertexAttribDivisorARB;
 } s_gl = { false };
 
 #ifndef MAC_PLUGIN
@@ -177,6 +191,38 @@ bool installGLExtensions() {
 		return false;
 	}
 
+	if ((s_gl.glGenBuffers = (PFNGLGENBUFFERSPROC) GETPROCADDRESS("glGenBuffers")) == NULL) {
+		std::cerr << "Fatal, Failed to load OpenGL buffer procedures" << std::endl;
+		return false;
+	}
+
+	if ((s_gl.glDeleteBuffers = (PFNGLDELETEBUFFERSPROC) GETPROCADDRESS("glDeleteBuffers")) == NULL) {
+		std::cerr << "Fatal, Failed to load OpenGL buffer procedures" << std::endl;
+		return false;
+	}
+
+	if ((s_gl.glBufferData = (PFNGLBUFFERDATAPROC) GETPROCADDRESS("glBufferData")) == NULL) {
+		std::cerr << "Fatal, Failed to load OpenGL buffer procedures" << std::endl;
+		return false;
+	}
+
+	if ((s_gl.glBufferSubData = (PFNGLBUFFERSUBDATAPROC) GETPROCADDRESS("glBufferSubData")) == NULL) {
+		std::cerr << "Fatal, Failed to load OpenGL buffer procedures" << std::endl;
+		return false;
+	}
+
+	if ((s_gl.glVertexAttrib4fv = (PFNGLVERTEXATTRIB4FVPROC) GETPROCADDRESS("glVertexAttrib4fv")) == NULL) {
+		std::cerr << "Fatal, Failed to load OpenGL shader procedures" << std::endl;
+		return false;
+	}
+
+	/*
+	 * Instancing is optional, users of it must check hasGLInstancing
+	 */
+
+	s_gl.glDrawArraysInstancedARB = (PFNGLDRAWARRAYSINSTANCEDARBPROC) GETPROCADDRESS("glDrawArraysInstancedARB");
+	s_gl.glVertexAttribDivisorARB = (PFNGLVERTEXATTRIBDIVISORARBPROC) GETPROCADDRESS("glVertexAttribDivisorARB");
+
 	s_gl.installed = true;
 
 	return true;
@@ -291,4 +337,48 @@ GLAPI void APIENTRY glPointParameteri (GLenum pname, GLint param) {
 	s_gl.glPointParameteri(pname, param);
 }
 
+GLAPI void APIENTRY glGenBuffers (GLsizei n, GLuint *buffers) {
+	s_gl.glGenBuffers(n, buffers);
+}
+
+GLAPI void APIENTRY glDeleteBuffers (GLsizei n, const GLuint *buffers) {
+	s_gl.glDeleteBuffers(n, buffers);
+}
+
+GLAPI void APIENTRY glBufferData (GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage) {
+	s_gl.glBufferData(target, size, data, usage);
+}
+
+GLAPI void APIENTRY glBufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid *data) {
+	s_gl.glBufferSubData(target, offset, size, data);
+}
+
+GLAPI void APIENTRY glVertexAttrib4fv (GLuint index, const GLfloat *v) {
+	s_gl.glVertexAttrib4fv(index, v);
+}
+
+GLAPI void APIENTRY glDrawArraysInstancedARB (GLenum mode, GLint first, GLsizei count, GLsizei primcount) {
+	s_gl.glDrawArraysInstancedARB(mode, first, count, primcount);
+}
+
+GLAPI void APIENTRY glVertexAttribDivisorARB (GLuint index, GLuint divisor) {
+	s_gl.glVertexAttribDivisorARB(index, divisor);
+}
+
+#endif /* N MAC_PLUGIN */
+
+bool hasGLInstancing() {
+	static int supported = -1;
+
+	if (supported == -1) {
+		const char *extensions = (const char *) glGetString(GL_EXTENSIONS);
+
+		supported = extensions != NULL && strstr(extensions, "GL_ARB_draw_instanced") != NULL && strstr(extensions, "GL_ARB_instanced_arrays") != NULL;
+
+#ifndef MAC_PLUGIN
+		supported = supported && s_gl.glDrawArraysInstancedARB != NULL && s_gl.glVertexAttribDivisorARB != NULL;
 #endif /* N MAC_PLUGIN */
+	}
+
+	return supported != 0;
+}
@@ -0,0 +1,316 @@
+#include <view/BVH.h>
+
+#include <maya/MDagPath.h>
+#include <maya/MFnCamera.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Helix {
+	namespace View {
+		/*
+		 * Orders box indices by the coordinate of their centroids along an axis
+		 */
+
+		class BVH_CentroidLess {
+		public:
+			inline BVH_CentroidLess(const std::vector<MPoint> & centroids, int axis) : m_centroids(centroids), m_axis(axis) {
+
+			}
+
+			inline bool operator()(unsigned int i, unsigned int j) const {
+				return m_centroids[i][m_axis] < m_centroids[j][m_axis];
+			}
+
+		private:
+			const std::vector<MPoint> & m_centroids;
+			int m_axis;
+		};
+
+		void BVH::build(const std::vector<MBoundingBox> & boxes) {
+			clear();
+
+			if (boxes.empty())
+				return;
+
+			m_boxes = boxes;
+			m_indices.resize(boxes.size());
+			m_nodes.reserve(2 * boxes.size() / BVH_LEAF_SIZE + 1);
+
+			std::vector<MPoint> centroids(boxes.size());
+
+			for (size_t i = 0; i < boxes.size(); ++i) {
+				m_indices[i] = (unsigned int) i;
+				centroids[i] = boxes[i].center();
+			}
+
+			build(centroids, 0, (unsigned int) boxes.size());
+		}
+
+		unsigned int BVH::build(const std::vector<MPoint> & centroids, unsigned int begin, unsigned int end) {
+			const unsigned int index = (unsigned int) m_nodes.size();
+
+			MBoundingBox box(m_boxes[m_indices[begin]]), centroidBox(centroids[m_indices[begin]], centroids[m_indices[begin]]);
+
+			for (unsigned int i = begin + 1; i < end; ++i) {
+				box.expand(m_boxes[m_indices[i]]);
+				centroidBox.expand(centroids[m_indices[i]]);
+			}
+
+			Node node;
+			node.box = box;
+			node.first = begin;
+			node.count = end - begin;
+
+			m_nodes.push_back(node);
+
+			if (end - begin <= BVH_LEAF_SIZE)
+				return index;
+
+			const double extents[] = { centroidBox.width(), centroidBox.height(), centroidBox.depth() };
+			const int axis = int(std::max_element(extents, extents + 3) - extents);
+			const unsigned int middle = begin + (end - begin) / 2;
+
+			std::nth_element(m_indices.begin() + begin, m_indices.begin() + middle, m_indices.begin() + end, BVH_CentroidLess(centroids, axis));
+
+			build(centroids, begin, middle);
+			const unsigned int right = build(centroids, middle, end);
+
+			m_nodes[index].first = right;
+			m_nodes[index].count = 0;
+
+			return index;
+		}
+
+		MStatus Frustum::setFromView(M3dView & view) {
+			MStatus status;
+			MDagPath cameraPath;
+
+			m_numPlanes = 0;
+
+			if (!(status = view.getCamera(cameraPath))) {
+				status.perror("M3dView::getCamera");
+				return status;
+			}
+
+			MFnCamera camera(cameraPath, &status);
+
+			if (!status) {
+				status.perror("MFnCamera::#ctor");
+				return status;
+			}
+
+			const MMatrix inverseMatrix(cameraPath.inclusiveMatrixInverse(&status));
+
+			if (!status) {
+				status.perror("MDagPath::inclusiveMatrixInverse");
+				return status;
+			}
+
+			double left, right, bottom, top;
+			const double aspect = view.portHeight() > 0 ? double(view.portWidth()) / view.portHeight() : 1.0;
+
+			if (!(status = camera.getViewingFrustum(aspect, left, right, bottom, top, true, true))) {
+				status.perror("MFnCamera::getViewingFrustum");
+				return status;
+			}
+
+			const double nearClip = camera.nearClippingPlane(), farClip = camera.farClippingPlane();
+
+			/*
+			 * The camera looks along the negative z axis. For perspective cameras, the extents are at the near clipping plane
+			 */
+
+			if (camera.isOrtho()) {
+				addPlane(inverseMatrix, 1.0, 0.0, 0.0, -left);
+				addPlane(inverseMatrix, -1.0, 0.0, 0.0, right);
+				addPlane(inverseMatrix, 0.0, 1.0, 0.0, -bottom);
+				addPlane(inverseMatrix, 0.0, -1.0, 0.0, top);
+			}
+			else {
+				addPlane(inverseMatrix, nearClip, 0.0, left, 0.0);
+				addPlane(inverseMatrix, -nearClip, 0.0, -right, 0.0);
+				addPlane(inverseMatrix, 0.0, nearClip, bottom, 0.0);
+				addPlane(inverseMatrix, 0.0, -nearClip, -top, 0.0);
+			}
+
+			addPlane(inverseMatrix, 0.0, 0.0, -1.0, -nearClip);
+			addPlane(inverseMatrix, 0.0, 0.0, 1.0, farClip);
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus Frustum::setFromRegion(M3dView & view, short x0, short y0, short x1, short y1) {
+			MStatus status;
+			MPoint nearPoints[4], farPoints[4], inside(0.0, 0.0, 0.0);
+
+			m_numPlanes = 0;
+
+			if (x1 <= x0)
+				x1 = x0 + 1;
+
+			if (y1 <= y0)
+				y1 = y0 + 1;
+
+			const short corners[4][2] = { { x0, y0 }, { x1, y0 }, { x1, y1 }, { x0, y1 } };
+
+			for (int i = 0; i < 4; ++i) {
+				if (!(status = view.viewToWorld(corners[i][0], corners[i][1], nearPoints[i], farPoints[i]))) {
+					status.perror("M3dView::viewToWorld");
+					return status;
+				}
+
+				inside += MVector(nearPoints[i]) / 8.0 + MVector(farPoints[i]) / 8.0;
+			}
+
+			for (int i = 0; i < 4; ++i)
+				addPlane(nearPoints[i], nearPoints[(i + 1) % 4], farPoints[i], inside);
+
+			addPlane(nearPoints[0], nearPoints[1], nearPoints[2], inside);
+			addPlane(farPoints[0], farPoints[1], farPoints[2], inside);
+
+			return MStatus::kSuccess;
+		}
+
+		void Frustum::addPlane(const MMatrix & inverseMatrix, double a, double b, double c, double d) {
+			const double plane[] = { a, b, c };
+			double *worldPlane = m_planes[m_numPlanes++];
+
+			worldPlane[3] = d;
+
+			for (int i = 0; i < 3; ++i) {
+				worldPlane[i] = 0.0;
+
+				for (int j = 0; j < 3; ++j)
+					worldPlane[i] += inverseMatrix[i][j] * plane[j];
+
+				worldPlane[3] += inverseMatrix[3][i] * plane[i];
+			}
+
+			/*
+			 * Normalized so that the distances can be compared to radii
+			 */
+
+			const double length = MVector(worldPlane[0], worldPlane[1], worldPlane[2]).length();
+
+			if (length > 0.0) {
+				for (int i = 0; i < 4; ++i)
+					worldPlane[i] /= length;
+			}
+		}
+
+		void Frustum::addPlane(const MPoint & p0, const MPoint & p1, const MPoint & p2, const MPoint & inside) {
+			MVector normal((p1 - p0) ^ (p2 - p0));
+
+			if (normal.length() == 0.0)
+				return;
+
+			normal.normalize();
+
+			double d = -(normal * MVector(p0));
+
+			if (normal * MVector(inside) + d < 0.0) {
+				normal = -normal;
+				d = -d;
+			}
+
+			double *plane = m_planes[m_numPlanes++];
+
+			plane[0] = normal.x;
+			plane[1] = normal.y;
+			plane[2] = normal.z;
+			plane[3] = d;
+		}
+
+		bool Frustum::intersects(const MPoint & a, const MPoint & b, double radius) const {
+			for (int i = 0; i < m_numPlanes; ++i) {
+				const double *plane = m_planes[i];
+
+				if (plane[0] * a.x + plane[1] * a.y + plane[2] * a.z + plane[3] < -radius && plane[0] * b.x + plane[1] * b.y + plane[2] * b.z + plane[3] < -radius)
+					return false;
+			}
+
+			return true;
+		}
+
+		BVH::Intersection Frustum::classify(const MBoundingBox & box) const {
+			const MPoint min(box.min()), max(box.max());
+			BVH::Intersection intersection = BVH::kInside;
+
+			for (int i = 0; i < m_numPlanes; ++i) {
+				const double *plane = m_planes[i];
+
+				/*
+				 * The corners furthest along and against the normal of the plane
+				 */
+
+				const double positive = plane[3] +
+					plane[0] * (plane[0] > 0.0 ? max.x : min.x) +
+					plane[1] * (plane[1] > 0.0 ? max.y : min.y) +
+					plane[2] * (plane[2] > 0.0 ? max.z : min.z);
+
+				if (positive < 0.0)
+					return BVH::kOutside;
+
+				const double negative = plane[3] +
+					plane[0] * (plane[0] > 0.0 ? min.x : max.x) +
+					plane[1] * (plane[1] > 0.0 ? min.y : max.y) +
+					plane[2] * (plane[2] > 0.0 ? min.z : max.z);
+
+				if (negative < 0.0)
+					intersection = BVH::kIntersects;
+			}
+
+			return intersection;
+		}
+
+		MStatus Ray::setFromView(M3dView & view, short x, short y) {
+			MStatus status;
+			MPoint nearPoint, farPoint;
+
+			if (!(status = view.viewToWorld(x, y, nearPoint, farPoint))) {
+				status.perror("M3dView::viewToWorld");
+				return status;
+			}
+
+			origin = nearPoint;
+			direction = farPoint - nearPoint;
+
+			return MStatus::kSuccess;
+		}
+
+		bool Ray::intersects(const MBoundingBox & box, double & distance) const {
+			const MPoint min(box.min()), max(box.max());
+			double tmin = 0.0, tmax = std::numeric_limits<double>::max();
+
+			/*
+			 * Slab test
+			 */
+
+			for (int i = 0; i < 3; ++i) {
+				if (std::fabs(direction[i]) < std::numeric_limits<double>::epsilon()) {
+					if (origin[i] < min[i] || origin[i] > max[i])
+						return false;
+
+					continue;
+				}
+
+				double t0 = (min[i] - origin[i]) / direction[i], t1 = (max[i] - origin[i]) / direction[i];
+
+				if (t0 > t1)
+					std::swap(t0, t1);
+
+				tmin = std::max(tmin, t0);
+				tmax = std::min(tmax, t1);
+
+				if (tmin > tmax)
+					return false;
+			}
+
+			distance = tmin;
+
+			return true;
+		}
+	}
+}
@@ -0,0 +1,165 @@
+#include <opengl.h>
+
+#include <view/BaseDrawOverride.h>
+
+#ifdef HELIX_VIEWPORT2
+
+#include <view/BaseShape.h>
+#include <view/BaseRenderer.h>
+
+#include <maya/M3dView.h>
+#include <maya/MFnDagNode.h>
+#include <maya/MGeometryUtilities.h>
+#include <maya/MMatrix.h>
+#include <maya/MPxSurfaceShapeUI.h>
+
+namespace Helix {
+	namespace View {
+		/*
+		 * Viewport 2.0 only passes the camera of the pane being drawn. Its view is found by the camera, preferring the active view
+		 * when several views look through the same camera. Only when no view matches, the active view is used.
+		 */
+
+		M3dView BaseDrawOverride_view(const MDagPath & cameraPath) {
+			MStatus status;
+			M3dView activeView = M3dView::active3dView(&status);
+			MDagPath camera;
+
+			if (status && activeView.getCamera(camera) && camera == cameraPath)
+				return activeView;
+
+			for (unsigned int i = 0; i < M3dView::numberOf3dViews(); ++i) {
+				M3dView view;
+
+				if (!M3dView::get3dView(i, view))
+					continue;
+
+				if (view.getCamera(camera) && camera == cameraPath)
+					return view;
+			}
+
+			return activeView;
+		}
+
+		bool BaseDrawOverride_beginGL(const MHWRender::MDrawContext & context) {
+			MStatus status;
+
+			const MMatrix worldViewMatrix(context.getMatrix(MHWRender::MFrameContext::kWorldViewMtx, &status));
+
+			if (!status) {
+				status.perror("MDrawContext::getMatrix");
+				return false;
+			}
+
+			const MMatrix projectionMatrix(context.getMatrix(MHWRender::MFrameContext::kProjectionMtx, &status));
+
+			if (!status) {
+				status.perror("MDrawContext::getMatrix");
+				return false;
+			}
+
+			glMatrixMode(GL_PROJECTION);
+			glPushMatrix();
+			glLoadMatrixd((const GLdouble *) projectionMatrix.matrix);
+
+			glMatrixMode(GL_MODELVIEW);
+			glPushMatrix();
+			glLoadMatrixd((const GLdouble *) worldViewMatrix.matrix);
+
+			return true;
+		}
+
+		void BaseDrawOverride_endGL() {
+			glMatrixMode(GL_PROJECTION);
+			glPopMatrix();
+
+			glMatrixMode(GL_MODELVIEW);
+			glPopMatrix();
+		}
+
+		BaseDrawOverride::BaseDrawOverride(const MObject & obj) : MHWRender::MPxDrawOverride(obj, BaseDrawOverride::draw) {
+
+		}
+
+		BaseDrawOverride::~BaseDrawOverride() {
+
+		}
+
+		MHWRender::MPxDrawOverride *BaseDrawOverride::creator(const MObject & obj) {
+			return new BaseDrawOverride(obj);
+		}
+
+		MHWRender::DrawAPI BaseDrawOverride::supportedDrawAPIs() const {
+			/*
+			 * BaseRenderer draws with GLSL 1.20 and the fixed function matrices
+			 */
+
+			return MHWRender::kOpenGL;
+		}
+
+		bool BaseDrawOverride::isBounded(const MDagPath & objPath, const MDagPath & cameraPath) const {
+			return true;
+		}
+
+		MBoundingBox BaseDrawOverride::boundingBox(const MDagPath & objPath, const MDagPath & cameraPath) const {
+			MStatus status;
+			MFnDagNode dagNode(objPath, &status);
+
+			if (!status) {
+				status.perror("MFnDagNode::#ctor");
+				return MBoundingBox();
+			}
+
+			BaseShape *shape = (BaseShape *) dagNode.userNode(&status);
+
+			if (!status || !shape) {
+				status.perror("MFnDagNode::userNode");
+				return MBoundingBox();
+			}
+
+			return shape->boundingBox();
+		}
+
+		MUserData *BaseDrawOverride::prepareForDraw(const MDagPath & objPath, const MDagPath & cameraPath, const MHWRender::MFrameContext & frameContext, MUserData *oldData) {
+			/*
+			 * The material and selection colors are still evaluated through the legacy interfaces, the same way as BaseShapeUI does.
+			 * The level of detail and culling use the view of the camera being drawn, as there can be several panes
+			 */
+
+			MPxSurfaceShapeUI *ui = MPxSurfaceShapeUI::surfaceShapeUI(objPath);
+
+			if (!ui)
+				return oldData;
+
+			M3dView view = BaseDrawOverride_view(cameraPath);
+			BaseRenderer::submit(objPath, (M3dView::DisplayStatus) MHWRender::MGeometryUtilities::displayStatus(objPath), view, *ui);
+
+			return oldData;
+		}
+
+		void BaseDrawOverride::draw(const MHWRender::MDrawContext & context, const MUserData *data) {
+			MStatus status;
+
+			const MMatrix viewMatrix(context.getMatrix(MHWRender::MFrameContext::kViewMtx, &status));
+
+			if (!status) {
+				status.perror("MDrawContext::getMatrix");
+				return;
+			}
+
+			const MMatrix projectionMatrix(context.getMatrix(MHWRender::MFrameContext::kProjectionMtx, &status));
+
+			if (!status) {
+				status.perror("MDrawContext::getMatrix");
+				return;
+			}
+
+			const unsigned int displayStyle = context.getDisplayStyle();
+			const bool wireframe = (displayStyle & MHWRender::MFrameContext::kWireFrame) && !(displayStyle & MHWRender::MFrameContext::kGouraudShaded);
+
+			BaseRenderer::draw(viewMatrix, projectionMatrix, wireframe);
+		}
+	}
+}
+
+#endif /* N HELIX_VIEWPORT2 */
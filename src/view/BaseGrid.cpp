@@ -0,0 +1,265 @@
+#include <view/BaseGrid.h>
+#include <HelixBase.h>
+
+#include <maya/MDagMessage.h>
+#include <maya/MDGMessage.h>
+#include <maya/MFnDagNode.h>
+#include <maya/MFnTransform.h>
+#include <maya/MItDag.h>
+#include <maya/MSceneMessage.h>
+#include <maya/MVector.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Helix {
+	namespace View {
+		BaseGrid::entry_map_t BaseGrid::s_entries;
+		BaseGrid::cell_map_t BaseGrid::s_cells;
+		MCallbackIdArray BaseGrid::s_globalCallbacks;
+		bool BaseGrid::s_rescan = true;
+
+		void BaseGrid::update(const MObject & base, const MObject & helix, const MPoint & position) {
+			/*
+			 * The next scan will find the base at its new position anyway
+			 */
+
+			if (s_rescan)
+				return;
+
+			const MObjectHandle handle(base);
+			entry_map_t::iterator it(s_entries.find(handle));
+
+			if (it == s_entries.end()) {
+				Entry entry;
+				entry.base = handle;
+				entry.helix = MObjectHandle(helix);
+				entry.position = position;
+				entry.cell = cellOf(position);
+
+				insert(entry);
+				return;
+			}
+
+			Entry & entry(it->second);
+			const Cell cell(cellOf(position));
+
+			entry.position = position;
+			entry.helix = MObjectHandle(helix);
+
+			if (!(cell == entry.cell)) {
+				removeFromCell(handle, entry.cell);
+
+				entry.cell = cell;
+				s_cells[cell].push_back(handle);
+			}
+		}
+
+		MStatus BaseGrid::query(const MPoint & position, double distance, const MObject & helix, MObjectArray & bases) {
+			MStatus status;
+
+			if (s_rescan && !(status = rescan())) {
+				status.perror("BaseGrid::rescan");
+				return status;
+			}
+
+			const Cell min(cellOf(position - MVector(distance, distance, distance))), max(cellOf(position + MVector(distance, distance, distance)));
+
+			for (int x = min.x; x <= max.x; ++x) {
+				for (int y = min.y; y <= max.y; ++y) {
+					for (int z = min.z; z <= max.z; ++z) {
+						const Cell cell = { x, y, z };
+						cell_map_t::const_iterator cell_it(s_cells.find(cell));
+
+						if (cell_it == s_cells.end())
+							continue;
+
+						for (std::vector<MObjectHandle>::const_iterator it = cell_it->second.begin(); it != cell_it->second.end(); ++it) {
+							entry_map_t::const_iterator entry_it(s_entries.find(*it));
+
+							if (entry_it == s_entries.end())
+								continue;
+
+							const Entry & entry(entry_it->second);
+
+							if (!entry.base.isValid() || (entry.helix.isValid() && entry.helix.object() == helix))
+								continue;
+
+							if ((entry.position - position).length() < distance)
+								bases.append(entry.base.object());
+						}
+					}
+				}
+			}
+
+			return MStatus::kSuccess;
+		}
+
+		void BaseGrid::invalidate() {
+			s_rescan = true;
+		}
+
+		BaseGrid::Cell BaseGrid::cellOf(const MPoint & position) {
+			const Cell cell = {
+				int(std::floor(position.x / BASEGRID_CELL_SIZE)),
+				int(std::floor(position.y / BASEGRID_CELL_SIZE)),
+				int(std::floor(position.z / BASEGRID_CELL_SIZE))
+			};
+
+			return cell;
+		}
+
+		MStatus BaseGrid::rescan() {
+			MStatus status;
+
+			/*
+			 * Bases can be created, deleted or reparented without being selected, so these callbacks are global
+			 */
+
+			if (s_globalCallbacks.length() == 0) {
+				s_globalCallbacks.append(MDGMessage::addNodeAddedCallback(&BaseGrid::MDGMessage_baseAddedRemoved, HELIX_HELIXBASE_NAME, NULL, &status));
+
+				if (!status)
+					status.perror("MDGMessage::addNodeAddedCallback");
+
+				s_globalCallbacks.append(MDGMessage::addNodeRemovedCallback(&BaseGrid::MDGMessage_baseAddedRemoved, HELIX_HELIXBASE_NAME, NULL, &status));
+
+				if (!status)
+					status.perror("MDGMessage::addNodeRemovedCallback");
+
+				s_globalCallbacks.append(MDagMessage::addParentAddedCallback(&BaseGrid::MDagMessage_parentAdded, NULL, &status));
+
+				if (!status)
+					status.perror("MDagMessage::addParentAddedCallback");
+
+				s_globalCallbacks.append(MDGMessage::addTimeChangeCallback(&BaseGrid::MDGMessage_timeChange, NULL, &status));
+
+				if (!status)
+					status.perror("MDGMessage::addTimeChangeCallback");
+
+				s_globalCallbacks.append(MSceneMessage::addCallback(MSceneMessage::kBeforeNew, &BaseGrid::MSceneMessage_beforeNewOpen, NULL, &status));
+
+				if (!status)
+					status.perror("MSceneMessage::addCallback");
+
+				s_globalCallbacks.append(MSceneMessage::addCallback(MSceneMessage::kBeforeOpen, &BaseGrid::MSceneMessage_beforeNewOpen, NULL, &status));
+
+				if (!status)
+					status.perror("MSceneMessage::addCallback");
+			}
+
+			clear();
+
+			MItDag itDag(MItDag::kDepthFirst, MFn::kTransform, &status);
+
+			if (!status) {
+				status.perror("MItDag::#ctor");
+				return status;
+			}
+
+			for (; !itDag.isDone(); itDag.next()) {
+				MDagPath path;
+
+				if (!(status = itDag.getPath(path))) {
+					status.perror("MItDag::getPath");
+					return status;
+				}
+
+				MFnTransform transform(path, &status);
+
+				if (!status) {
+					status.perror("MFnTransform::#ctor");
+					return status;
+				}
+
+				if (transform.typeId(&status) != HelixBase::id)
+					continue;
+
+				const MVector translation(transform.getTranslation(MSpace::kWorld, &status));
+
+				if (!status) {
+					status.perror("MFnTransform::getTranslation");
+					return status;
+				}
+
+				MObject base(transform.object());
+				Entry entry;
+
+				entry.base = MObjectHandle(base);
+				entry.helix = MObjectHandle(transform.parentCount() > 0 ? transform.parent(0) : MObject::kNullObj);
+				entry.position = MPoint(translation);
+				entry.cell = cellOf(entry.position);
+
+				insert(entry);
+			}
+
+			s_rescan = false;
+
+			return MStatus::kSuccess;
+		}
+
+		void BaseGrid::insert(const Entry & entry) {
+			/*
+			 * An instanced base is found once for every path, but only its first position is used
+			 */
+
+			if (s_entries.insert(std::make_pair(entry.base, entry)).second)
+				s_cells[entry.cell].push_back(entry.base);
+		}
+
+		void BaseGrid::removeFromCell(const MObjectHandle & base, const Cell & cell) {
+			cell_map_t::iterator it(s_cells.find(cell));
+
+			if (it == s_cells.end())
+				return;
+
+			std::vector<MObjectHandle> & bases(it->second);
+			std::vector<MObjectHandle>::iterator base_it(std::find(bases.begin(), bases.end(), base));
+
+			if (base_it != bases.end()) {
+				*base_it = bases.back();
+				bases.pop_back();
+			}
+
+			if (bases.empty())
+				s_cells.erase(it);
+		}
+
+		void BaseGrid::clear() {
+			s_entries.clear();
+			s_cells.clear();
+		}
+
+		void BaseGrid::release() {
+			clear();
+
+			if (s_globalCallbacks.length() > 0) {
+				MMessage::removeCallbacks(s_globalCallbacks);
+				s_globalCallbacks.clear();
+			}
+
+			s_rescan = true;
+		}
+
+		void BaseGrid::MDGMessage_baseAddedRemoved(MObject & node, void *clientData) {
+			s_rescan = true;
+		}
+
+		void BaseGrid::MDagMessage_parentAdded(MDagPath & child, MDagPath & parent, void *clientData) {
+			/*
+			 * Reparenting a base or a group of helices moves bases in world space
+			 */
+
+			s_rescan = true;
+		}
+
+		void BaseGrid::MDGMessage_timeChange(MTime & time, void *clientData) {
+			s_rescan = true;
+		}
+
+		void BaseGrid::MSceneMessage_beforeNewOpen(void *clientData) {
+			clear();
+			s_rescan = true;
+		}
+	}
+}
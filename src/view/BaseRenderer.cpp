@@ -0,0 +1,837 @@
+#include <opengl.h>
+
+#include <view/BaseRenderer.h>
+#include <view/HelixLOD.h>
+#include <Utility.h>
+
+#include <maya/MFnDagNode.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MMaterial.h>
+#include <maya/MMatrix.h>
+#include <maya/MPlugArray.h>
+#include <maya/MSceneMessage.h>
+
+#include <algorithm>
+
+#define BASERENDERER_GLSL_VERTEX_SHADER															\
+	"#version 120\n",																			\
+																								\
+	"attribute vec4 instanceMatrix0, instanceMatrix1, instanceMatrix2, instanceMatrix3;\n",		\
+	"attribute vec3 instanceColor;\n",															\
+	"attribute vec4 instanceBorder;\n",															\
+	"attribute float instanceVisible;\n",														\
+																								\
+	"varying vec3 Normal, EyeVec, Color, BorderColor;\n",										\
+	"varying float Border;\n",																	\
+																								\
+	"void main() {\n",																			\
+	"	mat4 world = mat4(instanceMatrix0, instanceMatrix1, instanceMatrix2, instanceMatrix3);\n",	\
+	"	vec4 wVertex = gl_ModelViewMatrix * (world * gl_Vertex);\n",							\
+	"	gl_Position = instanceVisible > 0.5 ? gl_ProjectionMatrix * wVertex : vec4(0.0, 0.0, 2.0, 1.0);\n",	\
+	"	EyeVec = -vec3(wVertex);\n",															\
+	"	Normal = gl_NormalMatrix * (mat3(world[0].xyz, world[1].xyz, world[2].xyz) * gl_Normal);\n",	\
+	"	Color = instanceColor;\n",																\
+	"	BorderColor = instanceBorder.rgb;\n",													\
+	"	Border = instanceBorder.a;\n",															\
+	"}\n"
+
+#define BASERENDERER_GLSL_FRAGMENT_SHADER														\
+	"#version 120\n",																			\
+																								\
+	"varying vec3 Normal, EyeVec, Color, BorderColor;\n",										\
+	"varying float Border;\n",																	\
+																								\
+	"void main() {\n",																			\
+	"	vec3 N = normalize(Normal), L = normalize(EyeVec);\n",									\
+	"	float lambertTerm = dot(N, L);\n",														\
+	"	float borderFlag = smoothstep(0.3 * (Border * 2.0 - 1.0), 0.7 * Border, abs(lambertTerm));\n",	\
+	"	gl_FragColor = vec4(BorderColor * (1.0 - borderFlag) + borderFlag * Color * max(0.0, lambertTerm), 1.0);\n",	\
+	"}\n"
+
+/*
+ * When adding or removing attributes, remember to modify BaseRenderer::Instance and the sizes and offsets below
+ */
+#define BASERENDERER_GLSL_ATTRIB_NAMES "instanceMatrix0", "instanceMatrix1", "instanceMatrix2", "instanceMatrix3", "instanceColor", "instanceBorder", "instanceVisible"
+#define BASERENDERER_GLSL_ATTRIB_COUNT 7
+
+/*
+ * The buffer grows in steps to avoid reallocating it for every base created
+ */
+#define BASERENDERER_MIN_BUFFER_CAPACITY 4096
+
+namespace Helix {
+	namespace Data {
+
+#include <data/BackboneArrow.h>
+
+	}
+
+	namespace View {
+		const GLint g_BaseRenderer_attrib_sizes[BASERENDERER_GLSL_ATTRIB_COUNT] = { 4, 4, 4, 4, 3, 4, 1 };
+		const size_t g_BaseRenderer_attrib_offsets[BASERENDERER_GLSL_ATTRIB_COUNT] = { 0, 4, 8, 12, 16, 19, 23 };
+
+		BaseRenderer::DrawData BaseRenderer::s_drawData;
+		std::vector<BaseRenderer::Instance> BaseRenderer::s_instances;
+		std::vector<MObjectHandle> BaseRenderer::s_slots;
+		std::vector<unsigned int> BaseRenderer::s_frames;
+		BaseRenderer::record_map_t BaseRenderer::s_records;
+		BaseRenderer::shader_callback_map_t BaseRenderer::s_shaders;
+		MCallbackIdArray BaseRenderer::s_globalCallbacks;
+		unsigned int BaseRenderer::s_frame = 1;
+		bool BaseRenderer::s_drawn = false;
+		size_t BaseRenderer::s_dirty_begin = 0, BaseRenderer::s_dirty_end = 0;
+		BaseRenderer::PickKey BaseRenderer::s_pickKey;
+		BVH BaseRenderer::s_pickBVH;
+		MBoundingBox BaseRenderer::s_arrowBox;
+		std::vector<unsigned int> BaseRenderer::s_pickSlots, BaseRenderer::s_picked;
+		unsigned int BaseRenderer::s_modified = 1, BaseRenderer::s_pickModified = 0;
+
+		void BaseRenderer::submit(const MDagPath & path, M3dView::DisplayStatus displayStatus, M3dView & view, MPxSurfaceShapeUI & ui) {
+			MStatus status;
+
+			if (s_drawn) {
+				++s_frame;
+				s_drawn = false;
+			}
+
+			/*
+			 * Bases that are not submitted are hidden, the shape is below the base transform which is below the helix.
+			 * Skips the bases of helices outside the view or drawn at a lower level of detail
+			 */
+
+			{
+				MDagPath helixPath(path);
+
+				if ((status = helixPath.pop(2)) && HelixLOD::level(helixPath, view) != HelixLOD::kBases)
+					return;
+			}
+
+			MObject shape(path.node(&status));
+
+			if (!status) {
+				status.perror("MDagPath::node");
+				return;
+			}
+
+			record_map_t::iterator it(s_records.find(MObjectHandle(shape)));
+			Record *record;
+
+			if (it != s_records.end())
+				record = &it->second;
+			else if (!(record = addRecord(path)))
+				return;
+
+			/*
+			 * Submitted twice without a draw in between, the previous frame was never drawn
+			 */
+
+			if (s_frames[record->slot] == s_frame)
+				++s_frame;
+
+			s_frames[record->slot] = s_frame;
+
+			Instance & instance(s_instances[record->slot]);
+			bool modified = false;
+
+			/*
+			 * The world matrix is not only modified by attributes of the base and its helix but also by constraints, animation and
+			 * the transforms above the helix, which don't send any messages to the base. Thus it's compared every time
+			 */
+
+			{
+				const MMatrix matrix(path.inclusiveMatrix(&status));
+
+				if (!status) {
+					status.perror("MDagPath::inclusiveMatrix");
+					return;
+				}
+
+				for (int i = 0; i < 4; ++i) {
+					for (int j = 0; j < 4; ++j) {
+						const GLfloat value = (GLfloat) matrix[i][j];
+
+						if (instance.matrix[i * 4 + j] != value) {
+							instance.matrix[i * 4 + j] = value;
+							modified = true;
+						}
+					}
+				}
+			}
+
+			if (record->colorDirty) {
+				watchShader(path, *record);
+
+				MDagPath materialPath(path);
+				MMaterial material = ui.material(materialPath);
+				MColor color;
+
+				if (!(status = material.evaluateMaterial(view, materialPath)))
+					status.perror("MMaterial::evaluateMaterial");
+
+				if (!(status = material.evaluateDiffuse()))
+					status.perror("MMaterial::evaluateDiffuse");
+
+				if (!(status = material.getDiffuse(color)))
+					status.perror("MMaterial::getDiffuse");
+
+				instance.color[0] = color.r;
+				instance.color[1] = color.g;
+				instance.color[2] = color.b;
+
+				record->colorDirty = false;
+				modified = true;
+			}
+
+			MColor borderColor;
+			GLfloat border = 0.0f;
+
+			switch (displayStatus)
+			{
+			case M3dView::kLead :
+				borderColor = view.colorAtIndex( LEAD_COLOR);
+				border = 1.0f;
+				break;
+			case M3dView::kActive :
+				borderColor = view.colorAtIndex( ACTIVE_COLOR);
+				border = 1.0f;
+				break;
+			case M3dView::kHilite :
+				borderColor = view.colorAtIndex( HILITE_COLOR);
+				border = 1.0f;
+				break;
+			default:
+				break;
+			}
+
+			if (instance.border[0] != borderColor.r || instance.border[1] != borderColor.g || instance.border[2] != borderColor.b || instance.border[3] != border) {
+				instance.border[0] = borderColor.r;
+				instance.border[1] = borderColor.g;
+				instance.border[2] = borderColor.b;
+				instance.border[3] = border;
+
+				modified = true;
+			}
+
+			if (modified)
+				touch(record->slot);
+		}
+
+		void BaseRenderer::draw(const MDrawRequest & request, M3dView & view) {
+			/*
+			 * Also called when all bases were culled, to let HelixLOD know that the frame was drawn
+			 */
+
+			if (!s_drawn && !s_drawData.failure) {
+				view.beginGL();
+
+				/*
+				 * The current matrix is that of the base that was requested to draw, the instances contain world matrices
+				 */
+
+				const MMatrix inverse(request.multiPath().inclusiveMatrixInverse());
+
+				glPushMatrix();
+				glMultMatrixd((const GLdouble *) inverse.matrix);
+
+				drawInstances((M3dView::DisplayStyle) request.token() == M3dView::kWireFrame);
+
+				glPopMatrix();
+
+				view.endGL();
+			}
+
+			HelixLOD::drawn();
+		}
+
+		void BaseRenderer::draw(const MMatrix & viewMatrix, const MMatrix & projectionMatrix, bool wireframe) {
+			if (!s_drawn && !s_drawData.failure) {
+				glMatrixMode(GL_PROJECTION);
+				glPushMatrix();
+				glLoadMatrixd((const GLdouble *) projectionMatrix.matrix);
+
+				glMatrixMode(GL_MODELVIEW);
+				glPushMatrix();
+				glLoadMatrixd((const GLdouble *) viewMatrix.matrix);
+
+				drawInstances(wireframe);
+
+				glMatrixMode(GL_PROJECTION);
+				glPopMatrix();
+
+				glMatrixMode(GL_MODELVIEW);
+				glPopMatrix();
+			}
+
+			HelixLOD::drawn();
+		}
+
+		void BaseRenderer::drawInstances(bool wireframe) {
+			s_drawn = true;
+
+			if (!s_drawData.initialized)
+				initializeDraw();
+
+			if (s_drawData.failure)
+				return;
+
+			/*
+			 * Hide the bases that were not submitted this frame, they're invisible or deleted
+			 */
+
+			const size_t numInstances = s_instances.size();
+			size_t numVisible = 0;
+
+			for (size_t i = 0; i < numInstances; ++i) {
+				const GLfloat visible = s_frames[i] == s_frame ? 1.0f : 0.0f;
+
+				if (s_instances[i].visible != visible) {
+					s_instances[i].visible = visible;
+					touch((unsigned int) i);
+				}
+
+				numVisible += s_frames[i] == s_frame;
+			}
+
+			if (numVisible == 0)
+				return;
+
+			if (s_drawData.instancing) {
+				GLCALL(glBindBuffer(GL_ARRAY_BUFFER, s_drawData.instance_buffer));
+
+				if (s_drawData.instance_buffer_capacity < GLsizei(numInstances)) {
+					s_drawData.instance_buffer_capacity = std::max(std::max(GLsizei(numInstances), s_drawData.instance_buffer_capacity * 2), GLsizei(BASERENDERER_MIN_BUFFER_CAPACITY));
+
+					GLCALL(glBufferData(GL_ARRAY_BUFFER, s_drawData.instance_buffer_capacity * sizeof(Instance), NULL, GL_DYNAMIC_DRAW));
+
+					s_dirty_begin = 0;
+					s_dirty_end = numInstances;
+				}
+
+				if (s_dirty_begin < s_dirty_end)
+					GLCALL(glBufferSubData(GL_ARRAY_BUFFER, s_dirty_begin * sizeof(Instance), (s_dirty_end - s_dirty_begin) * sizeof(Instance), &s_instances[s_dirty_begin]));
+			}
+
+			s_dirty_begin = 0;
+			s_dirty_end = 0;
+
+			if (wireframe) {
+				glPushAttrib(GL_POLYGON_BIT);
+
+				glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+			}
+
+			GLCALL(glUseProgram(s_drawData.program));
+
+			GLCALL(glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT));
+
+			/*
+			 * The arrow is always read from client memory
+			 */
+
+			GLCALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+			GLCALL(glEnableClientState(GL_VERTEX_ARRAY));
+			GLCALL(glEnableClientState(GL_NORMAL_ARRAY));
+			GLCALL(glVertexPointer(3, GL_FLOAT, 0, Data::BackboneArrowVerts));
+			GLCALL(glNormalPointer(GL_FLOAT, 0, Data::BackboneArrowNormals));
+
+			if (s_drawData.instancing) {
+				GLCALL(glBindBuffer(GL_ARRAY_BUFFER, s_drawData.instance_buffer));
+
+				for (int i = 0; i < BASERENDERER_GLSL_ATTRIB_COUNT; ++i) {
+					if (s_drawData.instance_attribs[i] == -1)
+						continue;
+
+					GLCALL(glEnableVertexAttribArray(s_drawData.instance_attribs[i]));
+					GLCALL(glVertexAttribPointer(s_drawData.instance_attribs[i], g_BaseRenderer_attrib_sizes[i], GL_FLOAT, GL_FALSE, sizeof(Instance), (const GLvoid *) (g_BaseRenderer_attrib_offsets[i] * sizeof(GLfloat))));
+					GLCALL(glVertexAttribDivisorARB(s_drawData.instance_attribs[i], 1));
+				}
+
+				GLCALL(glDrawArraysInstancedARB(GL_TRIANGLES, 0, Data::BackboneArrowNumVerts, GLsizei(numInstances)));
+
+				for (int i = 0; i < BASERENDERER_GLSL_ATTRIB_COUNT; ++i) {
+					if (s_drawData.instance_attribs[i] == -1)
+						continue;
+
+					GLCALL(glVertexAttribDivisorARB(s_drawData.instance_attribs[i], 0));
+					GLCALL(glDisableVertexAttribArray(s_drawData.instance_attribs[i]));
+				}
+
+				GLCALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+			}
+			else {
+				/*
+				 * Fallback, the instance attributes are set as constants. instanceColor reads the first border component which is ignored
+				 */
+
+				const GLfloat visible[] = { 1.0f, 0.0f, 0.0f, 1.0f };
+
+				if (s_drawData.instance_attribs[BASERENDERER_GLSL_ATTRIB_COUNT - 1] != -1)
+					GLCALL(glVertexAttrib4fv(s_drawData.instance_attribs[BASERENDERER_GLSL_ATTRIB_COUNT - 1], visible));
+
+				for (size_t i = 0; i < numInstances; ++i) {
+					if (s_frames[i] != s_frame)
+						continue;
+
+					const GLfloat *instance = (const GLfloat *) &s_instances[i];
+
+					for (int j = 0; j < BASERENDERER_GLSL_ATTRIB_COUNT - 1; ++j) {
+						if (s_drawData.instance_attribs[j] != -1)
+							GLCALL(glVertexAttrib4fv(s_drawData.instance_attribs[j], instance + g_BaseRenderer_attrib_offsets[j]));
+					}
+
+					GLCALL(glDrawArrays(GL_TRIANGLES, 0, Data::BackboneArrowNumVerts));
+				}
+			}
+
+			GLCALL(glPopClientAttrib());
+
+			GLCALL(glUseProgram(0));
+
+			if (wireframe)
+				glPopAttrib();
+		}
+
+		/*
+		 * Collects the indices of the boxes visited by a BVH query
+		 */
+
+		class BaseRenderer_PickVisitor {
+		public:
+			inline BaseRenderer_PickVisitor(std::vector<unsigned int> & indices) : m_indices(indices) {
+
+			}
+
+			inline void operator()(unsigned int index) {
+				m_indices.push_back(index);
+			}
+
+		private:
+			std::vector<unsigned int> & m_indices;
+		};
+
+		bool BaseRenderer::isPicked(MSelectInfo & selectInfo, MPoint & point) {
+			MStatus status;
+			M3dView view(selectInfo.view());
+			PickKey key;
+
+			selectInfo.selectRect(key.x, key.y, key.width, key.height);
+			key.singleSelection = selectInfo.singleSelection();
+			key.frame = s_frame;
+			key.modified = s_modified;
+
+			if (!(status = view.getCamera(key.camera))) {
+				status.perror("M3dView::getCamera");
+				return false;
+			}
+
+			/*
+			 * Maya calls select for every base, only the first call of a selection queries the BVH
+			 */
+
+			if (!(key == s_pickKey)) {
+				s_pickKey = key;
+				s_picked.clear();
+
+				if (key.singleSelection) {
+					Ray ray;
+					double distance;
+
+					if (ray.setFromView(view, short(key.x + key.width / 2), short(key.y + key.height / 2))) {
+						const int slot = pickSlot(ray, distance);
+
+						if (slot >= 0)
+							s_picked.push_back((unsigned int) slot);
+					}
+				}
+				else {
+					Frustum frustum;
+					std::vector<unsigned int> slots;
+
+					if (frustum.setFromRegion(view, short(key.x), short(key.y), short(key.x + key.width), short(key.y + key.height)))
+						pickSlots(frustum, slots);
+
+					s_picked.swap(slots);
+					std::sort(s_picked.begin(), s_picked.end());
+				}
+			}
+
+			MObject shape(selectInfo.multiPath().node(&status));
+
+			if (!status) {
+				status.perror("MDagPath::node");
+				return false;
+			}
+
+			record_map_t::const_iterator it(s_records.find(MObjectHandle(shape)));
+
+			if (it == s_records.end() || !std::binary_search(s_picked.begin(), s_picked.end(), it->second.slot))
+				return false;
+
+			const GLfloat *matrix = s_instances[it->second.slot].matrix;
+			point = MPoint(matrix[12], matrix[13], matrix[14]);
+
+			return true;
+		}
+
+		void BaseRenderer::pick(const Frustum & frustum, MDagPathArray & bases) {
+			MStatus status;
+			std::vector<unsigned int> slots;
+
+			pickSlots(frustum, slots);
+
+			for (std::vector<unsigned int>::iterator it = slots.begin(); it != slots.end(); ++it) {
+				MDagPath base;
+
+				if (!(status = getBasePath(*it, base))) {
+					status.perror("BaseRenderer::getBasePath");
+					continue;
+				}
+
+				bases.append(base);
+			}
+		}
+
+		bool BaseRenderer::pick(const Ray & ray, MDagPath & base, double & distance) {
+			MStatus status;
+			const int slot = pickSlot(ray, distance);
+
+			if (slot < 0)
+				return false;
+
+			if (!(status = getBasePath((unsigned int) slot, base))) {
+				status.perror("BaseRenderer::getBasePath");
+				return false;
+			}
+
+			return true;
+		}
+
+		void BaseRenderer::updatePickBVH() {
+			if (s_pickModified == s_modified)
+				return;
+
+			/*
+			 * The bounding box of the arrow in the space of the base
+			 */
+
+			s_arrowBox = MBoundingBox();
+
+			for (unsigned int i = 0; i < Data::BackboneArrowNumVerts; ++i)
+				s_arrowBox.expand(MPoint(Data::BackboneArrowVerts[i * 3], Data::BackboneArrowVerts[i * 3 + 1], Data::BackboneArrowVerts[i * 3 + 2]));
+
+			std::vector<MBoundingBox> boxes;
+
+			boxes.reserve(s_instances.size());
+			s_pickSlots.clear();
+
+			for (size_t i = 0; i < s_instances.size(); ++i) {
+				if (s_instances[i].visible < 0.5f)
+					continue;
+
+				MBoundingBox box(s_arrowBox);
+				box.transformUsing(instanceMatrix((unsigned int) i));
+
+				boxes.push_back(box);
+				s_pickSlots.push_back((unsigned int) i);
+			}
+
+			s_pickBVH.build(boxes);
+			s_pickModified = s_modified;
+		}
+
+		void BaseRenderer::pickSlots(const Frustum & frustum, std::vector<unsigned int> & slots) {
+			std::vector<unsigned int> indices;
+			BaseRenderer_PickVisitor visitor(indices);
+
+			updatePickBVH();
+			s_pickBVH.query(frustum, visitor);
+
+			slots.reserve(slots.size() + indices.size());
+
+			for (std::vector<unsigned int>::iterator it = indices.begin(); it != indices.end(); ++it)
+				slots.push_back(s_pickSlots[*it]);
+		}
+
+		int BaseRenderer::pickSlot(const Ray & ray, double & distance) {
+			std::vector<unsigned int> indices;
+			BaseRenderer_PickVisitor visitor(indices);
+			int closest = -1;
+
+			updatePickBVH();
+			s_pickBVH.query(ray, visitor);
+
+			/*
+			 * The world space boxes are loose for rotated bases, test the ray against the arrow box in the space of every candidate
+			 */
+
+			for (std::vector<unsigned int>::iterator it = indices.begin(); it != indices.end(); ++it) {
+				const unsigned int slot = s_pickSlots[*it];
+				double slotDistance;
+
+				if (ray.transformed(instanceMatrix(slot).inverse()).intersects(s_arrowBox, slotDistance) && (closest < 0 || slotDistance < distance)) {
+					closest = (int) slot;
+					distance = slotDistance;
+				}
+			}
+
+			return closest;
+		}
+
+		MMatrix BaseRenderer::instanceMatrix(unsigned int slot) {
+			double matrix[4][4];
+
+			for (int i = 0; i < 4; ++i) {
+				for (int j = 0; j < 4; ++j)
+					matrix[i][j] = s_instances[slot].matrix[i * 4 + j];
+			}
+
+			return MMatrix(matrix);
+		}
+
+		MStatus BaseRenderer::getBasePath(unsigned int slot, MDagPath & base) {
+			MStatus status;
+			record_map_t::const_iterator it(s_records.find(s_slots[slot]));
+
+			if (it == s_records.end() || !it->second.shape.isValid())
+				return MStatus::kInvalidParameter;
+
+			/*
+			 * The shape is below the HelixBase transform
+			 */
+
+			if (!(status = MDagPath::getAPathTo(it->second.shape.object(), base))) {
+				status.perror("MDagPath::getAPathTo");
+				return status;
+			}
+
+			if (!(status = base.pop())) {
+				status.perror("MDagPath::pop");
+				return status;
+			}
+
+			return MStatus::kSuccess;
+		}
+
+		void BaseRenderer::initializeDraw() {
+#if defined(WIN32) || defined(WIN64)
+			installGLExtensions();
+#endif /* WINDOWS */
+
+			MStatus status;
+
+			static const char *vertex_shader[] = { BASERENDERER_GLSL_VERTEX_SHADER, NULL }, *fragment_shader[] = { BASERENDERER_GLSL_FRAGMENT_SHADER, NULL }, *attrib_names[] = { BASERENDERER_GLSL_ATTRIB_NAMES, NULL };
+
+			if (!(status = SetupOpenGLShaders(vertex_shader, fragment_shader, NULL, NULL, 0, attrib_names, s_drawData.instance_attribs, BASERENDERER_GLSL_ATTRIB_COUNT, s_drawData.program, s_drawData.vertex_shader, s_drawData.fragment_shader))) {
+				status.perror("SetupOpenGLShaders");
+
+				s_drawData.failure = true;
+				return;
+			}
+
+			if ((s_drawData.instancing = hasGLInstancing()))
+				GLCALL(glGenBuffers(1, &s_drawData.instance_buffer));
+			else
+				std::cerr << "GL_ARB_draw_instanced or GL_ARB_instanced_arrays is not supported, bases will be drawn one by one" << std::endl;
+
+			s_drawData.initialized = true;
+		}
+
+		BaseRenderer::Record *BaseRenderer::addRecord(const MDagPath & path) {
+			MStatus status;
+
+			/*
+			 * Callbacks that are shared by all bases are registered with the first one
+			 */
+
+			if (s_globalCallbacks.length() == 0) {
+				s_globalCallbacks.append(MSceneMessage::addCallback(MSceneMessage::kBeforeNew, &BaseRenderer::MSceneMessage_beforeNewOpen, NULL, &status));
+
+				if (!status)
+					status.perror("MSceneMessage::addCallback");
+
+				s_globalCallbacks.append(MSceneMessage::addCallback(MSceneMessage::kBeforeOpen, &BaseRenderer::MSceneMessage_beforeNewOpen, NULL, &status));
+
+				if (!status)
+					status.perror("MSceneMessage::addCallback");
+			}
+
+			MObject shape(path.node());
+
+			Record record;
+			record.shape = MObjectHandle(shape);
+			record.slot = (unsigned int) s_instances.size();
+			record.colorDirty = true;
+
+			record.callbacks[0] = MNodeMessage::addAttributeChangedCallback(shape, &BaseRenderer::MNodeMessage_shape_attributeChanged, NULL, &status);
+
+			if (!status)
+				status.perror("MNodeMessage::addAttributeChangedCallback shape");
+
+			record.callbacks[1] = MNodeMessage::addNodePreRemovalCallback(shape, &BaseRenderer::MNodeMessage_shape_preRemoval, NULL, &status);
+
+			if (!status)
+				status.perror("MNodeMessage::addNodePreRemovalCallback");
+
+			Instance instance;
+			std::fill((GLfloat *) &instance, (GLfloat *) (&instance + 1), 0.0f);
+
+			s_instances.push_back(instance);
+			s_slots.push_back(record.shape);
+			s_frames.push_back(0);
+
+			touch(record.slot);
+
+			return &s_records.insert(std::make_pair(record.shape, record)).first->second;
+		}
+
+		void BaseRenderer::removeRecord(const MObjectHandle & shape) {
+			record_map_t::iterator it(s_records.find(shape));
+
+			if (it == s_records.end())
+				return;
+
+			Record & record(it->second);
+
+			for (int i = 0; i < 2; ++i) {
+				if (record.callbacks[i] != 0)
+					MMessage::removeCallback(record.callbacks[i]);
+			}
+
+			/*
+			 * Move the last instance into the removed slot
+			 */
+
+			const unsigned int slot = record.slot, last = (unsigned int) s_instances.size() - 1;
+
+			if (slot != last) {
+				s_instances[slot] = s_instances[last];
+				s_slots[slot] = s_slots[last];
+				s_frames[slot] = s_frames[last];
+				s_records[s_slots[slot]].slot = slot;
+
+				touch(slot);
+			}
+
+			s_instances.pop_back();
+			s_slots.pop_back();
+			s_frames.pop_back();
+
+			s_dirty_end = std::min(s_dirty_end, s_instances.size());
+			++s_modified;
+
+			s_records.erase(it);
+		}
+
+		void BaseRenderer::watchShader(const MDagPath & path, Record & record) {
+			MStatus status;
+
+			/*
+			 * Materials are assigned by connecting instObjGroups to a shading group, the shader is connected to its surfaceShader
+			 */
+
+			MPlug instObjGroups(MFnDagNode(path.node()).findPlug("instObjGroups", &status));
+
+			if (!status) {
+				status.perror("MFnDagNode::findPlug instObjGroups");
+				return;
+			}
+
+			MPlugArray shadingGroups, shaders;
+			instObjGroups.elementByLogicalIndex(path.instanceNumber()).connectedTo(shadingGroups, false, true, &status);
+
+			for (unsigned int i = 0; i < shadingGroups.length() && shaders.length() == 0; ++i) {
+				MPlug surfaceShader(MFnDependencyNode(shadingGroups[i].node()).findPlug("surfaceShader", &status));
+
+				if (status)
+					surfaceShader.connectedTo(shaders, true, false, &status);
+			}
+
+			if (shaders.length() == 0) {
+				record.shader = MObjectHandle();
+				return;
+			}
+
+			MObject shader(shaders[0].node());
+			record.shader = MObjectHandle(shader);
+
+			if (s_shaders.find(record.shader) != s_shaders.end())
+				return;
+
+			MCallbackId callback = MNodeMessage::addAttributeChangedCallback(shader, &BaseRenderer::MNodeMessage_shader_attributeChanged, NULL, &status);
+
+			if (!status) {
+				status.perror("MNodeMessage::addAttributeChangedCallback shader");
+				return;
+			}
+
+			s_shaders.insert(std::make_pair(record.shader, callback));
+		}
+
+		void BaseRenderer::touch(unsigned int slot) {
+			++s_modified;
+
+			if (s_dirty_begin >= s_dirty_end) {
+				s_dirty_begin = slot;
+				s_dirty_end = slot + 1;
+			}
+			else {
+				s_dirty_begin = std::min(s_dirty_begin, size_t(slot));
+				s_dirty_end = std::max(s_dirty_end, size_t(slot) + 1);
+			}
+		}
+
+		void BaseRenderer::clear() {
+			while (!s_records.empty())
+				removeRecord(s_records.begin()->first);
+
+			for (shader_callback_map_t::iterator it = s_shaders.begin(); it != s_shaders.end(); ++it)
+				MMessage::removeCallback(it->second);
+
+			s_shaders.clear();
+
+			s_dirty_begin = 0;
+			s_dirty_end = 0;
+		}
+
+		void BaseRenderer::release() {
+			clear();
+
+			if (s_globalCallbacks.length() > 0) {
+				MMessage::removeCallbacks(s_globalCallbacks);
+				s_globalCallbacks.clear();
+			}
+		}
+
+		void BaseRenderer::MNodeMessage_shape_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData) {
+			/*
+			 * Materials are assigned by connecting instObjGroups to a shading group
+			 */
+
+			if (msg & (MNodeMessage::kConnectionMade | MNodeMessage::kConnectionBroken)) {
+				record_map_t::iterator it(s_records.find(MObjectHandle(plug.node())));
+
+				if (it != s_records.end())
+					it->second.colorDirty = true;
+			}
+		}
+
+		void BaseRenderer::MNodeMessage_shape_preRemoval(MObject & node, void *clientData) {
+			removeRecord(MObjectHandle(node));
+		}
+
+		void BaseRenderer::MNodeMessage_shader_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData) {
+			if (msg & (MNodeMessage::kAttributeSet | MNodeMessage::kConnectionMade | MNodeMessage::kConnectionBroken)) {
+				const MObjectHandle shader(plug.node());
+
+				for (record_map_t::iterator it = s_records.begin(); it != s_records.end(); ++it) {
+					if (it->second.shader == shader)
+						it->second.colorDirty = true;
+				}
+			}
+		}
+
+		void BaseRenderer::MSceneMessage_beforeNewOpen(void *clientData) {
+			clear();
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#include <opengl.h>
+
+#include <view/ConnectSuggestionsDrawOverride.h>
+
+#ifdef HELIX_VIEWPORT2
+
+#include <view/ConnectSuggestionsLocatorNode.h>
+
+namespace Helix {
+	namespace View {
+		ConnectSuggestionsDrawOverride::ConnectSuggestionsDrawOverride(const MObject & obj) : MHWRender::MPxDrawOverride(obj, ConnectSuggestionsDrawOverride::draw) {
+
+		}
+
+		ConnectSuggestionsDrawOverride::~ConnectSuggestionsDrawOverride() {
+
+		}
+
+		MHWRender::MPxDrawOverride *ConnectSuggestionsDrawOverride::creator(const MObject & obj) {
+			return new ConnectSuggestionsDrawOverride(obj);
+		}
+
+		MHWRender::DrawAPI ConnectSuggestionsDrawOverride::supportedDrawAPIs() const {
+			/*
+			 * ConnectSuggestionsLocatorNode draws with GLSL and a 3D texture
+			 */
+
+			return MHWRender::kOpenGL;
+		}
+
+		bool ConnectSuggestionsDrawOverride::isBounded(const MDagPath & objPath, const MDagPath & cameraPath) const {
+			/*
+			 * Same as ConnectSuggestionsLocatorNode::isBounded
+			 */
+
+			return false;
+		}
+
+		MBoundingBox ConnectSuggestionsDrawOverride::boundingBox(const MDagPath & objPath, const MDagPath & cameraPath) const {
+			return MBoundingBox();
+		}
+
+		MUserData *ConnectSuggestionsDrawOverride::prepareForDraw(const MDagPath & objPath, const MDagPath & cameraPath, const MHWRender::MFrameContext & frameContext, MUserData *oldData) {
+			return oldData;
+		}
+
+		void ConnectSuggestionsDrawOverride::draw(const MHWRender::MDrawContext & context, const MUserData *data) {
+			MStatus status;
+			int originX, originY, width, height;
+
+			if (!(status = context.getViewportDimensions(originX, originY, width, height))) {
+				status.perror("MDrawContext::getViewportDimensions");
+				return;
+			}
+
+			if (!BaseDrawOverride_beginGL(context))
+				return;
+
+			ConnectSuggestionsLocatorNode::drawGL(width, height);
+
+			BaseDrawOverride_endGL();
+		}
+	}
+}
+
+#endif /* N HELIX_VIEWPORT2 */
@@ -1,4 +1,5 @@
 #include <view/ConnectSuggestionsLocatorNode.h>
+#include <view/BaseGrid.h>
 #include <opengl.h>
 #include <Utility.h>
 #include <HelixBase.h>
@@ -14,7 +15,10 @@
 #include <vector>
 #include <functional>
 
-#define CONNECT_SUGGESTIONS_MAX_DISTANCE DNA::STEP * 2.0
+/*
+ * The grid cells are as large as the distance, see BaseGrid
+ */
+#define CONNECT_SUGGESTIONS_MAX_DISTANCE BASEGRID_CELL_SIZE
 
 /*
  * FIXME: Color as an attribute is not required
@@ -227,6 +231,12 @@ namespace Helix {
 			std::for_each(g_attributeChangedCallbacks.begin(), g_attributeChangedCallbacks.end(), std::ptr_fun(MModelMessage::removeCallback));
 			g_attributeChangedCallbacks.clear();
 
+			/*
+			 * Bases that were not tracked might have been moved
+			 */
+
+			BaseGrid::invalidate();
+
 			/*
 			 * Look for objects selected that are helices, bases or transforms containing helices and track them
 			 * notice that we need to be able to remove the trackings, thus we must save the objects we track for future deattachment
@@ -382,6 +392,15 @@ namespace Helix {
 			if (s_closeBasesTable.empty())
 				return;
 
+			view.beginGL();
+			drawGL(view.portWidth(), view.portHeight());
+			view.endGL();
+		}
+
+		void ConnectSuggestionsLocatorNode::drawGL(int portWidth, int portHeight) {
+			if (s_closeBasesTable.empty())
+				return;
+
 			MStatus stat;
 
 			static const float quad[] = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
@@ -471,8 +490,6 @@ namespace Helix {
 				}
 			}
 
-			view.beginGL();
-
 			if (!s_drawData.s_gl_initialized)
 				initializeGL();
 
@@ -483,7 +500,7 @@ namespace Helix {
 			GLCALL(glUseProgram(s_drawData.program));
 			
 			/* FIXME: Cache uniform as it rarely changes */
-			GLCALL(glUniform2f(s_drawData.windowSize_uniform, (GLfloat) view.portWidth(), (GLfloat) view.portHeight()));
+			GLCALL(glUniform2f(s_drawData.windowSize_uniform, (GLfloat) portWidth, (GLfloat) portHeight));
 
 			/*
 			 * Calls that could be put in a display list
@@ -525,8 +542,6 @@ namespace Helix {
 			GLCALL(glPopAttrib());
 			GLCALL(glUseProgram(0));
 
-			view.endGL();
-
 			delete[] vertices;
 			delete[] colors;
 			delete[] shift_arrow_strength_directions;
@@ -588,56 +603,42 @@ namespace Helix {
 			}
 
 			/*
-			 * Store potential connections here
+			 * Store potential connections here. The grid only has to look at the cells around the base
 			 */
 
-			MItDag it(MItDag::kDepthFirst, MFn::kTransform, &status);
+			MObject base_object(base.getObject(status));
 
 			if (!status) {
-				status.perror("MItDag::#ctor");
+				status.perror("Base::getObject");
 				return status;
 			}
 
-			for(; !it.isDone(); it.next()) {
-				MDagPath path;
-				
-				if (!(status = it.getPath(path))) {
-					status.perror("MItDag::getPath");
-					return status;
-				}
+			MObject helix_object(helix.getObject(status));
 
-				MFnTransform transform (path, &status);
-
-				if (!status) {
-					status.perror("MFnTransform::#ctor");
-					return status;
-				}
+			if (!status) {
+				status.perror("Helix::getObject");
+				return status;
+			}
 
-				if (transform.typeId(&status) == HelixBase::id) {
-					/*
-					 * NOTE: Do we want suggestions between bases on the same helix?
-					 */
+			BaseGrid::update(base_object, helix_object, MPoint(base_translation));
 
-					if (transform.parentCount() > 0 && helix == transform.parent(0, &status))
-						continue;
+			/*
+			 * NOTE: Do we want suggestions between bases on the same helix?
+			 */
 
-					MVector translation = transform.getTranslation(MSpace::kWorld, &status);
+			MObjectArray closeBases;
 
-					if(!status) {
-						status.perror("MFnTransform::getTranslation");
-						return status;
-					}
+			if (!(status = BaseGrid::query(MPoint(base_translation), CONNECT_SUGGESTIONS_MAX_DISTANCE, helix_object, closeBases))) {
+				status.perror("BaseGrid::query");
+				return status;
+			}
 
-					if ((translation - base_translation).length() < CONNECT_SUGGESTIONS_MAX_DISTANCE) {
-						Model::Base otherBase(path);
-						s_closeBasesTable.push_back(BasePair(base, otherBase));
-					}
-				}
+			for (unsigned int i = 0; i < closeBases.length(); ++i) {
+				if (closeBases[i] == base_object)
+					continue;
 
-				if (!status) {
-					status.perror("MFnDagNode::typeId");
-					return status;
-				}
+				Model::Base otherBase(closeBases[i]);
+				s_closeBasesTable.push_back(BasePair(base, otherBase));
 			}
 
 			return MStatus::kSuccess;
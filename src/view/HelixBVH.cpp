@@ -0,0 +1,385 @@
+#include <view/HelixBVH.h>
+#include <view/HelixShape.h>
+#include <model/Helix.h>
+#include <Helix.h>
+#include <HelixBase.h>
+#include <DNA.h>
+
+#include <maya/MDagMessage.h>
+#include <maya/MDGMessage.h>
+#include <maya/MFnDagNode.h>
+#include <maya/MItDag.h>
+#include <maya/MSceneMessage.h>
+
+
+namespace Helix {
+	namespace View {
+		std::vector<HelixBVH::Entry> HelixBVH::s_entries;
+		HelixBVH::index_map_t HelixBVH::s_indices;
+		BVH HelixBVH::s_bvh;
+		MCallbackIdArray HelixBVH::s_globalCallbacks, HelixBVH::s_ancestorCallbacks;
+		unsigned int HelixBVH::s_frame = 0;
+		bool HelixBVH::s_rescan = true, HelixBVH::s_dirty = false, HelixBVH::s_culled = false;
+
+		/*
+		 * Marks the visited helices as visible
+		 */
+
+		class HelixBVH_CullVisitor {
+		public:
+			inline HelixBVH_CullVisitor(std::vector<unsigned int> & frames, unsigned int frame) : m_frames(frames), m_frame(frame) {
+
+			}
+
+			inline void operator()(unsigned int index) {
+				m_frames[index] = m_frame;
+			}
+
+		private:
+			std::vector<unsigned int> & m_frames;
+			unsigned int m_frame;
+		};
+
+		void HelixBVH::cull(const Frustum & frustum) {
+			MStatus status;
+
+			/*
+			 * Helices can be created, deleted or reparented without us drawing them, so these callbacks are global
+			 */
+
+			if (s_globalCallbacks.length() == 0) {
+				s_globalCallbacks.append(MDGMessage::addNodeAddedCallback(&HelixBVH::MDGMessage_helixAddedRemoved, HELIX_HELIX_NAME, NULL, &status));
+
+				if (!status)
+					status.perror("MDGMessage::addNodeAddedCallback");
+
+				s_globalCallbacks.append(MDGMessage::addNodeRemovedCallback(&HelixBVH::MDGMessage_helixAddedRemoved, HELIX_HELIX_NAME, NULL, &status));
+
+				if (!status)
+					status.perror("MDGMessage::addNodeRemovedCallback");
+
+				s_globalCallbacks.append(MDagMessage::addParentAddedCallback(&HelixBVH::MDagMessage_parentAdded, NULL, &status));
+
+				if (!status)
+					status.perror("MDagMessage::addParentAddedCallback");
+
+				s_globalCallbacks.append(MDGMessage::addTimeChangeCallback(&HelixBVH::MDGMessage_timeChange, NULL, &status));
+
+				if (!status)
+					status.perror("MDGMessage::addTimeChangeCallback");
+
+				s_globalCallbacks.append(MSceneMessage::addCallback(MSceneMessage::kBeforeNew, &HelixBVH::MSceneMessage_beforeNewOpen, NULL, &status));
+
+				if (!status)
+					status.perror("MSceneMessage::addCallback");
+
+				s_globalCallbacks.append(MSceneMessage::addCallback(MSceneMessage::kBeforeOpen, &HelixBVH::MSceneMessage_beforeNewOpen, NULL, &status));
+
+				if (!status)
+					status.perror("MSceneMessage::addCallback");
+			}
+
+			if (s_rescan)
+				rescan();
+			else if (s_dirty)
+				update();
+
+			++s_frame;
+
+			std::vector<unsigned int> frames(s_entries.size(), 0);
+			HelixBVH_CullVisitor visitor(frames, s_frame);
+
+			s_bvh.query(frustum, visitor);
+
+			for (size_t i = 0; i < s_entries.size(); ++i)
+				s_entries[i].frame = frames[i];
+
+			s_culled = true;
+		}
+
+		bool HelixBVH::isVisible(const MObject & helix) {
+			if (!s_culled)
+				return true;
+
+			index_map_t::const_iterator it(s_indices.find(MObjectHandle(helix)));
+
+			if (it == s_indices.end())
+				return true;
+
+			return s_entries[it->second].frame == s_frame;
+		}
+
+		void HelixBVH::rescan() {
+			MStatus status;
+
+			clear();
+
+			handle_set_t ancestors;
+			MItDag itDag(MItDag::kDepthFirst, MFn::kTransform, &status);
+
+			if (!status) {
+				status.perror("MItDag::#ctor");
+				return;
+			}
+
+			for (; !itDag.isDone(); itDag.next()) {
+				MObject helix(itDag.currentItem(&status));
+
+				if (!status) {
+					status.perror("MItDag::currentItem");
+					return;
+				}
+
+				MFnDagNode helix_dagNode(helix);
+
+				if (helix_dagNode.typeId(&status) != ::Helix::Helix::id)
+					continue;
+
+				const MObjectHandle handle(helix);
+				void *clientData = reinterpret_cast<void *>(s_entries.size());
+
+				if (s_indices.find(handle) != s_indices.end())
+					continue;
+
+				Entry entry;
+				entry.helix = handle;
+				entry.callbacks[0] = entry.callbacks[1] = 0;
+				entry.frame = 0;
+				entry.dirty = true;
+
+				if (!(status = itDag.getPath(entry.path))) {
+					status.perror("MItDag::getPath");
+					continue;
+				}
+
+				entry.callbacks[0] = MNodeMessage::addAttributeChangedCallback(helix, &HelixBVH::MNodeMessage_helix_attributeChanged, clientData, &status);
+
+				if (!status) {
+					status.perror("MNodeMessage::addAttributeChangedCallback helix");
+					entry.callbacks[0] = 0;
+				}
+
+				/*
+				 * The cylinder range is stored on the HelixShape
+				 */
+
+				for (unsigned int i = 0; i < helix_dagNode.childCount(); ++i) {
+					MObject child(helix_dagNode.child(i));
+
+					if (MFnDagNode(child).typeId() != HelixShape::id)
+						continue;
+
+					entry.callbacks[1] = MNodeMessage::addAttributeChangedCallback(child, &HelixBVH::MNodeMessage_shape_attributeChanged, clientData, &status);
+
+					if (!status) {
+						status.perror("MNodeMessage::addAttributeChangedCallback shape");
+						entry.callbacks[1] = 0;
+					}
+
+					break;
+				}
+
+				/*
+				 * Moving a group the helix is in changes its world space volume too
+				 */
+
+				MDagPath ancestor(entry.path);
+
+				while (ancestor.pop() && ancestor.length() > 0) {
+					MObject ancestor_object(ancestor.node());
+
+					if (!ancestors.insert(MObjectHandle(ancestor_object)).second)
+						break;
+
+					s_ancestorCallbacks.append(MNodeMessage::addAttributeChangedCallback(ancestor_object, &HelixBVH::MNodeMessage_ancestor_attributeChanged, NULL, &status));
+
+					if (!status)
+						status.perror("MNodeMessage::addAttributeChangedCallback ancestor");
+				}
+
+				s_indices.insert(std::make_pair(handle, (unsigned int) s_entries.size()));
+				s_entries.push_back(entry);
+			}
+
+			s_rescan = false;
+			s_dirty = true;
+
+			update();
+		}
+
+		void HelixBVH::update() {
+			MStatus status;
+			std::vector<MBoundingBox> boxes(s_entries.size());
+
+			for (size_t i = 0; i < s_entries.size(); ++i) {
+				if (s_entries[i].dirty && !(status = calculateBox(s_entries[i])))
+					status.perror("HelixBVH::calculateBox");
+
+				boxes[i] = s_entries[i].box;
+			}
+
+			s_bvh.build(boxes);
+			s_dirty = false;
+		}
+
+		MStatus HelixBVH::calculateBox(Entry & entry) {
+			MStatus status;
+			double origo = 0.0, height = 0.0;
+
+			entry.dirty = false;
+
+			if (!entry.helix.isValid() || !entry.path.isValid())
+				return MStatus::kSuccess;
+
+			const MMatrix matrix(entry.path.inclusiveMatrix(&status));
+
+			if (!status) {
+				status.perror("MDagPath::inclusiveMatrix");
+				return status;
+			}
+
+			/*
+			 * A helix without a cylinder range still gets a box around its origin
+			 */
+
+			Model::Helix helix(entry.helix.object(), entry.path);
+
+			if (!(status = helix.getCylinderRange(origo, height)))
+				status.perror("Helix::getCylinderRange");
+
+			const double radius = DNA::RADIUS + HELIXBVH_MARGIN;
+
+			MBoundingBox box(MPoint(-radius, -radius, origo - height / 2.0 - HELIXBVH_MARGIN), MPoint(radius, radius, origo + height / 2.0 + HELIXBVH_MARGIN));
+
+			/*
+			 * Bases animated by a trajectory can be far outside of the cylinder, Maya caches the bounding box of the children
+			 */
+
+			const MBoundingBox children(MFnDagNode(entry.path).boundingBox(&status));
+
+			if (status)
+				box.expand(children);
+
+			box.transformUsing(matrix);
+			entry.box = box;
+
+			return MStatus::kSuccess;
+		}
+
+		void HelixBVH::clear() {
+			for (std::vector<Entry>::iterator it = s_entries.begin(); it != s_entries.end(); ++it) {
+				for (int i = 0; i < 2; ++i) {
+					if (it->callbacks[i] != 0)
+						MMessage::removeCallback(it->callbacks[i]);
+				}
+			}
+
+			if (s_ancestorCallbacks.length() > 0) {
+				MMessage::removeCallbacks(s_ancestorCallbacks);
+				s_ancestorCallbacks.clear();
+			}
+
+			s_entries.clear();
+			s_indices.clear();
+			s_bvh.clear();
+			s_culled = false;
+		}
+
+		void HelixBVH::release() {
+			clear();
+
+			if (s_globalCallbacks.length() > 0) {
+				MMessage::removeCallbacks(s_globalCallbacks);
+				s_globalCallbacks.clear();
+			}
+
+			s_rescan = true;
+		}
+
+		void HelixBVH::markDirty(void *clientData) {
+			const size_t index = reinterpret_cast<size_t>(clientData);
+
+			if (index < s_entries.size()) {
+				s_entries[index].dirty = true;
+				s_dirty = true;
+			}
+		}
+
+		void HelixBVH::MNodeMessage_helix_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData) {
+			if (msg & (MNodeMessage::kAttributeSet | MNodeMessage::kConnectionMade | MNodeMessage::kConnectionBroken))
+				markDirty(clientData);
+		}
+
+		void HelixBVH::MNodeMessage_shape_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData) {
+			if (msg & MNodeMessage::kAttributeSet)
+				markDirty(clientData);
+		}
+
+		void HelixBVH::MNodeMessage_ancestor_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData) {
+			if (msg & (MNodeMessage::kAttributeSet | MNodeMessage::kConnectionMade | MNodeMessage::kConnectionBroken))
+				MDGMessage_timeChange(MTime(), NULL);
+		}
+
+		void HelixBVH::MDGMessage_helixAddedRemoved(MObject & node, void *clientData) {
+			s_rescan = true;
+		}
+
+		/*
+		 * Returns true if the node or any of its descendants is a helix. Bases are pruned, they can not have helices below them
+		 */
+
+		bool HelixBVH_hasHelix(const MDagPath & path) {
+			MStatus status;
+			MItDag itDag(MItDag::kDepthFirst, MFn::kTransform, &status);
+
+			if (!status) {
+				status.perror("MItDag::#ctor");
+				return true;
+			}
+
+			if (!(status = itDag.reset(path, MItDag::kDepthFirst, MFn::kTransform))) {
+				status.perror("MItDag::reset");
+				return true;
+			}
+
+			for (; !itDag.isDone(); itDag.next()) {
+				const MTypeId typeId(MFnDagNode(itDag.currentItem()).typeId(&status));
+
+				if (!status) {
+					status.perror("MFnDagNode::typeId");
+					return true;
+				}
+
+				if (typeId == ::Helix::Helix::id)
+					return true;
+
+				if (typeId == ::Helix::HelixBase::id)
+					itDag.prune();
+			}
+
+			return false;
+		}
+
+		void HelixBVH::MDagMessage_parentAdded(MDagPath & child, MDagPath & parent, void *clientData) {
+			/*
+			 * Only reparenting a helix, or a group with helices below it, changes the path or the ancestors of a helix.
+			 * The shapes of every new base are parented too, and must not trigger a rescan.
+			 */
+
+			if (!s_rescan && HelixBVH_hasHelix(child))
+				s_rescan = true;
+		}
+
+		void HelixBVH::MDGMessage_timeChange(MTime & time, void *clientData) {
+			for (std::vector<Entry>::iterator it = s_entries.begin(); it != s_entries.end(); ++it)
+				it->dirty = true;
+
+			s_dirty = true;
+		}
+
+		void HelixBVH::MSceneMessage_beforeNewOpen(void *clientData) {
+			clear();
+			s_rescan = true;
+		}
+	}
+}
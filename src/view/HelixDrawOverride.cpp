@@ -0,0 +1,104 @@
+#include <opengl.h>
+
+#include <view/HelixDrawOverride.h>
+
+#ifdef HELIX_VIEWPORT2
+
+#include <view/HelixShape.h>
+#include <view/HelixShapeUI.h>
+
+#include <maya/MFnDagNode.h>
+#include <maya/MGeometryUtilities.h>
+
+namespace Helix {
+	namespace View {
+		HelixDrawOverride::HelixDrawOverride(const MObject & obj) : MHWRender::MPxDrawOverride(obj, HelixDrawOverride::draw) {
+
+		}
+
+		HelixDrawOverride::~HelixDrawOverride() {
+
+		}
+
+		MHWRender::MPxDrawOverride *HelixDrawOverride::creator(const MObject & obj) {
+			return new HelixDrawOverride(obj);
+		}
+
+		MHWRender::DrawAPI HelixDrawOverride::supportedDrawAPIs() const {
+			/*
+			 * HelixShapeUI draws with GLSL and display lists
+			 */
+
+			return MHWRender::kOpenGL;
+		}
+
+		bool HelixDrawOverride::isBounded(const MDagPath & objPath, const MDagPath & cameraPath) const {
+			return true;
+		}
+
+		MBoundingBox HelixDrawOverride::boundingBox(const MDagPath & objPath, const MDagPath & cameraPath) const {
+			MStatus status;
+			MFnDagNode dagNode(objPath, &status);
+
+			if (!status) {
+				status.perror("MFnDagNode::#ctor");
+				return MBoundingBox();
+			}
+
+			HelixShape *shape = (HelixShape *) dagNode.userNode(&status);
+
+			if (!status || !shape) {
+				status.perror("MFnDagNode::userNode");
+				return MBoundingBox();
+			}
+
+			return shape->boundingBox();
+		}
+
+		MUserData *HelixDrawOverride::prepareForDraw(const MDagPath & objPath, const MDagPath & cameraPath, const MHWRender::MFrameContext & frameContext, MUserData *oldData) {
+			// The data returned by the previous call is passed back, it is kept between frames.
+			Data *data = oldData ? static_cast<Data *>(oldData) : new Data();
+
+			data->ui = static_cast<const HelixShapeUI *>(MPxSurfaceShapeUI::surfaceShapeUI(objPath));
+			data->level = HelixLOD::kCylinder;
+
+			if (!data->ui)
+				return data;
+
+			/*
+			 * Same as HelixShapeUI::getDrawRequests, the level is evaluated even when nothing is drawn so that HelixLOD knows about the frame
+			 */
+
+			M3dView view = BaseDrawOverride_view(cameraPath);
+			MDagPath helixPath(objPath);
+
+			if (helixPath.pop())
+				data->level = HelixLOD::level(helixPath, view);
+
+			data->color = HelixShapeUI::borderColor(view, (M3dView::DisplayStatus) MHWRender::MGeometryUtilities::displayStatus(objPath));
+
+			return data;
+		}
+
+		void HelixDrawOverride::draw(const MHWRender::MDrawContext & context, const MUserData *userData) {
+			const Data *data = static_cast<const Data *>(userData);
+
+			if (!data || !data->ui)
+				return;
+
+			if (data->level == HelixLOD::kBases || data->level == HelixLOD::kCulled) {
+				HelixLOD::drawn();
+				return;
+			}
+
+			if (!BaseDrawOverride_beginGL(context))
+				return;
+
+			data->ui->drawCylinder(data->level, data->color);
+
+			BaseDrawOverride_endGL();
+		}
+	}
+}
+
+#endif /* N HELIX_VIEWPORT2 */
@@ -0,0 +1,202 @@
+#include <view/HelixLOD.h>
+#include <view/HelixBVH.h>
+#include <view/BVH.h>
+
+#include <ToggleCylinderBaseView.h>
+
+#include <maya/MBoundingBox.h>
+#include <maya/MFnCamera.h>
+#include <maya/MFnDagNode.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MVector.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Helix {
+	namespace View {
+		HelixLOD::level_map_t HelixLOD::s_levels;
+		MTimer HelixLOD::s_timer;
+		MPoint HelixLOD::s_eye;
+		MDagPath HelixLOD::s_camera;
+		double HelixLOD::s_scale = 1.0, HelixLOD::s_pixelsPerUnit = std::numeric_limits<double>::max();
+		bool HelixLOD::s_drawn = false, HelixLOD::s_timing = false, HelixLOD::s_orthographic = false;
+
+		bool HelixLOD::isAutomatic() {
+			return ToggleCylinderBaseView::CurrentView == TOGGLECYLINDERBASEVIEW_AUTOMATIC;
+		}
+
+		HelixLOD::Level HelixLOD::level(const MDagPath & helixPath, M3dView & view) {
+			MStatus status;
+
+			if (s_drawn) {
+				/*
+				 * Adjust the thresholds to the time the previous frame took
+				 */
+
+				const double frameTime = s_timer.elapsedTime();
+
+				if (frameTime > HELIXLOD_FRAME_BUDGET)
+					s_scale = std::min(s_scale * 1.5, HELIXLOD_MAX_SCALE);
+				else if (frameTime < HELIXLOD_FRAME_BUDGET / 2.0)
+					s_scale = std::max(s_scale / 1.25, 1.0);
+
+				s_levels.clear();
+				s_drawn = false;
+				s_timing = false;
+			}
+
+			/*
+			 * Several panes are drawn one after another. A pane with nothing to draw never calls drawn, thus a new frame is also
+			 * started when the camera is not the one the helices were culled for
+			 */
+
+			if (s_timing) {
+				MDagPath cameraPath;
+
+				if (view.getCamera(cameraPath) && !(cameraPath == s_camera)) {
+					s_levels.clear();
+					s_timing = false;
+				}
+			}
+
+			if (!s_timing) {
+				s_timer.beginTimer();
+				s_timing = true;
+
+				beginFrame(view);
+			}
+
+			MObject helix(helixPath.node(&status));
+
+			if (!status) {
+				status.perror("MDagPath::node");
+				return kBases;
+			}
+
+			const MObjectHandle handle(helix);
+			level_map_t::const_iterator it(s_levels.find(handle));
+
+			if (it != s_levels.end())
+				return it->second;
+
+			Level level;
+
+			if (!HelixBVH::isVisible(helix))
+				level = kCulled;
+			else if (!isAutomatic())
+				level = ToggleCylinderBaseView::CurrentView == TOGGLECYLINDERBASEVIEW_CYLINDERS ? kCylinder : kBases;
+			else
+				level = evaluate(helixPath);
+
+			s_levels.insert(std::make_pair(handle, level));
+
+			return level;
+		}
+
+		HelixLOD::Level HelixLOD::lastLevel(const MDagPath & helixPath) {
+			MStatus status;
+			MObject helix(helixPath.node(&status));
+
+			if (!status) {
+				status.perror("MDagPath::node");
+				return kBases;
+			}
+
+			level_map_t::const_iterator it(s_levels.find(MObjectHandle(helix)));
+
+			return it != s_levels.end() ? it->second : kBases;
+		}
+
+		void HelixLOD::drawn() {
+			if (!s_timing)
+				return;
+
+			s_timer.endTimer();
+			s_drawn = true;
+		}
+
+		void HelixLOD::beginFrame(M3dView & view) {
+			MStatus status;
+			MDagPath cameraPath;
+
+			/*
+			 * On failure the frustum is empty and nothing is culled
+			 */
+
+			Frustum frustum;
+			frustum.setFromView(view);
+			HelixBVH::cull(frustum);
+
+			s_pixelsPerUnit = std::numeric_limits<double>::max();
+			s_orthographic = false;
+			s_camera = MDagPath();
+
+			if (!(status = view.getCamera(cameraPath))) {
+				status.perror("M3dView::getCamera");
+				return;
+			}
+
+			s_camera = cameraPath;
+
+			MFnCamera camera(cameraPath, &status);
+
+			if (!status) {
+				status.perror("MFnCamera::#ctor");
+				return;
+			}
+
+			if ((s_orthographic = camera.isOrtho()))
+				s_pixelsPerUnit = view.portWidth() / std::max(camera.orthoWidth(), std::numeric_limits<double>::epsilon());
+			else {
+				s_eye = camera.eyePoint(MSpace::kWorld);
+				s_pixelsPerUnit = view.portHeight() / (2.0 * std::tan(camera.verticalFieldOfView() / 2.0));
+			}
+		}
+
+		HelixLOD::Level HelixLOD::evaluate(const MDagPath & helixPath) {
+			MStatus status;
+			double pixelsPerUnit = s_pixelsPerUnit;
+
+			if (!s_orthographic) {
+				MFnDagNode dagNode(helixPath, &status);
+
+				if (!status) {
+					status.perror("MFnDagNode::#ctor");
+					return kBases;
+				}
+
+				const MBoundingBox box(dagNode.boundingBox(&status));
+
+				if (!status) {
+					status.perror("MFnDagNode::boundingBox");
+					return kBases;
+				}
+
+				/*
+				 * Distance from the camera to the closest point of the bounding box, in the space of the helix
+				 */
+
+				const MPoint eye(s_eye * helixPath.inclusiveMatrixInverse()), min(box.min()), max(box.max());
+				const MVector offset(
+					std::max(std::max(min.x - eye.x, eye.x - max.x), 0.0),
+					std::max(std::max(min.y - eye.y, eye.y - max.y), 0.0),
+					std::max(std::max(min.z - eye.z, eye.z - max.z), 0.0));
+				const double distance = offset.length();
+
+				if (distance < std::numeric_limits<double>::epsilon())
+					return kBases;
+
+				pixelsPerUnit /= distance;
+			}
+
+			if (pixelsPerUnit >= HELIXLOD_BASES_PIXELS_PER_UNIT * s_scale)
+				return kBases;
+			else if (pixelsPerUnit >= HELIXLOD_CYLINDER_PIXELS_PER_UNIT * s_scale)
+				return kCylinder;
+
+			return kBox;
+		}
+	}
+}
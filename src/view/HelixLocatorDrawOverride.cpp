@@ -0,0 +1,114 @@
+#include <opengl.h>
+
+#include <view/HelixLocatorDrawOverride.h>
+
+#ifdef HELIX_VIEWPORT2
+
+#include <Locator.h>
+
+#include <maya/MFnCamera.h>
+#include <maya/MFnDagNode.h>
+
+namespace Helix {
+	namespace View {
+		HelixLocatorDrawOverride::HelixLocatorDrawOverride(const MObject & obj) : MHWRender::MPxDrawOverride(obj, HelixLocatorDrawOverride::draw) {
+
+		}
+
+		HelixLocatorDrawOverride::~HelixLocatorDrawOverride() {
+
+		}
+
+		MHWRender::MPxDrawOverride *HelixLocatorDrawOverride::creator(const MObject & obj) {
+			return new HelixLocatorDrawOverride(obj);
+		}
+
+		MHWRender::DrawAPI HelixLocatorDrawOverride::supportedDrawAPIs() const {
+			/*
+			 * HelixLocator draws with GLSL point sprites
+			 */
+
+			return MHWRender::kOpenGL;
+		}
+
+		bool HelixLocatorDrawOverride::isBounded(const MDagPath & objPath, const MDagPath & cameraPath) const {
+			/*
+			 * Same as HelixLocator::isBounded
+			 */
+
+			return false;
+		}
+
+		MBoundingBox HelixLocatorDrawOverride::boundingBox(const MDagPath & objPath, const MDagPath & cameraPath) const {
+			return MBoundingBox();
+		}
+
+		MUserData *HelixLocatorDrawOverride::prepareForDraw(const MDagPath & objPath, const MDagPath & cameraPath, const MHWRender::MFrameContext & frameContext, MUserData *oldData) {
+			MStatus status;
+			Data *data = oldData ? static_cast<Data *>(oldData) : new Data();
+
+			data->locator = NULL;
+
+			MFnDagNode dagNode(objPath, &status);
+
+			if (!status) {
+				status.perror("MFnDagNode::#ctor");
+				return data;
+			}
+
+			HelixLocator *locator = (HelixLocator *) dagNode.userNode(&status);
+
+			if (!status || !locator) {
+				status.perror("MFnDagNode::userNode");
+				return data;
+			}
+
+			/*
+			 * Just like in HelixLocator::draw, the orthographic views are rendered differently
+			 */
+
+			MFnCamera camera(cameraPath, &status);
+
+			if (!status) {
+				status.perror("MFnCamera::#ctor");
+				return data;
+			}
+
+			data->isOrtho = camera.isOrtho(&status);
+
+			if (!status) {
+				status.perror("MFnCamera::isOrtho");
+				return data;
+			}
+
+			if (locator->prepareDraw())
+				data->locator = locator;
+
+			return data;
+		}
+
+		void HelixLocatorDrawOverride::draw(const MHWRender::MDrawContext & context, const MUserData *userData) {
+			MStatus status;
+			const Data *data = static_cast<const Data *>(userData);
+
+			if (!data || !data->locator)
+				return;
+
+			int originX, originY, width, height;
+
+			if (!(status = context.getViewportDimensions(originX, originY, width, height))) {
+				status.perror("MDrawContext::getViewportDimensions");
+				return;
+			}
+
+			if (!BaseDrawOverride_beginGL(context))
+				return;
+
+			data->locator->drawGL(data->isOrtho, width, height);
+
+			BaseDrawOverride_endGL();
+		}
+	}
+}
+
+#endif /* N HELIX_VIEWPORT2 */
@@ -2,14 +2,21 @@
 
 #include <view/HelixShapeUI.h>
 #include <view/HelixShape.h>
+#include <view/BaseShape.h>
+#include <view/HelixLOD.h>
 #include <model/Helix.h>
 #include <model/Base.h>
 #include <model/Color.h>
 
+#include <maya/MBoundingBox.h>
+#include <maya/MDagMessage.h>
+#include <maya/MDGMessage.h>
 #include <maya/MDrawData.h>
 #include <maya/MDrawRequest.h>
 #include <maya/MFnDagNode.h>
 #include <maya/MFnTransform.h>
+#include <maya/MMatrix.h>
+#include <maya/MPoint.h>
 #include <maya/MQuaternion.h>
 #include <maya/MTransformationMatrix.h>
 #include <maya/MFnSingleIndexedComponent.h>
@@ -18,6 +25,8 @@
 #include <memory>
 #include <list>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 #include <Utility.h>
 
@@ -38,6 +47,22 @@ namespace Helix {
 
 			getDrawData(shape, data);
 			request.setDrawData(data);
+
+			/*
+			 * Nothing is drawn when the helix is outside the view, or when its bases are drawn in the automatic view.
+			 * The request is still added, so that HelixLOD knows when the frame was drawn
+			 */
+
+			{
+				MDagPath helixPath(request.multiPath());
+				M3dView view = info.view();
+				HelixLOD::Level level = HelixLOD::kCylinder;
+
+				if (helixPath.pop())
+					level = HelixLOD::level(helixPath, view);
+
+				request.setToken(level);
+			}
 	
 			requests.add(request);
 		}
@@ -49,10 +74,43 @@ namespace Helix {
 			/*if (ToggleCylinderBaseView::CurrentView != 1)
 				return;*/
 
+			const HelixLOD::Level level = (HelixLOD::Level) request.token();
+
+			if (level == HelixLOD::kBases || level == HelixLOD::kCulled) {
+				HelixLOD::drawn();
+				return;
+			}
+
+			const MColor color(borderColor(view, request.displayStatus()));
+
+			view.beginGL();
+			drawCylinder(level, color);
+			view.endGL();
+		}
+
+		MColor HelixShapeUI::borderColor(M3dView & view, M3dView::DisplayStatus displayStatus) {
+			switch (displayStatus)
+            {
+            case M3dView::kLead :
+				return view.colorAtIndex( LEAD_COLOR);
+            case M3dView::kActive :
+                return view.colorAtIndex( ACTIVE_COLOR);
+            case M3dView::kActiveAffected :
+                return view.colorAtIndex( ACTIVE_AFFECTED_COLOR);
+            case M3dView::kDormant :
+				return view.colorAtIndex( DORMANT_COLOR, M3dView::kDormantColors);
+            case M3dView::kHilite :
+                return view.colorAtIndex( HILITE_COLOR);
+            default:
+            	std::cerr << "Unknown displayStatus for helix. Probably nothing to worry about." << std::endl;
+            	return MColor();
+            }
+		}
+
+		void HelixShapeUI::drawCylinder(HelixLOD::Level level, const MColor & color) const {
 			MStatus status;
 
-			MDrawData data = request.drawData();
-			HelixShape *shape = static_cast<HelixShape *> (data.geometry()); // Not really necessary, we can just as well call surfaceShape
+			HelixShape *shape = (HelixShape *) surfaceShape();
 
 			Model::Helix helix(MFnDagNode(shape->thisMObject()).parent(0, &status));
 
@@ -80,9 +138,6 @@ namespace Helix {
 				return;
 			}
 
-			
-			view.beginGL();
-
 			if (!s_drawData.initialized)
 				initializeDraw();
 
@@ -90,37 +145,160 @@ namespace Helix {
 				const_cast<HelixShapeUI *>(this)->initializeLocalDraw();
 
 			/*
-			 * Set selection color
+			 * Distant helices in the automatic view are only drawn as their bounding box
 			 */
 
-			MColor borderColor;
+			if (level == HelixLOD::kBox) {
+				const MBoundingBox box(shape->boundingBox());
+				const MPoint min(box.min()), max(box.max());
 
-			switch (request.displayStatus())
-            {
-            case M3dView::kLead :
-				borderColor = view.colorAtIndex( LEAD_COLOR);
-				break;
-            case M3dView::kActive :
-                borderColor = view.colorAtIndex( ACTIVE_COLOR);
-                break;
-            case M3dView::kActiveAffected :
-                borderColor = view.colorAtIndex( ACTIVE_AFFECTED_COLOR);
-                break;
-            case M3dView::kDormant :
-				borderColor = view.colorAtIndex( DORMANT_COLOR, M3dView::kDormantColors);
-                break;
-            case M3dView::kHilite :
-                borderColor = view.colorAtIndex( HILITE_COLOR);
-                break;
-            default:
-            	std::cerr << "Unknown displayStatus for helix. Probably nothing to worry about." << std::endl;
-            	break;
-            }
+				GLCALL(glPushAttrib(GL_CURRENT_BIT));
+				GLCALL(glColor3f(color.r, color.g, color.b));
+
+				glBegin(GL_LINES);
+
+				for(int i = 0; i < 4; ++i) {
+					const double x = (i & 1) ? max.x : min.x, y = (i & 2) ? max.y : min.y;
+
+					glVertex3d(x, y, min.z);
+					glVertex3d(x, y, max.z);
+				}
+
+				for(int i = 0; i < 2; ++i) {
+					const double z = i ? max.z : min.z;
+
+					glVertex3d(min.x, min.y, z); glVertex3d(max.x, min.y, z);
+					glVertex3d(max.x, min.y, z); glVertex3d(max.x, max.y, z);
+					glVertex3d(max.x, max.y, z); glVertex3d(min.x, max.y, z);
+					glVertex3d(min.x, max.y, z); glVertex3d(min.x, min.y, z);
+				}
+
+				glEnd();
+
+				GLCALL(glPopAttrib());
+
+				HelixLOD::drawn();
+				return;
+			}
+
+			/*
+			 * Only rebuild the texture if any of our bases moved or changed material since the last draw
+			 */
+
+			HelixShapeUI *self = const_cast<HelixShapeUI *>(this);
+
+			if (m_drawData.childrenChanged) {
+				if (!(status = self->registerCallbacks(helix)))
+					status.perror("HelixShapeUI::registerCallbacks");
+
+				self->m_drawData.childrenChanged = false;
+				self->m_drawData.dirty = true;
+			}
+
+			if (m_drawData.dirty || m_drawData.origo != origo || m_drawData.height != height) {
+				if (!(status = self->updateTexture(helix, origo, height))) {
+					status.perror("HelixShapeUI::updateTexture");
+					return;
+				}
+			}
+
+			GLCALL(glPushAttrib(GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT));
+			GLCALL(glBindTexture(GL_TEXTURE_2D, m_drawData.texture));
+
+			GLCALL(glUseProgram(s_drawData.program));
+			//GLCALL(glUniform2f(s_drawData.range_uniform, (GLfloat) origo, (GLfloat) height));
+			//GLCALL(glUniform3f(s_drawData.borderColor_uniform, borderColor.r, borderColor.g, borderColor.b));
+			s_drawData.updateRangeUniform((GLfloat) origo, (GLfloat) height);
+			s_drawData.updateBorderColorUniform(color.r, color.g, color.b);
+
+			GLCALL(glCallList(s_drawData.draw_display_list));
+
+			// Note: No glPopAttrib, cause it's compiled into the display list!
+
+			HelixLOD::drawn();
+		}
+
+		MStatus HelixShapeUI::registerCallbacks(Model::Helix & helix) {
+			MStatus status;
+
+			if (m_drawData.callbacks.length() > 0) {
+				MMessage::removeCallbacks(m_drawData.callbacks);
+				m_drawData.callbacks.clear();
+			}
+
+			for(Model::Helix::BaseIterator it = helix.begin(); it != helix.end(); ++it) {
+				MObject base = it->getObject(status);
+
+				if (!status) {
+					status.perror("Base::getObject");
+					return status;
+				}
+
+				m_drawData.callbacks.append(MNodeMessage::addAttributeChangedCallback(base, &HelixShapeUI::MNodeMessage_base_attributeChanged, &m_drawData, &status));
+
+				if (!status) {
+					status.perror("MNodeMessage::addAttributeChangedCallback base");
+					return status;
+				}
+
+				MFnDagNode base_dagNode(base);
+
+				for(unsigned int i = 0; i < base_dagNode.childCount(); ++i) {
+					MObject child = base_dagNode.child(i);
+
+					if (MFnDagNode(child).typeId() != BaseShape::id)
+						continue;
+
+					m_drawData.callbacks.append(MNodeMessage::addAttributeChangedCallback(child, &HelixShapeUI::MNodeMessage_shape_attributeChanged, &m_drawData, &status));
+
+					if (!status) {
+						status.perror("MNodeMessage::addAttributeChangedCallback shape");
+						return status;
+					}
+				}
+			}
+
+			/*
+			 * Bases added to or removed from the helix need their callbacks registered or removed, even if the number of bases is the same
+			 */
+
+			MDagPath & helix_dagPath = helix.getDagPath(status);
+
+			if (!status) {
+				status.perror("Helix::getDagPath");
+				return status;
+			}
+
+			m_drawData.callbacks.append(MDagMessage::addChildAddedDagPathCallback(helix_dagPath, &HelixShapeUI::MDagMessage_childAddedRemoved, &m_drawData, &status));
+
+			if (!status) {
+				status.perror("MDagMessage::addChildAddedDagPathCallback");
+				return status;
+			}
+
+			m_drawData.callbacks.append(MDagMessage::addChildRemovedDagPathCallback(helix_dagPath, &HelixShapeUI::MDagMessage_childAddedRemoved, &m_drawData, &status));
+
+			if (!status) {
+				status.perror("MDagMessage::addChildRemovedDagPathCallback");
+				return status;
+			}
 
 			/*
-			 * Collect color data from our bases and paint our texture
+			 * Animated bases don't trigger any attribute changes
 			 */
 
+			m_drawData.callbacks.append(MDGMessage::addTimeChangeCallback(&HelixShapeUI::MDGMessage_timeChange, &m_drawData, &status));
+
+			if (!status) {
+				status.perror("MDGMessage::addTimeChangeCallback");
+				return status;
+			}
+
+			return MStatus::kSuccess;
+		}
+
+		MStatus HelixShapeUI::updateTexture(Model::Helix & helix, double origo, double height) {
+			MStatus status;
 			GLsizei texture_height = (GLsizei) ceilf(float(height / DNA::STEP)) + 1;
 
 			GLfloat *colors = new GLfloat[texture_height * 2  * 4];
@@ -143,7 +321,8 @@ namespace Helix {
 
 				if (!(status = base.getTranslation(base_translation, MSpace::kTransform))) {
 					status.perror("Model::Base::getTranslation");
-					return;
+					delete[] colors;
+					return status;
 				}
 
 				/*
@@ -164,7 +343,8 @@ namespace Helix {
 
 				if (!(status = base.getMaterialColor(colors[(y * 2 + x) * 4], colors[(y * 2 + x) * 4 + 1], colors[(y * 2 + x) * 4 + 2], colors[(y * 2 + x) * 4 + 3]))) {
 					status.perror("Base::getMaterialColor");
-					return;
+					delete[] colors;
+					return status;
 				}
 
 				colors[(y * 2 + x) * 4 + 3] = 1.0f;
@@ -179,66 +359,77 @@ namespace Helix {
 
 			if (m_drawData.last_colors != NULL) {
 				if (m_drawData.texture_height == texture_height) {
-					if (std::equal(colors, colors +  texture_height * 2, m_drawData.last_colors))
+					if (std::equal(colors, colors + texture_height * 2 * 4, m_drawData.last_colors))
 						textureUpdate = false;
 				}
 
 				delete[] m_drawData.last_colors;
 			}
 
-			const_cast<HelixShapeUI *>(this)->m_drawData.last_colors = colors;
-
-			GLCALL(glPushAttrib(GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT));
-			GLCALL(glBindTexture(GL_TEXTURE_2D, m_drawData.texture));
+			m_drawData.last_colors = colors;
 
 			if (textureUpdate) {
+				GLCALL(glPushAttrib(GL_TEXTURE_BIT));
+				GLCALL(glBindTexture(GL_TEXTURE_2D, m_drawData.texture));
+
 				GLCALL(glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT));
 				GLCALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
 				if (m_drawData.texture_height != texture_height) {
 					GLCALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, texture_height, 0, GL_RGBA, GL_FLOAT, colors));
-					const_cast<HelixShapeUI *>(this)->m_drawData.texture_height = texture_height;
+					m_drawData.texture_height = texture_height;
 				}
 				else {
 					GLCALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 2, texture_height, GL_RGBA, GL_FLOAT, colors));
 				}
 				glPopClientAttrib();
+				glPopAttrib();
 			}
 
-			GLCALL(glUseProgram(s_drawData.program));
-			//GLCALL(glUniform2f(s_drawData.range_uniform, (GLfloat) origo, (GLfloat) height));
-			//GLCALL(glUniform3f(s_drawData.borderColor_uniform, borderColor.r, borderColor.g, borderColor.b));
-			s_drawData.updateRangeUniform((GLfloat) origo, (GLfloat) height);
-			s_drawData.updateBorderColorUniform(borderColor.r, borderColor.g, borderColor.b);
-
-			GLCALL(glCallList(s_drawData.draw_display_list));
+			m_drawData.origo = origo;
+			m_drawData.height = height;
+			m_drawData.dirty = false;
 
-			// Note: No glPopAttrib, cause it's compiled into the display list!
+			return MStatus::kSuccess;
+		}
 
-			view.endGL();
+		void HelixShapeUI::MNodeMessage_base_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData) {
+			if (msg & (MNodeMessage::kAttributeSet | MNodeMessage::kConnectionMade | MNodeMessage::kConnectionBroken))
+				static_cast<DrawData_Local *>(clientData)->dirty = true;
+		}
 
+		void HelixShapeUI::MNodeMessage_shape_attributeChanged(MNodeMessage::AttributeMessage msg, MPlug & plug, MPlug & otherPlug, void *clientData) {
 			/*
-			 * Don't delete the color array, it is saved for the next rendering
+			 * Materials are assigned by connecting instObjGroups to a shading group
 			 */
-			//delete[] colors;
+
+			if (msg & (MNodeMessage::kConnectionMade | MNodeMessage::kConnectionBroken))
+				static_cast<DrawData_Local *>(clientData)->dirty = true;
+		}
+
+		void HelixShapeUI::MDagMessage_childAddedRemoved(MDagPath & child, MDagPath & parent, void *clientData) {
+			static_cast<DrawData_Local *>(clientData)->childrenChanged = true;
+		}
+
+		void HelixShapeUI::MDGMessage_timeChange(MTime & time, void *clientData) {
+			static_cast<DrawData_Local *>(clientData)->dirty = true;
 		}
 
 		// Main selection routine
 		//
 
 		bool HelixShapeUI::select( MSelectInfo &selectInfo, MSelectionList &selectionList, MPointArray &worldSpaceSelectPts ) const {
-			if (ToggleCylinderBaseView::CurrentView != 1)
+			if (HelixLOD::isAutomatic()) {
+				MDagPath helixPath(selectInfo.multiPath());
+
+				if (!helixPath.pop() || HelixLOD::lastLevel(helixPath) == HelixLOD::kBases)
+					return false;
+			}
+			else if (ToggleCylinderBaseView::CurrentView != TOGGLECYLINDERBASEVIEW_CYLINDERS)
 				return false;
 
 			HelixShape *shape = (HelixShape *) surfaceShape();
 			MStatus status;
 
-			// Should never happen
-			//
-			if (!s_drawData.initialized) {
-				std::cerr << "Can't do selection, OpenGL context not initialized!" << std::endl;
-				return false;
-			}
-
 			/*
 			 * Get cylinder data
 			 */
@@ -258,28 +449,37 @@ namespace Helix {
 			}
 
 			/*
-			 * All code here is from the apiSimpleShapeUI and quadricShape but modified for our needs
+			 * The cylinder is tested against the ray of a click or the frustum of a marquee on the CPU, instead of being drawn in OpenGL selection mode
 			 */
 
 			M3dView view = selectInfo.view();
 			const MDagPath & path = selectInfo.multiPath();
+			const MMatrix matrix(path.inclusiveMatrix());
+			unsigned int x, y, rectWidth, rectHeight;
+			MPoint selectionPoint;
+			bool selected = false;
 
-			view.beginSelect();
+			selectInfo.selectRect(x, y, rectWidth, rectHeight);
 
-			glPushMatrix();
-			glScalef(1.0f, 1.0f, (GLfloat) height);
-			glTranslatef(0.0f, 0.0f, (GLfloat) origo - 0.5f);
-			glCallList(s_drawData.select_display_list);
+			if (selectInfo.singleSelection()) {
+				Ray ray;
+				double distance;
 
-			// The display list contains a glPopMatrix
+				if (ray.setFromView(view, short(x + rectWidth / 2), short(y + rectHeight / 2)) && (selected = intersectCylinder(ray.transformed(matrix.inverse()), origo, height, distance)))
+					selectionPoint = ray.origin + ray.direction * distance;
+			}
+			else {
+				Frustum frustum;
+
+				if (frustum.setFromRegion(view, short(x), short(y), short(x + rectWidth), short(y + rectHeight)) && (selected = frustum.intersects(MPoint(0.0, 0.0, origo - height / 2.0) * matrix, MPoint(0.0, 0.0, origo + height / 2.0) * matrix, DNA::RADIUS)))
+					selectionPoint = MPoint(0.0, 0.0, origo) * matrix;
+			}
 
-			if (view.endSelect() > 0) {
+			if (selected) {
 				MSelectionMask priorityMask( MSelectionMask::kSelectObjectsMask );
 				MSelectionList item;
 				item.add( selectInfo.selectPath() );
-				MPoint xformedPt;
-				xformedPt *= path.inclusiveMatrix();
-				selectInfo.addSelection( item, xformedPt, selectionList, worldSpaceSelectPts, priorityMask, false );
+				selectInfo.addSelection( item, selectionPoint, selectionList, worldSpaceSelectPts, priorityMask, false );
 				return true;
 			}
 
@@ -414,6 +614,55 @@ namespace Helix {
 			return selected;*/
 		}
 
+		bool HelixShapeUI::intersectCylinder(const Ray & ray, double origo, double height, double & distance) {
+			const double zmin = origo - height / 2.0, zmax = origo + height / 2.0, radius2 = DNA::RADIUS * DNA::RADIUS;
+			bool hit = false;
+
+			/*
+			 * The side of the cylinder along the z axis
+			 */
+
+			const double a = ray.direction.x * ray.direction.x + ray.direction.y * ray.direction.y,
+				b = 2.0 * (ray.origin.x * ray.direction.x + ray.origin.y * ray.direction.y),
+				c = ray.origin.x * ray.origin.x + ray.origin.y * ray.origin.y - radius2;
+
+			if (a > std::numeric_limits<double>::epsilon()) {
+				const double discriminant = b * b - 4.0 * a * c;
+
+				if (discriminant >= 0.0) {
+					const double root = std::sqrt(discriminant), t[] = { (-b - root) / (2.0 * a), (-b + root) / (2.0 * a) };
+
+					for (int i = 0; i < 2; ++i) {
+						const double z = ray.origin.z + t[i] * ray.direction.z;
+
+						if (t[i] >= 0.0 && z >= zmin && z <= zmax && (!hit || t[i] < distance)) {
+							distance = t[i];
+							hit = true;
+						}
+					}
+				}
+			}
+
+			/*
+			 * The caps
+			 */
+
+			if (std::fabs(ray.direction.z) > std::numeric_limits<double>::epsilon()) {
+				const double z[] = { zmin, zmax };
+
+				for (int i = 0; i < 2; ++i) {
+					const double t = (z[i] - ray.origin.z) / ray.direction.z, x = ray.origin.x + t * ray.direction.x, y = ray.origin.y + t * ray.direction.y;
+
+					if (t >= 0.0 && x * x + y * y <= radius2 && (!hit || t < distance)) {
+						distance = t;
+						hit = true;
+					}
+				}
+			}
+
+			return hit;
+		}
+
 		void *HelixShapeUI::creator() {
 			return new HelixShapeUI();
 		}